@@ -1,4 +1,5 @@
 #include "bitmap.h"
+#include "mappedfile.h"
 
 
 Bitmap::Bitmap()
@@ -92,6 +93,21 @@ void Bitmap::setBitCount(WORD bitCount)
   this->m_bitmapInfoHeader.m_bitCount = bitCount;
 }
 
+LONG Bitmap::getWidth() const
+{
+  return(abs(m_bitmapInfoHeader.m_width));
+}
+
+LONG Bitmap::getHeight() const
+{
+  return(abs(m_bitmapInfoHeader.m_height));
+}
+
+bool Bitmap::isTopDown() const
+{
+  return(m_bitmapInfoHeader.m_height < 0);
+}
+
 void Bitmap::writeToFile(char *filename)
 {
   DWORD pixelArraySize = calculatePixelArraySize();
@@ -123,9 +139,152 @@ void Bitmap::writeToFile(char *filename)
   }
 }
 
-void Bitmap::readFromFile(char *filename)
+bool Bitmap::readFromFile(const char *filename)
+{
+  MappedFile file;
+
+  if(!file.open(filename))
+    return(false);
+
+  return(readFromBuffer(file.getData(), file.getSize()));
+}
+
+/// little endian values of the file, which may not be aligned.
+static DWORD readDWORD(const unsigned char *p)
+{
+  return((DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16) | ((DWORD)p[3] << 24));
+}
+
+static WORD readWORD(const unsigned char *p)
+{
+  return((WORD)(p[0] | (p[1] << 8)));
+}
+
+bool Bitmap::readFromBuffer(const unsigned char *buffer, size_t size)
 {
+  const size_t fileHeaderSize = sizeof(BITMAPFILEHEADER);
+
+  if((buffer == NULL) || (size < fileHeaderSize + sizeof(BITMAPINFOHEADER)) || (readWORD(buffer) != 0x4d42))
+    return(false);
+
+  /// BITMAPINFOHEADER, or a later version of it (V4, V5) which starts the same way.
+  const unsigned char *info = buffer + fileHeaderSize;
+  DWORD offBits = readDWORD(buffer + 10);
+  DWORD infoSize = readDWORD(info);
+  LONG width = (LONG)readDWORD(info + 4);
+  LONG height = (LONG)readDWORD(info + 8);
+  WORD bitCount = readWORD(info + 14);
+  DWORD compression = readDWORD(info + 16);
+  DWORD clrUsed = readDWORD(info + 32);
+
+  if((infoSize < sizeof(BITMAPINFOHEADER)) || (width <= 0) || (height == 0) || (height == (LONG)0x80000000) ||
+      ((bitCount != 1) && (bitCount != 8) && (bitCount != 24) && (bitCount != 32)))
+    return(false);
+
+  if(compression == BI_BITFIELDS)
+  {
+    /// only the usual layout (the one of BI_RGB) is supported. The masks follow a
+    /// BITMAPINFOHEADER, or are part of the later versions.
+    if((bitCount != 32) || (size < fileHeaderSize + sizeof(BITMAPINFOHEADER) + 12) ||
+        (readDWORD(info + 40) != 0x00ff0000) || (readDWORD(info + 44) != 0x0000ff00) || (readDWORD(info + 48) != 0x000000ff))
+      return(false);
+  }
+  else if(compression != BI_RGB)
+    return(false);
+
+  DWORD rows = (DWORD)abs(height);
+
+  /// keep the row and pixel array sizes within a DWORD.
+  if(((DWORD)width > 0x3ffffff) || (((unsigned long long)((3 * (DWORD)width + 3) & ~3u) * rows) > 0xffffffffULL))
+    return(false);
+
+  DWORD srcRowSize = ((bitCount * (DWORD)width + 31) / 32) * 4;
+
+  if((offBits > size) || (((size - offBits) / srcRowSize) < rows))
+    return(false);
+
+  /// color table of the 1 and 8 bit bitmaps, 4 bytes (blue, green, red, 0) per entry.
+  const unsigned char *palette = info + infoSize;
+  DWORD paletteSize = 0;
+
+  if(bitCount <= 8)
+  {
+    paletteSize = ((clrUsed > 0) && (clrUsed <= (1u << bitCount))) ? clrUsed : (1u << bitCount);
+    if(((size_t)(palette - buffer) + (paletteSize * 4)) > offBits)
+      return(false);
+  }
+
+  m_bitmapFileHeader = BITMAPFILEHEADER();
+  m_bitmapInfoHeader = BITMAPINFOHEADER();
+  m_bitmapInfoHeader.m_width = width;
+  m_bitmapInfoHeader.m_height = height;
+  m_bitmapInfoHeader.m_bitCount = 24;
+  m_bitmapInfoHeader.m_xPelsPerMeter = (LONG)readDWORD(info + 24);
+  m_bitmapInfoHeader.m_yPelsPerMeter = (LONG)readDWORD(info + 28);
+
+  DWORD pixelArraySize = calculatePixelArraySize();
+  DWORD dstRowSize = pixelArraySize / rows;
+  m_bitmapFileHeader.m_size += pixelArraySize;
+
+  if(p_pixelArray != NULL)
+    free(p_pixelArray);
+
+  p_pixelArray = (unsigned char*)malloc(pixelArraySize);
+  if(p_pixelArray == NULL)
+    return(false);
+
+  const unsigned char *src = buffer + offBits;
+
+  /// same layout, the pixel array is taken as it is.
+  if(bitCount == 24)
+  {
+    memcpy(p_pixelArray, src, pixelArraySize);
+    return(true);
+  }
+
+  for(DWORD row = 0; row < rows; row++)
+  {
+    const unsigned char *s = src + (row * srcRowSize);
+    unsigned char *d = p_pixelArray + (row * dstRowSize);
+
+    switch(bitCount)
+    {
+      case 32:
+        for(LONG col = 0; col < width; col++, s += 4, d += 3)
+        {
+          d[0] = s[0];
+          d[1] = s[1];
+          d[2] = s[2];
+        }
+        break;
+
+      case 8:
+        for(LONG col = 0; col < width; col++, d += 3)
+        {
+          const unsigned char *entry = palette + (4 * (s[col] < paletteSize ? s[col] : 0));
+          d[0] = entry[0];
+          d[1] = entry[1];
+          d[2] = entry[2];
+        }
+        break;
+
+      case 1:
+        for(LONG col = 0; col < width; col++, d += 3)
+        {
+          DWORD index = (s[col >> 3] >> (7 - (col & 7))) & 1;
+          const unsigned char *entry = palette + (4 * (index < paletteSize ? index : 0));
+          d[0] = entry[0];
+          d[1] = entry[1];
+          d[2] = entry[2];
+        }
+        break;
+    }
+
+    /// row padding is left as zero, like a written bitmap.
+    memset(d, 0, dstRowSize - (3 * width));
+  }
 
+  return(true);
 }
 
 DWORD Bitmap::calculatePixelArraySize() const
@@ -34,6 +34,7 @@ typedef signed int      LONG;
 
 // define
 #define BI_RGB          0L          /// An uncomprassed format for bitmap
+#define BI_BITFIELDS    3L          /// An uncomprassed format with color masks (16 and 32 bit per pixel)
 
 
 /// To pack a class is to place its members directly after each other in memory,
@@ -256,8 +257,39 @@ public:
   void setSize(LONG width, LONG height);
   void setBitCount(WORD bitCount);
 
+  /// width of the image in pixels.
+  LONG getWidth() const;
+
+  /// height of the image in pixels.
+  LONG getHeight() const;
+
+  /// true if the first row of the pixel array is the top row of the image (negative height).
+  bool isTopDown() const;
+
   void writeToFile(char *filename);
-  void readFromFile(char *filename);
+
+  /** @brief load a bitmap file.
+  *
+  *  The file is mapped into memory and decoded from there, see readFromBuffer().
+  *
+  *  @param[in]  filename the name of the file.
+  *
+  *  @return bool true if the bitmap is loaded, false if the file can't be read or isn't supported.
+  */
+  bool readFromFile(const char *filename);
+
+  /** @brief load a bitmap from memory.
+  *
+  *  Uncompressed 1, 8 (with color table), 24 and 32 bit per pixel bitmaps are supported,
+  *  both bottom-up and top-down. The pixels are stored as 24 bit per pixel, in the
+  *  row order of the file, so 24 bit bitmaps are copied as they are.
+  *
+  *  @param[in]  buffer the bitmap file content.
+  *  @param[in]  size the size of buffer in bytes.
+  *
+  *  @return bool true if the bitmap is loaded, false if it is malformed or not supported.
+  */
+  bool readFromBuffer(const unsigned char *buffer, size_t size);
 
 private:
   DWORD calculatePixelArraySize() const;
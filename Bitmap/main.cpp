@@ -49,6 +49,10 @@ int main(int argc, char **argv)
   //bmp.setPixelArray(buf);
   bmp.writeToFile(filename);
 
+  Bitmap readBack;
+  if(readBack.readFromFile(filename))
+    cout << "read back : " << readBack.getWidth() << " x " << readBack.getHeight() << endl;
+
   cout << "sizeof(WORD) : " << sizeof(WORD) << endl;
   cout << "sizeof(DWORD) : " << sizeof(DWORD) << endl;
   cout << "sizeof(LONG) : " << sizeof(LONG) << endl;
@@ -0,0 +1,246 @@
+/**
+*  @file    charclass.c
+*  @brief   vectorized character classification for the segmenters.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpudispatch.h"
+#include "charclass.h"
+
+#if defined(CPU_DISPATCH_X86)
+# include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+/* Alphanumeric characters from 0x20 to 0x3f, bit c - 0x20:
+ * space $ % * + - . / : and the digits. */
+#define CHARCLASS_AN_PUNCTUATION 0x07ffec31u
+
+static int CharClass_ctz(CharClassWord word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(word);
+#elif defined(_MSC_VER)
+	unsigned long index;
+
+	_BitScanForward(&index, word);
+	return (int)index;
+#else
+	int n = 0;
+
+	while((word & 1) == 0) {
+		word >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+/* Classes of the bytes data[from] to data[to - 1], all in the word of from. */
+static void CharClass_classifyScalarWord(const unsigned char *data, int from, int to,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji)
+{
+	CharClassWord n = 0, a = 0, k = 0, bit;
+	unsigned char c;
+	int i;
+
+	for(i=from; i<to; i++) {
+		c = data[i];
+		bit = (CharClassWord)1 << (i % CHARCLASS_WORD_BITS);
+		if((unsigned char)(c - '0') < 10) n |= bit;
+		if((unsigned char)(c - 'A') < 26 || (c >= 0x20 && c < 0x40 && ((CHARCLASS_AN_PUNCTUATION >> (c - 0x20)) & 1))) {
+			a |= bit;
+		}
+		if((unsigned char)(c - 0x81) < 0x1f || (unsigned char)(c - 0xe0) < 0x0c) k |= bit;
+	}
+	num[from / CHARCLASS_WORD_BITS] = n;
+	an[from / CHARCLASS_WORD_BITS] = a;
+	kanji[from / CHARCLASS_WORD_BITS] = k;
+}
+
+static void CharClass_classifyScalar(const unsigned char *data, int length,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji)
+{
+	int i, end;
+
+	for(i=0; i<length; i+=CHARCLASS_WORD_BITS) {
+		end = (length - i < CHARCLASS_WORD_BITS) ? length : i + CHARCLASS_WORD_BITS;
+		CharClass_classifyScalarWord(data, i, end, num, an, kanji);
+	}
+}
+
+#if defined(CPU_DISPATCH_X86)
+/* x - low <= range - 1, unsigned, per byte */
+#define CHARCLASS_IN_RANGE_SSE2(__v__, __low__, __count__) \
+	_mm_cmpeq_epi8(_mm_min_epu8(_mm_sub_epi8((__v__), _mm_set1_epi8((char)(__low__))), _mm_set1_epi8((char)((__count__) - 1))), \
+	               _mm_sub_epi8((__v__), _mm_set1_epi8((char)(__low__))))
+
+CPU_TARGET_SSE2 static void CharClass_classify16SSE2(const unsigned char *data,
+		unsigned int *n, unsigned int *a, unsigned int *k)
+{
+	__m128i v, digit, an;
+
+	v = _mm_loadu_si128((const __m128i *)data);
+	digit = CHARCLASS_IN_RANGE_SSE2(v, '0', 10);
+	an = _mm_or_si128(digit, CHARCLASS_IN_RANGE_SSE2(v, 'A', 26));
+	an = _mm_or_si128(an, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8(':'))));
+	an = _mm_or_si128(an, CHARCLASS_IN_RANGE_SSE2(v, '$', 2));	/* $ % */
+	an = _mm_or_si128(an, CHARCLASS_IN_RANGE_SSE2(v, '*', 2));	/* * + */
+	an = _mm_or_si128(an, CHARCLASS_IN_RANGE_SSE2(v, '-', 3));	/* - . / */
+
+	*n = (unsigned int)_mm_movemask_epi8(digit);
+	*a = (unsigned int)_mm_movemask_epi8(an);
+	*k = (unsigned int)_mm_movemask_epi8(_mm_or_si128(CHARCLASS_IN_RANGE_SSE2(v, 0x81, 0x1f),
+	                                                  CHARCLASS_IN_RANGE_SSE2(v, 0xe0, 0x0c)));
+}
+
+CPU_TARGET_SSE2 static void CharClass_classifySSE2(const unsigned char *data, int length,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji)
+{
+	unsigned int n0, a0, k0, n1, a1, k1;
+	int i, w;
+
+	for(i=0, w=0; i+CHARCLASS_WORD_BITS<=length; i+=CHARCLASS_WORD_BITS, w++) {
+		CharClass_classify16SSE2(data + i, &n0, &a0, &k0);
+		CharClass_classify16SSE2(data + i + 16, &n1, &a1, &k1);
+		num[w] = n0 | (n1 << 16);
+		an[w] = a0 | (a1 << 16);
+		kanji[w] = k0 | (k1 << 16);
+	}
+	if(i < length) {
+		CharClass_classifyScalarWord(data, i, length, num, an, kanji);
+	}
+}
+
+/* The alphanumeric test of the AVX2 variant looks both nibbles up: a low
+ * nibble gives the high nibbles (bit 0: 2, bit 1: 3, bit 2: 4, bit 3: 5)
+ * it is alphanumeric with. */
+CPU_TARGET_AVX2 static void CharClass_classifyAVX2(const unsigned char *data, int length,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji)
+{
+	__m256i v, lo, hi, digit, alnum, lead, tableLo, tableHi, nibble;
+	int i, w;
+
+	tableLo = _mm256_setr_epi8(0x0b, 0x0e, 0x0e, 0x0e, 0x0f, 0x0f, 0x0e, 0x0e,
+	                           0x0e, 0x0e, 0x0f, 0x05, 0x04, 0x05, 0x05, 0x05,
+	                           0x0b, 0x0e, 0x0e, 0x0e, 0x0f, 0x0f, 0x0e, 0x0e,
+	                           0x0e, 0x0e, 0x0f, 0x05, 0x04, 0x05, 0x05, 0x05);
+	tableHi = _mm256_setr_epi8(0, 0, 1, 2, 4, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	                           0, 0, 1, 2, 4, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	nibble = _mm256_set1_epi8(0x0f);
+
+	for(i=0, w=0; i+CHARCLASS_WORD_BITS<=length; i+=CHARCLASS_WORD_BITS, w++) {
+		v = _mm256_loadu_si256((const __m256i *)(data + i));
+		lo = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+		digit = _mm256_cmpeq_epi8(_mm256_min_epu8(lo, _mm256_set1_epi8(9)), lo);
+		lo = _mm256_shuffle_epi8(tableLo, _mm256_and_si256(v, nibble));
+		hi = _mm256_shuffle_epi8(tableHi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+		alnum = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+		lo = _mm256_sub_epi8(v, _mm256_set1_epi8((char)0x81));
+		hi = _mm256_sub_epi8(v, _mm256_set1_epi8((char)0xe0));
+		lead = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(lo, _mm256_set1_epi8(0x1e)), lo),
+		                       _mm256_cmpeq_epi8(_mm256_min_epu8(hi, _mm256_set1_epi8(0x0b)), hi));
+
+		num[w] = (CharClassWord)_mm256_movemask_epi8(digit);
+		an[w] = ~(CharClassWord)_mm256_movemask_epi8(alnum);
+		kanji[w] = (CharClassWord)_mm256_movemask_epi8(lead);
+	}
+	if(i < length) {
+		CharClass_classifyScalarWord(data, i, length, num, an, kanji);
+	}
+}
+#endif
+
+typedef void (*CharClassKernel)(const unsigned char *data, int length,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji);
+
+void CharClass_classify(const unsigned char *data, int length,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji)
+{
+	CpuFunction variants[CPU_LEVEL_COUNT] = { NULL, NULL, NULL, NULL, NULL };
+	int level;
+
+	variants[CPU_SCALAR] = (CpuFunction)CharClass_classifyScalar;
+#if defined(CPU_DISPATCH_X86)
+	variants[CPU_SSE2] = (CpuFunction)CharClass_classifySSE2;
+	variants[CPU_AVX2] = (CpuFunction)CharClass_classifyAVX2;
+#endif
+
+	/* the dispatcher keeps the level of the bound variant */
+	level = CpuDispatch_getSelected(CPU_KERNEL_CLASSIFY);
+	if(level < 0) {
+		((CharClassKernel)CpuDispatch_bind(CPU_KERNEL_CLASSIFY, variants))(data, length, num, an, kanji);
+	} else {
+		((CharClassKernel)variants[level])(data, length, num, an, kanji);
+	}
+}
+
+CharClassMasks *CharClass_new(const unsigned char *data, int length)
+{
+	CharClassMasks *masks;
+	int words;
+
+	words = CHARCLASS_WORDS(length);
+	masks = (CharClassMasks *)malloc(sizeof(CharClassMasks) + sizeof(CharClassWord) * words * 3);
+	if(masks == NULL) return NULL;
+
+	masks->length = length;
+	masks->num = (CharClassWord *)(masks + 1);
+	masks->an = masks->num + words;
+	masks->kanji = masks->an + words;
+	CharClass_classify(data, length, masks->num, masks->an, masks->kanji);
+
+	return masks;
+}
+
+void CharClass_free(CharClassMasks *masks)
+{
+	free(masks);
+}
+
+int CharClass_span(const CharClassWord *mask, int from, int length)
+{
+	CharClassWord word;
+	int w, words;
+
+	if(from >= length) return length;
+
+	words = CHARCLASS_WORDS(length);
+	w = from / CHARCLASS_WORD_BITS;
+	/* the bits before from count as set */
+	word = ~mask[w] & (~(CharClassWord)0 << (from % CHARCLASS_WORD_BITS));
+	while(word == 0) {
+		if(++w == words) return length;
+		word = ~mask[w];
+	}
+	from = w * CHARCLASS_WORD_BITS + CharClass_ctz(word);
+
+	return (from < length) ? from : length;
+}
+
+int CharClass_find(const CharClassWord *mask, int from, int length)
+{
+	CharClassWord word;
+	int w, words;
+
+	if(from >= length) return length;
+
+	words = CHARCLASS_WORDS(length);
+	w = from / CHARCLASS_WORD_BITS;
+	word = mask[w] & (~(CharClassWord)0 << (from % CHARCLASS_WORD_BITS));
+	while(word == 0) {
+		if(++w == words) return length;
+		word = mask[w];
+	}
+	from = w * CHARCLASS_WORD_BITS + CharClass_ctz(word);
+
+	return (from < length) ? from : length;
+}
@@ -0,0 +1,86 @@
+/**
+*  @file    charclass.h
+*  @brief   vectorized character classification for the segmenters.
+*
+*  The segmenters of QRCodeGen and LibQREncode split a string into runs of
+*  digits, alphanumeric characters, Shift-JIS kanji and bytes. Instead of a
+*  test per byte, the string is classified once, 16 or 32 bytes per step,
+*  into one bit per byte and class; the end of a run, or the next byte of a
+*  class, is then found with a count of trailing zeros per 32 bytes.
+*
+*  Bit i of word w of a mask stands for byte 32 * w + i; the bits past the
+*  end of the string are clear. The byte class is every byte, it has no mask.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Word of a mask, 32 bytes of the string.
+ */
+typedef unsigned int CharClassWord;
+
+#define CHARCLASS_WORD_BITS 32
+#define CHARCLASS_WORDS(__length__) (((__length__) + CHARCLASS_WORD_BITS - 1) / CHARCLASS_WORD_BITS)
+
+/**
+ * Nonzero if byte i is in the class of the mask.
+ */
+#define CharClass_test(__mask__, __i__) \
+	(((__mask__)[(__i__) / CHARCLASS_WORD_BITS] >> ((__i__) % CHARCLASS_WORD_BITS)) & 1)
+
+/**
+ * Class masks of a string.
+ */
+typedef struct {
+	int length;             ///< bytes of the string
+	CharClassWord *num;     ///< digits, 0-9
+	CharClassWord *an;      ///< alphanumeric characters, the digits included
+	CharClassWord *kanji;   ///< first bytes of Shift-JIS kanji, 0x81-0x9f and 0xe0-0xeb
+} CharClassMasks;
+
+/**
+ * Classify a string.
+ * @param data the string, it need not end with a NUL.
+ * @param length bytes of the string.
+ * @return the masks in one block, or NULL when out of memory.
+ */
+extern CharClassMasks *CharClass_new(const unsigned char *data, int length);
+
+/**
+ * Free the masks of CharClass_new().
+ */
+extern void CharClass_free(CharClassMasks *masks);
+
+/**
+ * Classify a string into masks of CHARCLASS_WORDS(length) words each,
+ * with the best variant the CPU runs.
+ */
+extern void CharClass_classify(const unsigned char *data, int length,
+		CharClassWord *num, CharClassWord *an, CharClassWord *kanji);
+
+/**
+ * End of the run of a class starting at byte from.
+ * @return the first byte at or after from not in the class, or length.
+ */
+extern int CharClass_span(const CharClassWord *mask, int from, int length);
+
+/**
+ * Next byte of a class.
+ * @return the first byte at or after from in the class, or length.
+ */
+extern int CharClass_find(const CharClassWord *mask, int from, int length);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CHARCLASS_H */
@@ -0,0 +1,265 @@
+/**
+*  @file    cpudispatch.c
+*  @brief   runtime CPU feature detection and kernel dispatch.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpudispatch.h"
+
+#if defined(CPU_DISPATCH_X86)
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# else
+#  include <cpuid.h>
+# endif
+#endif
+
+static const char *levelNames[CPU_LEVEL_COUNT] = {
+	"scalar", "sse2", "sse4.2", "avx2", "avx512"
+};
+
+static const char *kernelNames[CPU_KERNEL_COUNT] = {
+	"rs-parity", "mask", "penalty", "fdct", "deflate", "raster", "classify",
+	"pack-num", "pack-an"
+};
+
+/* All the state is written with the same values by whichever thread gets
+ * there first, so the lazy initialization needs no lock, only atomic
+ * loads and stores of the ints. */
+#if defined(__GNUC__) || defined(__clang__)
+# define CPU_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+# define CPU_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#else
+/* volatile int accesses are atomic, with acquire/release semantics, on MSVC */
+# define CPU_LOAD(p) (*(volatile int *)(p))
+# define CPU_STORE(p, v) (*(volatile int *)(p) = (v))
+#endif
+
+/* Levels of the variants of every family, bit n: a variant of level n. The
+ * report resolves the families not bound yet with them; CpuDispatch_bind()
+ * records the variants a family actually passes. */
+#define CPU_VARIANTS(l) (1 << (l))
+#if defined(CPU_DISPATCH_X86)
+# define CPU_VARIANTS_X86(l) CPU_VARIANTS(l)
+#else
+# define CPU_VARIANTS_X86(l) 0
+#endif
+static const int declared[CPU_KERNEL_COUNT] = {
+	CPU_VARIANTS(CPU_SCALAR),	/* rs-parity */
+	CPU_VARIANTS(CPU_SCALAR) | CPU_VARIANTS_X86(CPU_SSE2) | CPU_VARIANTS_X86(CPU_AVX2),	/* mask */
+	CPU_VARIANTS(CPU_SCALAR),	/* penalty */
+	CPU_VARIANTS(CPU_SCALAR) | CPU_VARIANTS_X86(CPU_SSE2) | CPU_VARIANTS_X86(CPU_AVX2),	/* fdct */
+	CPU_VARIANTS(CPU_SCALAR),	/* deflate */
+	CPU_VARIANTS(CPU_SCALAR),	/* raster */
+	CPU_VARIANTS(CPU_SCALAR) | CPU_VARIANTS_X86(CPU_SSE2) | CPU_VARIANTS_X86(CPU_AVX2),	/* classify */
+	CPU_VARIANTS(CPU_SCALAR) | CPU_VARIANTS_X86(CPU_SSE42) | CPU_VARIANTS_X86(CPU_AVX2),	/* pack-num */
+	CPU_VARIANTS(CPU_SCALAR) | CPU_VARIANTS_X86(CPU_SSE42) | CPU_VARIANTS_X86(CPU_AVX2)	/* pack-an */
+};
+
+static int detectedLevel = -1;
+static int level = -1;
+static int selected[CPU_KERNEL_COUNT] = { -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+static int available[CPU_KERNEL_COUNT];	/* bit n: a variant of level n */
+static char report[1024];
+
+#if defined(CPU_DISPATCH_X86)
+static void CpuDispatch_cpuid(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	int r[4];
+
+	__cpuidex(r, leaf, subleaf);
+	regs[0] = (unsigned int)r[0];
+	regs[1] = (unsigned int)r[1];
+	regs[2] = (unsigned int)r[2];
+	regs[3] = (unsigned int)r[3];
+#else
+	if(!__get_cpuid_count((unsigned int)leaf, (unsigned int)subleaf, &regs[0], &regs[1], &regs[2], &regs[3])) {
+		regs[0] = regs[1] = regs[2] = regs[3] = 0;
+	}
+#endif
+}
+
+/* Register state the OS saves on a context switch (XCR0). */
+static unsigned int CpuDispatch_xgetbv(void)
+{
+#if defined(_MSC_VER)
+	return (unsigned int)_xgetbv(0);
+#else
+	unsigned int eax, edx;
+
+	__asm__ volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+	return eax;
+#endif
+}
+#endif
+
+static int CpuDispatch_detect(void)
+{
+#if defined(CPU_DISPATCH_X86)
+	unsigned int r0[4], r1[4], r7[4] = { 0, 0, 0, 0 };
+	unsigned int xcr0;
+	int result = CPU_SCALAR;
+
+	CpuDispatch_cpuid(0, 0, r0);	/* EAX: highest leaf */
+	if(r0[0] < 1) return CPU_SCALAR;
+	CpuDispatch_cpuid(1, 0, r1);
+	if(r0[0] >= 7) {
+		CpuDispatch_cpuid(7, 0, r7);
+	}
+
+	/* leaf 1: EDX 26 SSE2, ECX 20 SSE4.2, 23 POPCNT, 27 OSXSAVE, 28 AVX */
+	if(!(r1[3] & (1u << 26))) return result;
+	result = CPU_SSE2;
+
+	if(!(r1[2] & (1u << 20)) || !(r1[2] & (1u << 23))) return result;
+	result = CPU_SSE42;
+
+	if(!(r1[2] & (1u << 27)) || !(r1[2] & (1u << 28))) return result;
+	xcr0 = CpuDispatch_xgetbv();
+	if((xcr0 & 0x06) != 0x06) return result;	/* XMM and YMM state */
+
+	/* leaf 7: EBX 3 BMI1, 5 AVX2, 8 BMI2, 16 AVX512F, 30 AVX512BW, 31 AVX512VL */
+	if(!(r7[1] & (1u << 3)) || !(r7[1] & (1u << 5)) || !(r7[1] & (1u << 8))) return result;
+	result = CPU_AVX2;
+
+	if((xcr0 & 0xe0) != 0xe0) return result;	/* opmask and ZMM state */
+	if(!(r7[1] & (1u << 16)) || !(r7[1] & (1u << 30)) || !(r7[1] & (1u << 31))) return result;
+	result = CPU_AVX512;
+
+	return result;
+#else
+	return CPU_SCALAR;
+#endif
+}
+
+CpuLevel CpuDispatch_getDetectedLevel(void)
+{
+	int l = CPU_LOAD(&detectedLevel);
+
+	if(l < 0) {
+		l = CpuDispatch_detect();
+		CPU_STORE(&detectedLevel, l);
+	}
+
+	return (CpuLevel)l;
+}
+
+CpuLevel CpuDispatch_getLevel(void)
+{
+	const char *env;
+	int i, result;
+
+	result = CPU_LOAD(&level);
+	if(result >= 0) return (CpuLevel)result;
+
+	result = CpuDispatch_getDetectedLevel();
+	env = getenv("QR_CPU");
+	if(env != NULL && env[0] != '\0') {
+		for(i=0; i<CPU_LEVEL_COUNT; i++) {
+			if(strcmp(env, levelNames[i]) == 0) break;
+		}
+		if(i == CPU_LEVEL_COUNT) {
+			fprintf(stderr, "QR_CPU=%s is not one of scalar, sse2, sse4.2, avx2, avx512; ignored\n", env);
+		} else if(i < result) {
+			result = i;
+		}
+	}
+
+	CPU_STORE(&level, result);
+	return (CpuLevel)result;
+}
+
+const char *CpuDispatch_getLevelName(CpuLevel l)
+{
+	if(l < 0 || l >= CPU_LEVEL_COUNT) return "unknown";
+	return levelNames[l];
+}
+
+const char *CpuDispatch_getKernelName(CpuKernel kernel)
+{
+	if(kernel < 0 || kernel >= CPU_KERNEL_COUNT) return "unknown";
+	return kernelNames[kernel];
+}
+
+/* The highest level of a set of variants not above the level in use. */
+static int CpuDispatch_choose(int variants)
+{
+	int i;
+
+	for(i=CpuDispatch_getLevel(); i>CPU_SCALAR; i--) {
+		if(variants & (1 << i)) break;
+	}
+
+	return i;
+}
+
+CpuFunction CpuDispatch_bind(CpuKernel kernel, const CpuFunction variants[CPU_LEVEL_COUNT])
+{
+	int i, mask = 0;
+
+	for(i=0; i<CPU_LEVEL_COUNT; i++) {
+		if(variants[i] != NULL) mask |= 1 << i;
+	}
+	i = CpuDispatch_choose(mask);
+
+	/* an unknown family still gets its variant, only the report misses it */
+	if(kernel >= 0 && kernel < CPU_KERNEL_COUNT) {
+		CPU_STORE(&available[kernel], mask);
+		CPU_STORE(&selected[kernel], i);
+	}
+
+	return variants[i];
+}
+
+int CpuDispatch_getSelected(CpuKernel kernel)
+{
+	if(kernel < 0 || kernel >= CPU_KERNEL_COUNT) return -1;
+	return CPU_LOAD(&selected[kernel]);
+}
+
+const char *CpuDispatch_getReport(void)
+{
+	char line[128];
+	int k, i, length, sel, avail;
+	CpuLevel detected = CpuDispatch_getDetectedLevel();
+	CpuLevel l = CpuDispatch_getLevel();
+
+	sprintf(report, "cpu: %s", CpuDispatch_getLevelName(detected));
+	if(l != detected) {
+		sprintf(line, " (QR_CPU=%s)", CpuDispatch_getLevelName(l));
+		strcat(report, line);
+	}
+	strcat(report, "\n");
+
+	for(k=0; k<CPU_KERNEL_COUNT; k++) {
+		sel = CPU_LOAD(&selected[k]);
+		avail = CPU_LOAD(&available[k]);
+		if(sel < 0) {
+			/* not used yet, or scalar only: the variant it gets (or would) */
+			avail = declared[k];
+			sel = CpuDispatch_choose(avail);
+		}
+		if(avail == (1 << CPU_SCALAR)) {
+			sprintf(line, "%-10s scalar (no vectorized variant)\n", kernelNames[k]);
+		} else {
+			length = sprintf(line, "%-10s %s (of", kernelNames[k], levelNames[sel]);
+			for(i=0; i<CPU_LEVEL_COUNT; i++) {
+				if(avail & (1 << i)) {
+					length += sprintf(line + length, " %s", levelNames[i]);
+				}
+			}
+			strcpy(line + length, ")\n");
+		}
+		strcat(report, line);
+	}
+
+	return report;
+}
@@ -0,0 +1,126 @@
+/**
+*  @file    cpudispatch.h
+*  @brief   runtime CPU feature detection and kernel dispatch.
+*
+*  Shared by QRCodeGen (C++) and LibQREncode (C), so it is plain C.
+*  The instruction set level of the CPU is detected once, at the first
+*  call; the environment variable QR_CPU (scalar, sse2, sse4.2, avx2 or
+*  avx512) lowers it, to test the other variants of the kernels on one
+*  machine. A kernel family keeps a variant per level, NULL where it has
+*  none, and CpuDispatch_bind() picks the best one the CPU runs. The
+*  variants are compiled in every build with CPU_TARGET_SSE2 /
+*  CPU_TARGET_AVX2 ..., so a single binary runs everywhere.
+*
+*  CpuDispatch_getReport() tells which variant every family got.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#ifndef CPUDISPATCH_H
+#define CPUDISPATCH_H
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+  #define CPU_DISPATCH_X86 1
+#endif
+
+/* Target attributes of the variants. MSVC compiles every intrinsic
+ * without them, GCC and Clang only in functions with the target. */
+#if defined(CPU_DISPATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+  #define CPU_TARGET_SSE2     __attribute__((target("sse2")))
+  #define CPU_TARGET_SSE42    __attribute__((target("sse4.2,popcnt")))
+  #define CPU_TARGET_AVX2     __attribute__((target("avx2,bmi,bmi2,popcnt")))
+  #define CPU_TARGET_AVX512   __attribute__((target("avx512f,avx512bw,avx512vl,avx2,bmi,bmi2,popcnt")))
+#else
+  #define CPU_TARGET_SSE2
+  #define CPU_TARGET_SSE42
+  #define CPU_TARGET_AVX2
+  #define CPU_TARGET_AVX512
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Instruction set levels, every one includes the ones before it.
+ */
+typedef enum {
+	CPU_SCALAR = 0,   ///< portable C
+	CPU_SSE2,         ///< SSE2, every x86-64 CPU
+	CPU_SSE42,        ///< SSE4.2 and POPCNT
+	CPU_AVX2,         ///< AVX2, BMI1/2
+	CPU_AVX512,       ///< AVX-512 F, BW and VL
+	CPU_LEVEL_COUNT
+} CpuLevel;
+
+/**
+ * Kernel families with variants.
+ */
+typedef enum {
+	CPU_KERNEL_RS_PARITY = 0,   ///< Reed-Solomon parity
+	CPU_KERNEL_MASK,            ///< mask XOR of the data modules
+	CPU_KERNEL_PENALTY,         ///< penalty score of a masked symbol
+	CPU_KERNEL_FDCT,            ///< JPEG forward DCT and quantization
+	CPU_KERNEL_DEFLATE,         ///< PNG deflate
+	CPU_KERNEL_RASTER,          ///< rasterization of the modules to pixels
+	CPU_KERNEL_CLASSIFY,        ///< character classes of the segmenters
+	CPU_KERNEL_PACK_NUMERIC,    ///< values of the digit groups of numeric mode
+	CPU_KERNEL_PACK_AN,         ///< values of the character pairs of alphanumeric mode
+	CPU_KERNEL_COUNT
+} CpuKernel;
+
+/**
+ * A variant of a kernel, cast to the type of the family.
+ */
+typedef void (*CpuFunction)(void);
+
+/**
+ * Level the CPU (and the OS, for the AVX registers) supports.
+ */
+extern CpuLevel CpuDispatch_getDetectedLevel(void);
+
+/**
+ * Level the variants are chosen with: the detected level, lowered by QR_CPU.
+ */
+extern CpuLevel CpuDispatch_getLevel(void);
+
+/**
+ * Lowercase name of a level, as QR_CPU takes it.
+ */
+extern const char *CpuDispatch_getLevelName(CpuLevel level);
+
+/**
+ * Name of a kernel family.
+ */
+extern const char *CpuDispatch_getKernelName(CpuKernel kernel);
+
+/**
+ * Choose the variant of a kernel family.
+ * @param kernel the family, its choice is recorded for the report (not
+ *               for a value out of CpuKernel, which still gets its variant).
+ * @param variants one variant per level, NULL where there is none. The
+ *                 scalar one must be given.
+ * @return the variant of the highest level not above CpuDispatch_getLevel().
+ */
+extern CpuFunction CpuDispatch_bind(CpuKernel kernel, const CpuFunction variants[CPU_LEVEL_COUNT]);
+
+/**
+ * Level of the variant a family got, -1 before it is bound.
+ */
+extern int CpuDispatch_getSelected(CpuKernel kernel);
+
+/**
+ * Text report of the levels and of the variant of every family, one per
+ * line. Families not bound yet are resolved as CpuDispatch_bind() would,
+ * and those without vectorized variants say so.
+ * @return a static buffer, rewritten by every call.
+ */
+extern const char *CpuDispatch_getReport(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CPUDISPATCH_H */
@@ -0,0 +1,286 @@
+/**
+*  @file    textpack.c
+*  @brief   bulk packers of the numeric and alphanumeric modes.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpudispatch.h"
+#include "textpack.h"
+
+#if defined(CPU_DISPATCH_X86)
+# include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+typedef unsigned __int64 TextPackWord;
+#else
+typedef unsigned long long TextPackWord;
+#endif
+
+/* Groups whose values are computed before they are packed. */
+#define TEXTPACK_BLOCK 64
+
+/* Values of the alphanumeric characters, 0 for the others. */
+static const unsigned char TextPack_anTable[128] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	36,  0,  0,  0, 37, 38,  0,  0,  0,  0, 39, 40,  0, 41, 42, 43,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 44,  0,  0,  0,  0,  0,
+	 0, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+	25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+#define TEXTPACK_AN(__c__) (TextPack_anTable[(__c__) & 0x7f])
+
+/******************************************************************************
+ * Field writer
+ *****************************************************************************/
+
+/* The fields collect in a 64-bit word and leave it 32 bits at a time. */
+typedef struct {
+	TextPackWord word;
+	int bits;             /* bits in word, fewer than 32 between calls */
+	unsigned char *out;
+} TextPackWriter;
+
+static void TextPack_put(TextPackWriter *writer, unsigned int value, int bits)
+{
+	unsigned int high;
+
+	writer->word = (writer->word << bits) | value;
+	writer->bits += bits;
+	if(writer->bits >= 32) {
+		writer->bits -= 32;
+		high = (unsigned int)(writer->word >> writer->bits);
+		writer->out[0] = (unsigned char)(high >> 24);
+		writer->out[1] = (unsigned char)(high >> 16);
+		writer->out[2] = (unsigned char)(high >> 8);
+		writer->out[3] = (unsigned char)high;
+		writer->out += 4;
+	}
+}
+
+static void TextPack_flush(TextPackWriter *writer)
+{
+	while(writer->bits >= 8) {
+		writer->bits -= 8;
+		*writer->out++ = (unsigned char)(writer->word >> writer->bits);
+	}
+	if(writer->bits > 0) {
+		*writer->out++ = (unsigned char)(writer->word << (8 - writer->bits));
+		writer->bits = 0;
+	}
+}
+
+/******************************************************************************
+ * Values of the groups
+ *****************************************************************************/
+
+typedef void (*TextPackValues)(const unsigned char *data, int groups, unsigned short *values);
+
+static void TextPack_numericValuesScalar(const unsigned char *digits, int groups, unsigned short *values)
+{
+	int i;
+
+	for(i=0; i<groups; i++) {
+		values[i] = (unsigned short)((digits[i * 3] - '0') * 100 + (digits[i * 3 + 1] - '0') * 10 + (digits[i * 3 + 2] - '0'));
+	}
+}
+
+static void TextPack_alphanumericValuesScalar(const unsigned char *chars, int groups, unsigned short *values)
+{
+	int i;
+
+	for(i=0; i<groups; i++) {
+		values[i] = (unsigned short)(TEXTPACK_AN(chars[i * 2]) * 45 + TEXTPACK_AN(chars[i * 2 + 1]));
+	}
+}
+
+#if defined(CPU_DISPATCH_X86)
+/* Numeric: the digits of four groups are spread to four 32-bit lanes,
+ * d0 d1 d2 0, and weighed 100 10 1 0 by pmaddubsw and pmaddwd. */
+#define TEXTPACK_NUMERIC_SHUFFLE 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+#define TEXTPACK_NUMERIC_WEIGHTS 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0
+
+/* Alphanumeric: the value of a character is c - '0' for the digits,
+ * c - 'A' + 10 for the letters, a lookup of its low nibble for space to /,
+ * and 44 for ':'. pmaddubsw weighs the pairs 45 1. */
+#define TEXTPACK_AN_PUNCTUATION 36, 0, 0, 0, 37, 38, 0, 0, 0, 0, 39, 40, 0, 41, 42, 43
+
+CPU_TARGET_SSE42 static void TextPack_numericValuesSSE42(const unsigned char *digits, int groups, unsigned short *values)
+{
+	__m128i v, shuffle, weights, ones;
+	int i;
+
+	shuffle = _mm_setr_epi8(TEXTPACK_NUMERIC_SHUFFLE);
+	weights = _mm_setr_epi8(TEXTPACK_NUMERIC_WEIGHTS);
+	ones = _mm_set1_epi16(1);
+
+	/* a load takes 16 digits for the 12 of four groups */
+	for(i=0; i+6<=groups; i+=4) {
+		v = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)(digits + i * 3)), _mm_set1_epi8('0'));
+		v = _mm_madd_epi16(_mm_maddubs_epi16(_mm_shuffle_epi8(v, shuffle), weights), ones);
+		_mm_storel_epi64((__m128i *)(values + i), _mm_packs_epi32(v, v));
+	}
+	TextPack_numericValuesScalar(digits + i * 3, groups - i, values + i);
+}
+
+CPU_TARGET_SSE42 static void TextPack_alphanumericValuesSSE42(const unsigned char *chars, int groups, unsigned short *values)
+{
+	__m128i c, v, punctuation, weights;
+	int i;
+
+	punctuation = _mm_setr_epi8(TEXTPACK_AN_PUNCTUATION);
+	weights = _mm_set1_epi16(0x012d);	/* bytes 45, 1 */
+
+	for(i=0; i+8<=groups; i+=8) {
+		c = _mm_loadu_si128((const __m128i *)(chars + i * 2));
+		v = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+		v = _mm_blendv_epi8(v, _mm_sub_epi8(c, _mm_set1_epi8('A' - 10)), _mm_cmpgt_epi8(c, _mm_set1_epi8('@')));
+		v = _mm_blendv_epi8(v, _mm_shuffle_epi8(punctuation, c), _mm_cmplt_epi8(c, _mm_set1_epi8('0')));
+		v = _mm_blendv_epi8(v, _mm_set1_epi8(44), _mm_cmpeq_epi8(c, _mm_set1_epi8(':')));
+		_mm_storeu_si128((__m128i *)(values + i), _mm_maddubs_epi16(v, weights));
+	}
+	TextPack_alphanumericValuesScalar(chars + i * 2, groups - i, values + i);
+}
+
+CPU_TARGET_AVX2 static void TextPack_numericValuesAVX2(const unsigned char *digits, int groups, unsigned short *values)
+{
+	__m256i v, shuffle, weights, ones;
+	int i;
+
+	shuffle = _mm256_setr_epi8(TEXTPACK_NUMERIC_SHUFFLE, TEXTPACK_NUMERIC_SHUFFLE);
+	weights = _mm256_setr_epi8(TEXTPACK_NUMERIC_WEIGHTS, TEXTPACK_NUMERIC_WEIGHTS);
+	ones = _mm256_set1_epi16(1);
+
+	/* four groups per lane, the high lane loaded 12 digits on */
+	for(i=0; i+10<=groups; i+=8) {
+		v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(digits + i * 3))),
+		                            _mm_loadu_si128((const __m128i *)(digits + i * 3 + 12)), 1);
+		v = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+		v = _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_shuffle_epi8(v, shuffle), weights), ones);
+		v = _mm256_permute4x64_epi64(_mm256_packs_epi32(v, v), 0x08);
+		_mm_storeu_si128((__m128i *)(values + i), _mm256_castsi256_si128(v));
+	}
+	TextPack_numericValuesScalar(digits + i * 3, groups - i, values + i);
+}
+
+CPU_TARGET_AVX2 static void TextPack_alphanumericValuesAVX2(const unsigned char *chars, int groups, unsigned short *values)
+{
+	__m256i c, v, punctuation, weights;
+	int i;
+
+	punctuation = _mm256_setr_epi8(TEXTPACK_AN_PUNCTUATION, TEXTPACK_AN_PUNCTUATION);
+	weights = _mm256_set1_epi16(0x012d);
+
+	for(i=0; i+16<=groups; i+=16) {
+		c = _mm256_loadu_si256((const __m256i *)(chars + i * 2));
+		v = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+		v = _mm256_blendv_epi8(v, _mm256_sub_epi8(c, _mm256_set1_epi8('A' - 10)), _mm256_cmpgt_epi8(c, _mm256_set1_epi8('@')));
+		v = _mm256_blendv_epi8(v, _mm256_shuffle_epi8(punctuation, c), _mm256_cmpgt_epi8(_mm256_set1_epi8('0'), c));
+		v = _mm256_blendv_epi8(v, _mm256_set1_epi8(44), _mm256_cmpeq_epi8(c, _mm256_set1_epi8(':')));
+		_mm256_storeu_si256((__m256i *)(values + i), _mm256_maddubs_epi16(v, weights));
+	}
+	TextPack_alphanumericValuesScalar(chars + i * 2, groups - i, values + i);
+}
+#endif
+
+/* The dispatcher keeps the level of the bound variant. */
+static TextPackValues TextPack_getValues(CpuKernel kernel, CpuFunction variants[CPU_LEVEL_COUNT])
+{
+	int level;
+
+	level = CpuDispatch_getSelected(kernel);
+	if(level < 0) {
+		return (TextPackValues)CpuDispatch_bind(kernel, variants);
+	}
+
+	return (TextPackValues)variants[level];
+}
+
+/******************************************************************************
+ * Packers
+ *****************************************************************************/
+
+int TextPack_numeric(const unsigned char *digits, int count, unsigned char *out)
+{
+	CpuFunction variants[CPU_LEVEL_COUNT] = { NULL, NULL, NULL, NULL, NULL };
+	unsigned short values[TEXTPACK_BLOCK];
+	TextPackValues numericValues;
+	TextPackWriter writer;
+	int groups, i, j, n, rest;
+
+	variants[CPU_SCALAR] = (CpuFunction)TextPack_numericValuesScalar;
+#if defined(CPU_DISPATCH_X86)
+	variants[CPU_SSE42] = (CpuFunction)TextPack_numericValuesSSE42;
+	variants[CPU_AVX2] = (CpuFunction)TextPack_numericValuesAVX2;
+#endif
+	numericValues = TextPack_getValues(CPU_KERNEL_PACK_NUMERIC, variants);
+
+	writer.word = 0;
+	writer.bits = 0;
+	writer.out = out;
+
+	groups = count / 3;
+	for(i=0; i<groups; i+=n) {
+		n = (groups - i < TEXTPACK_BLOCK) ? groups - i : TEXTPACK_BLOCK;
+		numericValues(digits + i * 3, n, values);
+		for(j=0; j<n; j++) {
+			TextPack_put(&writer, values[j], 10);
+		}
+	}
+
+	rest = count - groups * 3;
+	if(rest == 1) {
+		TextPack_put(&writer, digits[groups * 3] - '0', 4);
+	} else if(rest == 2) {
+		TextPack_put(&writer, (digits[groups * 3] - '0') * 10 + (digits[groups * 3 + 1] - '0'), 7);
+	}
+	TextPack_flush(&writer);
+
+	return TEXTPACK_NUMERIC_BITS(count);
+}
+
+int TextPack_alphanumeric(const unsigned char *chars, int count, unsigned char *out)
+{
+	CpuFunction variants[CPU_LEVEL_COUNT] = { NULL, NULL, NULL, NULL, NULL };
+	unsigned short values[TEXTPACK_BLOCK];
+	TextPackValues alphanumericValues;
+	TextPackWriter writer;
+	int groups, i, j, n;
+
+	variants[CPU_SCALAR] = (CpuFunction)TextPack_alphanumericValuesScalar;
+#if defined(CPU_DISPATCH_X86)
+	variants[CPU_SSE42] = (CpuFunction)TextPack_alphanumericValuesSSE42;
+	variants[CPU_AVX2] = (CpuFunction)TextPack_alphanumericValuesAVX2;
+#endif
+	alphanumericValues = TextPack_getValues(CPU_KERNEL_PACK_AN, variants);
+
+	writer.word = 0;
+	writer.bits = 0;
+	writer.out = out;
+
+	groups = count / 2;
+	for(i=0; i<groups; i+=n) {
+		n = (groups - i < TEXTPACK_BLOCK) ? groups - i : TEXTPACK_BLOCK;
+		alphanumericValues(chars + i * 2, n, values);
+		for(j=0; j<n; j++) {
+			TextPack_put(&writer, values[j], 11);
+		}
+	}
+
+	if(count & 1) {
+		TextPack_put(&writer, TEXTPACK_AN(chars[count - 1]), 6);
+	}
+	TextPack_flush(&writer);
+
+	return TEXTPACK_ALPHANUMERIC_BITS(count);
+}
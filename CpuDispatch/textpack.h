@@ -0,0 +1,63 @@
+/**
+*  @file    textpack.h
+*  @brief   bulk packers of the numeric and alphanumeric modes.
+*
+*  Numeric mode turns every three digits into 10 bits, alphanumeric mode
+*  every two characters into 11 bits. The packers compute the values of
+*  the groups with SIMD multiply-adds, 4 to 16 groups per step, and pack
+*  the fields into 64-bit words; QRCodeGen and LibQREncode both use them,
+*  so the segments come out bit for bit as the one-group-at-a-time
+*  encoders wrote them.
+*
+*  The output is big endian, the first bit in the most significant bit of
+*  out[0]; the bits after the last field are clear.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#ifndef TEXTPACK_H
+#define TEXTPACK_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Bits of count digits: 10 per three, 4 or 7 for one or two left over.
+ */
+#define TEXTPACK_NUMERIC_BITS(__count__) \
+	((__count__) / 3 * 10 + (((__count__) % 3 == 0) ? 0 : (__count__) % 3 * 3 + 1))
+
+/**
+ * Bits of count alphanumeric characters: 11 per two, 6 for the last one.
+ */
+#define TEXTPACK_ALPHANUMERIC_BITS(__count__) ((__count__) / 2 * 11 + ((__count__) & 1) * 6)
+
+/**
+ * Bytes of the output of bits bits.
+ */
+#define TEXTPACK_BYTES(__bits__) (((__bits__) + 7) / 8)
+
+/**
+ * Pack digits as numeric mode does.
+ * @param digits the digits, '0' to '9'.
+ * @param out TEXTPACK_BYTES(TEXTPACK_NUMERIC_BITS(count)) bytes.
+ * @return bits written.
+ */
+extern int TextPack_numeric(const unsigned char *digits, int count, unsigned char *out);
+
+/**
+ * Pack alphanumeric characters as alphanumeric mode does.
+ * @param chars the characters, all of the 45 of the mode.
+ * @param out TEXTPACK_BYTES(TEXTPACK_ALPHANUMERIC_BITS(count)) bytes.
+ * @return bits written.
+ */
+extern int TextPack_alphanumeric(const unsigned char *chars, int count, unsigned char *out);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* TEXTPACK_H */
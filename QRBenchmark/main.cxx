@@ -0,0 +1,459 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include "qrbenchmark.h"
+#include "qrcode.h"
+#include "qrincrementalencoder.h"
+#include "qrsymbolcache.h"
+#include "qrsymbolstore.h"
+#include "qrtestcorpus.h"
+#include "qrsegment.h"
+#include "qrbitbuffer.h"
+#include "cpudispatch.h"
+
+using namespace QR;
+
+/// keeps the results of the benchmarks which only compute a value.
+static volatile int g_sink = 0;
+
+static const char ALPHANUMERIC_CHARSET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+/// Forward declaration
+static void BM_createNumeric(QRBenchmarkState &state);
+static void BM_createAlphanumeric(QRBenchmarkState &state);
+static void BM_createBytes(QRBenchmarkState &state);
+static void BM_bitBufferAppend(QRBenchmarkState &state);
+static void BM_appendErrorCorrection(QRBenchmarkState &state);
+static void BM_drawFunctionPatterns(QRBenchmarkState &state);
+static void BM_drawCodewords(QRBenchmarkState &state);
+static void BM_applyMask(QRBenchmarkState &state);
+static void BM_getPenaltyScore(QRBenchmarkState &state);
+static void BM_encodeFixedMask(QRBenchmarkState &state);
+static void BM_encodeIncremental(QRBenchmarkState &state);
+static void BM_encode(QRBenchmarkState &state);
+static void BM_writeBMP(QRBenchmarkState &state);
+static void BM_writePNG(QRBenchmarkState &state);
+static void BM_writeJPEG(QRBenchmarkState &state);
+static void BM_writeSVG(QRBenchmarkState &state);
+static void BM_writeEPS(QRBenchmarkState &state);
+static void BM_writePDF(QRBenchmarkState &state);
+static void BM_cachedEncode(QRBenchmarkState &state);
+static void BM_cachedWritePNG(QRBenchmarkState &state);
+static void BM_storeLookup(QRBenchmarkState &state);
+
+/// usage: QRBenchmark [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>]
+int main(int argc, char **argv)
+{
+  QRBenchmark benchmark;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strncmp(argv[i], "--benchmark_filter=", 19) == 0)
+      benchmark.setFilter(argv[i] + 19);
+    else if (strncmp(argv[i], "--benchmark_min_time=", 21) == 0)
+      benchmark.setMinTime(atof(argv[i] + 21));
+    else
+    {
+      std::cout << "usage: " << argv[0] << " [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>]" << std::endl;
+      return(1);
+    }
+  }
+
+  const int versions[] = {1, 10, 25, 40};
+  const ECL levels[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+  const std::vector<int> v(versions, versions + 4);
+  const std::vector<ECL> e(levels, levels + 4);
+
+  benchmark.add("BM_createNumeric", BM_createNumeric, v, e);
+  benchmark.add("BM_createAlphanumeric", BM_createAlphanumeric, v, e);
+  benchmark.add("BM_createBytes", BM_createBytes, v, e);
+  benchmark.add("BM_bitBufferAppend", BM_bitBufferAppend, v, e);
+  benchmark.add("BM_appendErrorCorrection", BM_appendErrorCorrection, v, e);
+  benchmark.add("BM_drawFunctionPatterns", BM_drawFunctionPatterns, v, e);
+  benchmark.add("BM_drawCodewords", BM_drawCodewords, v, e);
+  benchmark.add("BM_applyMask", BM_applyMask, v, e);
+  benchmark.add("BM_getPenaltyScore", BM_getPenaltyScore, v, e);
+  benchmark.add("BM_encodeFixedMask", BM_encodeFixedMask, v, e);
+  benchmark.add("BM_encodeIncremental", BM_encodeIncremental, v, e);
+  benchmark.add("BM_encode", BM_encode, v, e);
+  benchmark.add("BM_writeBMP", BM_writeBMP, v, e);
+  benchmark.add("BM_writePNG", BM_writePNG, v, e);
+  benchmark.add("BM_writeJPEG", BM_writeJPEG, v, e);
+  benchmark.add("BM_writeSVG", BM_writeSVG, v, e);
+  benchmark.add("BM_writeEPS", BM_writeEPS, v, e);
+  benchmark.add("BM_writePDF", BM_writePDF, v, e);
+  benchmark.add("BM_cachedEncode", BM_cachedEncode, v, e);
+  benchmark.add("BM_cachedWritePNG", BM_cachedWritePNG, v, e);
+  benchmark.add("BM_storeLookup", BM_storeLookup, v, e);
+
+  /// the variants the kernels run with, like the context Google Benchmark prints first.
+  std::cout << CpuDispatch_getReport() << std::endl;
+  benchmark.run();
+
+  return(0);
+}
+
+/// bits left for the characters of a single segment filling the symbol.
+static int getPayloadBits(int version, const ECL &ecl, const DATA_MODE &mode)
+{
+  return((QRStages::getDataCodewordsCount(version, ecl) * 8) - 4 - QRSegment::getCharCountIndicatorSize(mode, version));
+}
+
+/// digits filling the symbol.
+static std::string makeNumeric(int version, const ECL &ecl)
+{
+  int bits = getPayloadBits(version, ecl, DM_NUM);
+  int n = ((bits / 10) * 3) + (((bits % 10) >= 7) ? 2 : (((bits % 10) >= 4) ? 1 : 0));
+  std::string text;
+
+  for (int i = 0; i < n; i++)
+    text += (char)('0' + (rand() % 10));
+
+  return(text);
+}
+
+/// alphanumeric characters filling the symbol.
+static std::string makeAlphanumeric(int version, const ECL &ecl)
+{
+  int bits = getPayloadBits(version, ecl, DM_AN);
+  int n = ((bits / 11) * 2) + (((bits % 11) >= 6) ? 1 : 0);
+  std::string text;
+
+  for (int i = 0; i < n; i++)
+    text += ALPHANUMERIC_CHARSET[rand() % 45];
+
+  return(text);
+}
+
+/// bytes filling the symbol.
+static ui8vector makeBytes(int version, const ECL &ecl)
+{
+  ui8vector data(getPayloadBits(version, ecl, DM_8) / 8);
+
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = (uint8_t)(rand() & 0xFF);
+
+  return(data);
+}
+
+/// data codewords of the symbol, as QRCode::encode() builds them.
+static ui8vector makeCodewords(int version, const ECL &ecl, const QRSegment &seg)
+{
+  const int capacity = QRStages::getDataCodewordsCount(version, ecl) * 8;
+  QRBitBuffer bits;
+
+  bits.appendBits(seg.getMode(), 4);
+  bits.appendBits(seg.getInputSize(), seg.getCharCountIndicatorSize(version));
+  bits.appendData(seg);
+  bits.appendBits(0, std::min(4, capacity - bits.getBitLength()));
+  bits.appendBits(0, (8 - bits.getBitLength() % 8) % 8);
+
+  for (uint8_t padByte = 0xEC; bits.getBitLength() < capacity; padByte ^= 0xEC ^ 0x11)
+    bits.appendBits(padByte, 8);
+
+  return(bits.getBytes());
+}
+
+/// a symbol with function patterns and codewords drawn, not masked.
+static void makeUnmasked(QRCode &qr, int version, const ECL &ecl, ui8vector &allCodewords)
+{
+  QRSegment seg;
+  seg.create(makeBytes(version, ecl));
+
+  QRStages::reset(qr, version, ecl);
+  QRStages::drawFunctionPatterns(qr);
+  allCodewords = QRStages::appendErrorCorrection(qr, makeCodewords(version, ecl, seg));
+  QRStages::drawCodewords(qr, allCodewords);
+}
+
+static void BM_createNumeric(QRBenchmarkState &state)
+{
+  const std::string input = makeNumeric(state.getVersion(), state.getECL());
+
+  while (state.keepRunning())
+  {
+    QRSegment seg;
+    QRStages::createNumeric(seg, input);
+    state.addBytesProcessed((double)input.size());
+  }
+}
+
+static void BM_createAlphanumeric(QRBenchmarkState &state)
+{
+  const std::string input = makeAlphanumeric(state.getVersion(), state.getECL());
+
+  while (state.keepRunning())
+  {
+    QRSegment seg;
+    QRStages::createAlphanumeric(seg, input);
+    state.addBytesProcessed((double)input.size());
+  }
+}
+
+static void BM_createBytes(QRBenchmarkState &state)
+{
+  const ui8vector input = makeBytes(state.getVersion(), state.getECL());
+
+  while (state.keepRunning())
+  {
+    QRSegment seg;
+    QRStages::createBytes(seg, input);
+    state.addBytesProcessed((double)input.size());
+  }
+}
+
+static void BM_bitBufferAppend(QRBenchmarkState &state)
+{
+  QRSegment seg;
+  seg.create(makeBytes(state.getVersion(), state.getECL()));
+
+  while (state.keepRunning())
+  {
+    ui8vector codewords = makeCodewords(state.getVersion(), state.getECL(), seg);
+    state.addBytesProcessed((double)codewords.size());
+  }
+}
+
+static void BM_appendErrorCorrection(QRBenchmarkState &state)
+{
+  QRSegment seg;
+  seg.create(makeBytes(state.getVersion(), state.getECL()));
+
+  QRCode qr;
+  QRStages::reset(qr, state.getVersion(), state.getECL());
+  const ui8vector codewords = makeCodewords(state.getVersion(), state.getECL(), seg);
+
+  while (state.keepRunning())
+  {
+    ui8vector allCodewords = QRStages::appendErrorCorrection(qr, codewords);
+    state.addBytesProcessed((double)codewords.size());
+  }
+}
+
+static void BM_drawFunctionPatterns(QRBenchmarkState &state)
+{
+  const int size = (state.getVersion() * 4) + 17;
+  QRCode qr;
+
+  while (state.keepRunning())
+  {
+    state.pauseTiming();
+    QRStages::reset(qr, state.getVersion(), state.getECL());
+    state.resumeTiming();
+
+    QRStages::drawFunctionPatterns(qr);
+    state.addBytesProcessed((size * size) / 8.0);
+  }
+}
+
+static void BM_drawCodewords(QRBenchmarkState &state)
+{
+  QRCode qr;
+  ui8vector allCodewords;
+  makeUnmasked(qr, state.getVersion(), state.getECL(), allCodewords);
+
+  /// drawing again overwrites the same data modules.
+  while (state.keepRunning())
+  {
+    QRStages::drawCodewords(qr, allCodewords);
+    state.addBytesProcessed((double)allCodewords.size());
+  }
+}
+
+static void BM_applyMask(QRBenchmarkState &state)
+{
+  const int size = (state.getVersion() * 4) + 17;
+  QRCode qr;
+  ui8vector allCodewords;
+  makeUnmasked(qr, state.getVersion(), state.getECL(), allCodewords);
+
+  int mask = 0;
+  while (state.keepRunning())
+  {
+    QRStages::applyMask(qr, mask);
+    mask = (mask + 1) & 7;
+    state.addBytesProcessed((size * size) / 8.0);
+  }
+}
+
+static void BM_getPenaltyScore(QRBenchmarkState &state)
+{
+  const int size = (state.getVersion() * 4) + 17;
+  QRCode qr;
+  ui8vector allCodewords;
+  makeUnmasked(qr, state.getVersion(), state.getECL(), allCodewords);
+  QRStages::applyMask(qr, 0);
+
+  while (state.keepRunning())
+  {
+    g_sink = QRStages::getPenaltyScore(qr);
+    state.addBytesProcessed((size * size) / 8.0);
+  }
+}
+
+static void BM_encodeFixedMask(QRBenchmarkState &state)
+{
+  std::vector<QRSegment> segs(1);
+  segs[0].create(makeBytes(state.getVersion(), state.getECL()));
+  const int codewords = QRStages::getDataCodewordsCount(state.getVersion(), state.getECL());
+
+  int mask = 0;
+  while (state.keepRunning())
+  {
+    QRCode qr;
+    qr.encode(segs, state.getECL(), mask);
+    mask = (mask + 1) & 7;
+    state.addBytesProcessed((double)codewords);
+  }
+}
+
+/// labels of a series: the same bytes but for a serial number in the last ones.
+static void BM_encodeIncremental(QRBenchmarkState &state)
+{
+  std::vector<QRSegment> segs(1);
+  ui8vector label = makeBytes(state.getVersion(), state.getECL());
+  const int codewords = QRStages::getDataCodewordsCount(state.getVersion(), state.getECL());
+  const size_t serial = std::min((size_t)4, label.size());
+
+  /// the first label makes the whole symbol, outside of the loop.
+  QRIncrementalEncoder encoder;
+  segs[0].create(label);
+  encoder.encode(segs, state.getECL(), 0);
+
+  uint32_t number = 0;
+  while (state.keepRunning())
+  {
+    number++;
+    for (size_t i = 0; i < serial; i++)
+      label[label.size() - 1 - i] = (uint8_t)(number >> (8 * i));
+
+    segs[0].create(label);
+    encoder.encode(segs, state.getECL(), 0);
+    state.addBytesProcessed((double)codewords);
+  }
+}
+
+static void BM_encode(QRBenchmarkState &state)
+{
+  std::vector<QRSegment> segs(1);
+  segs[0].create(makeBytes(state.getVersion(), state.getECL()));
+  const int codewords = QRStages::getDataCodewordsCount(state.getVersion(), state.getECL());
+
+  while (state.keepRunning())
+  {
+    QRCode qr;
+    qr.encode(segs, state.getECL());
+    state.addBytesProcessed((double)codewords);
+  }
+}
+
+/// an image writer, bytes processed being the size of the image.
+static void writeImage(QRBenchmarkState &state, const IMAGE_FORMAT &format)
+{
+  QRCode qr;
+  qr.encode(makeBytes(state.getVersion(), state.getECL()), state.getECL(), 0);
+
+  ui8vector buffer;
+  while (state.keepRunning())
+  {
+    buffer.clear();
+    qr.encodeToBuffer(format, buffer, 4, 4);
+    state.addBytesProcessed((double)buffer.size());
+  }
+}
+
+static void BM_writeBMP(QRBenchmarkState &state)
+{
+  writeImage(state, IF_BMP);
+}
+
+static void BM_writePNG(QRBenchmarkState &state)
+{
+  writeImage(state, IF_PNG);
+}
+
+static void BM_writeJPEG(QRBenchmarkState &state)
+{
+  writeImage(state, IF_JPEG);
+}
+
+static void BM_writeSVG(QRBenchmarkState &state)
+{
+  writeImage(state, IF_SVG);
+}
+
+static void BM_writeEPS(QRBenchmarkState &state)
+{
+  writeImage(state, IF_EPS);
+}
+
+static void BM_writePDF(QRBenchmarkState &state)
+{
+  writeImage(state, IF_PDF);
+}
+
+/// hits of the symbol cache, the cost of a payload seen before.
+static void BM_cachedEncode(QRBenchmarkState &state)
+{
+  const ui8vector payload = makeBytes(state.getVersion(), state.getECL());
+  QRSymbolCache cache;
+  QRSymbolCache::Symbol symbol;
+
+  cache.encode(payload, state.getECL(), -1, symbol);
+  while (state.keepRunning())
+  {
+    cache.encode(payload, state.getECL(), -1, symbol);
+    state.addBytesProcessed((double)payload.size());
+  }
+}
+
+static void BM_cachedWritePNG(QRBenchmarkState &state)
+{
+  const ui8vector payload = makeBytes(state.getVersion(), state.getECL());
+  QRSymbolCache cache;
+
+  ui8vector buffer;
+  cache.encodeToBuffer(payload, state.getECL(), -1, IF_PNG, buffer, 4, 4);
+  while (state.keepRunning())
+  {
+    buffer.clear();
+    cache.encodeToBuffer(payload, state.getECL(), -1, IF_PNG, buffer, 4, 4);
+    state.addBytesProcessed((double)buffer.size());
+  }
+}
+
+/// lookups in a mapped symbol store, the symbols written beforehand.
+static void BM_storeLookup(QRBenchmarkState &state)
+{
+  const std::string filename(QRTestCorpus::getScratchFileName("qrbench", ".qrstore"));
+  std::vector<std::string> payloads;
+  QRSymbolStoreWriter writer;
+
+  writer.open(filename);
+  for (int i = 0; i < 64; i++)
+  {
+    payloads.push_back(makeNumeric(state.getVersion(), state.getECL()));
+    writer.append(payloads.back(), state.getECL(), 0);
+  }
+  writer.close();
+
+  QRSymbolStore store;
+  QRSymbolStore::Symbol symbol;
+  size_t i = 0;
+
+  store.open(filename);
+  while (state.keepRunning())
+  {
+    const std::string &payload = payloads[i++ % payloads.size()];
+    if (store.find(payload, state.getECL(), 0, symbol))
+      g_sink += symbol.p_data[0];
+    state.addBytesProcessed((double)payload.size());
+  }
+
+  store.close();
+  remove(filename.c_str());
+}
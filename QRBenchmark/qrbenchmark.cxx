@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "qrbenchmark.h"
+
+using namespace QR;
+
+static const char *ECL_NAMES[] = {"L", "M", "Q", "H"};
+
+/// most iterations of a benchmark, whatever its time.
+static const long MAX_ITERATIONS = 1000000000L;
+
+/// Parametric Constructor
+QRBenchmarkState::QRBenchmarkState(int version, const ECL &ecl, long iterations)
+  :m_version(version),
+  m_ecl(ecl),
+  m_iterations(iterations),
+  m_done(0),
+  m_running(false),
+  m_wallStart(),
+  m_cpuStart(0),
+  m_wallTime(0.0),
+  m_cpuTime(0.0),
+  m_bytes(0.0)
+{
+}
+
+/// Copy Constructor
+QRBenchmarkState::QRBenchmarkState(const QRBenchmarkState &other)
+  :m_version(other.m_version),
+  m_ecl(other.m_ecl),
+  m_iterations(other.m_iterations),
+  m_done(other.m_done),
+  m_running(other.m_running),
+  m_wallStart(other.m_wallStart),
+  m_cpuStart(other.m_cpuStart),
+  m_wallTime(other.m_wallTime),
+  m_cpuTime(other.m_cpuTime),
+  m_bytes(other.m_bytes)
+{
+}
+
+/// Destructor
+QRBenchmarkState::~QRBenchmarkState()
+{
+}
+
+/// Assignment Operator
+QRBenchmarkState& QRBenchmarkState::operator=(const QRBenchmarkState &other)
+{
+  if(this != &other)
+  {
+    m_version = other.m_version;
+    m_ecl = other.m_ecl;
+    m_iterations = other.m_iterations;
+    m_done = other.m_done;
+    m_running = other.m_running;
+    m_wallStart = other.m_wallStart;
+    m_cpuStart = other.m_cpuStart;
+    m_wallTime = other.m_wallTime;
+    m_cpuTime = other.m_cpuTime;
+    m_bytes = other.m_bytes;
+  }
+
+  return(*this);
+}
+
+bool QRBenchmarkState::keepRunning()
+{
+  if (m_done == 0)
+    resumeTiming();
+
+  if (m_done < m_iterations)
+  {
+    m_done++;
+    return(true);
+  }
+
+  pauseTiming();
+  return(false);
+}
+
+void QRBenchmarkState::pauseTiming()
+{
+  if (m_running)
+  {
+    m_wallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_wallStart).count();
+    m_cpuTime += (double)(std::clock() - m_cpuStart) / CLOCKS_PER_SEC;
+    m_running = false;
+  }
+}
+
+void QRBenchmarkState::resumeTiming()
+{
+  if (!m_running)
+  {
+    m_running = true;
+    m_cpuStart = std::clock();
+    m_wallStart = std::chrono::steady_clock::now();
+  }
+}
+
+void QRBenchmarkState::addBytesProcessed(double bytes)
+{
+  m_bytes += bytes;
+}
+
+int QRBenchmarkState::getVersion() const
+{
+  return(m_version);
+}
+
+ECL QRBenchmarkState::getECL() const
+{
+  return(m_ecl);
+}
+
+long QRBenchmarkState::getIterations() const
+{
+  return(m_done);
+}
+
+double QRBenchmarkState::getWallTime() const
+{
+  return(m_wallTime);
+}
+
+double QRBenchmarkState::getCpuTime() const
+{
+  return(m_cpuTime);
+}
+
+double QRBenchmarkState::getBytesProcessed() const
+{
+  return(m_bytes);
+}
+
+/// Default Constructor
+QRBenchmark::QRBenchmark()
+  :m_entries(),
+  m_minTime(0.2),
+  m_filter()
+{
+}
+
+/// Copy Constructor
+QRBenchmark::QRBenchmark(const QRBenchmark &other)
+  :m_entries(other.m_entries),
+  m_minTime(other.m_minTime),
+  m_filter(other.m_filter)
+{
+}
+
+/// Destructor
+QRBenchmark::~QRBenchmark()
+{
+}
+
+/// Assignment Operator
+QRBenchmark& QRBenchmark::operator=(const QRBenchmark &other)
+{
+  if(this != &other)
+  {
+    m_entries = other.m_entries;
+    m_minTime = other.m_minTime;
+    m_filter = other.m_filter;
+  }
+
+  return(*this);
+}
+
+void QRBenchmark::add(const std::string &name, Function function, const std::vector<int> &versions, const std::vector<ECL> &ecls)
+{
+  char suffix[16];
+
+  for (size_t v = 0; v < versions.size(); v++)
+  {
+    if ((versions[v] < 1) || (versions[v] > 40))
+      throw "Version number out of range";
+
+    for (size_t e = 0; e < ecls.size(); e++)
+    {
+      Entry entry;
+      sprintf(suffix, "/%d/%s", versions[v], ECL_NAMES[ecls[e]]);
+      entry.m_name = name + suffix;
+      entry.m_function = function;
+      entry.m_version = versions[v];
+      entry.m_ecl = ecls[e];
+
+      m_entries.push_back(entry);
+    }
+  }
+}
+
+void QRBenchmark::setMinTime(double seconds)
+{
+  if (seconds <= 0.0)
+    throw "Value out of range";
+
+  m_minTime = seconds;
+}
+
+void QRBenchmark::setFilter(const std::string &filter)
+{
+  m_filter = filter;
+}
+
+int QRBenchmark::run()
+{
+  int count = 0;
+
+  printf("%-40s %14s %14s %12s %14s %12s\n", "Benchmark", "Time", "CPU", "Iterations", "symbols/s", "MB/s");
+  printf("%s\n", std::string(111, '-').c_str());
+
+  for (size_t i = 0; i < m_entries.size(); i++)
+  {
+    const Entry &entry = m_entries[i];
+    if (entry.m_name.find(m_filter) == std::string::npos)
+      continue;
+
+    /// more iterations until the run is long enough to be measured, like Google Benchmark.
+    long iterations = 1;
+    for (;;)
+    {
+      QRBenchmarkState state(entry.m_version, entry.m_ecl, iterations);
+      entry.m_function(state);
+
+      const double wall = state.getWallTime();
+      if ((wall >= m_minTime) || (iterations >= MAX_ITERATIONS))
+      {
+        const double n = (double)state.getIterations();
+
+        printf("%-40s %11.0f ns %11.0f ns %12ld %14.1f %12.2f\n", entry.m_name.c_str(),
+            wall * 1e9 / n, state.getCpuTime() * 1e9 / n, state.getIterations(),
+            n / wall, state.getBytesProcessed() / wall / 1e6);
+        fflush(stdout);
+        break;
+      }
+
+      double multiplier = (wall > 0.0) ? std::min(10.0, (m_minTime * 1.4) / wall) : 10.0;
+      iterations = std::min(MAX_ITERATIONS, std::max(iterations + 1, (long)(iterations * multiplier)));
+    }
+
+    count++;
+  }
+
+  return(count);
+}
+
+void QRStages::createNumeric(QRSegment &segment, const std::string &input)
+{
+  segment.createNumeric(input);
+}
+
+void QRStages::createAlphanumeric(QRSegment &segment, const std::string &input)
+{
+  segment.createAlphanumeric(input);
+}
+
+void QRStages::createBytes(QRSegment &segment, const ui8vector &data)
+{
+  segment.createBytes(data);
+}
+
+int QRStages::getDataCodewordsCount(int version, const ECL &ecl)
+{
+  return(QRCode::getDataCodewordsCount(version, ecl));
+}
+
+void QRStages::reset(QRCode &qr, int version, const ECL &ecl)
+{
+  /// the start of makeQRCode(): the scalar fields and blank grids.
+  qr.m_version = version;
+  qr.m_size = (version * 4) + 17;
+  qr.m_ecl = ecl;
+  qr.m_mask = 0;
+  qr.m_modules.assign(qr.m_size, std::vector<bool>(qr.m_size, false));
+  qr.m_isFunction.assign(qr.m_size, std::vector<bool>(qr.m_size, false));
+}
+
+void QRStages::drawFunctionPatterns(QRCode &qr)
+{
+  qr.drawFunctionPatterns();
+}
+
+ui8vector QRStages::appendErrorCorrection(QRCode &qr, const ui8vector &data)
+{
+  return(qr.appendErrorCorrection(data));
+}
+
+void QRStages::drawCodewords(QRCode &qr, const ui8vector &data)
+{
+  qr.drawCodewords(data);
+}
+
+void QRStages::applyMask(QRCode &qr, int mask)
+{
+  qr.applyMask(mask);
+}
+
+int QRStages::getPenaltyScore(const QRCode &qr)
+{
+  return(qr.getPenaltyScore());
+}
@@ -0,0 +1,196 @@
+/**
+*  @file    qrbenchmark.h
+*  @brief   classes to time every stage of the QR Code encoder on its own.
+*
+*  A small benchmark runner in the style of Google Benchmark, without the
+*  dependency. A benchmark is a function looping on
+*  QRBenchmarkState::keepRunning(), registered for a set of versions and
+*  error correction levels. Every one runs long enough to be measured
+*  (the number of iterations grows until the minimum time is reached), and
+*  is reported with its wall and CPU time per iteration, symbols per second
+*  and MB per second of the bytes it reports as processed.
+*
+*  QRStages is a friend of QRCode and QRSegment, and calls their private
+*  stages (mode encoders, error correction, function patterns, codeword
+*  placement, masking, penalty score) one by one.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRBENCHMARK_H
+#define QRBENCHMARK_H
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrcode.h"
+#include "qrsegment.h"
+
+namespace QR
+{
+  //!  @class  QRBenchmarkState
+  /*!
+    State of a running benchmark: its arguments, the iteration loop and its timer.
+  */
+  class QRBenchmarkState
+  {
+    public:
+      /// Parametric Constructor, iterations is the number of times keepRunning() returns true.
+      QRBenchmarkState(int version, const ECL &ecl, long iterations);
+
+      /// Copy Constructor
+      QRBenchmarkState(const QRBenchmarkState &other);
+
+      /// Destructor
+      ~QRBenchmarkState();
+
+      /// Assignment Operator
+      QRBenchmarkState& operator=(const QRBenchmarkState &other);
+
+      /** @brief loop condition of a benchmark.
+      *
+      *  The timer starts at the first call and stops at the last one.
+      *
+      *  @return bool true while iterations are left.
+      */
+      bool keepRunning();
+
+      /// stop the timer, for the setup an iteration needs but which isn't measured.
+      void pauseTiming();
+
+      /// restart the timer stopped by pauseTiming().
+      void resumeTiming();
+
+      /// add to the number of bytes processed, for the MB/s column.
+      void addBytesProcessed(double bytes);
+
+      /// version the benchmark runs with.
+      int getVersion() const;
+
+      /// error correction level the benchmark runs with.
+      ECL getECL() const;
+
+      /// number of iterations run.
+      long getIterations() const;
+
+      /// wall time of the iterations, in seconds.
+      double getWallTime() const;
+
+      /// CPU time of the iterations, in seconds.
+      double getCpuTime() const;
+
+      /// bytes processed by the iterations.
+      double getBytesProcessed() const;
+
+    private:
+      int                                   m_version;      ///< Define version argument.
+      ECL                                   m_ecl;          ///< Define error correction level argument.
+      long                                  m_iterations;   ///< Define number of iterations to run.
+      long                                  m_done;         ///< Define number of iterations run.
+      bool                                  m_running;      ///< Define whether the timer runs.
+      std::chrono::steady_clock::time_point m_wallStart;    ///< Define wall time the timer started at.
+      std::clock_t                          m_cpuStart;     ///< Define CPU time the timer started at.
+      double                                m_wallTime;     ///< Define wall time measured.
+      double                                m_cpuTime;      ///< Define CPU time measured.
+      double                                m_bytes;        ///< Define bytes processed.
+  };
+
+  //!  @class  QRBenchmark
+  /*!
+    Registry and runner of the benchmarks.
+  */
+  class QRBenchmark
+  {
+    public:
+      /// a benchmark, looping on state.keepRunning().
+      typedef void (*Function)(QRBenchmarkState &state);
+
+      /// Default Constructor, 0.2 seconds per benchmark.
+      QRBenchmark();
+
+      /// Copy Constructor
+      QRBenchmark(const QRBenchmark &other);
+
+      /// Destructor
+      ~QRBenchmark();
+
+      /// Assignment Operator
+      QRBenchmark& operator=(const QRBenchmark &other);
+
+      /** @brief register a benchmark for every version and error correction level given.
+      *
+      *  Every pair is reported as name/version/level.
+      *
+      *  @param[in] name the name of the benchmark.
+      *  @param[in] function the benchmark.
+      *  @param[in] versions the versions to run it with.
+      *  @param[in] ecls the error correction levels to run it with.
+      *
+      *  @return nothing.
+      */
+      void add(const std::string &name, Function function, const std::vector<int> &versions, const std::vector<ECL> &ecls);
+
+      /// set the least time every benchmark runs for, in seconds.
+      void setMinTime(double seconds);
+
+      /// only run the benchmarks whose full name contains filter.
+      void setFilter(const std::string &filter);
+
+      /** @brief run the benchmarks and print a line for each to the standard output.
+      *
+      *  @return int number of benchmarks run.
+      */
+      int run();
+
+    private:
+      //!  @struct  Entry
+      /*!
+        A registered benchmark with its arguments.
+      */
+      struct Entry
+      {
+        std::string m_name;       ///< Define full name, name/version/level.
+        Function    m_function;   ///< Define benchmark.
+        int         m_version;    ///< Define version argument.
+        ECL         m_ecl;        ///< Define error correction level argument.
+      };
+
+      std::vector<Entry>  m_entries;    ///< Define registered benchmarks.
+      double              m_minTime;    ///< Define least time every benchmark runs for.
+      std::string         m_filter;     ///< Define filter of the names of the benchmarks to run.
+  };
+
+  //!  @class  QRStages
+  /*!
+    Calls the private encoding stages of QRCode and QRSegment.
+  */
+  class QRStages
+  {
+    public:
+      /// mode encoders of QRSegment.
+      static void createNumeric(QRSegment &segment, const std::string &input);
+      static void createAlphanumeric(QRSegment &segment, const std::string &input);
+      static void createBytes(QRSegment &segment, const ui8vector &data);
+
+      /// number of data codewords of a version and error correction level.
+      static int getDataCodewordsCount(int version, const ECL &ecl);
+
+      /// make qr an empty symbol of a version and error correction level, without function patterns.
+      static void reset(QRCode &qr, int version, const ECL &ecl);
+
+      /// stages of QRCode::makeQRCode(), in order.
+      static void drawFunctionPatterns(QRCode &qr);
+      static ui8vector appendErrorCorrection(QRCode &qr, const ui8vector &data);
+      static void drawCodewords(QRCode &qr, const ui8vector &data);
+      static void applyMask(QRCode &qr, int mask);
+      static int getPenaltyScore(const QRCode &qr);
+  };
+}
+
+#endif    // QRBENCHMARK_H
@@ -0,0 +1,270 @@
+/**
+*  @file    main.cxx
+*  @brief   command line front end of QRCodeGen.
+*
+*  Encodes a text into a QR Code symbol and writes it as an image (the
+*  format taken from the file extension) or prints it to the console.
+*  With --verify it runs the round trip verification (QRRoundTrip) instead,
+*  which is how a deployed build checks itself.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "qrcode.h"
+#include "qrroundtrip.h"
+#include "cpudispatch.h"
+
+using namespace QR;
+
+/// exit codes.
+static const int EXIT_USAGE = 1;
+static const int EXIT_ENCODE = 2;
+static const int EXIT_MISMATCH = 3;
+
+static void printUsage(const char *program)
+{
+  std::cerr << "usage: " << program << " [options] <text | ->\n"
+            << "       " << program << " --verify [-v <min>-<max>] [-m <min>-<max>] [-j <json file>]\n"
+            << "       " << program << " --cpu\n"
+            << "\n"
+            << "  -o <file>   write the symbol to file, as BMP, PNG, JPEG, SVG, EPS or PDF\n"
+            << "              after its extension (.bmp .png .jpg .svg .eps .pdf)\n"
+            << "  -l <L|M|Q|H> error correction level, the lowest accepted (default L)\n"
+            << "  -m <mask>   mask 0 to 7 (default automatic)\n"
+            << "  -s <pixels> pixels per module of the images (default 8)\n"
+            << "  -b <border> quiet zone in modules (default 4)\n"
+            << "  -           read the text from the standard input\n"
+            << "\n"
+            << "  --verify    encode, render, read back and decode every version, level and\n"
+            << "              mask, and exit with " << EXIT_MISMATCH << " on any mismatch\n"
+            << "  -v          versions of the verification (default 1-40)\n"
+            << "  -m          masks of the verification (default 0-7)\n"
+            << "  -j          write the summary of the verification as JSON\n"
+            << "\n"
+            << "  --cpu       print the instruction set of the CPU and the variant of every\n"
+            << "              kernel, QR_CPU=scalar|sse2|sse4.2|avx2|avx512 lowers it" << std::endl;
+}
+
+/// parses "min-max" or a single number.
+static bool parseRange(const char *text, int &first, int &last)
+{
+  char *end;
+  first = (int)strtol(text, &end, 10);
+
+  if (end == text)
+    return(false);
+
+  last = first;
+  if (*end == '-')
+  {
+    const char *second = end + 1;
+    last = (int)strtol(second, &end, 10);
+
+    if (end == second)
+      return(false);
+  }
+
+  return(*end == '\0');
+}
+
+static bool getFormat(const std::string &filename, IMAGE_FORMAT &format)
+{
+  const char *extensions[] = {".bmp", ".png", ".jpg", ".svg", ".eps", ".pdf", ".jpeg"};
+  const IMAGE_FORMAT formats[] = {IF_BMP, IF_PNG, IF_JPEG, IF_SVG, IF_EPS, IF_PDF, IF_JPEG};
+
+  size_t dot = filename.rfind('.');
+  if (dot == std::string::npos)
+    return(false);
+
+  std::string extension = filename.substr(dot);
+  for (size_t i = 0; i < extension.size(); i++)
+    extension[i] = (char)tolower((unsigned char)extension[i]);
+
+  for (int i = 0; i < 7; i++)
+  {
+    if (extension == extensions[i])
+    {
+      format = formats[i];
+      return(true);
+    }
+  }
+
+  return(false);
+}
+
+static int verify(int minVersion, int maxVersion, int minMask, int maxMask, const std::string &json)
+{
+  QRRoundTrip roundTrip;
+
+  try
+  {
+    roundTrip.setVersions(minVersion, maxVersion);
+    roundTrip.setMasks(minMask, maxMask);
+  }
+  catch (const char *error)
+  {
+    std::cerr << error << std::endl;
+    return(EXIT_USAGE);
+  }
+
+  int mismatches = roundTrip.run();
+
+  const std::vector<std::string> &failures = roundTrip.getMismatches();
+  for (size_t i = 0; (i < failures.size()) && (i < 20); i++)
+    std::cerr << failures[i] << std::endl;
+
+  if (!json.empty() && !roundTrip.writeJSON(json))
+    std::cerr << "can't write " << json << std::endl;
+
+  std::cout << roundTrip.getCaseCount() << " symbols, " << roundTrip.getRenderCount() << " images, "
+            << mismatches << " mismatches" << std::endl;
+
+  return((mismatches == 0) ? EXIT_SUCCESS : EXIT_MISMATCH);
+}
+
+int main(int argc, char **argv)
+{
+  std::string text, output, json;
+  bool hasText = false, doVerify = false;
+  ECL ecl = ECL_L;
+  int mask = -1, scale = 8, border = 4;
+  int minVersion = 1, maxVersion = 40, minMask = 0, maxMask = 7;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+
+    if (arg == "--verify")
+      doVerify = true;
+    else if (arg == "--cpu")
+    {
+      std::cout << CpuDispatch_getReport();
+      return(EXIT_SUCCESS);
+    }
+    else if ((arg == "-o") && hasValue)
+      output = argv[++i];
+    else if ((arg == "-j") && hasValue)
+      json = argv[++i];
+    else if ((arg == "-l") && hasValue)
+    {
+      const char *level = argv[++i];
+      const char *levels = "LMQH";
+      const char *found = (strlen(level) == 1) ? strchr(levels, toupper((unsigned char)level[0])) : NULL;
+
+      if (found == NULL)
+      {
+        printUsage(argv[0]);
+        return(EXIT_USAGE);
+      }
+
+      ecl = (ECL)(found - levels);
+    }
+    else if ((arg == "-m") && hasValue)
+    {
+      if (!parseRange(argv[++i], minMask, maxMask))
+      {
+        printUsage(argv[0]);
+        return(EXIT_USAGE);
+      }
+
+      mask = minMask;
+    }
+    else if ((arg == "-v") && hasValue)
+    {
+      if (!parseRange(argv[++i], minVersion, maxVersion))
+      {
+        printUsage(argv[0]);
+        return(EXIT_USAGE);
+      }
+    }
+    else if ((arg == "-s") && hasValue)
+      scale = atoi(argv[++i]);
+    else if ((arg == "-b") && hasValue)
+      border = atoi(argv[++i]);
+    else if (arg == "-")
+    {
+      text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+      hasText = true;
+    }
+    else if ((arg[0] != '-') && !hasText)
+    {
+      text = arg;
+      hasText = true;
+    }
+    else
+    {
+      printUsage(argv[0]);
+      return(EXIT_USAGE);
+    }
+  }
+
+  if (doVerify)
+    return(verify(minVersion, maxVersion, minMask, maxMask, json));
+
+  if (!hasText || (mask < -1) || (mask > 7) || (scale < 1) || (border < 0))
+  {
+    printUsage(argv[0]);
+    return(EXIT_USAGE);
+  }
+
+  QRCode qr;
+  try
+  {
+    qr.encode(text, ecl, mask);
+  }
+  catch (const char *error)
+  {
+    std::cerr << error << std::endl;
+    return(EXIT_ENCODE);
+  }
+
+  if (output.empty())
+  {
+    /// two characters per module, so that the symbol looks square.
+    for (int y = -border; y < qr.getSize() + border; y++)
+    {
+      for (int x = -border; x < qr.getSize() + border; x++)
+        std::cout << ((qr.getModule(x, y) == 1) ? "##" : "  ");
+
+      std::cout << std::endl;
+    }
+
+    return(EXIT_SUCCESS);
+  }
+
+  IMAGE_FORMAT format;
+  if (!getFormat(output, format))
+  {
+    std::cerr << "unknown image format: " << output << std::endl;
+    return(EXIT_USAGE);
+  }
+
+  ui8vector image;
+  qr.encodeToBuffer(format, image, scale, border);
+
+  FILE *file = fopen(output.c_str(), "wb");
+  if ((file == NULL) || (fwrite(&image[0], 1, image.size(), file) != image.size()))
+  {
+    std::cerr << "can't write " << output << std::endl;
+    if (file != NULL)
+      fclose(file);
+
+    return(EXIT_ENCODE);
+  }
+
+  fclose(file);
+  std::cout << output << ": version " << qr.getVersion() << ", level " << "LMQH"[qr.getECL()]
+            << ", mask " << qr.getMask() << ", " << image.size() << " bytes" << std::endl;
+
+  return(EXIT_SUCCESS);
+}
@@ -1,4 +1,5 @@
 #include "bitmap.h"
+#include "mappedfile.h"
 
 
 Bitmap::Bitmap()
@@ -92,44 +93,245 @@ void Bitmap::setBitCount(WORD bitCount)
   this->m_bitmapInfoHeader.m_bitCount = bitCount;
 }
 
-void Bitmap::writeToFile(const char *filename)
+LONG Bitmap::getWidth() const
 {
-  DWORD pixelArraySize = calculatePixelArraySize();
+  return(abs(m_bitmapInfoHeader.m_width));
+}
+
+LONG Bitmap::getHeight() const
+{
+  return(abs(m_bitmapInfoHeader.m_height));
+}
 
-/*  p_file = fopen (filename,"wb");
-  if ((p_file != NULL) && (pixelArraySize > 0))
+bool Bitmap::isTopDown() const
+{
+  return(m_bitmapInfoHeader.m_height < 0);
+}
+
+void Bitmap::getGrayscale(vector<unsigned char> &gray) const
+{
+  LONG width = getWidth();
+  LONG height = getHeight();
+  DWORD rowSize = ((m_bitmapInfoHeader.m_bitCount * width + 31) / 32) * 4;
+
+  gray.assign(width * height, 0xff);
+
+  if(p_pixelArray == NULL)
+    return;
+
+  for(LONG y = 0; y < height; y++)
   {
-    // set proper size of the bitmap file including pixel array size.
-    if(m_bitmapFileHeader.m_size == (14 + 40))
-      m_bitmapFileHeader.m_size += pixelArraySize;
+    /// pixel array bytes are blue, green, red (as in the file).
+    const unsigned char *s = p_pixelArray + ((isTopDown() ? y : (height - 1 - y)) * rowSize);
+    unsigned char *d = &gray[y * width];
 
-    fwrite(&m_bitmapFileHeader, sizeof(BITMAPFILEHEADER), 1, p_file);
-    fwrite(&m_bitmapInfoHeader, sizeof(BITMAPINFOHEADER), 1, p_file);
-    //if( convertRGBAToFileFormat() )
-    /// fuck you
-      fwrite(p_pixelArray, sizeof(unsigned char), pixelArraySize, p_file);
+    for(LONG x = 0; x < width; x++, s += 3)
+      d[x] = (unsigned char)(((29 * s[0]) + (150 * s[1]) + (77 * s[2])) >> 8);
+  }
+}
 
-    fclose(p_file);
-  }*/
+DWORD Bitmap::getFileSize() const
+{
+  return(sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) + calculatePixelArraySize());
+}
 
-  /// reverse the array as its bottom up approach.
-  //if(m_bitmapInfoHeader.m_height > 0)
-  //  reverse();
+DWORD Bitmap::writeToBuffer(unsigned char *buffer, DWORD capacity) const
+{
+  DWORD pixelArraySize = calculatePixelArraySize();
+  DWORD fileSize = getFileSize();
+
+  if((buffer == NULL) || (pixelArraySize == 0) || (capacity < fileSize))
+    return(0);
+
+  /// file header always carry the size of the whole file.
+  BITMAPFILEHEADER fileHeader(m_bitmapFileHeader);
+  fileHeader.m_size = fileSize;
+
+  memcpy(buffer, &fileHeader, sizeof(BITMAPFILEHEADER));
+  buffer += sizeof(BITMAPFILEHEADER);
+
+  memcpy(buffer, &m_bitmapInfoHeader, sizeof(BITMAPINFOHEADER));
+  buffer += sizeof(BITMAPINFOHEADER);
+
+  /// untouched bitmap is white, same as setPixelLow() initialize it.
+  if(p_pixelArray != NULL)
+    memcpy(buffer, p_pixelArray, pixelArraySize);
+  else
+    memset(buffer, 0xff, pixelArraySize);
+
+  return(fileSize);
+}
+
+void Bitmap::writeToBuffer(vector<unsigned char> &buffer) const
+{
+  size_t offset = buffer.size();
+
+  buffer.resize(offset + getFileSize());
+  if(writeToBuffer(&buffer[offset], getFileSize()) == 0)
+    buffer.resize(offset);
+}
+
+void Bitmap::writeToFile(const char *filename)
+{
+  vector<unsigned char> buffer;
+  writeToBuffer(buffer);
 
   fs.open(filename, ios::out|ios::binary);
   if(fs.is_open())
   {
-    fs.write(reinterpret_cast<char*>(&m_bitmapFileHeader), sizeof(BITMAPFILEHEADER));
-    fs.write(reinterpret_cast<char*>(&m_bitmapInfoHeader), sizeof(BITMAPINFOHEADER));
-    fs.write(reinterpret_cast<char*>(p_pixelArray), pixelArraySize);
+    if(buffer.size() > 0)
+      fs.write(reinterpret_cast<char*>(&buffer[0]), buffer.size());
 
     fs.close();
   }
 }
 
-void Bitmap::readFromFile(const char *filename)
+bool Bitmap::readFromFile(const char *filename)
 {
+  MappedFile file;
+
+  if(!file.open(filename))
+    return(false);
+
+  return(readFromBuffer(file.getData(), file.getSize()));
+}
+
+/// little endian values of the file, which may not be aligned.
+static DWORD readDWORD(const unsigned char *p)
+{
+  return((DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16) | ((DWORD)p[3] << 24));
+}
+
+static WORD readWORD(const unsigned char *p)
+{
+  return((WORD)(p[0] | (p[1] << 8)));
+}
+
+bool Bitmap::readFromBuffer(const unsigned char *buffer, size_t size)
+{
+  const size_t fileHeaderSize = sizeof(BITMAPFILEHEADER);
+
+  if((buffer == NULL) || (size < fileHeaderSize + sizeof(BITMAPINFOHEADER)) || (readWORD(buffer) != 0x4d42))
+    return(false);
+
+  /// BITMAPINFOHEADER, or a later version of it (V4, V5) which starts the same way.
+  const unsigned char *info = buffer + fileHeaderSize;
+  DWORD offBits = readDWORD(buffer + 10);
+  DWORD infoSize = readDWORD(info);
+  LONG width = (LONG)readDWORD(info + 4);
+  LONG height = (LONG)readDWORD(info + 8);
+  WORD bitCount = readWORD(info + 14);
+  DWORD compression = readDWORD(info + 16);
+  DWORD clrUsed = readDWORD(info + 32);
+
+  if((infoSize < sizeof(BITMAPINFOHEADER)) || (width <= 0) || (height == 0) || (height == (LONG)0x80000000) ||
+      ((bitCount != 1) && (bitCount != 8) && (bitCount != 24) && (bitCount != 32)))
+    return(false);
+
+  if(compression == BI_BITFIELDS)
+  {
+    /// only the usual layout (the one of BI_RGB) is supported. The masks follow a
+    /// BITMAPINFOHEADER, or are part of the later versions.
+    if((bitCount != 32) || (size < fileHeaderSize + sizeof(BITMAPINFOHEADER) + 12) ||
+        (readDWORD(info + 40) != 0x00ff0000) || (readDWORD(info + 44) != 0x0000ff00) || (readDWORD(info + 48) != 0x000000ff))
+      return(false);
+  }
+  else if(compression != BI_RGB)
+    return(false);
+
+  DWORD rows = (DWORD)abs(height);
+
+  /// keep the row and pixel array sizes within a DWORD.
+  if(((DWORD)width > 0x3ffffff) || (((unsigned long long)((3 * (DWORD)width + 3) & ~3u) * rows) > 0xffffffffULL))
+    return(false);
+
+  DWORD srcRowSize = ((bitCount * (DWORD)width + 31) / 32) * 4;
+
+  if((offBits > size) || (((size - offBits) / srcRowSize) < rows))
+    return(false);
+
+  /// color table of the 1 and 8 bit bitmaps, 4 bytes (blue, green, red, 0) per entry.
+  const unsigned char *palette = info + infoSize;
+  DWORD paletteSize = 0;
+
+  if(bitCount <= 8)
+  {
+    paletteSize = ((clrUsed > 0) && (clrUsed <= (1u << bitCount))) ? clrUsed : (1u << bitCount);
+    if(((size_t)(palette - buffer) + (paletteSize * 4)) > offBits)
+      return(false);
+  }
+
+  m_bitmapFileHeader = BITMAPFILEHEADER();
+  m_bitmapInfoHeader = BITMAPINFOHEADER();
+  m_bitmapInfoHeader.m_width = width;
+  m_bitmapInfoHeader.m_height = height;
+  m_bitmapInfoHeader.m_bitCount = 24;
+  m_bitmapInfoHeader.m_xPelsPerMeter = (LONG)readDWORD(info + 24);
+  m_bitmapInfoHeader.m_yPelsPerMeter = (LONG)readDWORD(info + 28);
+
+  DWORD pixelArraySize = calculatePixelArraySize();
+  DWORD dstRowSize = pixelArraySize / rows;
+  m_bitmapFileHeader.m_size += pixelArraySize;
+
+  if(p_pixelArray != NULL)
+    free(p_pixelArray);
+
+  p_pixelArray = (unsigned char*)malloc(pixelArraySize);
+  if(p_pixelArray == NULL)
+    return(false);
+
+  const unsigned char *src = buffer + offBits;
+
+  /// same layout, the pixel array is taken as it is.
+  if(bitCount == 24)
+  {
+    memcpy(p_pixelArray, src, pixelArraySize);
+    return(true);
+  }
+
+  for(DWORD row = 0; row < rows; row++)
+  {
+    const unsigned char *s = src + (row * srcRowSize);
+    unsigned char *d = p_pixelArray + (row * dstRowSize);
+
+    switch(bitCount)
+    {
+      case 32:
+        for(LONG col = 0; col < width; col++, s += 4, d += 3)
+        {
+          d[0] = s[0];
+          d[1] = s[1];
+          d[2] = s[2];
+        }
+        break;
+
+      case 8:
+        for(LONG col = 0; col < width; col++, d += 3)
+        {
+          const unsigned char *entry = palette + (4 * (s[col] < paletteSize ? s[col] : 0));
+          d[0] = entry[0];
+          d[1] = entry[1];
+          d[2] = entry[2];
+        }
+        break;
+
+      case 1:
+        for(LONG col = 0; col < width; col++, d += 3)
+        {
+          DWORD index = (s[col >> 3] >> (7 - (col & 7))) & 1;
+          const unsigned char *entry = palette + (4 * (index < paletteSize ? index : 0));
+          d[0] = entry[0];
+          d[1] = entry[1];
+          d[2] = entry[2];
+        }
+        break;
+    }
+
+    /// row padding is left as zero, like a written bitmap.
+    memset(d, 0, dstRowSize - (3 * width));
+  }
 
+  return(true);
 }
 
 DWORD Bitmap::calculatePixelArraySize() const
@@ -165,8 +367,9 @@ void Bitmap::setPixel(int row, int col, int red, int green, int blue, int alpha)
   setPixelLow(row, col, red, green, blue, alpha);
 }
 
-void Bitmap::setPixelLow(int row, int col, int red, int green, int blue, int alpha)
+void Bitmap::setPixelLow(int row, int col, int red, int green, int blue, int /*alpha*/)
 {
+  // the pixel array is 24 bit, there is no alpha channel to store.
   int       c = getCurrentPos(row, col);
 
   if(c != -1)
@@ -235,11 +438,12 @@ int Bitmap::getCurrentPos(int row, int col) const
 {
     int pos = -1;
 
-    if(((row >= 0) && (row < abs(m_bitmapInfoHeader.m_width))) &&
-        ((col >= 0) && (col < abs(m_bitmapInfoHeader.m_height))))
+    if(((row >= 0) && (row < abs(m_bitmapInfoHeader.m_height))) &&
+        ((col >= 0) && (col < abs(m_bitmapInfoHeader.m_width))))
     {
-        if((abs(m_bitmapInfoHeader.m_width) > 0) && (abs(m_bitmapInfoHeader.m_height) > 0))
-            pos = (row * abs(m_bitmapInfoHeader.m_height) * 3) + (col * 3);
+        /// each row of the pixel array is padded to a multiple of 4 bytes.
+        DWORD rowSize = ((m_bitmapInfoHeader.m_bitCount * abs(m_bitmapInfoHeader.m_width) + 31) / 32) * 4;
+        pos = (row * rowSize) + (col * 3);
     }
 
     return(pos);
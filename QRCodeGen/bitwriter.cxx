@@ -0,0 +1,142 @@
+#include <cstddef>
+
+#include "bitwriter.h"
+
+BitWriter::BitWriter()
+  :p_buffer(NULL),
+  m_acc(0),
+  m_bits(0),
+  m_count(0),
+  m_order(BO_MSB_FIRST),
+  m_stuffing(false)
+{
+}
+
+BitWriter::BitWriter(std::vector<unsigned char> *buffer, const BIT_ORDER &order, bool stuffing)
+  :p_buffer(buffer),
+  m_acc(0),
+  m_bits(0),
+  m_count(0),
+  m_order(order),
+  m_stuffing(stuffing)
+{
+}
+
+void BitWriter::setBuffer(std::vector<unsigned char> *buffer, const BIT_ORDER &order, bool stuffing)
+{
+  p_buffer = buffer;
+  m_acc = 0;
+  m_bits = 0;
+  m_count = 0;
+  m_order = order;
+  m_stuffing = stuffing;
+}
+
+void BitWriter::writeBits(const unsigned int value, const int length)
+{
+  unsigned long long bits = value & ((1ULL << length) - 1);
+
+  if((m_bits + length) < 64)
+  {
+    if(m_order == BO_MSB_FIRST)
+      m_acc = (m_acc << length) | bits;
+    else
+      m_acc |= bits << m_bits;
+
+    m_bits += length;
+  }
+  else
+  {
+    /// fill the accumulator up, the rest of the code starts the next one.
+    /// length is at most 32, so are fit and rest.
+    int fit = 64 - m_bits;
+    int rest = length - fit;
+
+    if(m_order == BO_MSB_FIRST)
+    {
+      m_acc = (m_acc << fit) | (bits >> rest);
+      emitAccumulator();
+      m_acc = bits & ((1ULL << rest) - 1);
+    }
+    else
+    {
+      m_acc |= bits << m_bits;
+      emitAccumulator();
+      m_acc = bits >> fit;
+    }
+
+    m_bits = rest;
+  }
+}
+
+void BitWriter::flush(bool fillOnes)
+{
+  int pad = (8 - (m_bits % 8)) % 8;
+
+  if(pad > 0)
+    writeBits(fillOnes ? ((1u << pad) - 1) : 0, pad);
+
+  if(m_order == BO_MSB_FIRST)
+  {
+    for(int shift = m_bits - 8; shift >= 0; shift -= 8)
+      emitByte((unsigned char)(m_acc >> shift));
+  }
+  else
+  {
+    for(int shift = 0; shift < m_bits; shift += 8)
+      emitByte((unsigned char)(m_acc >> shift));
+  }
+
+  m_count += m_bits;
+  m_acc = 0;
+  m_bits = 0;
+}
+
+unsigned long long BitWriter::getBitCount() const
+{
+  return(m_count + m_bits);
+}
+
+void BitWriter::emitAccumulator()
+{
+  unsigned char bytes[8];
+
+  m_count += 64;
+
+  if(p_buffer == NULL)
+    return;
+
+  if(m_order == BO_MSB_FIRST)
+  {
+    /// a byte is 0xFF only if adding 1 to it clears its top bit, so one test
+    /// tells whether any of the 8 bytes needs stuffing (it may be a false alarm).
+    if(m_stuffing && (((m_acc & 0x8080808080808080ULL) & ~(m_acc + 0x0101010101010101ULL)) != 0))
+    {
+      for(int shift = 56; shift >= 0; shift -= 8)
+        emitByte((unsigned char)(m_acc >> shift));
+
+      return;
+    }
+
+    for(int i = 0; i < 8; i++)
+      bytes[i] = (unsigned char)(m_acc >> (56 - (8 * i)));
+  }
+  else
+  {
+    for(int i = 0; i < 8; i++)
+      bytes[i] = (unsigned char)(m_acc >> (8 * i));
+  }
+
+  p_buffer->insert(p_buffer->end(), bytes, bytes + 8);
+}
+
+void BitWriter::emitByte(const unsigned char byte)
+{
+  if(p_buffer == NULL)
+    return;
+
+  p_buffer->push_back(byte);
+
+  if(m_stuffing && (byte == 0xFF))
+    p_buffer->push_back(0);
+}
@@ -0,0 +1,98 @@
+/**
+*  @file    bitwriter.h
+*  @brief   class to write variable length codes into memory.
+*
+*  BitWriter collects codes in a 64 bit accumulator and appends them
+*  to a byte vector 8 bytes at a time. JPEG entropy coded data is
+*  written MSB first with 0xFF byte stuffing, DEFLATE data is written
+*  LSB first without stuffing.
+*
+*  Only built-in types are used here, savejpg.h defines BYTE/WORD
+*  as macros.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#ifndef BITWRITER_H
+#define BITWRITER_H
+
+/// C++-related include
+#include <vector>
+
+//!  @class  BitWriter
+/*!
+  BitWriter class appends codes of up to 32 bits to a byte vector.
+  Codes are kept in the accumulator until 64 bits are collected, so
+  flush() must be called before anything else is appended to the vector.
+*/
+class BitWriter
+{
+  public:
+    //!  @enum  BIT_ORDER
+    /*!
+      Order in which the bits of a code are packed into bytes.
+    */
+    typedef enum BIT_ORDER
+    {
+      BO_MSB_FIRST = 0,   ///< First bit goes to the most significant bit of the byte (JPEG)
+      BO_LSB_FIRST        ///< First bit goes to the least significant bit of the byte (DEFLATE)
+    } BO;
+
+    /// Default Constructor
+    BitWriter();
+
+    /// Parametric Constructor
+    BitWriter(std::vector<unsigned char> *buffer, const BIT_ORDER &order, bool stuffing);
+
+    /** @brief set the vector to append to, and reset the writer.
+    *
+    *  Pending bits are dropped, call flush() first to keep them.
+    *
+    *  @param[in]  buffer the vector to append the bytes to.
+    *  @param[in]  order the bit order.
+    *  @param[in]  stuffing true to write a 0x00 after every 0xFF byte (JPEG entropy coded segment).
+    *
+    *  @return nothing.
+    */
+    void setBuffer(std::vector<unsigned char> *buffer, const BIT_ORDER &order, bool stuffing);
+
+    /** @brief append a code.
+    *
+    *  In BO_MSB_FIRST order the most significant bit of the code is written first,
+    *  in BO_LSB_FIRST order the least significant one (like DEFLATE does for everything
+    *  but huffman codes).
+    *
+    *  @param[in]  value the code, in the low bits.
+    *  @param[in]  length the number of bits of the code, 0 to 32.
+    *
+    *  @return nothing.
+    */
+    void writeBits(const unsigned int value, const int length);
+
+    /** @brief pad the last byte and append all the pending bits to the vector.
+    *
+    *  @param[in]  fillOnes true to pad with 1 bits (JPEG), false to pad with 0 bits (DEFLATE).
+    *
+    *  @return nothing.
+    */
+    void flush(bool fillOnes);
+
+    /// number of bits written since setBuffer(), including padding.
+    unsigned long long getBitCount() const;
+
+  private:
+    void emitAccumulator();
+    void emitByte(const unsigned char byte);
+
+  private:
+    std::vector<unsigned char>  *p_buffer;  ///< Define the vector the bytes are appended to.
+    unsigned long long          m_acc;      ///< Define the accumulator, pending bits are the low m_bits bits.
+    int                         m_bits;     ///< Define the number of pending bits, 0 to 63.
+    unsigned long long          m_count;    ///< Define the number of bits already appended to the vector.
+    BIT_ORDER                   m_order;    ///< Define the bit order.
+    bool                        m_stuffing; ///< Define true if 0xFF bytes are followed by 0x00.
+};
+
+#endif  // end of BITWRITER_H
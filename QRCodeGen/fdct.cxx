@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <cmath>
+
+#include "fdct.h"
+#include "cpudispatch.h"
+
+#if defined(CPU_DISPATCH_X86)
+  #include <immintrin.h>
+#endif
+
+namespace JPEG
+{
+  /// zigzag position of every coefficient, same as in jpeginfo.h
+  static const unsigned char fdctZigzag[64] = {
+                                                0, 1, 5, 6,14,15,27,28,
+                                                2, 4, 7,13,16,26,29,42,
+                                                3, 8,12,17,25,30,41,43,
+                                                9,11,18,24,31,40,44,53,
+                                                10,19,23,32,39,45,52,54,
+                                                20,22,33,38,46,51,55,60,
+                                                21,34,37,47,50,56,59,61,
+                                                35,36,48,49,57,58,62,63
+                                              };
+
+  // scalefactor[0] = 1
+  // scalefactor[k] = cos(k*PI/16) * sqrt(2)    for k=1..7
+  static const double aanScaleFactor[8] = {
+                                            1.0, 1.387039845, 1.306562965, 1.175875602,
+                                            1.0, 0.785694958, 0.541196100, 0.275899379
+                                          };
+
+  // Fixed point constants of IJG's jfdctfst, scaled by 2^8 (CONST_BITS).
+  static const int FIX_0_382683433 = 98;
+  static const int FIX_0_541196100 = 139;
+  static const int FIX_0_707106781 = 181;
+  static const int FIX_1_306562965 = 334;
+  static const int CONST_BITS = 8;
+
+  // The 16 bit SIMD multiply keeps the high half of the product, so the
+  // sample is shifted left by 2 and the constant by 16 - 8 - 2 = 6. The result
+  // is the same as (x * c) >> 8 as long as |x| < 2^13, which holds for
+  // 8 bit samples.
+  static const int PRE_MULTIPLY_SCALE_BITS = 2;
+  static const int CONST_SHIFT = 16 - CONST_BITS - PRE_MULTIPLY_SCALE_BITS;
+
+  static void computeReciprocal(double divisor, FDCTDivisors &divisors, int i)
+  {
+    divisors.m_divisor[i] = (float)divisor;
+
+    if (divisor < 2.0)
+    {
+      divisors.m_reciprocal[i] = 1;
+      divisors.m_correction[i] = 0;
+      divisors.m_scale[i] = 1;
+      divisors.m_smallDivisor = true;
+      return;
+    }
+
+    /// 2^b <= divisor < 2^(b+1), so 2^(16+b) / divisor is a 16 bit reciprocal. The
+    /// divisor isn't rounded: with the AA&N factors of the high frequencies it is only a
+    /// few units, and rounding it would scale those coefficients by up to 20%.
+    int b = 0;
+    while ((double)(2u << b) <= divisor)
+      b++;
+
+    int r = 16 + b;
+    double fq = std::floor((std::ldexp(1.0, r) / divisor) + 0.5);
+
+    divisors.m_reciprocal[i] = (unsigned short)std::min(fq, 65535.0);
+    divisors.m_correction[i] = (unsigned short)std::floor((divisor / 2.0) + 0.5);
+    divisors.m_scale[i] = (unsigned short)(1UL << (32 - r));
+  }
+
+  void prepareFDCTDivisors(const unsigned char *qtable, FDCTDivisors &divisors)
+  {
+    int i = 0;
+
+    divisors.m_smallDivisor = false;
+
+    for (int row = 0; row < 8; row++)
+    {
+      for (int col = 0; col < 8; col++)
+      {
+        // The integer AA&N output is scaled like the float one, by
+        // scalefactor[row]*scalefactor[col]*8.
+        computeReciprocal((double)qtable[fdctZigzag[i]] * aanScaleFactor[row] * aanScaleFactor[col] * 8.0, divisors, i);
+        i++;
+      }
+    }
+  }
+
+  // For float AA&N IDCT method, divisors are equal to quantization
+  //   coefficients scaled by scalefactor[row]*scalefactor[col]*8.
+  //   What's actually stored is 1/divisor so that the inner loop can
+  //   use a multiplication rather than a division.
+  void prepareFDCTTable(const unsigned char *qtable, float *fdtbl)
+  {
+    int i = 0;
+
+    for (int row = 0; row < 8; row++)
+    {
+      for (int col = 0; col < 8; col++)
+      {
+        fdtbl[i] = (float) (1.0 / ((double) qtable[fdctZigzag[i]] *
+                            aanScaleFactor[row] * aanScaleFactor[col] * 8.0));
+        i++;
+      }
+    }
+  }
+
+  static inline short quantize(int x, const FDCTDivisors &divisors, int i)
+  {
+    unsigned int t = (unsigned int)((x < 0) ? -x : x);
+    unsigned int q;
+
+    if (divisors.m_smallDivisor)
+      q = (unsigned int)(((float)t / divisors.m_divisor[i]) + 0.5f);
+    else
+    {
+      q = ((t + divisors.m_correction[i]) * divisors.m_reciprocal[i]) >> 16;
+      q = (q * divisors.m_scale[i]) >> 16;
+    }
+
+    return((short)((x < 0) ? -(int)q : (int)q));
+  }
+
+#if defined(CPU_DISPATCH_X86)
+  CPU_TARGET_SSE2 static inline __m128i multiply(const __m128i &x, const int c)
+  {
+    return(_mm_mulhi_epi16(_mm_slli_epi16(x, PRE_MULTIPLY_SCALE_BITS),
+                           _mm_set1_epi16((short)(c << CONST_SHIFT))));
+  }
+
+  /// d[k] holds element k of 8 rows (or columns), the 1-D AA&N DCT is done on all of them.
+  CPU_TARGET_SSE2 static inline void butterfly(__m128i *d)
+  {
+    __m128i tmp0 = _mm_add_epi16(d[0], d[7]);
+    __m128i tmp7 = _mm_sub_epi16(d[0], d[7]);
+    __m128i tmp1 = _mm_add_epi16(d[1], d[6]);
+    __m128i tmp6 = _mm_sub_epi16(d[1], d[6]);
+    __m128i tmp2 = _mm_add_epi16(d[2], d[5]);
+    __m128i tmp5 = _mm_sub_epi16(d[2], d[5]);
+    __m128i tmp3 = _mm_add_epi16(d[3], d[4]);
+    __m128i tmp4 = _mm_sub_epi16(d[3], d[4]);
+
+    // Even part
+    __m128i tmp10 = _mm_add_epi16(tmp0, tmp3);
+    __m128i tmp13 = _mm_sub_epi16(tmp0, tmp3);
+    __m128i tmp11 = _mm_add_epi16(tmp1, tmp2);
+    __m128i tmp12 = _mm_sub_epi16(tmp1, tmp2);
+
+    d[0] = _mm_add_epi16(tmp10, tmp11);
+    d[4] = _mm_sub_epi16(tmp10, tmp11);
+
+    __m128i z1 = multiply(_mm_add_epi16(tmp12, tmp13), FIX_0_707106781);
+    d[2] = _mm_add_epi16(tmp13, z1);
+    d[6] = _mm_sub_epi16(tmp13, z1);
+
+    // Odd part
+    tmp10 = _mm_add_epi16(tmp4, tmp5);
+    tmp11 = _mm_add_epi16(tmp5, tmp6);
+    tmp12 = _mm_add_epi16(tmp6, tmp7);
+
+    __m128i z5 = multiply(_mm_sub_epi16(tmp10, tmp12), FIX_0_382683433);
+    __m128i z2 = _mm_add_epi16(multiply(tmp10, FIX_0_541196100), z5);
+    __m128i z4 = _mm_add_epi16(multiply(tmp12, FIX_1_306562965), z5);
+    __m128i z3 = multiply(tmp11, FIX_0_707106781);
+
+    __m128i z11 = _mm_add_epi16(tmp7, z3);
+    __m128i z13 = _mm_sub_epi16(tmp7, z3);
+
+    d[5] = _mm_add_epi16(z13, z2);
+    d[3] = _mm_sub_epi16(z13, z2);
+    d[1] = _mm_add_epi16(z11, z4);
+    d[7] = _mm_sub_epi16(z11, z4);
+  }
+
+  CPU_TARGET_SSE2 static inline void transpose(__m128i *r)
+  {
+    __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+    __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    r[0] = _mm_unpacklo_epi64(b0, b4);
+    r[1] = _mm_unpackhi_epi64(b0, b4);
+    r[2] = _mm_unpacklo_epi64(b1, b5);
+    r[3] = _mm_unpackhi_epi64(b1, b5);
+    r[4] = _mm_unpacklo_epi64(b2, b6);
+    r[5] = _mm_unpackhi_epi64(b2, b6);
+    r[6] = _mm_unpacklo_epi64(b3, b7);
+    r[7] = _mm_unpackhi_epi64(b3, b7);
+  }
+
+  /// quantize with the reciprocals, coef holds the 64 coefficients in natural order.
+  CPU_TARGET_SSE2 static inline void quantizeSSE2(const __m128i *coef, const FDCTDivisors &divisors, short *outdata)
+  {
+    for (int k = 0; k < 8; k++)
+    {
+      __m128i x = coef[k];
+      __m128i sign = _mm_srai_epi16(x, 15);
+      __m128i t = _mm_sub_epi16(_mm_xor_si128(x, sign), sign);
+
+      t = _mm_add_epi16(t, _mm_loadu_si128((const __m128i*)(divisors.m_correction + (8 * k))));
+      t = _mm_mulhi_epu16(t, _mm_loadu_si128((const __m128i*)(divisors.m_reciprocal + (8 * k))));
+      t = _mm_mulhi_epu16(t, _mm_loadu_si128((const __m128i*)(divisors.m_scale + (8 * k))));
+
+      _mm_storeu_si128((__m128i*)(outdata + (8 * k)), _mm_sub_epi16(_mm_xor_si128(t, sign), sign));
+    }
+  }
+
+  /// the same on two rows at once.
+  CPU_TARGET_AVX2 static inline void quantizeAVX2(const __m128i *coef, const FDCTDivisors &divisors, short *outdata)
+  {
+    for (int k = 0; k < 4; k++)
+    {
+      __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(coef[2 * k]), coef[(2 * k) + 1], 1);
+      __m256i t = _mm256_abs_epi16(x);
+
+      t = _mm256_add_epi16(t, _mm256_loadu_si256((const __m256i*)(divisors.m_correction + (16 * k))));
+      t = _mm256_mulhi_epu16(t, _mm256_loadu_si256((const __m256i*)(divisors.m_reciprocal + (16 * k))));
+      t = _mm256_mulhi_epu16(t, _mm256_loadu_si256((const __m256i*)(divisors.m_scale + (16 * k))));
+
+      _mm256_storeu_si256((__m256i*)(outdata + (16 * k)), _mm256_sign_epi16(t, x));
+    }
+  }
+
+  /// both passes of the AA&N DCT, d[k] holds row k of the coefficients.
+  CPU_TARGET_SSE2 static inline void transform(const signed char *data, __m128i *d)
+  {
+    /// load rows, sign extend samples to 16 bit
+    for (int row = 0; row < 8; row++)
+    {
+      __m128i s = _mm_loadl_epi64((const __m128i*)(data + (8 * row)));
+      d[row] = _mm_srai_epi16(_mm_unpacklo_epi8(s, s), 8);
+    }
+
+    // Pass 1: process rows, d[k] holds column k of every row.
+    transpose(d);
+    butterfly(d);
+
+    // Pass 2: process columns, d[k] holds row k of every column.
+    transpose(d);
+    butterfly(d);
+  }
+
+  /// divisors below 2 have no 16 bit reciprocal, quantize by division.
+  CPU_TARGET_SSE2 static inline void quantizeByDivision(const __m128i *d, const FDCTDivisors &divisors, short *outdata)
+  {
+    short coef[64];
+
+    for (int k = 0; k < 8; k++)
+      _mm_storeu_si128((__m128i*)(coef + (8 * k)), d[k]);
+
+    for (int i = 0; i < 64; i++)
+      outdata[i] = quantize(coef[i], divisors, i);
+  }
+
+  CPU_TARGET_SSE2 static void integerFDCTSSE2(const signed char *data, const FDCTDivisors &divisors, short *outdata)
+  {
+    __m128i d[8];
+
+    transform(data, d);
+
+    if (divisors.m_smallDivisor)
+      quantizeByDivision(d, divisors, outdata);
+    else
+      quantizeSSE2(d, divisors, outdata);
+  }
+
+  CPU_TARGET_AVX2 static void integerFDCTAVX2(const signed char *data, const FDCTDivisors &divisors, short *outdata)
+  {
+    __m128i d[8];
+
+    transform(data, d);
+
+    if (divisors.m_smallDivisor)
+      quantizeByDivision(d, divisors, outdata);
+    else
+      quantizeAVX2(d, divisors, outdata);
+  }
+#endif
+
+  static inline int multiply(const int x, const int c)
+  {
+    return((x * c) >> CONST_BITS);
+  }
+
+  static void integerFDCTScalar(const signed char *data, const FDCTDivisors &divisors, short *outdata)
+  {
+    int tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+    int tmp10, tmp11, tmp12, tmp13;
+    int z1, z2, z3, z4, z5, z11, z13;
+    int workspace[64];
+    int *dataptr;
+    int i;
+
+    for (i = 0; i < 64; i++)
+      workspace[i] = data[i];
+
+    // Pass 1: process rows.
+    dataptr = workspace;
+    for (i = 0; i < 8; i++)
+    {
+      tmp0 = dataptr[0] + dataptr[7];
+      tmp7 = dataptr[0] - dataptr[7];
+      tmp1 = dataptr[1] + dataptr[6];
+      tmp6 = dataptr[1] - dataptr[6];
+      tmp2 = dataptr[2] + dataptr[5];
+      tmp5 = dataptr[2] - dataptr[5];
+      tmp3 = dataptr[3] + dataptr[4];
+      tmp4 = dataptr[3] - dataptr[4];
+
+      // Even part
+      tmp10 = tmp0 + tmp3;
+      tmp13 = tmp0 - tmp3;
+      tmp11 = tmp1 + tmp2;
+      tmp12 = tmp1 - tmp2;
+
+      dataptr[0] = tmp10 + tmp11;
+      dataptr[4] = tmp10 - tmp11;
+
+      z1 = multiply(tmp12 + tmp13, FIX_0_707106781);
+      dataptr[2] = tmp13 + z1;
+      dataptr[6] = tmp13 - z1;
+
+      // Odd part
+      tmp10 = tmp4 + tmp5;
+      tmp11 = tmp5 + tmp6;
+      tmp12 = tmp6 + tmp7;
+
+      z5 = multiply(tmp10 - tmp12, FIX_0_382683433);
+      z2 = multiply(tmp10, FIX_0_541196100) + z5;
+      z4 = multiply(tmp12, FIX_1_306562965) + z5;
+      z3 = multiply(tmp11, FIX_0_707106781);
+
+      z11 = tmp7 + z3;
+      z13 = tmp7 - z3;
+
+      dataptr[5] = z13 + z2;
+      dataptr[3] = z13 - z2;
+      dataptr[1] = z11 + z4;
+      dataptr[7] = z11 - z4;
+
+      dataptr += 8;
+    }
+
+    // Pass 2: process columns.
+    dataptr = workspace;
+    for (i = 0; i < 8; i++)
+    {
+      tmp0 = dataptr[0] + dataptr[56];
+      tmp7 = dataptr[0] - dataptr[56];
+      tmp1 = dataptr[8] + dataptr[48];
+      tmp6 = dataptr[8] - dataptr[48];
+      tmp2 = dataptr[16] + dataptr[40];
+      tmp5 = dataptr[16] - dataptr[40];
+      tmp3 = dataptr[24] + dataptr[32];
+      tmp4 = dataptr[24] - dataptr[32];
+
+      // Even part
+      tmp10 = tmp0 + tmp3;
+      tmp13 = tmp0 - tmp3;
+      tmp11 = tmp1 + tmp2;
+      tmp12 = tmp1 - tmp2;
+
+      dataptr[0] = tmp10 + tmp11;
+      dataptr[32] = tmp10 - tmp11;
+
+      z1 = multiply(tmp12 + tmp13, FIX_0_707106781);
+      dataptr[16] = tmp13 + z1;
+      dataptr[48] = tmp13 - z1;
+
+      // Odd part
+      tmp10 = tmp4 + tmp5;
+      tmp11 = tmp5 + tmp6;
+      tmp12 = tmp6 + tmp7;
+
+      z5 = multiply(tmp10 - tmp12, FIX_0_382683433);
+      z2 = multiply(tmp10, FIX_0_541196100) + z5;
+      z4 = multiply(tmp12, FIX_1_306562965) + z5;
+      z3 = multiply(tmp11, FIX_0_707106781);
+
+      z11 = tmp7 + z3;
+      z13 = tmp7 - z3;
+
+      dataptr[40] = z13 + z2;
+      dataptr[24] = z13 - z2;
+      dataptr[8] = z11 + z4;
+      dataptr[56] = z11 - z4;
+
+      dataptr++;
+    }
+
+    for (i = 0; i < 64; i++)
+      outdata[i] = quantize(workspace[i], divisors, i);
+  }
+
+  typedef void (*IntegerFDCT)(const signed char *data, const FDCTDivisors &divisors, short *outdata);
+
+  static IntegerFDCT bindIntegerFDCT()
+  {
+    CpuFunction variants[CPU_LEVEL_COUNT] = {(CpuFunction)integerFDCTScalar};
+#if defined(CPU_DISPATCH_X86)
+    variants[CPU_SSE2] = (CpuFunction)integerFDCTSSE2;
+    variants[CPU_AVX2] = (CpuFunction)integerFDCTAVX2;
+#endif
+
+    return((IntegerFDCT)CpuDispatch_bind(CPU_KERNEL_FDCT, variants));
+  }
+
+  /// bound at startup, before any thread can encode.
+  static const IntegerFDCT integerFDCT = bindIntegerFDCT();
+
+  void integerFDCTAndQuantization(const signed char *data, const FDCTDivisors &divisors, short *outdata)
+  {
+    integerFDCT(data, divisors, outdata);
+  }
+
+  // Using a bit modified form of the FDCT routine from IJG's C source:
+  // Forward DCT routine idea taken from Independent JPEG Group's C source for
+  // JPEG encoders/decoders
+  void floatFDCTAndQuantization(const signed char *data, const float *fdtbl, short *outdata)
+  {
+    float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+    float tmp10, tmp11, tmp12, tmp13;
+    float z1, z2, z3, z4, z5, z11, z13;
+    float *dataptr;
+    float datafloat[64];
+    float temp;
+    int ctr;
+    int i;
+
+    for (i=0; i<64; i++)
+      datafloat[i]=data[i];
+
+    // Pass 1: process rows.
+    dataptr = datafloat;
+    for (ctr = 7; ctr >= 0; ctr--)
+    {
+      tmp0 = dataptr[0] + dataptr[7];
+      tmp7 = dataptr[0] - dataptr[7];
+      tmp1 = dataptr[1] + dataptr[6];
+      tmp6 = dataptr[1] - dataptr[6];
+      tmp2 = dataptr[2] + dataptr[5];
+      tmp5 = dataptr[2] - dataptr[5];
+      tmp3 = dataptr[3] + dataptr[4];
+      tmp4 = dataptr[3] - dataptr[4];
+
+      // Even part
+      tmp10 = tmp0 + tmp3;	// phase 2
+      tmp13 = tmp0 - tmp3;
+      tmp11 = tmp1 + tmp2;
+      tmp12 = tmp1 - tmp2;
+
+      dataptr[0] = tmp10 + tmp11; // phase 3
+      dataptr[4] = tmp10 - tmp11;
+
+      z1 = (tmp12 + tmp13) * ((float) 0.707106781); // c4
+      dataptr[2] = tmp13 + z1;	// phase 5
+      dataptr[6] = tmp13 - z1;
+
+      // Odd part
+      tmp10 = tmp4 + tmp5;	// phase 2
+      tmp11 = tmp5 + tmp6;
+      tmp12 = tmp6 + tmp7;
+
+      // The rotator is modified from fig 4-8 to avoid extra negations
+      z5 = (tmp10 - tmp12) * ((float) 0.382683433); // c6
+      z2 = ((float) 0.541196100) * tmp10 + z5; // c2-c6
+      z4 = ((float) 1.306562965) * tmp12 + z5; // c2+c6
+      z3 = tmp11 * ((float) 0.707106781); // c4
+
+      z11 = tmp7 + z3;		// phase 5
+      z13 = tmp7 - z3;
+
+      dataptr[5] = z13 + z2;	// phase 6
+      dataptr[3] = z13 - z2;
+      dataptr[1] = z11 + z4;
+      dataptr[7] = z11 - z4;
+
+      dataptr += 8;		//advance pointer to next row
+    }
+
+    // Pass 2: process columns
+    dataptr = datafloat;
+    for (ctr = 7; ctr >= 0; ctr--)
+    {
+      tmp0 = dataptr[0] + dataptr[56];
+      tmp7 = dataptr[0] - dataptr[56];
+      tmp1 = dataptr[8] + dataptr[48];
+      tmp6 = dataptr[8] - dataptr[48];
+      tmp2 = dataptr[16] + dataptr[40];
+      tmp5 = dataptr[16] - dataptr[40];
+      tmp3 = dataptr[24] + dataptr[32];
+      tmp4 = dataptr[24] - dataptr[32];
+
+      //Even part
+      tmp10 = tmp0 + tmp3;	//phase 2
+      tmp13 = tmp0 - tmp3;
+      tmp11 = tmp1 + tmp2;
+      tmp12 = tmp1 - tmp2;
+
+      dataptr[0] = tmp10 + tmp11; // phase 3
+      dataptr[32] = tmp10 - tmp11;
+
+      z1 = (tmp12 + tmp13) * ((float) 0.707106781); // c4
+      dataptr[16] = tmp13 + z1; // phase 5
+      dataptr[48] = tmp13 - z1;
+
+      // Odd part
+      tmp10 = tmp4 + tmp5;	// phase 2
+      tmp11 = tmp5 + tmp6;
+      tmp12 = tmp6 + tmp7;
+
+      // The rotator is modified from fig 4-8 to avoid extra negations.
+      z5 = (tmp10 - tmp12) * ((float) 0.382683433); // c6
+      z2 = ((float) 0.541196100) * tmp10 + z5; // c2-c6
+      z4 = ((float) 1.306562965) * tmp12 + z5; // c2+c6
+      z3 = tmp11 * ((float) 0.707106781); // c4
+
+      z11 = tmp7 + z3;		// phase 5
+      z13 = tmp7 - z3;
+
+      dataptr[40] = z13 + z2; // phase 6
+      dataptr[24] = z13 - z2;
+      dataptr[8] = z11 + z4;
+      dataptr[56] = z11 - z4;
+
+      dataptr++;			// advance pointer to next column
+    }
+
+    // Quantize/descale the coefficients, and store into output array
+    for (i = 0; i < 64; i++)
+    {
+      // Apply the quantization and scaling factor
+      temp = datafloat[i] * fdtbl[i];
+
+      //Round to nearest integer.
+      //Since C does not specify the direction of rounding for negative
+      //quotients, we have to force the dividend positive for portability.
+      outdata[i] = (short) ((short)(temp + 16384.5) - 16384);
+    }
+  }
+
+  const char* getFDCTImplementation()
+  {
+    return(CpuDispatch_getLevelName((CpuLevel)CpuDispatch_getSelected(CPU_KERNEL_FDCT)));
+  }
+}
@@ -0,0 +1,90 @@
+/**
+*  @file    fdct.h
+*  @brief   forward DCT and quantization of 8x8 data units.
+*
+*  Both JPEG encoders (Jpeg class and savejpg) use these routines.
+*  The integer one is the fixed point AA&N algorithm (IJG's jfdctfst)
+*  with the quantization done as a multiplication by the reciprocal
+*  of the divisor. On SSE2 (or AVX2) CPUs, chosen at runtime by
+*  cpudispatch, the row and column passes work on all the 8
+*  rows/columns of the data unit at once; the scalar code gives the
+*  very same coefficients.
+*  The float one is the original AA&N implementation, kept as the
+*  reference for the precision check.
+*
+*  Only built-in types are used here, savejpg.h defines BYTE/WORD
+*  as macros.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#ifndef FDCT_H
+#define FDCT_H
+
+namespace JPEG
+{
+  //!  @struct  FDCTDivisors
+  /*!
+    Quantization divisors of the integer FDCT, in natural (not zigzag) order.
+    round(x / divisor) is computed as ((|x| + correction) * reciprocal >> 16) * scale >> 16.
+    The divisors aren't whole numbers, so this rounds x / divisor to nearest within half
+    a unit of x (the correction is divisor / 2 rounded) and a relative error of 2^-16.
+  */
+  struct FDCTDivisors
+  {
+    float           m_divisor[64];      ///< Define quantization step times the AA&N scale factors.
+    unsigned short  m_reciprocal[64];   ///< Define 2^(16 + floor(log2(divisor))) / divisor, rounded.
+    unsigned short  m_correction[64];   ///< Define rounding term added before the multiplication.
+    unsigned short  m_scale[64];        ///< Define 2^(16 - floor(log2(divisor))), undoes the extra precision of m_reciprocal.
+    bool            m_smallDivisor;     ///< Define true if any divisor is below 2, their reciprocal doesn't fit
+                                        //   in 16 bit, so the table is quantized by division.
+  };
+
+  /** @brief prepare the integer FDCT divisors from a quantization table.
+  *
+  *  @param[in]  qtable the quantization table, in zigzag order (as written in the DQT marker).
+  *  @param[out] divisors the divisors for integerFDCTAndQuantization().
+  *
+  *  @return nothing.
+  */
+  void prepareFDCTDivisors(const unsigned char *qtable, FDCTDivisors &divisors);
+
+  /** @brief prepare the float FDCT table from a quantization table.
+  *
+  *  @param[in]  qtable the quantization table, in zigzag order (as written in the DQT marker).
+  *  @param[out] fdtbl the 64 reciprocal divisors for floatFDCTAndQuantization().
+  *
+  *  @return nothing.
+  */
+  void prepareFDCTTable(const unsigned char *qtable, float *fdtbl);
+
+  /** @brief fixed point FDCT and quantization of a data unit.
+  *
+  *  @param[in]  data the 64 level shifted samples (-128..127).
+  *  @param[in]  divisors the quantization divisors.
+  *  @param[out] outdata the 64 quantized coefficients, in natural order.
+  *
+  *  @return nothing.
+  */
+  void integerFDCTAndQuantization(const signed char *data, const FDCTDivisors &divisors, short *outdata);
+
+  /** @brief floating point FDCT and quantization of a data unit.
+  *
+  *  @param[in]  data the 64 level shifted samples (-128..127).
+  *  @param[in]  fdtbl the reciprocal divisors.
+  *  @param[out] outdata the 64 quantized coefficients, in natural order.
+  *
+  *  @return nothing.
+  */
+  void floatFDCTAndQuantization(const signed char *data, const float *fdtbl, short *outdata);
+
+  /** @brief name of the instruction set used by integerFDCTAndQuantization().
+  *
+  *  @return const char* "avx2", "sse2" or "scalar".
+  */
+  const char* getFDCTImplementation();
+}
+
+#endif  // end of FDCT_H
@@ -8,9 +8,11 @@ Jpeg::Jpeg()
   m_dqt(),
   m_dht(),
   m_sos0(),
-  m_bytenew(0),
-  m_bytepos(7),
-  p_file(NULL),
+  m_mode(EM_COLOR),
+  m_dctMethod(DCT_INTEGER),
+  m_duCache(),
+  m_bitWriter(),
+  p_buffer(NULL),
   p_rgb(NULL),
   p_categoryAlloc(NULL),
   p_category(NULL),
@@ -25,9 +27,11 @@ Jpeg::Jpeg(const WORD height, const WORD width)
   m_dqt(),
   m_dht(),
   m_sos0(),
-  m_bytenew(0),
-  m_bytepos(7),
-  p_file(NULL),
+  m_mode(EM_COLOR),
+  m_dctMethod(DCT_INTEGER),
+  m_duCache(),
+  m_bitWriter(),
+  p_buffer(NULL),
   p_rgb(NULL),
   p_categoryAlloc(NULL),
   p_category(NULL),
@@ -44,9 +48,11 @@ Jpeg::Jpeg(const Jpeg &other)
   m_dqt(other.m_dqt),
   m_dht(other.m_dht),
   m_sos0(other.m_sos0),
-  m_bytenew(other.m_bytenew),
-  m_bytepos(other.m_bytepos),
-  p_file(other.p_file),
+  m_mode(other.m_mode),
+  m_dctMethod(other.m_dctMethod),
+  m_duCache(other.m_duCache),
+  m_bitWriter(),
+  p_buffer(NULL),
   p_rgb(other.p_rgb),
   p_categoryAlloc(other.p_categoryAlloc),
   p_category(other.p_category),
@@ -57,12 +63,9 @@ Jpeg::Jpeg(const Jpeg &other)
 
 Jpeg::~Jpeg()
 {
-  if(p_file != NULL)
-    fclose(p_file);
-
   if(p_rgb != NULL)
   {
-    delete(p_rgb);
+    delete[] p_rgb;
     p_rgb = NULL;
   }
 
@@ -80,11 +83,12 @@ Jpeg& Jpeg::operator=(const Jpeg &other)
   {
     m_app0 = other.m_app0;
     m_sof0 = other.m_sof0;
-    m_bytenew = other.m_bytenew;
-    m_bytepos = m_bytepos;
     m_dqt = other.m_dqt;
     m_dht = other.m_dht;
     m_sos0 = other.m_sos0;
+    m_mode = other.m_mode;
+    m_dctMethod = other.m_dctMethod;
+    m_duCache = other.m_duCache;
   }
 
   return(*this);
@@ -100,63 +104,113 @@ void Jpeg::setWidth(const WORD width)
   m_sof0.m_width = width;
 }
 
+void Jpeg::setEncodeMode(const ENCODE_MODE &mode)
+{
+  m_mode = mode;
+  m_duCache.clear();
+
+  if(m_mode == EM_BILEVEL)
+  {
+    /// Only Y component, with the luminance quantization and huffman tables
+    m_sof0.m_components = 1;
+    m_sof0.m_len = 8 + 3 * 1;
+    m_sos0.m_components = 1;
+    m_sos0.m_len = 6 + 2 * 1;
+    m_dqt.m_len = 2 + 65 * 1;
+    m_dht.m_len = 2 + (17 + 12) + (17 + 162);
+  }
+  else
+  {
+    m_sof0.m_components = 3;
+    m_sof0.m_len = 8 + 3 * 3;
+    m_sos0.m_components = 3;
+    m_sos0.m_len = 6 + 2 * 3;
+    m_dqt.m_len = 2 + 65 * 2;
+    m_dht.m_len = 2 + (17 + 12) * 2 + (17 + 162) * 2;
+  }
+}
+
+void Jpeg::setDCTMethod(const DCT_METHOD &method)
+{
+  m_dctMethod = method;
+  m_duCache.clear();
+}
+
 void Jpeg::setJPEGPixel(int row, int col, int red, int green, int blue)
 {
-  if((m_sof0.m_height > 0) && (m_sof0.m_width > 0))
+  if((row >= 0) && (row < m_sof0.m_height) && (col >= 0) && (col < m_sof0.m_width))
   {
+    /// pixel buffer is padded to whole data units, padding stays white.
     if(p_rgb == NULL)
-      p_rgb = new RGB[3 * m_sof0.m_height * m_sof0.m_width];
+      p_rgb = new RGB[getPaddedHeight() * getPaddedWidth()];
 
-    int i = row * m_sof0.m_height + col;
+    int i = row * getPaddedWidth() + col;
     p_rgb[i].red = (BYTE)red;
     p_rgb[i].green = (BYTE)green;
     p_rgb[i].blue = (BYTE)blue;
   }
 }
 
-void Jpeg::writeToFile(const char *filename)
+void Jpeg::writeToBuffer(std::vector<BYTE> &buffer)
 {
-  bitstring fillbits; //filling bitstring for the bit alignment of the EOI marker
-
   if((m_sof0.m_height > 0) && (m_sof0.m_width > 0))
   {
-    fopen_s(&p_file, filename,"wb");
-    if(p_file != NULL)
-    {
+    /// untouched image is white.
+    if(p_rgb == NULL)
+      p_rgb = new RGB[getPaddedHeight() * getPaddedWidth()];
 
-      initComponents();
+    p_buffer = &buffer;
 
-      /// 
-      writeword(0xFFD8); //SOI
-      
-      /// write markers
-      writeAPP();
-      writeDQT();
-      writeSOF();
-      writeDHT();
-      writeSOS();
+    initComponents();
 
-      m_bytenew=0;
-      m_bytepos=7;
+    /// 
+    writeword(0xFFD8); //SOI
 
-      /// encode all image pixels
-      encodePixels();
+    /// write markers
+    writeAPP();
+    writeDQT();
+    writeSOF();
+    writeDHT();
+    writeSOS();
 
-      //Do the bit alignment of the EOI marker
-      if (m_bytepos>=0) 
-      {
-        fillbits.length = m_bytepos+1;
-        fillbits.value=(1<<(m_bytepos+1))-1;
-        writeBits(fillbits);
-      }
+    m_bitWriter.setBuffer(p_buffer, BitWriter::BO_MSB_FIRST, true);
 
-      writeword(0xFFD9); //EOI
+    /// encode all image pixels
+    encodePixels();
 
-      fclose(p_file);
-    }
+    //Do the bit alignment of the EOI marker
+    m_bitWriter.flush(true);
+    m_bitWriter.setBuffer(NULL, BitWriter::BO_MSB_FIRST, true);
+
+    writeword(0xFFD9); //EOI
+
+    p_buffer = NULL;
   }
 }
 
+void Jpeg::writeToFile(const char *filename)
+{
+  std::vector<BYTE> buffer;
+  writeToBuffer(buffer);
+
+  if(buffer.size() > 0)
+  {
+    std::ofstream fs(filename, std::ios::out | std::ios::binary);
+    if(fs.is_open())
+      fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+  }
+}
+
+WORD Jpeg::getPaddedWidth() const
+{
+  return((m_sof0.m_width + 7) & ~7);
+}
+
+WORD Jpeg::getPaddedHeight() const
+{
+  return((m_sof0.m_height + 7) & ~7);
+}
+
 void Jpeg::initComponents()
 {
   initHoffmanTable();
@@ -177,6 +231,10 @@ void Jpeg::initCategoryAndBit()
   SDWORD nrlower,nrupper;
   BYTE cat;
 
+  /// tables don't depend on the image, build them only once.
+  if (p_categoryAlloc != NULL)
+    return;
+
   p_categoryAlloc = (BYTE *)malloc(65535 * sizeof(BYTE));
   if (p_categoryAlloc != NULL)
   {
@@ -225,9 +283,14 @@ void Jpeg::encodePixels()
     {
       loadDUFromRGBPixels(xpos,ypos);
 
-      writeDU(m_Y, m_dqt.m_fdctTableY, &DCY, m_htY);
-      writeDU(m_Cb, m_dqt.m_fdctTableCb, &DCCb, m_htCb);
-      writeDU(m_Cr, m_dqt.m_fdctTableCb, &DCCr, m_htCb);
+      if(m_mode == EM_BILEVEL)
+        writeBilevelDU(m_Y, m_dqt.m_infoY, &DCY, m_htY);
+      else
+      {
+        writeDU(m_Y, m_dqt.m_infoY, &DCY, m_htY);
+        writeDU(m_Cb, m_dqt.m_infoCb, &DCCb, m_htCb);
+        writeDU(m_Cr, m_dqt.m_infoCb, &DCCr, m_htCb);
+      }
     }
 }
 
@@ -238,7 +301,7 @@ void Jpeg::loadDUFromRGBPixels(const WORD xpos, const WORD ypos)
   DWORD location;
   BYTE R,G,B;
 
-  location = ypos * m_sof0.m_width + xpos;
+  location = ypos * getPaddedWidth() + xpos;
   for (y=0;y<8;y++)
   {
     for (x=0;x<8;x++)
@@ -248,40 +311,107 @@ void Jpeg::loadDUFromRGBPixels(const WORD xpos, const WORD ypos)
       B = p_rgb[location].blue;
 
       m_Y[pos]  = m_ycbcr.Y(R,G,B);
-      m_Cb[pos] = m_ycbcr.Cb(R,G,B);
-      m_Cr[pos] = m_ycbcr.Cr(R,G,B);
+      if(m_mode != EM_BILEVEL)
+      {
+        m_Cb[pos] = m_ycbcr.Cb(R,G,B);
+        m_Cr[pos] = m_ycbcr.Cr(R,G,B);
+      }
 
       location++;
       pos++;
     }
 
-    location += m_sof0.m_width - 8;
+    location += getPaddedWidth() - 8;
   }
 }
 
-void Jpeg::writeDU(const SBYTE *ComponentDU, const float *fdtbl, SWORD *DC, const HT &ht)
+void Jpeg::writeDU(const SBYTE *ComponentDU, const BYTE qt, SWORD *DC, const HT &ht)
 {
-  BYTE i;
-  BYTE startpos;
-  BYTE end0pos;
-  BYTE nrzeroes;
-  BYTE nrmarker;
-
-  SWORD DU_DCT[64];   // Current DU (after DCT and quantization) which we'll zigzag
   SWORD DU[64];       //zigzag reordered DU which will be Huffman coded
-  SWORD Diff;
 
-  bitstring EOB = ht.m_ac[0x00];
-  bitstring M16zeroes = ht.m_ac[0xF0];
+  quantizeDU(ComponentDU, qt, DU);
 
-  calculateFDCTAndQuantization(ComponentDU, fdtbl, DU_DCT);
+  writeDC(DU[0], DC, ht);
+  writeAC(DU, ht, NULL);
+}
+
+void Jpeg::writeBilevelDU(const SBYTE *ComponentDU, const BYTE qt, SWORD *DC, const HT &ht)
+{
+  SBYTE low = ComponentDU[0];
+  SBYTE high = ComponentDU[0];
+  unsigned long long mask = 0;
+
+  /// find the (at most) two levels of this data unit
+  for (int i = 1; i < 64; i++)
+  {
+    SBYTE v = ComponentDU[i];
+    if ((v == low) || (v == high))
+      continue;
+
+    if (low == high)
+    {
+      if (v < low)
+        low = v;
+      else
+        high = v;
+    }
+    else
+    {
+      /// more than two levels, no point caching it
+      writeDU(ComponentDU, qt, DC, ht);
+      return;
+    }
+  }
+
+  /// uniform data unit has an empty mask
+  if (low != high)
+  {
+    for (int i = 0; i < 64; i++)
+    {
+      if (ComponentDU[i] == high)
+        mask |= (1ULL << i);
+    }
+  }
+
+  std::pair<unsigned long long, WORD> key(mask, (WORD)(((BYTE)low << 8) | (BYTE)high));
+  std::map<std::pair<unsigned long long, WORD>, EncodedDU>::iterator it = m_duCache.find(key);
+
+  if (it == m_duCache.end())
+  {
+    SWORD DU[64];
+    EncodedDU encoded;
+
+    quantizeDU(ComponentDU, qt, DU);
+    encoded.m_dc = DU[0];
+    writeAC(DU, ht, &encoded.m_ac);
+
+    it = m_duCache.insert(std::make_pair(key, encoded)).first;
+  }
+
+  writeDC(it->second.m_dc, DC, ht);
+
+  const std::vector<bitstring> &ac = it->second.m_ac;
+  for (size_t i = 0; i < ac.size(); i++)
+    writeBits(ac[i]);
+}
+
+void Jpeg::quantizeDU(const SBYTE *ComponentDU, const BYTE qt, SWORD *DU)
+{
+  SWORD DU_DCT[64];   // Current DU (after DCT and quantization) which we'll zigzag
+
+  calculateFDCTAndQuantization(ComponentDU, qt, DU_DCT);
 
   //zigzag reorder
-  for (i=0;i<=63;i++)
+  for (BYTE i=0;i<=63;i++)
     DU[zigzag[i]] = DU_DCT[i];
+}
+
+void Jpeg::writeDC(const SWORD dc, SWORD *DC, const HT &ht)
+{
+  SWORD Diff;
 
-  Diff=DU[0]-*DC;
-  *DC=DU[0];
+  Diff=dc-*DC;
+  *DC=dc;
 
   //Encode DC
   if(Diff==0)
@@ -291,17 +421,25 @@ void Jpeg::writeDU(const SBYTE *ComponentDU, const float *fdtbl, SWORD *DC, cons
     writeBits(ht.m_dc[p_category[Diff]]);
     writeBits(p_bit[Diff]);
   }
+}
+
+void Jpeg::writeAC(const SWORD *DU, const HT &ht, std::vector<bitstring> *record)
+{
+  BYTE i;
+  BYTE startpos;
+  BYTE end0pos;
+  BYTE nrzeroes;
+  BYTE nrmarker;
+
+  bitstring EOB = ht.m_ac[0x00];
+  bitstring M16zeroes = ht.m_ac[0xF0];
+  bitstring codes[(63 * 2) + 1];
+  int count = 0;
 
   //Encode ACs
   for (end0pos=63; (end0pos>0)&&(DU[end0pos]==0); end0pos--) ;
 
   //end0pos = first element in reverse order !=0
-  if (end0pos==0)
-  {
-    writeBits(EOB);
-    return;
-  }
-
   i=1;
   while (i<=end0pos)
   {
@@ -312,155 +450,42 @@ void Jpeg::writeDU(const SBYTE *ComponentDU, const float *fdtbl, SWORD *DC, cons
     if (nrzeroes>=16) 
     {
       for (nrmarker=1;nrmarker<=nrzeroes/16;nrmarker++)
-        writeBits(M16zeroes);
+        codes[count++] = M16zeroes;
 
       nrzeroes=nrzeroes%16;
     }
 
-    writeBits(ht.m_ac[nrzeroes*16 + p_category[DU[i]]]);
-    writeBits(p_bit[DU[i]]);
+    codes[count++] = ht.m_ac[nrzeroes*16 + p_category[DU[i]]];
+    codes[count++] = p_bit[DU[i]];
 
     i++;
   }
 
-  if (end0pos!=63) writeBits(EOB);
-}
+  if (end0pos!=63)
+    codes[count++] = EOB;
 
-void Jpeg::calculateFDCTAndQuantization(const SBYTE *data, const float *fdtbl, SWORD *outdata)
-{
-  float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
-  float tmp10, tmp11, tmp12, tmp13;
-  float z1, z2, z3, z4, z5, z11, z13;
-  float *dataptr;
-  float datafloat[64];
-  float temp;
-  SBYTE ctr;
-  BYTE i;
-
-  for (i=0; i<64; i++)
-    datafloat[i]=data[i];
-
-  // Pass 1: process rows.
-  dataptr = datafloat;
-  for (ctr = 7; ctr >= 0; ctr--) 
-  {
-    tmp0 = dataptr[0] + dataptr[7];
-    tmp7 = dataptr[0] - dataptr[7];
-    tmp1 = dataptr[1] + dataptr[6];
-    tmp6 = dataptr[1] - dataptr[6];
-    tmp2 = dataptr[2] + dataptr[5];
-    tmp5 = dataptr[2] - dataptr[5];
-    tmp3 = dataptr[3] + dataptr[4];
-    tmp4 = dataptr[3] - dataptr[4];
-
-    // Even part
-    tmp10 = tmp0 + tmp3;	// phase 2
-    tmp13 = tmp0 - tmp3;
-    tmp11 = tmp1 + tmp2;
-    tmp12 = tmp1 - tmp2;
-
-    dataptr[0] = tmp10 + tmp11; // phase 3
-    dataptr[4] = tmp10 - tmp11;
-
-    z1 = (tmp12 + tmp13) * ((float) 0.707106781); // c4
-    dataptr[2] = tmp13 + z1;	// phase 5
-    dataptr[6] = tmp13 - z1;
-
-
-    // Odd part
-    tmp10 = tmp4 + tmp5;	// phase 2
-    tmp11 = tmp5 + tmp6;
-    tmp12 = tmp6 + tmp7;
-
-    // The rotator is modified from fig 4-8 to avoid extra negations
-    z5 = (tmp10 - tmp12) * ((float) 0.382683433); // c6
-    z2 = ((float) 0.541196100) * tmp10 + z5; // c2-c6
-    z4 = ((float) 1.306562965) * tmp12 + z5; // c2+c6
-    z3 = tmp11 * ((float) 0.707106781); // c4
-
-    z11 = tmp7 + z3;		// phase 5
-    z13 = tmp7 - z3;
-
-    dataptr[5] = z13 + z2;	// phase 6
-    dataptr[3] = z13 - z2;
-    dataptr[1] = z11 + z4;
-    dataptr[7] = z11 - z4;
-
-    dataptr += 8;		//advance pointer to next row
-  }
-
-  // Pass 2: process columns
-
-  dataptr = datafloat;
-  for (ctr = 7; ctr >= 0; ctr--) 
+  if (record != NULL)
+    record->insert(record->end(), codes, codes + count);
+  else
   {
-    tmp0 = dataptr[0] + dataptr[56];
-    tmp7 = dataptr[0] - dataptr[56];
-    tmp1 = dataptr[8] + dataptr[48];
-    tmp6 = dataptr[8] - dataptr[48];
-    tmp2 = dataptr[16] + dataptr[40];
-    tmp5 = dataptr[16] - dataptr[40];
-    tmp3 = dataptr[24] + dataptr[32];
-    tmp4 = dataptr[24] - dataptr[32];
-
-    //Even part/
-
-    tmp10 = tmp0 + tmp3;	//phase 2
-    tmp13 = tmp0 - tmp3;
-    tmp11 = tmp1 + tmp2;
-    tmp12 = tmp1 - tmp2;
-
-    dataptr[0] = tmp10 + tmp11; // phase 3
-    dataptr[32] = tmp10 - tmp11;
-
-    z1 = (tmp12 + tmp13) * ((float) 0.707106781); // c4
-    dataptr[16] = tmp13 + z1; // phase 5
-    dataptr[48] = tmp13 - z1;
-
-    // Odd part
-
-    tmp10 = tmp4 + tmp5;	// phase 2
-    tmp11 = tmp5 + tmp6;
-    tmp12 = tmp6 + tmp7;
-
-    // The rotator is modified from fig 4-8 to avoid extra negations.
-    z5 = (tmp10 - tmp12) * ((float) 0.382683433); // c6
-    z2 = ((float) 0.541196100) * tmp10 + z5; // c2-c6
-    z4 = ((float) 1.306562965) * tmp12 + z5; // c2+c6
-    z3 = tmp11 * ((float) 0.707106781); // c4
-
-    z11 = tmp7 + z3;		// phase 5
-    z13 = tmp7 - z3;
-
-    dataptr[40] = z13 + z2; // phase 6
-    dataptr[24] = z13 - z2;
-    dataptr[8] = z11 + z4;
-    dataptr[56] = z11 - z4;
-
-    dataptr++;			// advance pointer to next column
+    for (int k = 0; k < count; k++)
+      writeBits(codes[k]);
   }
+}
 
-  // Quantize/descale the coefficients, and store into output array
-  for (i = 0; i < 64; i++) 
-  {
-    // Apply the quantization and scaling factor
-    temp = datafloat[i] * fdtbl[i];
-
-    //Round to nearest integer.
-    //Since C does not specify the direction of rounding for negative
-    //quotients, we have to force the dividend positive for portability.
-    //The maximum coefficient size is +-16K (for 12-bit data), so this
-    //code should work for either 16-bit or 32-bit ints.
-
-    outdata[i] = (SWORD) ((SWORD)(temp + 16384.5) - 16384);
-  }
+void Jpeg::calculateFDCTAndQuantization(const SBYTE *data, const BYTE qt, SWORD *outdata)
+{
+  if(m_dctMethod == DCT_FLOAT)
+    floatFDCTAndQuantization(data, (qt == m_dqt.m_infoY) ? m_dqt.m_fdctTableY : m_dqt.m_fdctTableCb, outdata);
+  else
+    integerFDCTAndQuantization(data, (qt == m_dqt.m_infoY) ? m_dqt.m_divisorsY : m_dqt.m_divisorsCb, outdata);
 }
 
 /// Private methods
 void Jpeg::writebyte(const char b)
 {
-  if(p_file != NULL)
-    fputc(b, p_file);
+  if(p_buffer != NULL)
+    p_buffer->push_back((BYTE)b);
 }
 
 void Jpeg::writeword(const WORD w)
@@ -501,13 +526,16 @@ void Jpeg::writeSOF()
   writebyte(m_sof0.m_compY.m_samplingFactor);
   writebyte(m_sof0.m_compY.m_quantizationTable);
 
-  writebyte(m_sof0.m_compCb.m_id);
-  writebyte(m_sof0.m_compCb.m_samplingFactor);
-  writebyte(m_sof0.m_compCb.m_quantizationTable);
+  if(m_sof0.m_components == 3)
+  {
+    writebyte(m_sof0.m_compCb.m_id);
+    writebyte(m_sof0.m_compCb.m_samplingFactor);
+    writebyte(m_sof0.m_compCb.m_quantizationTable);
 
-  writebyte(m_sof0.m_compCr.m_id);
-  writebyte(m_sof0.m_compCr.m_samplingFactor);
-  writebyte(m_sof0.m_compCr.m_quantizationTable);
+    writebyte(m_sof0.m_compCr.m_id);
+    writebyte(m_sof0.m_compCr.m_samplingFactor);
+    writebyte(m_sof0.m_compCr.m_quantizationTable);
+  }
 }
 
 void Jpeg::writeDQT()
@@ -519,9 +547,12 @@ void Jpeg::writeDQT()
   for (int i = 0; i < 64; i++)
     writebyte(m_dqt.m_tableY[i]);
 
-  writebyte(m_dqt.m_infoCb);
-  for (int i = 0; i < 64; i++)
-    writebyte(m_dqt.m_tableCb[i]);
+  if(m_sof0.m_components == 3)
+  {
+    writebyte(m_dqt.m_infoCb);
+    for (int i = 0; i < 64; i++)
+      writebyte(m_dqt.m_tableCb[i]);
+  }
 }
 
 void Jpeg::writeDHT()
@@ -531,8 +562,12 @@ void Jpeg::writeDHT()
 
   writeHTComponent(m_dht.m_YDC);
   writeHTComponent(m_dht.m_YAC);
-  writeHTComponent(m_dht.m_CbDC);
-  writeHTComponent(m_dht.m_CbAC);
+
+  if(m_sof0.m_components == 3)
+  {
+    writeHTComponent(m_dht.m_CbDC);
+    writeHTComponent(m_dht.m_CbAC);
+  }
 }
 
 void Jpeg::writeHTComponent(const DHTComponent &htc)
@@ -553,11 +588,14 @@ void Jpeg::writeSOS()
   writebyte(m_sos0.m_idY);
   writebyte(m_sos0.m_HTY);
 
-  writebyte(m_sos0.m_idCb);
-  writebyte(m_sos0.m_HTCb);
+  if(m_sos0.m_components == 3)
+  {
+    writebyte(m_sos0.m_idCb);
+    writebyte(m_sos0.m_HTCb);
 
-  writebyte(m_sos0.m_idCr);
-  writebyte(m_sos0.m_HTCr);
+    writebyte(m_sos0.m_idCr);
+    writebyte(m_sos0.m_HTCr);
+  }
 
   writebyte(m_sos0.m_Ss);
   writebyte(m_sos0.m_Se);
@@ -576,35 +614,5 @@ void Jpeg::writeComment(BYTE *comment)
 
 void Jpeg::writeBits(const bitstring &bs)
 {
-  WORD value;
-  SBYTE posval;    //bit position in the bitstring we read, should be<=15 and >=0
-  const WORD mask[16] = {
-                      1,2,4,8,
-                      16,32,64,128,
-                      256,512,1024,2048,
-                      4096,8192,16384,32768
-                    };
-
-  value=bs.value;
-  posval=bs.length-1;
-  while (posval>=0)
-  {
-    if (value & mask[posval]) 
-      m_bytenew |= mask[m_bytepos];
-
-    posval--; m_bytepos--;
-    if (m_bytepos < 0) 
-    {
-      if (m_bytenew == 0xFF)
-      {
-        writebyte(0xFF);
-        writebyte(0);
-      }
-      else
-        writebyte(m_bytenew);
-
-      m_bytepos=7;
-      m_bytenew=0;
-    }
-  }
+  m_bitWriter.writeBits(bs.value, bs.length);
 }
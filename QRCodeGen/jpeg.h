@@ -15,9 +15,12 @@
 
 /// C++-related include
 #include <iostream>
+#include <fstream>
 #include <cstdio>
+#include <vector>
 
 #include "jpeginfo.h"
+#include "bitwriter.h"
 
 namespace JPEG
 {
@@ -35,19 +38,73 @@ namespace JPEG
       void setHeight(const WORD height);
       void setWidth(const WORD width);
 
+      /** @brief set encoding mode of the jpeg stream.
+      *
+      *  EM_COLOR (default) writes a YCbCr image. EM_BILEVEL writes a grayscale
+      *  (single component) image and encodes each distinct two-level 8x8 data unit
+      *  only once, which skips the FDCT for almost every data unit of a QR Code symbol.
+      *  Both are baseline JPEG.
+      *
+      *  @param[in]  mode the encoding mode.
+      *
+      *  @return nothing.
+      */
+      void setEncodeMode(const ENCODE_MODE &mode);
+
+      /** @brief set forward DCT implementation.
+      *
+      *  DCT_INTEGER (default) is the fixed point one, DCT_FLOAT the original
+      *  floating point one. Coefficients agree within +-1 for usual quantization
+      *  steps; with steps below about 16 the fixed point error adds a few units
+      *  to the highest frequencies (the bound is 1 + 73 / divisor).
+      *
+      *  @param[in]  method the forward DCT implementation.
+      *
+      *  @return nothing.
+      */
+      void setDCTMethod(const DCT_METHOD &method);
+
+      /// row is the y coordinate of the pixel (0 is the top row) and col is the x coordinate.
       void setJPEGPixel(int row, int col, int red, int green, int blue);
+
+      /** @brief encode the jpeg and append it to buffer.
+      *
+      *  Encode the image exactly like writeToFile() does, but into memory.
+      *  JPEG is a compressed format, so the size isn't known in advance
+      *  and buffer grows as needed.
+      *
+      *  @param[out] buffer the vector to append the encoded jpeg to.
+      *
+      *  @return nothing.
+      */
+      void writeToBuffer(std::vector<BYTE> &buffer);
+
       void writeToFile(const char *filename);
 
     private:
+      /// width and height of the pixel buffer, rounded up to whole 8x8 data units.
+      WORD getPaddedWidth() const;
+      WORD getPaddedHeight() const;
+
       void initComponents();
       void initHoffmanTable();
       void initCategoryAndBit();
 
       void encodePixels();
       void loadDUFromRGBPixels(const WORD xpos, const WORD ypos);
-      void calculateFDCTAndQuantization(const SBYTE *data, const float *fdtbl, SWORD *outdata);
 
-      void writeDU(const SBYTE *ComponentDU, const float *fdtbl, SWORD *DC, const HT &ht);
+      /// qt is the quantization table number, 0 for Y and 1 for Cb/Cr.
+      void calculateFDCTAndQuantization(const SBYTE *data, const BYTE qt, SWORD *outdata);
+
+      void writeDU(const SBYTE *ComponentDU, const BYTE qt, SWORD *DC, const HT &ht);
+      void writeBilevelDU(const SBYTE *ComponentDU, const BYTE qt, SWORD *DC, const HT &ht);
+
+      /// FDCT, quantization and zigzag reorder of a data unit.
+      void quantizeDU(const SBYTE *ComponentDU, const BYTE qt, SWORD *DU);
+      void writeDC(const SWORD dc, SWORD *DC, const HT &ht);
+
+      /// write huffman codes of AC coefficients, or only append them to record if it's not NULL.
+      void writeAC(const SWORD *DU, const HT &ht, std::vector<bitstring> *record);
       void writebyte(const char byte);
       void writeword(const WORD w);
 
@@ -73,6 +130,12 @@ namespace JPEG
       DHTINFO   m_dht;
       SOSINFO   m_sos0;
 
+      ENCODE_MODE m_mode;
+      DCT_METHOD  m_dctMethod;
+
+      /// Encoded bi-level data units, keyed by (bit mask of high samples, low value << 8 | high value)
+      std::map<std::pair<unsigned long long, WORD>, EncodedDU> m_duCache;
+
       HT        m_htY;
       HT        m_htCb;
       YCbCr     m_ycbcr;
@@ -81,10 +144,9 @@ namespace JPEG
       SBYTE     m_Y[64];
       SBYTE     m_Cb[64];
       SBYTE     m_Cr[64];
-      BYTE      m_bytenew; // The byte that will be written in the JPG file
-      SBYTE     m_bytepos; //bit position in the byte we write (bytenew)
+      BitWriter m_bitWriter;        // Entropy coded data, valid during writeToBuffer() only
 
-      FILE      *p_file;
+      std::vector<BYTE> *p_buffer;  // The encoded jpeg stream, valid during writeToBuffer() only
       RGB       *p_rgb;
       BYTE      *p_categoryAlloc;
       BYTE      *p_category;        //Here we'll keep the category of the numbers in range: -32767..32767
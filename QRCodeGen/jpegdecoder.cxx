@@ -0,0 +1,604 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "jpegdecoder.h"
+
+using namespace JPEG;
+
+/// IDCT basis, cosines[x][u] = C(u) / 2 * cos((2x + 1) * u * pi / 16), and the
+/// natural position of every zigzag index (zigzag[] maps the other way).
+/// Built once during static initialization, so it's safe to use from any thread.
+struct DecoderTables
+{
+  DecoderTables()
+  {
+    for (int x = 0; x < 8; x++)
+    {
+      for (int u = 0; u < 8; u++)
+        m_cosines[x][u] = ((u == 0) ? std::sqrt(0.5) : 1.0) / 2.0 * std::cos((2 * x + 1) * u * 3.14159265358979323846 / 16.0);
+    }
+
+    for (int i = 0; i < 64; i++)
+      m_natural[zigzag[i]] = (BYTE)i;
+  }
+
+  double  m_cosines[8][8];
+  BYTE    m_natural[64];
+};
+
+static const DecoderTables tables;
+
+/// Default Constructor
+JpegDecoder::JpegDecoder()
+  :m_width(0),
+  m_height(0),
+  m_maxH(1),
+  m_maxV(1),
+  m_restartInterval(0),
+  m_components(),
+  m_luminance(),
+  p_data(NULL),
+  m_size(0),
+  m_pos(0),
+  m_bits(0),
+  m_bitCount(0)
+{
+  memset(m_qt, 0, sizeof(m_qt));
+  memset(m_dcTables, 0, sizeof(m_dcTables));
+  memset(m_acTables, 0, sizeof(m_acTables));
+}
+
+/// Copy Constructor
+JpegDecoder::JpegDecoder(const JpegDecoder &other)
+  :m_width(other.m_width),
+  m_height(other.m_height),
+  m_maxH(other.m_maxH),
+  m_maxV(other.m_maxV),
+  m_restartInterval(other.m_restartInterval),
+  m_components(other.m_components),
+  m_luminance(other.m_luminance),
+  p_data(NULL),
+  m_size(0),
+  m_pos(0),
+  m_bits(0),
+  m_bitCount(0)
+{
+  memcpy(m_qt, other.m_qt, sizeof(m_qt));
+  memcpy(m_dcTables, other.m_dcTables, sizeof(m_dcTables));
+  memcpy(m_acTables, other.m_acTables, sizeof(m_acTables));
+}
+
+/// Destructor
+JpegDecoder::~JpegDecoder()
+{
+}
+
+/// Assignment Operator
+JpegDecoder& JpegDecoder::operator=(const JpegDecoder &other)
+{
+  if(this != &other)
+  {
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_maxH = other.m_maxH;
+    m_maxV = other.m_maxV;
+    m_restartInterval = other.m_restartInterval;
+    m_components = other.m_components;
+    m_luminance = other.m_luminance;
+    memcpy(m_qt, other.m_qt, sizeof(m_qt));
+    memcpy(m_dcTables, other.m_dcTables, sizeof(m_dcTables));
+    memcpy(m_acTables, other.m_acTables, sizeof(m_acTables));
+  }
+
+  return(*this);
+}
+
+bool JpegDecoder::decode(const BYTE *buffer, size_t size)
+{
+  m_width = m_height = 0;
+  m_restartInterval = 0;
+  m_components.clear();
+  m_luminance.clear();
+  memset(m_dcTables, 0, sizeof(m_dcTables));
+  memset(m_acTables, 0, sizeof(m_acTables));
+
+  if((buffer == NULL) || (size < 4) || (buffer[0] != 0xFF) || (buffer[1] != 0xD8))
+    return(false);
+
+  p_data = buffer;
+  m_size = size;
+  m_pos = 2;
+
+  bool frame = false;
+  bool scanned = false;
+
+  for (;;)
+  {
+    /// markers may be preceded by any number of fill bytes.
+    if((m_pos >= m_size) || (p_data[m_pos] != 0xFF))
+      return(false);
+
+    while((m_pos < m_size) && (p_data[m_pos] == 0xFF))
+      m_pos++;
+
+    if(m_pos >= m_size)
+      return(false);
+
+    BYTE marker = p_data[m_pos++];
+
+    if(marker == 0xD9)      // EOI
+      break;
+
+    if((m_size - m_pos < 2))
+      return(false);
+
+    size_t len = (p_data[m_pos] << 8) | p_data[m_pos + 1];
+    if((len < 2) || (len > m_size - m_pos))
+      return(false);
+
+    const BYTE *data = p_data + m_pos + 2;
+    len -= 2;
+    m_pos += len + 2;
+
+    switch(marker)
+    {
+      case 0xDB:
+        if(!readDQT(data, len))
+          return(false);
+        break;
+
+      case 0xC4:
+        if(!readDHT(data, len))
+          return(false);
+        break;
+
+      case 0xC0:    // SOF0, baseline
+      case 0xC1:    // SOF1, extended sequential, same decoding for 8 bit samples
+        if(frame || !readSOF(data, len))
+          return(false);
+        frame = true;
+        break;
+
+      case 0xDD:    // DRI
+        if(len != 2)
+          return(false);
+        m_restartInterval = (data[0] << 8) | data[1];
+        break;
+
+      case 0xDA:
+        if(!frame || !readSOS(data, len))
+          return(false);
+        scanned = true;
+        break;
+
+      default:
+        /// progressive, lossless, hierarchical or arithmetic coded frames aren't supported.
+        if(((marker >= 0xC2) && (marker <= 0xCF)) && (marker != 0xC4) && (marker != 0xC8) && (marker != 0xCC))
+          return(false);
+        break;      // APPn, COM and the like
+    }
+  }
+
+  if(!scanned)
+    return(false);
+
+  /// the luminance is the first component, brought to full resolution.
+  const Component &y = m_components[0];
+  const int planeWidth = y.m_blocksWide * 8;
+
+  m_luminance.resize(m_width * m_height);
+  for (int row = 0; row < m_height; row++)
+  {
+    const BYTE *src = &y.m_plane[((row * y.m_v) / m_maxV) * planeWidth];
+    BYTE *dst = &m_luminance[row * m_width];
+
+    if(y.m_h == m_maxH)
+      memcpy(dst, src, m_width);
+    else
+    {
+      for (int col = 0; col < m_width; col++)
+        dst[col] = src[(col * y.m_h) / m_maxH];
+    }
+  }
+
+  return(true);
+}
+
+WORD JpegDecoder::getWidth() const
+{
+  return(m_width);
+}
+
+WORD JpegDecoder::getHeight() const
+{
+  return(m_height);
+}
+
+int JpegDecoder::getComponents() const
+{
+  return((int)m_components.size());
+}
+
+const std::vector<BYTE>& JpegDecoder::getLuminance() const
+{
+  return(m_luminance);
+}
+
+bool JpegDecoder::readDQT(const BYTE *data, size_t len)
+{
+  while(len > 0)
+  {
+    int precision = data[0] >> 4;
+    int id = data[0] & 0x0F;
+    size_t size = 1 + ((precision == 0) ? 64 : 128);
+
+    if((id > 3) || (precision > 1) || (len < size))
+      return(false);
+
+    /// tables are stored in zigzag order.
+    for (int i = 0; i < 64; i++)
+      m_qt[id][tables.m_natural[i]] = (precision == 0) ? data[1 + i] : (WORD)((data[1 + 2 * i] << 8) | data[2 + 2 * i]);
+
+    data += size;
+    len -= size;
+  }
+
+  return(true);
+}
+
+bool JpegDecoder::readDHT(const BYTE *data, size_t len)
+{
+  while(len > 0)
+  {
+    if(len < 17)
+      return(false);
+
+    int tableClass = data[0] >> 4;
+    int id = data[0] & 0x0F;
+    int total = 0;
+
+    for (int i = 1; i <= 16; i++)
+      total += data[i];
+
+    if((tableClass > 1) || (id > 3) || (total > 256) || (len < (size_t)(17 + total)))
+      return(false);
+
+    HuffmanTable &table = (tableClass == 0) ? m_dcTables[id] : m_acTables[id];
+    int code = 0;
+    int k = 0;
+
+    /// canonical codes: consecutive within a length, doubled for the next length.
+    for (int length = 1; length <= 16; length++)
+    {
+      table.m_valPtr[length] = k;
+      table.m_minCode[length] = code;
+      code += data[length];
+      k += data[length];
+      table.m_maxCode[length] = (data[length] > 0) ? (code - 1) : -1;
+      code <<= 1;
+    }
+
+    table.m_maxCode[17] = 0x7FFFFFFF;
+    memcpy(table.m_values, data + 17, total);
+    table.m_defined = true;
+
+    data += 17 + total;
+    len -= 17 + total;
+  }
+
+  return(true);
+}
+
+bool JpegDecoder::readSOF(const BYTE *data, size_t len)
+{
+  if((len < 6) || (data[0] != 8))
+    return(false);
+
+  m_height = (WORD)((data[1] << 8) | data[2]);
+  m_width = (WORD)((data[3] << 8) | data[4]);
+  int count = data[5];
+
+  /// images whose height is given by a DNL marker aren't supported.
+  if((m_width == 0) || (m_height == 0) || ((count != 1) && (count != 3)) || (len != (size_t)(6 + 3 * count)))
+    return(false);
+
+  m_maxH = m_maxV = 1;
+  m_components.resize(count);
+
+  for (int i = 0; i < count; i++)
+  {
+    Component &c = m_components[i];
+    c.m_id = data[6 + 3 * i];
+    c.m_h = data[7 + 3 * i] >> 4;
+    c.m_v = data[7 + 3 * i] & 0x0F;
+    c.m_tq = data[8 + 3 * i];
+
+    if((c.m_h < 1) || (c.m_h > 4) || (c.m_v < 1) || (c.m_v > 4) || (c.m_tq > 3))
+      return(false);
+
+    m_maxH = std::max(m_maxH, c.m_h);
+    m_maxV = std::max(m_maxV, c.m_v);
+  }
+
+  /// planes cover whole MCUs.
+  int mcusWide = (m_width + 8 * m_maxH - 1) / (8 * m_maxH);
+  int mcusHigh = (m_height + 8 * m_maxV - 1) / (8 * m_maxV);
+
+  for (int i = 0; i < count; i++)
+  {
+    Component &c = m_components[i];
+    c.m_blocksWide = mcusWide * c.m_h;
+    c.m_blocksHigh = mcusHigh * c.m_v;
+    c.m_plane.assign(c.m_blocksWide * c.m_blocksHigh * 64, 0);
+  }
+
+  return(true);
+}
+
+bool JpegDecoder::readSOS(const BYTE *data, size_t len)
+{
+  if((len < 1) || (data[0] < 1) || (data[0] > 4) || (len != (size_t)(4 + 2 * data[0])))
+    return(false);
+
+  int count = data[0];
+  std::vector<int> components;
+
+  for (int i = 0; i < count; i++)
+  {
+    int id = data[1 + 2 * i];
+    size_t c = 0;
+
+    while((c < m_components.size()) && (m_components[c].m_id != id))
+      c++;
+
+    if(c == m_components.size())
+      return(false);
+
+    m_components[c].m_td = data[2 + 2 * i] >> 4;
+    m_components[c].m_ta = data[2 + 2 * i] & 0x0F;
+
+    if((m_components[c].m_td > 3) || (m_components[c].m_ta > 3) ||
+       !m_dcTables[m_components[c].m_td].m_defined || !m_acTables[m_components[c].m_ta].m_defined)
+      return(false);
+
+    components.push_back((int)c);
+  }
+
+  /// baseline: the whole spectrum, no successive approximation.
+  if((data[1 + 2 * count] != 0) || (data[2 + 2 * count] != 63) || (data[3 + 2 * count] != 0))
+    return(false);
+
+  return(decodeScan(components));
+}
+
+bool JpegDecoder::decodeScan(const std::vector<int> &components)
+{
+  m_bits = 0;
+  m_bitCount = 0;
+
+  for (size_t i = 0; i < components.size(); i++)
+    m_components[components[i]].m_dc = 0;
+
+  int mcusWide, mcusHigh;
+
+  if(components.size() == 1)
+  {
+    /// a single component scan isn't interleaved, its MCU is one block, and only
+    /// the blocks covering the component (not the padding to whole MCUs) are coded.
+    const Component &c = m_components[components[0]];
+    mcusWide = ((m_width * c.m_h + m_maxH - 1) / m_maxH + 7) / 8;
+    mcusHigh = ((m_height * c.m_v + m_maxV - 1) / m_maxV + 7) / 8;
+  }
+  else
+  {
+    mcusWide = (m_width + 8 * m_maxH - 1) / (8 * m_maxH);
+    mcusHigh = (m_height + 8 * m_maxV - 1) / (8 * m_maxV);
+  }
+
+  int mcus = 0;
+
+  for (int my = 0; my < mcusHigh; my++)
+  {
+    for (int mx = 0; mx < mcusWide; mx++)
+    {
+      if((m_restartInterval > 0) && (mcus > 0) && ((mcus % m_restartInterval) == 0))
+      {
+        if(!restart())
+          return(false);
+
+        for (size_t i = 0; i < components.size(); i++)
+          m_components[components[i]].m_dc = 0;
+      }
+
+      if(components.size() == 1)
+      {
+        if(!decodeBlock(m_components[components[0]], mx, my))
+          return(false);
+      }
+      else
+      {
+        for (size_t i = 0; i < components.size(); i++)
+        {
+          Component &c = m_components[components[i]];
+
+          for (int v = 0; v < c.m_v; v++)
+          {
+            for (int h = 0; h < c.m_h; h++)
+            {
+              if(!decodeBlock(c, mx * c.m_h + h, my * c.m_v + v))
+                return(false);
+            }
+          }
+        }
+      }
+
+      mcus++;
+    }
+  }
+
+  /// skip to the marker after the entropy coded data.
+  while(m_pos + 1 < m_size)
+  {
+    if((p_data[m_pos] == 0xFF) && (p_data[m_pos + 1] != 0x00) &&
+       !((p_data[m_pos + 1] >= 0xD0) && (p_data[m_pos + 1] <= 0xD7)))
+      return(true);
+
+    m_pos++;
+  }
+
+  return(false);
+}
+
+bool JpegDecoder::decodeBlock(Component &component, int bx, int by)
+{
+  int coefficients[64] = {0};
+  const WORD *qt = m_qt[component.m_tq];
+
+  /// DC: difference to the previous block, size category then extra bits.
+  int size = decodeHuffman(m_dcTables[component.m_td]);
+  if((size < 0) || (size > 11))
+    return(false);
+
+  int diff = readBits(size);
+  if((size > 0) && (diff < (1 << (size - 1))))
+    diff -= (1 << size) - 1;
+
+  component.m_dc += diff;
+  coefficients[0] = component.m_dc * qt[0];
+
+  /// AC: run of zeros and size in one symbol, 0x00 ends the block, 0xF0 is 16 zeros.
+  for (int k = 1; k < 64; )
+  {
+    int symbol = decodeHuffman(m_acTables[component.m_ta]);
+    if(symbol < 0)
+      return(false);
+
+    int run = symbol >> 4;
+    size = symbol & 0x0F;
+
+    if(size == 0)
+    {
+      if(run != 15)
+        break;
+
+      k += 16;
+      continue;
+    }
+
+    k += run;
+    if(k > 63)
+      return(false);
+
+    int value = readBits(size);
+    if(value < (1 << (size - 1)))
+      value -= (1 << size) - 1;
+
+    coefficients[tables.m_natural[k]] = value * qt[tables.m_natural[k]];
+    k++;
+  }
+
+  if((bx >= component.m_blocksWide) || (by >= component.m_blocksHigh))
+    return(true);
+
+  /// separable inverse DCT, rows then columns, then level shift.
+  double temp[64];
+  const double (*cosines)[8] = tables.m_cosines;
+
+  for (int v = 0; v < 8; v++)
+  {
+    for (int x = 0; x < 8; x++)
+    {
+      double sum = 0.0;
+      for (int u = 0; u < 8; u++)
+        sum += cosines[x][u] * coefficients[v * 8 + u];
+
+      temp[v * 8 + x] = sum;
+    }
+  }
+
+  const int stride = component.m_blocksWide * 8;
+  BYTE *out = &component.m_plane[(by * 8 * stride) + (bx * 8)];
+
+  for (int y = 0; y < 8; y++)
+  {
+    for (int x = 0; x < 8; x++)
+    {
+      double sum = 0.0;
+      for (int v = 0; v < 8; v++)
+        sum += cosines[y][v] * temp[v * 8 + x];
+
+      int sample = (int)std::floor(sum + 128.5);
+      out[y * stride + x] = (BYTE)std::max(0, std::min(255, sample));
+    }
+  }
+
+  return(true);
+}
+
+int JpegDecoder::readBit()
+{
+  if(m_bitCount == 0)
+  {
+    /// 0xFF is followed by a stuffed 0x00 in the entropy coded data, anything
+    /// else is a marker: the data ended, zeros are supplied from there on.
+    BYTE b = 0;
+
+    if(m_pos < m_size)
+    {
+      if(p_data[m_pos] != 0xFF)
+        b = p_data[m_pos++];
+      else if((m_pos + 1 < m_size) && (p_data[m_pos + 1] == 0x00))
+      {
+        b = 0xFF;
+        m_pos += 2;
+      }
+    }
+
+    m_bits = b;
+    m_bitCount = 8;
+  }
+
+  m_bitCount--;
+
+  return((m_bits >> m_bitCount) & 1);
+}
+
+int JpegDecoder::readBits(int count)
+{
+  int value = 0;
+
+  for (int i = 0; i < count; i++)
+    value = (value << 1) | readBit();
+
+  return(value);
+}
+
+int JpegDecoder::decodeHuffman(const HuffmanTable &table)
+{
+  int code = readBit();
+
+  for (int length = 1; length <= 16; length++)
+  {
+    if((table.m_maxCode[length] >= 0) && (code <= table.m_maxCode[length]) && (code >= table.m_minCode[length]))
+      return(table.m_values[table.m_valPtr[length] + code - table.m_minCode[length]]);
+
+    code = (code << 1) | readBit();
+  }
+
+  return(-1);
+}
+
+bool JpegDecoder::restart()
+{
+  /// the bits left before a restart marker are padding.
+  m_bits = 0;
+  m_bitCount = 0;
+
+  if((m_pos + 1 >= m_size) || (p_data[m_pos] != 0xFF) || (p_data[m_pos + 1] < 0xD0) || (p_data[m_pos + 1] > 0xD7))
+    return(false);
+
+  m_pos += 2;
+
+  return(true);
+}
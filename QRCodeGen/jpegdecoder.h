@@ -0,0 +1,139 @@
+/**
+*  @file    jpegdecoder.h
+*  @brief   class to decode baseline jpeg images.
+*
+*  JpegDecoder reads baseline (sequential, Huffman coded, 8 bit) JPEG
+*  files, like the ones Jpeg writes, so that rendered symbols can be read
+*  back and checked. Any sampling factors, interleaved or single component
+*  scans and restart intervals are supported. Only the luminance (the Y
+*  component, or the only component of a grayscale image) is kept, which
+*  is all a QR Code reader needs.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef JPEGDECODER_H
+#define JPEGDECODER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "jpeginfo.h"
+
+namespace JPEG
+{
+  //!  @class  JpegDecoder
+  /*!
+    Decodes the luminance of a baseline JPEG image.
+  */
+  class JpegDecoder
+  {
+    public:
+      /// Default Constructor
+      JpegDecoder();
+
+      /// Copy Constructor
+      JpegDecoder(const JpegDecoder &other);
+
+      /// Destructor
+      ~JpegDecoder();
+
+      /// Assignment Operator
+      JpegDecoder& operator=(const JpegDecoder &other);
+
+      /** @brief decode a jpeg image from memory.
+      *
+      *  @param[in]  buffer the encoded image.
+      *  @param[in]  size the size of buffer in bytes.
+      *
+      *  @return bool true if the image is decoded, false if it is corrupt or not
+      *               baseline (progressive, lossless, 12 bit or arithmetic coded).
+      */
+      bool decode(const BYTE *buffer, size_t size);
+
+      /// width of the last decoded image.
+      WORD getWidth() const;
+
+      /// height of the last decoded image.
+      WORD getHeight() const;
+
+      /// number of components of the last decoded image (1 or 3).
+      int getComponents() const;
+
+      /// luminance of the last decoded image, width * height bytes, top row first.
+      const std::vector<BYTE>& getLuminance() const;
+
+    private:
+      //!  @struct  HuffmanTable
+      /*!
+        Canonical Huffman decoding table (JPEG specification, F.2.2.3).
+      */
+      struct HuffmanTable
+      {
+        int   m_maxCode[18];      ///< Define largest code of each length, -1 if none.
+        int   m_valPtr[17];       ///< Define index in m_values of the first code of each length.
+        int   m_minCode[17];      ///< Define smallest code of each length.
+        BYTE  m_values[256];      ///< Define symbols, ordered by code.
+        bool  m_defined;          ///< Define whether a DHT segment set this table.
+      };
+
+      //!  @struct  Component
+      /*!
+        A component of the frame and its decoded samples.
+      */
+      struct Component
+      {
+        int               m_id;           ///< Define component identifier.
+        int               m_h;            ///< Define horizontal sampling factor.
+        int               m_v;            ///< Define vertical sampling factor.
+        int               m_tq;           ///< Define quantization table.
+        int               m_td;           ///< Define DC Huffman table of the current scan.
+        int               m_ta;           ///< Define AC Huffman table of the current scan.
+        int               m_dc;           ///< Define DC predictor.
+        int               m_blocksWide;   ///< Define width of the plane, in blocks (whole MCUs).
+        int               m_blocksHigh;   ///< Define height of the plane, in blocks (whole MCUs).
+        std::vector<BYTE> m_plane;        ///< Define decoded samples.
+      };
+
+      // Marker segments, every one returns false if the segment is malformed or not supported.
+      bool readDQT(const BYTE *data, size_t len);
+      bool readDHT(const BYTE *data, size_t len);
+      bool readSOF(const BYTE *data, size_t len);
+      bool readSOS(const BYTE *data, size_t len);
+
+      // Decodes the entropy coded data following a SOS, from m_pos.
+      bool decodeScan(const std::vector<int> &components);
+
+      // Decodes one 8x8 block into the plane of a component, at block (bx, by).
+      bool decodeBlock(Component &component, int bx, int by);
+
+      // Entropy decoding helpers. At a marker the bit reader supplies zeros.
+      int readBit();
+      int readBits(int count);
+      int decodeHuffman(const HuffmanTable &table);
+      bool restart();
+
+    private:
+      WORD                    m_width;            ///< Define width of the image.
+      WORD                    m_height;           ///< Define height of the image.
+      int                     m_maxH;             ///< Define largest horizontal sampling factor.
+      int                     m_maxV;             ///< Define largest vertical sampling factor.
+      int                     m_restartInterval;  ///< Define number of MCUs between restart markers, 0 for none.
+      WORD                    m_qt[4][64];        ///< Define quantization tables, natural order.
+      HuffmanTable            m_dcTables[4];      ///< Define DC Huffman tables.
+      HuffmanTable            m_acTables[4];      ///< Define AC Huffman tables.
+      std::vector<Component>  m_components;       ///< Define components of the frame.
+      std::vector<BYTE>       m_luminance;        ///< Define decoded luminance.
+
+      const BYTE             *p_data;             ///< Define the encoded image being decoded.
+      size_t                  m_size;             ///< Define size of the encoded image.
+      size_t                  m_pos;              ///< Define read position in the encoded image.
+      unsigned int            m_bits;             ///< Define bits read but not consumed.
+      int                     m_bitCount;         ///< Define number of valid bits in m_bits.
+  };
+}
+
+#endif    // JPEGDECODER_H
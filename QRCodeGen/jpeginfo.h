@@ -15,8 +15,12 @@
 /// C++-related includes
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
+#include <map>
 
+#include "fdct.h"
 
 namespace JPEG
 {
@@ -29,6 +33,28 @@ namespace JPEG
   typedef signed long int     SDWORD;
 
 
+  //!  @enum  ENCODE_MODE
+  /*!
+    Encoding mode of the JPEG stream.
+  */
+  typedef enum ENCODE_MODE
+  {
+    EM_COLOR    = 0,    ///< YCbCr (3 components), every data unit goes through FDCT
+    EM_BILEVEL          ///< Grayscale (1 component) for two colour images, like QR Code symbols.
+                        ///< Data units with one or two distinct values are encoded only once,
+                        ///< identical ones reuse the cached huffman codes.
+  } EM;
+
+  //!  @enum  DCT_METHOD
+  /*!
+    Forward DCT implementation used by the encoder.
+  */
+  typedef enum DCT_METHOD
+  {
+    DCT_INTEGER = 0,    ///< Fixed point AA&N with reciprocal quantization (SIMD when available)
+    DCT_FLOAT           ///< Floating point AA&N, reference implementation
+  } DCTM;
+
   /// Constant variables
   const BYTE zigzag[64]={ 
                           0, 1, 5, 6,14,15,27,28,
@@ -290,7 +316,9 @@ namespace JPEG
     float m_fdctTableY[64];     ///< Define forward DCT table for Y component.
     BYTE  m_infoCb;             ///< Define information for Cb/Cr component.
     BYTE  m_tableCb[64];        ///< Define Quantization Table for Cb/Cr component.
-    float m_fdctTableCb[64];     ///< Define forward DCT table for Y component.
+    float m_fdctTableCb[64];     ///< Define forward DCT table for Cb/Cr component.
+    FDCTDivisors m_divisorsY;   ///< Define integer forward DCT divisors for Y component.
+    FDCTDivisors m_divisorsCb;  ///< Define integer forward DCT divisors for Cb/Cr component.
 
     public:
       void setQuantizationTableForY()
@@ -348,39 +376,14 @@ namespace JPEG
         }
       }
 
-      // Using a bit modified form of the FDCT routine from IJG's C source:
-      // Forward DCT routine idea taken from Independent JPEG Group's C source for
-      // JPEG encoders/decoders
-
-      // For float AA&N IDCT method, divisors are equal to quantization
-      //   coefficients scaled by scalefactor[row]*scalefactor[col], where
-      //   scalefactor[0] = 1
-      //   scalefactor[k] = cos(k*PI/16) * sqrt(2)    for k=1..7
-      //   We apply a further scale factor of 8.
-      //   What's actually stored is 1/divisor so that the inner loop can
-      //   use a multiplication rather than a division.
+      // Tables of the float and the integer forward DCT, see fdct.h
       void prepareQuantizationTable()
       {
-        int i = 0;
-
-        double aanScaleFactor[8] = {
-                                    1.0, 1.387039845, 1.306562965, 1.175875602,
-                                    1.0, 0.785694958, 0.541196100, 0.275899379
-                                   };
-
-        for (int row = 0; row < 8; row++)
-        {
-          for (int col = 0; col < 8; col++)
-          {
-            m_fdctTableY[i] = (float) (1.0 / ((double) m_tableY[zigzag[i]] *
-                                aanScaleFactor[row] * aanScaleFactor[col] * 8.0));
-
-            m_fdctTableCb[i] = (float) (1.0 / ((double) m_tableCb[zigzag[i]] *
-                              aanScaleFactor[row] * aanScaleFactor[col] * 8.0));
+        prepareFDCTTable(m_tableY, m_fdctTableY);
+        prepareFDCTTable(m_tableCb, m_fdctTableCb);
 
-            i++;
-          }
-        }
+        prepareFDCTDivisors(m_tableY, m_divisorsY);
+        prepareFDCTDivisors(m_tableCb, m_divisorsCb);
       }
 
   } DQTINFO;
@@ -408,12 +411,9 @@ namespace JPEG
       m_nrcodeSize  (nrSize),
       m_valuesSize  (valSize)
     {
-      if((m_nrcodeSize > 0) && (m_valuesSize > 0))
+      if((m_nrcodeSize > 0) && (m_nrcodeSize <= 16) &&
+          (m_valuesSize > 0) && (m_valuesSize <= 162))
       {
-        /// Allocate memory
-        m_nrcodes = new BYTE[m_nrcodeSize];
-        m_values = new BYTE[m_valuesSize];
-
         for (int i = 0; i < m_nrcodeSize; i++)
           m_nrcodes[i]=nrcodes[i+1];
 
@@ -425,9 +425,9 @@ namespace JPEG
     /// member variables
     BYTE  m_index;
     BYTE  m_type;          // DC = 0, AC = 1
-    BYTE  *m_nrcodes;
+    BYTE  m_nrcodes[16];    // Fixed size, so copies of the component never share memory
     int   m_nrcodeSize;
-    BYTE  *m_values;
+    BYTE  m_values[162];
     int   m_valuesSize;
   };
 
@@ -579,6 +579,20 @@ namespace JPEG
   } bitstring;
 
 
+  //!  @struct  EncodedDU
+  /*!
+    Huffman coded form of a data unit, as cached by the bi-level encoder.
+    DC is kept as the quantized coefficient, because it's coded as a
+    difference from the previous data unit. AC codes don't depend on
+    any other data unit, so they are stored ready to be written.
+  */
+  struct EncodedDU
+  {
+    SWORD                   m_dc;   ///< Define quantized DC coefficient.
+    std::vector<bitstring>  m_ac;   ///< Define huffman codes of the AC coefficients, including EOB.
+  };
+
+
   //!  @struct  HT
   /*!
     .
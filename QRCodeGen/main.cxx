@@ -1,9 +1,25 @@
 #include <iostream>
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <thread>
 
 #include "bitmap.h"
 #include "qrcode.h"
+#include "qrdecoder.h"
+#include "qrreedsolomondecoder.h"
+#include "qrgridsampler.h"
+#include "qrdetector.h"
+#include "qrperspectivetransform.h"
+#include "qrmultidetector.h"
+#include "qrscenegenerator.h"
+#include "qrroundtrip.h"
+#include "jpeginfo.h"
 
 using namespace QR;
 
@@ -13,14 +29,53 @@ using namespace QR;
 void doBasicDemo();
 void doVarietyDemo();
 void doSegmentDemo();
+void doBufferDemo();
+bool doDCTDemo();
+void doDecodeDemo();
+bool doReedSolomonDemo();
+void doSamplerDemo();
+bool doCameraDemo();
+bool doMultiDetectDemo();
+void doRoundTripDemo();
 
 void printQR(const QRCode &qr);
 
 int main(int argc, char **argv)
 {
+  /// a self check named on the command line (ctest), its verdict as the exit status.
+  if (argc > 1)
+  {
+    const std::string check = argv[1];
+    bool pass = false;
+
+    if (check == "dct")
+      pass = doDCTDemo();
+    else if (check == "reedsolomon")
+      pass = doReedSolomonDemo();
+    else if (check == "camera")
+      pass = doCameraDemo();
+    else if (check == "multidetect")
+      pass = doMultiDetectDemo();
+    else
+    {
+      std::cout << "unknown check " << check << ", one of: dct, reedsolomon, camera, multidetect" << std::endl;
+      return(EXIT_FAILURE);
+    }
+
+    return(pass ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
   //doBasicDemo();
   doVarietyDemo();
   //doSegmentDemo();
+  //doBufferDemo();
+  //doDCTDemo();
+  //doDecodeDemo();
+  //doReedSolomonDemo();
+  //doSamplerDemo();
+  //doCameraDemo();
+  //doMultiDetectDemo();
+  //doRoundTripDemo();
 
   return(0);
 }
@@ -108,6 +163,555 @@ void doSegmentDemo()
   qr2.writeToBMP("qr2.bmp");
 }
 
+// Encodes a QR Code symbol into memory in every image format, without touching the file system.
+void doBufferDemo()
+{
+  const IMAGE_FORMAT formats[] = {IF_BMP, IF_PNG, IF_JPEG, IF_SVG, IF_EPS, IF_PDF};
+  const char *names[] = {"BMP", "PNG", "JPEG", "SVG", "EPS", "PDF"};
+
+  QRCode qr;
+  qr.encode("https://www.nayuki.io/", ECL_M);
+
+  for (int i = 0; i < 6; i++)
+  {
+    // Growing vector
+    ui8vector image;
+    size_t written = qr.encodeToBuffer(formats[i], image, OUT_FILE_PIXEL_PRESCALER, 4);
+
+    std::cout << names[i] << ": " << written << " bytes";
+
+    // Caller provided buffer, sized up front for the uncompressed formats
+    size_t expected = qr.getImageSize(formats[i], OUT_FILE_PIXEL_PRESCALER, 4);
+    if (expected > 0)
+    {
+      ui8vector fixed(expected);
+      written = qr.encodeToBuffer(formats[i], &fixed[0], fixed.size(), OUT_FILE_PIXEL_PRESCALER, 4);
+      std::cout << " (expected " << expected << ", " << (fixed == image ? "same" : "different") << " bytes)";
+    }
+
+    std::cout << std::endl;
+  }
+}
+
+// Decodes the quantized coefficients with a reference IDCT and returns the squared error against the samples.
+static double reconstructionError(const signed char *samples, const short *coef, const JPEG::BYTE *qtable)
+{
+  const double PI = 3.14159265358979323846;
+  double error = 0.0;
+
+  for (int y = 0; y < 8; y++)
+  {
+    for (int x = 0; x < 8; x++)
+    {
+      double sum = 0.0;
+      for (int v = 0; v < 8; v++)
+      {
+        for (int u = 0; u < 8; u++)
+        {
+          double cu = (u == 0) ? std::sqrt(0.5) : 1.0;
+          double cv = (v == 0) ? std::sqrt(0.5) : 1.0;
+          double value = (double)coef[(v * 8) + u] * qtable[JPEG::zigzag[(v * 8) + u]];
+
+          sum += cu * cv * value * std::cos(((2 * x + 1) * u * PI) / 16) * std::cos(((2 * y + 1) * v * PI) / 16);
+        }
+      }
+
+      double pixel = std::floor((sum / 4) + 0.5);
+      pixel = (pixel < -128) ? -128 : ((pixel > 127) ? 127 : pixel);
+
+      double diff = pixel - samples[(y * 8) + x];
+      error += diff * diff;
+    }
+  }
+
+  return(error);
+}
+
+// Bound of the error of the integer AA&N DCT against the float one, before quantization, in units of
+// its output (scaled by 8 and the AA&N factors). Propagating the error of every fixed point multiplication
+// (truncation, 8 bit constant) through both passes, for samples of at most 128 in magnitude, gives at
+// most 72 (the worst coefficients, 20 is the most seen on random and bi-level blocks); the quantization
+// adds at most 1 (its correction is rounded, and its reciprocal has 16 bits).
+static const double FDCT_ERROR_BOUND = 73.0;
+
+// Mean squared error, per sample, the integer DCT may add to the reconstruction (0.2 to 0.3 is usual).
+static const double MAX_ADDED_ERROR = 0.5;
+
+// Compares the integer forward DCT against the float one on photo like, noisy and bi-level blocks, with
+// the default luminance table and with flat tables. The integer DCT may add at most MAX_ADDED_ERROR to the
+// mean squared error of the reconstruction: its own error is about the same for every table, so it costs a
+// fraction of a dB with the usual tables and about 2 dB at the finest steps. A quantized coefficient may differ by 1 + FDCT_ERROR_BOUND / divisor at most: the rounding of a
+// value moved by less than that bound changes by at most that much. For the usual tables this is 1 for the
+// low frequencies and a few units for the highest ones (whose divisor shrinks with the AA&N factors).
+bool doDCTDemo()
+{
+  const int BLOCKS = 3000;
+  const char *kinds[] = {"smooth", "noise", "bi-level"};
+  const char *tableNames[] = {"luminance", "flat 16", "flat 2"};
+
+  JPEG::DQTINFO dqt;
+
+  std::cout << "Integer FDCT: " << JPEG::getFDCTImplementation() << std::endl;
+
+  bool passed = true;
+
+  for (int table = 0; table < 3; table++)
+  {
+    JPEG::BYTE qtable[64];
+    float fdtbl[64];
+    JPEG::FDCTDivisors divisors;
+
+    for (int i = 0; i < 64; i++)
+      qtable[i] = (table == 0) ? dqt.m_tableY[i] : ((table == 1) ? 16 : 2);
+
+    JPEG::prepareFDCTTable(qtable, fdtbl);
+    JPEG::prepareFDCTDivisors(qtable, divisors);
+
+    std::srand(2016);
+    for (int kind = 0; kind < 3; kind++)
+    {
+      double errorFloat = 0.0;
+      double errorInteger = 0.0;
+      int maxDiff = 0;
+      int mismatches = 0;
+      int outOfBound = 0;
+
+      for (int n = 0; n < BLOCKS; n++)
+      {
+        signed char samples[64];
+        int a = (std::rand() % 64) - 32;
+        int b = (std::rand() % 64) - 32;
+        int c = (std::rand() % 256) - 128;
+        int level0 = (std::rand() % 256) - 128;
+        int level1 = (std::rand() % 256) - 128;
+
+        for (int i = 0; i < 64; i++)
+        {
+          int x = i % 8;
+          int y = i / 8;
+          int value;
+
+          if (kind == 0)
+            value = c + ((a * x) / 4) + ((b * y) / 4) + (std::rand() % 5) - 2;
+          else if (kind == 1)
+            value = (std::rand() % 256) - 128;
+          else
+            value = (std::rand() % 2) ? level0 : level1;
+
+          samples[i] = (signed char)((value < -128) ? -128 : ((value > 127) ? 127 : value));
+        }
+
+        short coefFloat[64];
+        short coefInteger[64];
+
+        JPEG::floatFDCTAndQuantization(samples, fdtbl, coefFloat);
+        JPEG::integerFDCTAndQuantization(samples, divisors, coefInteger);
+
+        for (int i = 0; i < 64; i++)
+        {
+          int diff = std::abs(coefFloat[i] - coefInteger[i]);
+          maxDiff = (diff > maxDiff) ? diff : maxDiff;
+          mismatches += (diff != 0) ? 1 : 0;
+          outOfBound += (diff > 1 + (int)(FDCT_ERROR_BOUND / divisors.m_divisor[i])) ? 1 : 0;
+        }
+
+        errorFloat += reconstructionError(samples, coefFloat, qtable);
+        errorInteger += reconstructionError(samples, coefInteger, qtable);
+      }
+
+      double psnrFloat = 10 * std::log10((255.0 * 255.0 * 64 * BLOCKS) / errorFloat);
+      double psnrInteger = 10 * std::log10((255.0 * 255.0 * 64 * BLOCKS) / errorInteger);
+      double addedError = (errorInteger - errorFloat) / (64 * BLOCKS);
+      bool pass = (outOfBound == 0) && (addedError < MAX_ADDED_ERROR);
+      passed = passed && pass;
+
+      std::cout << tableNames[table] << ", " << kinds[kind] << ": PSNR float " << psnrFloat << " dB, integer " << psnrInteger
+                << " dB (MSE +" << addedError << "), " << mismatches << " of " << (64 * BLOCKS) << " coefficients differ (max "
+                << maxDiff << ", " << outOfBound << " beyond the bound) " << (pass ? "PASS" : "FAIL") << std::endl;
+    }
+  }
+
+  return(passed);
+}
+
+// Encodes numeric, alphanumeric and binary texts of growing length (so all the 40 versions are used)
+// at every error correction level with every mask, and reads each symbol back with the decoder.
+// Also damages 3 bits of the format information and of the version information, and the first codeword
+// (bottom right corner), which must be corrected.
+void doDecodeDemo()
+{
+  const char *kinds[] = {"numeric", "alphanumeric", "binary"};
+  const char *charsets[] = {"0123456789", "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:", "abcdefghijklmnopqrstuvwxyz{|}~!\"#&'()@[]^_`"};
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+
+  QRDecoder decoder;
+  int symbols = 0;
+  int failures = 0;
+  bool versions[41] = {false};
+
+  srand(31);
+  for (int kind = 0; kind < 3; kind++)
+  {
+    int charsetLen = (int)strlen(charsets[kind]);
+
+    for (int e = 0; e < 4; e++)
+    {
+      for (int len = 1; ; len += 1 + len / 12)
+      {
+        std::string text;
+        for (int i = 0; i < len; i++)
+          text += charsets[kind][rand() % charsetLen];
+
+        QRCode qr;
+        try
+        {
+          qr.encode(text, ecls[e], symbols % 8);
+        }
+        catch (const char *)
+        {
+          break;  // Data too long
+        }
+
+        QRBitMatrix matrix = qr.toBitMatrix();
+        int size = matrix.getSize();
+
+        /// damage the first format information copy and the first version information copy.
+        for (int i = 0; i < 3; i++)
+          matrix.set(8, i, matrix.get(8, i) == 0);
+
+        if (qr.getVersion() >= 7)
+        {
+          for (int i = 0; i < 3; i++)
+            matrix.set(size - 11, i, matrix.get(size - 11, i) == 0);
+        }
+
+        matrix.set(size - 1, size - 1, matrix.get(size - 1, size - 1) == 0);
+        matrix.set(size - 2, size - 1, matrix.get(size - 2, size - 1) == 0);
+
+        symbols++;
+        versions[qr.getVersion()] = true;
+
+        try
+        {
+          if ((decoder.decode(matrix) != text) || (decoder.getVersion() != qr.getVersion()) ||
+              (decoder.getECL() != qr.getECL()) || (decoder.getMask() != qr.getMask()) ||
+              (decoder.getCorrectedCount() != 1))
+            failures++;
+        }
+        catch (const char *error)
+        {
+          std::cout << kinds[kind] << " length " << len << ": " << error << std::endl;
+          failures++;
+        }
+      }
+    }
+  }
+
+  int versionCount = 0;
+  for (int v = 1; v <= 40; v++)
+    versionCount += versions[v] ? 1 : 0;
+
+  std::cout << symbols << " symbols of " << versionCount << " versions decoded, " << failures
+            << " failures " << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+}
+
+// Corrupts blocks of every block shape (short and long blocks of the 160 version/ECL combinations)
+// with random errors and erasures, 2 * errors + erasures <= error correction codewords, and checks
+// that the Reed-Solomon decoder restores them.
+bool doReedSolomonDemo()
+{
+  const int TRIALS = 20;
+  int blocks = 0;
+  int failures = 0;
+
+  srand(32);
+  for (int version = 1; version <= 40; version++)
+  {
+    for (int e = 0; e < 4; e++)
+    {
+      int numBlocks, numShortBlocks, shortDataLen, blockEccLen;
+      QRCode::getBlockStructure(version, (ECL)e, numBlocks, numShortBlocks, shortDataLen, blockEccLen);
+
+      const QRReedSolomonGenerator generator(blockEccLen);
+      const QRReedSolomonDecoder decoder(blockEccLen);
+
+      for (int dataLen = shortDataLen; dataLen <= shortDataLen + (numShortBlocks < numBlocks ? 1 : 0); dataLen++)
+      {
+        for (int trial = 0; trial < TRIALS; trial++)
+        {
+          ui8vector block(dataLen);
+          for (int i = 0; i < dataLen; i++)
+            block[i] = (uint8_t)(rand() % 256);
+
+          ui8vector ecc = generator.getErrorCorrection(block);
+          block.insert(block.end(), ecc.begin(), ecc.end());
+
+          /// the first and last trials use the whole capacity with errors only and erasures only.
+          int numErasures = (trial == 0) ? 0 : ((trial == 1) ? blockEccLen : rand() % (blockEccLen + 1));
+          int numErrors = (trial <= 1) ? (blockEccLen - numErasures) / 2 : rand() % ((blockEccLen - numErasures) / 2 + 1);
+
+          std::vector<int> positions;
+          for (int i = 0; i < (int)block.size(); i++)
+            positions.push_back(i);
+          std::random_shuffle(positions.begin(), positions.end());
+
+          ui8vector damaged(block);
+          for (int i = 0; i < numErasures + numErrors; i++)
+            damaged[positions[i]] ^= (uint8_t)((i < numErasures) ? rand() % 256 : 1 + rand() % 255);
+
+          std::vector<int> erasures(positions.begin(), positions.begin() + numErasures);
+
+          blocks++;
+          try
+          {
+            decoder.decode(damaged, erasures);
+            if (damaged != block)
+              failures++;
+          }
+          catch (const char *)
+          {
+            failures++;
+          }
+        }
+      }
+    }
+  }
+
+  std::cout << blocks << " corrupted blocks, " << failures << " not recovered "
+            << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+
+  return(failures == 0);
+}
+
+// Renders symbols as BMP at several scales and quiet zones, reads the images back (from memory,
+// and once through a file), recovers the module grid with detected and with known geometry and decodes it.
+void doSamplerDemo()
+{
+  const char *texts[] = {"123", "https://www.nayuki.io/", "DOLLAR-AMOUNT:$39.87 PERCENTAGE:100.00% OPERATIONS:+-*/",
+                         "314159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706798"};
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+
+  QRGridSampler sampler;
+  QRDecoder decoder;
+  int images = 0;
+  int failures = 0;
+
+  for (int t = 0; t < 4; t++)
+  {
+    QRCode qr;
+    qr.encode(texts[t], ecls[t]);
+
+    for (int scale = 1; scale <= 6; scale++)
+    {
+      for (int border = 0; border <= 4; border += 2)
+      {
+        ui8vector buffer;
+        qr.encodeToBuffer(IF_BMP, buffer, scale, border);
+
+        Bitmap bmp;
+        if (!bmp.readFromBuffer(&buffer[0], buffer.size()))
+        {
+          failures++;
+          continue;
+        }
+
+        for (int known = 0; known < 2; known++)
+        {
+          images++;
+          try
+          {
+            QRBitMatrix matrix = (known == 1) ? sampler.sample(bmp, scale, border) : sampler.sample(bmp);
+
+            if ((decoder.decode(matrix) != texts[t]) || (sampler.getBorder() != border))
+              failures++;
+          }
+          catch (const char *error)
+          {
+            std::cout << "scale " << scale << " border " << border << ": " << error << std::endl;
+            failures++;
+          }
+        }
+      }
+    }
+  }
+
+  QRCode qr;
+  qr.encode(texts[1], ECL_M);
+  qr.writeToBMP("doSamplerDemo-qr0.bmp");
+
+  Bitmap bmp;
+  images++;
+  try
+  {
+    if (!bmp.readFromFile("doSamplerDemo-qr0.bmp") || (decoder.decode(sampler.sample(bmp)) != texts[1]))
+      failures++;
+  }
+  catch (const char *error)
+  {
+    std::cout << "doSamplerDemo-qr0.bmp: " << error << std::endl;
+    failures++;
+  }
+
+  std::cout << images << " images sampled, " << failures << " failures "
+            << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+}
+
+// Renders symbols into synthetic 1080p photos (rotated, in perspective, unevenly lit and noisy),
+// finds and decodes them, and reports the detection throughput.
+bool doCameraDemo()
+{
+  const char *texts[] = {"123", "https://www.nayuki.io/", "DOLLAR-AMOUNT:$39.87 PERCENTAGE:100.00% OPERATIONS:+-*/",
+                         "314159265358979323846264338327950288419716939937510582097494459230781640628620899862803482534211706798"};
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+  const int width = 1920;
+  const int height = 1080;
+  const int quietZone = 4;
+
+  std::vector<unsigned char> image(width * height);
+  QRDetector detector;
+  QRDecoder decoder;
+  unsigned int seed = 12345;
+  int frames = 0;
+  int failures = 0;
+  clock_t elapsed = 0;
+
+  for (int t = 0; t < 4; t++)
+  {
+    QRCode qr;
+    qr.encode(texts[t], ecls[t]);
+    QRBitMatrix symbol = qr.toBitMatrix();
+    const double extent = symbol.getSize() + 2 * quietZone;
+
+    for (int pose = 0; pose < 12; pose++)
+    {
+      /// a square of 400 to 800 pixels, rotated, with its corners moved to fake the perspective.
+      double side = 400.0 + 40.0 * (pose % 11);
+      double angle = pose * 0.5;
+      double corners[8];
+
+      for (int c = 0; c < 4; c++)
+      {
+        double cx = ((c == 1) || (c == 2)) ? 0.5 : -0.5;
+        double cy = (c >= 2) ? 0.5 : -0.5;
+        double skew = (c == pose % 4) ? 0.1 * ((pose % 3) - 1) : 0.0;
+
+        corners[2 * c] = 960.0 + side * (1.0 + skew) * (cx * std::cos(angle) - cy * std::sin(angle));
+        corners[2 * c + 1] = 540.0 + side * (1.0 + skew) * (cx * std::sin(angle) + cy * std::cos(angle));
+      }
+
+      QRPerspectiveTransform toSymbol = QRPerspectiveTransform::quadrilateralToQuadrilateral(
+          corners[0], corners[1], corners[2], corners[3], corners[4], corners[5], corners[6], corners[7],
+          0.0, 0.0, extent, 0.0, extent, extent, 0.0, extent);
+
+      for (int y = 0; y < height; y++)
+      {
+        for (int x = 0; x < width; x++)
+        {
+          double sx = x + 0.5;
+          double sy = y + 0.5;
+          toSymbol.transform(sx, sy);
+
+          int level = 150;
+          if ((sx >= 0.0) && (sy >= 0.0) && (sx < extent) && (sy < extent))
+            level = symbol.get((int)sx - quietZone, (int)sy - quietZone) ? 30 : 210;
+
+          /// light falling off to the right and to the bottom, plus noise.
+          seed = seed * 1103515245 + 12345;
+          level = (int)(level * (1.0 - 0.35 * x / width - 0.2 * y / height)) + (int)((seed >> 16) % 21) - 10;
+          image[y * width + x] = (unsigned char)std::max(0, std::min(255, level));
+        }
+      }
+
+      frames++;
+      clock_t start = clock();
+
+      QRBitMatrix matrix;
+      bool found = detector.detect(&image[0], width, height, width, matrix);
+
+      try
+      {
+        if (!found || (decoder.decode(matrix) != texts[t]))
+          failures++;
+      }
+      catch (const char *error)
+      {
+        std::cout << "pose " << pose << ": " << error << std::endl;
+        failures++;
+      }
+
+      elapsed += clock() - start;
+    }
+  }
+
+  double seconds = (double)elapsed / CLOCKS_PER_SEC;
+
+  std::cout << frames << " frames, " << failures << " failures, "
+            << (seconds > 0.0 ? frames / seconds : 0.0) << " frames/s "
+            << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+
+  return(failures == 0);
+}
+
+// Composites 10 to 40 labels into large synthetic pallet photos, finds and decodes them all
+// with one and with all hardware threads, and reports the wall clock time per frame once the
+// detectors are warm (buffers sized, decoder tables built), and the speedup of the threads.
+bool doMultiDetectDemo()
+{
+  const int FRAMES = 5;
+  const int counts[] = {10, 20, 40};
+  const int threads[] = {1, 0};
+  int symbols = 0;
+  int failures = 0;
+
+  std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+  for (int c = 0; c < 3; c++)
+  {
+    QRSceneGenerator scene(3000, 2000, 7 + c);
+    std::vector<std::string> texts;
+    int placed = scene.generate(counts[c], 4.0, texts);
+    double ms[2];
+
+    for (int t = 0; t < 2; t++)
+    {
+      QRMultiDetector detector(threads[t]);
+      std::vector<QRSymbolResult> results;
+
+      /// a first frame to warm up, then the average of the next ones.
+      detector.detectAll(&scene.getImage()[0], scene.getWidth(), scene.getHeight(), scene.getWidth(), results);
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int f = 0; f < FRAMES; f++)
+        detector.detectAll(&scene.getImage()[0], scene.getWidth(), scene.getHeight(), scene.getWidth(), results);
+      ms[t] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+      /// every label found once, nothing else.
+      int found = 0;
+      for (size_t i = 0; i < texts.size(); i++)
+      {
+        int matches = 0;
+        for (size_t j = 0; j < results.size(); j++)
+          matches += (results[j].m_text == texts[i]) ? 1 : 0;
+
+        found += (matches == 1) ? 1 : 0;
+      }
+
+      symbols += placed;
+      failures += (placed - found) + (int)(results.size() - found);
+
+      std::cout << placed << " labels, " << (threads[t] == 0 ? "all" : "1") << " thread(s): " << found << " decoded, "
+                << results.size() << " results, " << detector.getClusterCount() << " clusters, " << ms[t] << " ms" << std::endl;
+    }
+
+    std::cout << placed << " labels: speedup " << (ms[0] / ms[1]) << std::endl;
+  }
+
+  std::cout << symbols << " labels, " << failures << " failures "
+            << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+
+  return(failures == 0);
+}
+
 void printQR(const QRCode &qr) 
 {
   int border = 4;
@@ -146,3 +750,22 @@ void printQR(const QRCode &qr)
   // write to file
   bmp.writeToFile("test.bmp");
 }
+
+void doRoundTripDemo()
+{
+  QRRoundTrip roundTrip;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  int mismatches = roundTrip.run();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  const std::vector<std::string> &failures = roundTrip.getMismatches();
+  for (size_t i = 0; (i < failures.size()) && (i < 20); i++)
+    std::cout << failures[i] << std::endl;
+
+  roundTrip.writeJSON("doRoundTripDemo.json");
+
+  std::cout << roundTrip.getCaseCount() << " symbols, " << roundTrip.getRenderCount() << " images, "
+            << mismatches << " mismatches, " << seconds << " s "
+            << (mismatches == 0 ? "PASS" : "FAIL") << std::endl;
+}
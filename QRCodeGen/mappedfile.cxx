@@ -0,0 +1,122 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+  :p_data(NULL),
+  m_size(0)
+#ifdef _WIN32
+  ,m_file(NULL),
+  m_mapping(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+bool MappedFile::open(const char *filename)
+{
+  close();
+
+  if(filename == NULL)
+    return(false);
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE)
+    return(false);
+
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(file, &size) || (size.QuadPart == 0))
+  {
+    CloseHandle(file);
+    return(false);
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if(mapping == NULL)
+  {
+    CloseHandle(file);
+    return(false);
+  }
+
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if(view == NULL)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return(false);
+  }
+
+  m_file = file;
+  m_mapping = mapping;
+  p_data = (const unsigned char*)view;
+  m_size = (size_t)size.QuadPart;
+#else
+  int fd = ::open(filename, O_RDONLY);
+  if(fd < 0)
+    return(false);
+
+  struct stat st;
+  if((fstat(fd, &st) != 0) || (st.st_size == 0))
+  {
+    ::close(fd);
+    return(false);
+  }
+
+  void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  /// the mapping keeps its own reference to the file.
+  ::close(fd);
+
+  if(view == MAP_FAILED)
+    return(false);
+
+  /// the whole file is read once from the start.
+  madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+  p_data = (const unsigned char*)view;
+  m_size = (size_t)st.st_size;
+#endif
+
+  return(true);
+}
+
+void MappedFile::close()
+{
+  if(p_data == NULL)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(p_data);
+  CloseHandle((HANDLE)m_mapping);
+  CloseHandle((HANDLE)m_file);
+  m_mapping = NULL;
+  m_file = NULL;
+#else
+  munmap((void*)p_data, m_size);
+#endif
+
+  p_data = NULL;
+  m_size = 0;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+  return(p_data);
+}
+
+size_t MappedFile::getSize() const
+{
+  return(m_size);
+}
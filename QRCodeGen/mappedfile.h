@@ -0,0 +1,69 @@
+/**
+*  @file    mappedfile.h
+*  @brief   class to map a file into memory for reading.
+*
+*  MappedFile maps a whole file read-only (mmap on POSIX systems,
+*  a file mapping object on Windows), so readers can parse it in
+*  place instead of reading it into a buffer first.
+*  It is kept apart from bitmap.h, as windows.h defines WORD/DWORD/LONG
+*  with other types than Bitmap does.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+/// C++-related include
+#include <cstddef>
+
+//!  @class  MappedFile
+/*!
+  MappedFile class maps a file read-only. The mapping stays valid until
+  close() is called or the object is destroyed.
+*/
+class MappedFile
+{
+  public:
+    /// Default Constructor
+    MappedFile();
+
+    /// Destructor
+    ~MappedFile();
+
+    /** @brief map a file.
+    *
+    *  Any file mapped before is closed first.
+    *
+    *  @param[in]  filename the name of the file.
+    *
+    *  @return bool true if the file is mapped, false if it can't be opened or is empty.
+    */
+    bool open(const char *filename);
+
+    /// unmap the file.
+    void close();
+
+    /// content of the file, NULL if nothing is mapped.
+    const unsigned char* getData() const;
+
+    /// size of the file in bytes.
+    size_t getSize() const;
+
+  private:
+    /// not copyable, the mapping has a single owner.
+    MappedFile(const MappedFile &other);
+    MappedFile& operator=(const MappedFile &other);
+
+  private:
+    const unsigned char *p_data;    ///< Define the start of the mapping.
+    size_t              m_size;     ///< Define size of the mapping in bytes.
+#ifdef _WIN32
+    void                *m_file;    ///< Define handle of the file.
+    void                *m_mapping; ///< Define handle of the file mapping object.
+#endif
+};
+
+#endif  // end of MAPPEDFILE_H
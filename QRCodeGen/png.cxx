@@ -0,0 +1,427 @@
+#include "png.h"
+
+using namespace PNG;
+
+const DWORD Png::MAX_STORED_BLOCK = 65535;
+
+/// CRC-32 (ISO 3309) lookup table, shared by every Png object.
+/// Built once during static initialization, so it's safe to use from any thread.
+struct CRCTable
+{
+  CRCTable()
+  {
+    for (DWORD n = 0; n < 256; n++)
+    {
+      DWORD c = n;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+
+      m_table[n] = c;
+    }
+  }
+
+  DWORD m_table[256];
+};
+
+static const CRCTable crcTable;
+
+static DWORD calculateCRC(const BYTE *data, DWORD len)
+{
+  DWORD c = 0xFFFFFFFFu;
+
+  for (DWORD i = 0; i < len; i++)
+    c = crcTable.m_table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+
+  return(c ^ 0xFFFFFFFFu);
+}
+
+Png::Png()
+  :m_width(0),
+  m_height(0),
+  m_scanlines()
+{
+}
+
+Png::Png(const DWORD width, const DWORD height)
+  :m_width(0),
+  m_height(0),
+  m_scanlines()
+{
+  setSize(width, height);
+}
+
+Png::Png(const Png &other)
+  :m_width(other.m_width),
+  m_height(other.m_height),
+  m_scanlines(other.m_scanlines)
+{
+}
+
+Png::~Png()
+{
+}
+
+Png& Png::operator=(const Png &other)
+{
+  if(this != &other)
+  {
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_scanlines = other.m_scanlines;
+  }
+
+  return(*this);
+}
+
+void Png::setSize(const DWORD width, const DWORD height)
+{
+  m_width = width;
+  m_height = height;
+
+  /// every scanline starts with filter type 0 (None), followed by white pixels.
+  m_scanlines.assign(getScanlineSize() * m_height, 0xff);
+  for (DWORD y = 0; y < m_height; y++)
+    m_scanlines[y * getScanlineSize()] = 0;
+}
+
+void Png::setPNGPixel(int row, int col, bool black)
+{
+  if((row >= 0) && (row < (int)m_height) && (col >= 0) && (col < (int)m_width))
+  {
+    BYTE &b = m_scanlines[row * getScanlineSize() + 1 + (col >> 3)];
+    BYTE mask = (BYTE)(0x80 >> (col & 7));
+
+    /// bit value 0 is black in a 1-bit grayscale image.
+    if(black)
+      b &= ~mask;
+    else
+      b |= mask;
+  }
+}
+
+DWORD Png::getScanlineSize() const
+{
+  return(1 + (m_width + 7) / 8);
+}
+
+DWORD Png::getZlibSize() const
+{
+  DWORD rawSize = getScanlineSize() * m_height;
+  DWORD blocks = (rawSize + MAX_STORED_BLOCK - 1) / MAX_STORED_BLOCK;
+
+  /// zlib header + stored blocks (5 bytes header each) + adler32
+  return(2 + rawSize + (blocks * 5) + 4);
+}
+
+DWORD Png::getFileSize() const
+{
+  if((m_width == 0) || (m_height == 0))
+    return(0);
+
+  /// signature + IHDR + IDAT + IEND, every chunk has 12 bytes of length/type/crc.
+  return(8 + (12 + 13) + (12 + getZlibSize()) + 12);
+}
+
+DWORD Png::writeToBuffer(BYTE *buffer, DWORD capacity) const
+{
+  const BYTE signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+  DWORD fileSize = getFileSize();
+
+  if((buffer == NULL) || (fileSize == 0) || (capacity < fileSize))
+    return(0);
+
+  BYTE *pos = buffer;
+
+  memcpy(pos, signature, sizeof(signature));
+  pos += sizeof(signature);
+
+  /// IHDR: width, height, bit depth 1, color type 0 (grayscale),
+  /// compression 0, filter 0, interlace 0.
+  BYTE ihdr[13];
+  writeDWORD(ihdr, m_width);
+  writeDWORD(ihdr + 4, m_height);
+  ihdr[8] = 1;
+  ihdr[9] = 0;
+  ihdr[10] = 0;
+  ihdr[11] = 0;
+  ihdr[12] = 0;
+  pos = writeChunk(pos, "IHDR", ihdr, sizeof(ihdr));
+
+  pos = writeIDAT(pos);
+  pos = writeChunk(pos, "IEND", NULL, 0);
+
+  return((DWORD)(pos - buffer));
+}
+
+void Png::writeToBuffer(std::vector<BYTE> &buffer) const
+{
+  size_t offset = buffer.size();
+
+  buffer.resize(offset + getFileSize());
+  if(writeToBuffer(&buffer[0] + offset, getFileSize()) == 0)
+    buffer.resize(offset);
+}
+
+void Png::writeToFile(const char *filename) const
+{
+  std::vector<BYTE> buffer;
+  writeToBuffer(buffer);
+
+  std::ofstream fs(filename, std::ios::out | std::ios::binary);
+  if(fs.is_open() && (buffer.size() > 0))
+    fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
+}
+
+bool Png::readFromBuffer(const BYTE *buffer, DWORD size)
+{
+  const BYTE signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+  std::vector<BYTE> zlib;
+  bool header = false;
+  bool end = false;
+
+  if((buffer == NULL) || (size < 8) || (memcmp(buffer, signature, 8) != 0))
+    return(false);
+
+  /// collect the chunks, IDAT data may be split over several of them.
+  DWORD pos = 8;
+  while(!end)
+  {
+    if(size - pos < 12)
+      return(false);
+
+    DWORD len = readDWORD(buffer + pos);
+    if(len > size - pos - 12)
+      return(false);
+
+    const BYTE *type = buffer + pos + 4;
+    const BYTE *data = buffer + pos + 8;
+
+    if(readDWORD(data + len) != calculateCRC(type, len + 4))
+      return(false);
+
+    if(memcmp(type, "IHDR", 4) == 0)
+    {
+      /// 1 bit grayscale, deflate, standard filters, no interlace.
+      if((len != 13) || (data[8] != 1) || (data[9] != 0) || (data[10] != 0) || (data[11] != 0) || (data[12] != 0))
+        return(false);
+
+      DWORD width = readDWORD(data);
+      DWORD height = readDWORD(data + 4);
+
+      /// the scanlines come from stored blocks, so they can't be larger than the buffer.
+      if((width == 0) || (height == 0) || (width > 0x7fffffff) || (height > 0x7fffffff) ||
+         (((1ULL + (width + 7ULL) / 8) * height) > size))
+        return(false);
+
+      setSize(width, height);
+      header = true;
+    }
+    else if(memcmp(type, "IDAT", 4) == 0)
+      zlib.insert(zlib.end(), data, data + len);
+    else if(memcmp(type, "IEND", 4) == 0)
+      end = true;
+    else if((type[0] & 0x20) == 0)
+      return(false);      // unknown critical chunk
+
+    pos += len + 12;
+  }
+
+  if(!header || (m_width == 0) || (m_height == 0) || (zlib.size() < 6) || ((zlib[0] & 0x0F) != 8) ||
+     ((((zlib[0] << 8) | zlib[1]) % 31) != 0) || (zlib[1] & 0x20))
+    return(false);
+
+  /// only stored blocks: BFINAL/BTYPE byte, LEN, NLEN, raw bytes.
+  DWORD rawSize = (DWORD)m_scanlines.size();
+  DWORD filled = 0;
+  DWORD in = 2;
+  bool last = false;
+
+  while(!last)
+  {
+    if(zlib.size() - in < 5)
+      return(false);
+
+    last = (zlib[in] & 1) != 0;
+    if((zlib[in] & 6) != 0)
+      return(false);      // compressed block
+
+    DWORD len = zlib[in + 1] | (zlib[in + 2] << 8);
+    DWORD nlen = zlib[in + 3] | (zlib[in + 4] << 8);
+    in += 5;
+
+    if(((len ^ nlen) != 0xFFFF) || (len > zlib.size() - in) || (len > rawSize - filled))
+      return(false);
+
+    memcpy(&m_scanlines[filled], &zlib[in], len);
+    filled += len;
+    in += len;
+  }
+
+  if((filled != rawSize) || (zlib.size() - in < 4))
+    return(false);
+
+  DWORD s1 = 1, s2 = 0;
+  for (DWORD offset = 0; offset < rawSize; offset += 5552)
+  {
+    DWORD stop = std::min(rawSize, offset + 5552);
+    for (DWORD i = offset; i < stop; i++)
+    {
+      s1 += m_scanlines[i];
+      s2 += s1;
+    }
+
+    s1 %= 65521;
+    s2 %= 65521;
+  }
+
+  if(readDWORD(&zlib[in]) != ((s2 << 16) | s1))
+    return(false);
+
+  unfilterScanlines();
+
+  return(true);
+}
+
+DWORD Png::getWidth() const
+{
+  return(m_width);
+}
+
+DWORD Png::getHeight() const
+{
+  return(m_height);
+}
+
+bool Png::getPNGPixel(int row, int col) const
+{
+  if((row < 0) || (row >= (int)m_height) || (col < 0) || (col >= (int)m_width))
+    return(false);
+
+  return((m_scanlines[row * getScanlineSize() + 1 + (col >> 3)] & (0x80 >> (col & 7))) == 0);
+}
+
+/// Private methods
+BYTE* Png::writeDWORD(BYTE *pos, const DWORD value) const
+{
+  /// PNG stores integers in network byte order.
+  pos[0] = (BYTE)(value >> 24);
+  pos[1] = (BYTE)(value >> 16);
+  pos[2] = (BYTE)(value >> 8);
+  pos[3] = (BYTE)(value);
+
+  return(pos + 4);
+}
+
+BYTE* Png::writeChunk(BYTE *pos, const char *type, const BYTE *data, const DWORD len) const
+{
+  BYTE *typePos;
+
+  pos = writeDWORD(pos, len);
+
+  typePos = pos;
+  memcpy(pos, type, 4);
+  pos += 4;
+
+  if(len > 0)
+  {
+    memcpy(pos, data, len);
+    pos += len;
+  }
+
+  /// CRC covers chunk type and chunk data.
+  return(writeDWORD(pos, calculateCRC(typePos, len + 4)));
+}
+
+BYTE* Png::writeIDAT(BYTE *pos) const
+{
+  DWORD rawSize = (DWORD)m_scanlines.size();
+  const BYTE *raw = &m_scanlines[0];
+  DWORD s1 = 1, s2 = 0;
+  BYTE *typePos;
+
+  pos = writeDWORD(pos, getZlibSize());
+
+  typePos = pos;
+  memcpy(pos, "IDAT", 4);
+  pos += 4;
+
+  /// zlib header: deflate, 32K window, no preset dictionary, fastest.
+  *pos++ = 0x78;
+  *pos++ = 0x01;
+
+  /// Stored (uncompressed) deflate blocks, each at most 65535 bytes long.
+  for (DWORD offset = 0; offset < rawSize; offset += MAX_STORED_BLOCK)
+  {
+    DWORD len = std::min(MAX_STORED_BLOCK, rawSize - offset);
+
+    *pos++ = (BYTE)((offset + len == rawSize) ? 1 : 0);     // BFINAL, BTYPE = 00
+    *pos++ = (BYTE)(len & 0xFF);
+    *pos++ = (BYTE)(len >> 8);
+    *pos++ = (BYTE)(~len & 0xFF);
+    *pos++ = (BYTE)((~len >> 8) & 0xFF);
+
+    memcpy(pos, raw + offset, len);
+    pos += len;
+  }
+
+  /// Adler-32 of the uncompressed data. Sums are reduced every 5552 bytes,
+  /// the largest n for which they can't overflow 32 bits.
+  for (DWORD offset = 0; offset < rawSize; offset += 5552)
+  {
+    DWORD end = std::min(rawSize, offset + 5552);
+    for (DWORD i = offset; i < end; i++)
+    {
+      s1 += raw[i];
+      s2 += s1;
+    }
+
+    s1 %= 65521;
+    s2 %= 65521;
+  }
+  pos = writeDWORD(pos, (s2 << 16) | s1);
+
+  return(writeDWORD(pos, calculateCRC(typePos, (DWORD)(pos - typePos))));
+}
+
+DWORD Png::readDWORD(const BYTE *pos)
+{
+  return(((DWORD)pos[0] << 24) | ((DWORD)pos[1] << 16) | ((DWORD)pos[2] << 8) | (DWORD)pos[3]);
+}
+
+void Png::unfilterScanlines()
+{
+  const DWORD stride = getScanlineSize();
+
+  for (DWORD y = 0; y < m_height; y++)
+  {
+    BYTE *line = &m_scanlines[y * stride];
+    const BYTE *prior = (y > 0) ? &m_scanlines[(y - 1) * stride] : NULL;
+
+    /// a is the byte on the left, b the one above, c the one above left (0 outside the image).
+    for (DWORD i = 1; i < stride; i++)
+    {
+      int a = (i > 1) ? line[i - 1] : 0;
+      int b = (prior != NULL) ? prior[i] : 0;
+      int c = ((prior != NULL) && (i > 1)) ? prior[i - 1] : 0;
+
+      switch(line[0])
+      {
+        case 1: line[i] = (BYTE)(line[i] + a);            break;
+        case 2: line[i] = (BYTE)(line[i] + b);            break;
+        case 3: line[i] = (BYTE)(line[i] + (a + b) / 2);  break;
+        case 4:
+        {
+          int p = a + b - c;
+          int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+          line[i] = (BYTE)(line[i] + (((pa <= pb) && (pa <= pc)) ? a : ((pb <= pc) ? b : c)));
+          break;
+        }
+        default:                                          break;
+      }
+    }
+  }
+
+  /// the filter bytes go back to None, as setPNGPixel() expects.
+  for (DWORD y = 0; y < m_height; y++)
+    m_scanlines[y * stride] = 0;
+}
@@ -0,0 +1,151 @@
+/**
+*  @file    png.h
+*  @brief   class to handle png image file.
+*
+*  Png class writes a bi-level (1 bit per pixel, grayscale) PNG image.
+*  Image data is kept in the PNG scanline format, so encoding only adds
+*  the zlib/deflate framing (stored blocks) and the chunk checksums.
+*  As nothing is compressed, the size of the encoded file is known in
+*  advance, which lets the caller encode into a fixed size buffer.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef PNG_H
+#define PNG_H
+
+/// C++-related include
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+namespace PNG
+{
+  /// typedef
+  typedef unsigned char       BYTE;
+  typedef unsigned int        DWORD;
+
+  //!  @class  Png
+  /*!
+    Png class provides methods for building and saving a bi-level PNG image.
+    Pixels are white by default, setPNGPixel() turns them black.
+  */
+  class Png
+  {
+    public:
+      /// Default Constructor
+      Png();
+
+      /// Parametric Constructor
+      /// Set width and height of the png image. All the pixels are white.
+      Png(const DWORD width, const DWORD height);
+
+      /// Copy Constructor
+      Png(const Png &other);
+
+      /// Destructor
+      ~Png();
+
+      /// Assignment Operator
+      Png& operator=(const Png &other);
+
+      /** @brief set width and height of the png image.
+      *
+      *  Resize the image and reset all the pixels to white.
+      *
+      *  @param[in]  width the width of the image in pixels.
+      *  @param[in]  height the height of the image in pixels.
+      *
+      *  @return nothing.
+      */
+      void setSize(const DWORD width, const DWORD height);
+
+      /** @brief set color of a pixel.
+      *
+      *  @param[in]  row the row (y coordinate) of the pixel, 0 is the top row.
+      *  @param[in]  col the column (x coordinate) of the pixel.
+      *  @param[in]  black true for a black pixel, false for a white one.
+      *
+      *  @return nothing.
+      */
+      void setPNGPixel(int row, int col, bool black);
+
+      /** @brief get the exact size of the png file.
+      *
+      *  @return DWORD size of the png file in bytes, 0 if the image is empty.
+      */
+      DWORD getFileSize() const;
+
+      /** @brief encode the png into the caller provided buffer.
+      *
+      *  @param[out] buffer the memory to write the png into.
+      *  @param[in]  capacity the size of buffer in bytes.
+      *
+      *  @return DWORD number of bytes written, 0 if buffer is smaller than getFileSize().
+      */
+      DWORD writeToBuffer(BYTE *buffer, DWORD capacity) const;
+
+      /** @brief encode the png and append it to buffer.
+      *
+      *  @param[out] buffer the vector to append the encoded png to.
+      *
+      *  @return nothing.
+      */
+      void writeToBuffer(std::vector<BYTE> &buffer) const;
+
+      void writeToFile(const char *filename) const;
+
+      /** @brief load a png from memory.
+      *
+      *  Reads the images writeToBuffer() produces: 1 bit grayscale, not interlaced,
+      *  the image data in stored (uncompressed) deflate blocks. Any scanline filter
+      *  is accepted. Chunk CRCs and the Adler-32 checksum are verified.
+      *
+      *  @param[in]  buffer the encoded png.
+      *  @param[in]  size the size of buffer in bytes.
+      *
+      *  @return bool true if the png is loaded, false if it is corrupt or not supported.
+      */
+      bool readFromBuffer(const BYTE *buffer, DWORD size);
+
+      /// width of the image in pixels.
+      DWORD getWidth() const;
+
+      /// height of the image in pixels.
+      DWORD getHeight() const;
+
+      /// true for a black pixel, false for a white one or outside the image.
+      bool getPNGPixel(int row, int col) const;
+
+    private:
+      /// number of bytes of a scanline, including the leading filter type byte.
+      DWORD getScanlineSize() const;
+
+      /// size of the zlib stream holding all the scanlines in stored deflate blocks.
+      DWORD getZlibSize() const;
+
+      BYTE* writeDWORD(BYTE *pos, const DWORD value) const;
+      BYTE* writeChunk(BYTE *pos, const char *type, const BYTE *data, const DWORD len) const;
+      BYTE* writeIDAT(BYTE *pos) const;
+      static DWORD readDWORD(const BYTE *pos);
+
+      /// undo the scanline filters (PNG specification, section 9), 1 byte per pixel at most.
+      void unfilterScanlines();
+
+    private:
+      DWORD             m_width;        ///< Define the width of the image, in pixels.
+      DWORD             m_height;       ///< Define the height of the image, in pixels.
+      std::vector<BYTE> m_scanlines;    ///< Define filter byte + packed pixels (1 = white) for every row.
+
+      static const DWORD MAX_STORED_BLOCK;   ///< Define maximum length of a stored deflate block.
+  };
+}
+
+#endif  // end of PNG_H
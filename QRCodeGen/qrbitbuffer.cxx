@@ -52,13 +52,6 @@ void QRBitBuffer::appendBits(uint32_t val, int len)
   for (int i = len - 1; i >= 0; i--, m_len++)  // Append bit by bit
   {
     unsigned pos = m_len >> 3;              // to manage 8-bit format for each entry
-    unsigned val_left = val >> i;           // ??
-    unsigned and_one = val_left & 1;        // ??
-    unsigned bit_and = m_len & 7;           // manage value b/w 0 - 7, whatever is the value of m_len
-    unsigned after_bit_and = 7 - bit_and;   // ??
-    unsigned char right_shift = and_one << after_bit_and;   // ??
-    unsigned char prev_val = m_bits.at(pos);                // ??
-    unsigned char final_val = prev_val | right_shift;       // ??
 
     m_bits.at(pos) |= ((val >> i) & 1) << (7 - (m_len & 7));
   }
@@ -0,0 +1,104 @@
+#include "qrbitmatrix.h"
+
+using namespace QR;
+
+/// Default Constructor
+QRBitMatrix::QRBitMatrix()
+  :m_size(0),
+  m_stride(0),
+  m_data()
+{
+}
+
+/// Parametric Constructor
+QRBitMatrix::QRBitMatrix(int size)
+  :m_size(size),
+  m_stride((size + 7) / 8),
+  m_data()
+{
+  if(size < 0)
+    throw "Value out of range";
+
+  m_data.resize(m_stride * m_size, 0);
+}
+
+/// Parametric Constructor
+QRBitMatrix::QRBitMatrix(int size, const uint8_t *data)
+  :m_size(size),
+  m_stride((size + 7) / 8),
+  m_data()
+{
+  if((size < 0) || (data == NULL))
+    throw "Invalid argument";
+
+  m_data.assign(data, data + (m_stride * m_size));
+}
+
+/// Copy Constructor
+QRBitMatrix::QRBitMatrix(const QRBitMatrix &other)
+  :m_size(other.m_size),
+  m_stride(other.m_stride),
+  m_data(other.m_data)
+{
+}
+
+/// Destructor
+QRBitMatrix::~QRBitMatrix()
+{
+}
+
+/// Assignment Operator
+QRBitMatrix& QRBitMatrix::operator=(const QRBitMatrix &other)
+{
+  if(this != &other)
+  {
+    m_size = other.m_size;
+    m_stride = other.m_stride;
+    m_data = other.m_data;
+  }
+
+  return(*this);
+}
+
+int QRBitMatrix::getSize() const
+{
+  return(m_size);
+}
+
+int QRBitMatrix::getStride() const
+{
+  return(m_stride);
+}
+
+size_t QRBitMatrix::getDataSize() const
+{
+  return(m_data.size());
+}
+
+const uint8_t* QRBitMatrix::getData() const
+{
+  return(m_data.empty() ? NULL : &m_data[0]);
+}
+
+uint8_t* QRBitMatrix::getData()
+{
+  return(m_data.empty() ? NULL : &m_data[0]);
+}
+
+int QRBitMatrix::get(int x, int y) const
+{
+  if((0 <= x) && (x < m_size) && (0 <= y) && (y < m_size))
+    return((m_data[(y * m_stride) + (x >> 3)] >> (7 - (x & 7))) & 1);
+  else
+    return(0);
+}
+
+void QRBitMatrix::set(int x, int y, bool isBlack)
+{
+  uint8_t bit = (uint8_t)(0x80 >> (x & 7));
+
+  if(isBlack)
+    m_data[(y * m_stride) + (x >> 3)] |= bit;
+  else
+    m_data[(y * m_stride) + (x >> 3)] &= (uint8_t)~bit;
+}
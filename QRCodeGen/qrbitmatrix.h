@@ -0,0 +1,95 @@
+/**
+*  @file    qrbitmatrix.h
+*  @brief   class to hold the modules of a QR Code symbol as packed bits.
+*
+*  QRBitMatrix stores a square grid of modules with one bit per module.
+*  Every row starts on a byte boundary and the leftmost module of a byte
+*  is its most significant bit (like a 1 bit per pixel image), so a row
+*  of a version 40 symbol takes 23 bytes instead of 177 bools.
+*  It is the input of QRDecoder, and QRCode::toBitMatrix() produces it.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRBITMATRIX_H
+#define QRBITMATRIX_H
+
+#include <vector>
+
+#include "qrutility.h"
+
+namespace QR
+{
+  //!  @class  QRBitMatrix
+  /*!
+    Square grid of modules packed 8 per byte, MSB first, rows padded to a whole byte.
+    Bit 1 is a dark (black) module, bit 0 a light (white) one.
+  */
+  class QRBitMatrix
+  {
+    public:
+      /// Default Constructor
+      QRBitMatrix();
+
+      /// Parametric Constructor
+      /// Creates a size * size matrix, all modules light.
+      QRBitMatrix(int size);
+
+      /// Parametric Constructor
+      /// Creates a size * size matrix from getDataSize() bytes of packed rows.
+      QRBitMatrix(int size, const uint8_t *data);
+
+      /// Copy Constructor
+      QRBitMatrix(const QRBitMatrix &other);
+
+      /// Destructor
+      ~QRBitMatrix();
+
+      /// Assignment Operator
+      QRBitMatrix& operator=(const QRBitMatrix &other);
+
+      /// width and height of the matrix, in modules.
+      int getSize() const;
+
+      /// number of bytes of a row, (size + 7) / 8.
+      int getStride() const;
+
+      /// number of bytes of the whole matrix, stride * size.
+      size_t getDataSize() const;
+
+      /// packed rows, top row first.
+      const uint8_t* getData() const;
+      uint8_t* getData();
+
+      /** @brief get a module.
+      *
+      *  @param[in]   x the column, 0 is the left one.
+      *  @param[in]   y the row, 0 is the top one.
+      *
+      *  @return int 1 for a dark module, 0 for a light one or if (x, y) is out of the matrix.
+      */
+      int get(int x, int y) const;
+
+      /** @brief set a module.
+      *
+      *  Coordinates must be in range.
+      *
+      *  @param[in]   x the column, 0 is the left one.
+      *  @param[in]   y the row, 0 is the top one.
+      *  @param[in]   isBlack true for a dark module.
+      *
+      *  @return nothing.
+      */
+      void set(int x, int y, bool isBlack);
+
+    private:
+      int       m_size;     ///< Define width and height of the matrix, in modules.
+      int       m_stride;   ///< Define number of bytes of a row.
+      ui8vector m_data;     ///< Define packed rows, m_stride * m_size bytes.
+  };
+}
+
+#endif    // QRBITMATRIX_H
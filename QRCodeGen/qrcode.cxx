@@ -1,6 +1,10 @@
+#include <fstream>
+#include <cstring>
+
 #include "qrcode.h"
 #include "bitmap.h"
 #include "jpeg.h"
+#include "png.h"
 
 using namespace QR;
 
@@ -111,6 +115,16 @@ int QRCode::getSize() const
   return m_size;
 }
 
+int QRCode::getVersion() const
+{
+  return m_version;
+}
+
+ECL QRCode::getECL() const
+{
+  return m_ecl;
+}
+
 int QRCode::getModule(int x, int y) const 
 {
   if (0 <= x && x < m_size && 0 <= y && y < m_size)
@@ -124,34 +138,62 @@ std::string QRCode::toSvgString(int border) const
   if (border < 0)
     throw "Border must be non-negative";
 
-  std::ostringstream sb;
-  sb << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-  sb << "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n";
-  sb << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 ";
-  sb << (m_size + border * 2) << " " << (m_size + border * 2) << "\">\n";
-  sb << "\t<rect width=\"100%\" height=\"100%\" fill=\"#FFFFFF\" stroke-width=\"0\"/>\n";
-  sb << "\t<path d=\"";
-  bool head = true;
-  for (int y = -border; y < m_size + border; y++) 
-  {
-    for (int x = -border; x < m_size + border; x++) 
-    {
-      if (getModule(x, y) == 1)
-      {
-        if (head)
-          head = false;
-        else
-          sb << " ";
+  ui8vector svg;
+  encodeToBuffer(IF_SVG, svg, 1, border);
 
-        sb << "M" << (x + border) << "," << (y + border) << "h1v1h-1z";
-      }
+  return std::string(svg.begin(), svg.end());
+}
+
+QRBitMatrix QRCode::toBitMatrix() const
+{
+  QRBitMatrix matrix(m_size);
+
+  for (int y = 0; y < m_size; y++)
+  {
+    for (int x = 0; x < m_size; x++)
+    {
+      if (m_modules[y][x])
+        matrix.set(x, y, true);
     }
   }
 
-  sb << "\" fill=\"#000000\" stroke-width=\"0\"/>\n";
-  sb << "</svg>\n";
+  return matrix;
+}
+
+void QRCode::fromBitMatrix(int size, const uint8_t *data, const ECL &ecl, int mask)
+{
+  if ((size < 21) || (size > 177) || ((size - 17) % 4 != 0) || (mask < 0) || (mask > 7) || (data == NULL))
+    throw "Value out of range";
+
+  // The function modules are marked as if encoded, then every module is overwritten
+  makeFunctionPatterns((size - 17) / 4, ecl);
+  this->m_mask = mask;
 
-  return sb.str();
+  const int stride = (size + 7) / 8;
+  for (int y = 0; y < size; y++)
+  {
+    const uint8_t *row = data + (y * stride);
+    for (int x = 0; x < size; x++)
+      m_modules[y][x] = ((row[x >> 3] >> (7 - (x & 7))) & 1) != 0;
+  }
+}
+
+void QRCode::fromBitMatrix(const QRBitMatrix &matrix, const ECL &ecl, int mask)
+{
+  fromBitMatrix(matrix.getSize(), matrix.getData(), ecl, mask);
+}
+
+void QRCode::getBlockStructure(int version, const ECL &ecl, int &numBlocks, int &numShortBlocks, int &shortDataLen, int &blockEccLen)
+{
+  if (version < 1 || version > 40)
+    throw "Version number out of range";
+
+  int rawCodewords = getRawDataModulesCount(version) / 8;
+
+  numBlocks = ERROR_CORRECTION_BLOCKS[ecl][version];
+  blockEccLen = ERROR_CORRECTION_CODEWORDS[ecl][version] / numBlocks;
+  numShortBlocks = numBlocks - rawCodewords % numBlocks;
+  shortDataLen = rawCodewords / numBlocks - blockEccLen;
 }
 
 void QRCode::encode(const std::string &input, const ECL &ecl, int mask) 
@@ -187,139 +229,657 @@ void QRCode::encode(const std::vector<QRSegment> &segs, const ECL &ecl, int mask
   if (((mask < -1) && (mask > 7)))
     throw "Invalid value";
 
-  // Find the minimal version number to use
-  int version, dataUsedBits;
-  for (version = MIN_VERSION; ; version++) 
-  {
-    int dataCapacityBits = getDataCodewordsCount(version, ecl) * 8;  // Number of data bits available
+  int version;
+  ECL newEcl;
+  const ui8vector dataCodewords(makeDataCodewords(segs, ecl, version, newEcl));
 
-    dataUsedBits = getTotalBits(segs, version);
-    if (dataUsedBits != -1 && dataUsedBits <= dataCapacityBits)
-      break;  // This version number is found to be suitable
+  // Create the QR Code symbol
+  makeQRCode(version, newEcl, dataCodewords, mask);
+}
 
-    if (version >= MAX_VERSION)  // All versions in the range could not fit the given data
-      throw "Data too long";
-  }
+/// side of the raster image of a symbol, which must be sized and written with DWORDs;
+/// the 24 bit BMP is the larger of the raster formats.
+static int getRasterDimension(int size, int scale, int border)
+{
+  unsigned long long side = ((unsigned long long)size + 2ULL * border) * scale;
 
-  if (dataUsedBits == -1)
-    throw "Assertion error";
+  if((((3 * side + 3) & ~3ULL) * side + 54) > 0xffffffffULL)
+    throw "Image too large";
 
-  // Increase the error correction level while the data still fits in the current version number
-  ECL newEcl = ecl;
-  //if (boostEcl) 
-  //{
-    if (dataUsedBits <= getDataCodewordsCount(version, ECL_M ) * 8)  newEcl = ECL_M;
-    if (dataUsedBits <= getDataCodewordsCount(version, ECL_Q ) * 8)  newEcl = ECL_Q;
-    if (dataUsedBits <= getDataCodewordsCount(version, ECL_H ) * 8)  newEcl = ECL_H;
-  //}
+  return((int)side);
+}
 
-  // Create the data bit string by concatenating all segments
-  int dataCapacityBits = getDataCodewordsCount(version, newEcl) * 8;
-  QRBitBuffer bits;
-  for (size_t i = 0; i < segs.size(); i++) 
+/// write the whole buffer into a binary file.
+static void writeBufferToFile(const std::string &filename, const ui8vector &buffer)
+{
+  if(buffer.size() > 0)
   {
-    const QRSegment &seg(segs.at(i));
-    bits.appendBits(seg.getMode(), 4);
-    bits.appendBits(seg.getInputSize(), seg.getCharCountIndicatorSize(version));
-    bits.appendData(seg);
+    std::ofstream fs(filename.c_str(), std::ios::out | std::ios::binary);
+    if(fs.is_open())
+      fs.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size());
   }
+}
 
-  // Add terminator and pad up to a byte if applicable
-  bits.appendBits(0, std::min(4, dataCapacityBits - bits.getBitLength()));
-  bits.appendBits(0, (8 - bits.getBitLength() % 8) % 8);
+void QRCode::writeToBMP(const std::string &filename)
+{
+  ui8vector buffer;
+  encodeToBuffer(IF_BMP, buffer);
+  writeBufferToFile(filename, buffer);
+}
 
-  // Pad with alternate bytes until data capacity is reached
-  for (uint8_t padByte = 0xEC; bits.getBitLength() < dataCapacityBits; padByte ^= 0xEC ^ 0x11)
-    bits.appendBits(padByte, 8);
+void QRCode::writeToPNG(const std::string &filename)
+{
+  ui8vector buffer;
+  encodeToBuffer(IF_PNG, buffer);
+  writeBufferToFile(filename, buffer);
+}
 
-  if (bits.getBitLength() % 8 != 0)
-    throw "Assertion error";  
+void QRCode::writeToJPEG(const std::string &filename)
+{
+  ui8vector buffer;
+  encodeToBuffer(IF_JPEG, buffer);
+  writeBufferToFile(filename, buffer);
+}
 
-  // Create the QR Code symbol
-  makeQRCode(version, newEcl, bits.getBytes(), mask);
+void QRCode::writeToSVG(const std::string &filename, int border)
+{
+  ui8vector buffer;
+  encodeToBuffer(IF_SVG, buffer, 1, border);
+  writeBufferToFile(filename, buffer);
 }
 
-void QRCode::writeToBMP(const std::string &filename)
+void QRCode::writeToEPS(const std::string &filename, int scale, int border)
+{
+  ui8vector buffer;
+  encodeToBuffer(IF_EPS, buffer, scale, border);
+  writeBufferToFile(filename, buffer);
+}
+
+void QRCode::writeToPDF(const std::string &filename, int scale, int border)
+{
+  ui8vector buffer;
+  encodeToBuffer(IF_PDF, buffer, scale, border);
+  writeBufferToFile(filename, buffer);
+}
+
+size_t QRCode::getImageSize(const IMAGE_FORMAT &format, int scale, int border) const
 {
+  if ((scale < 1) || (border < 0))
+    throw "Value out of range";
+
+  size_t size = 0;
+
   if(m_size > 0)
   {
-    int OUT_FILE_PIXEL_PRESCALER = 8;
-    // Output the bmp file
-    Bitmap bmp(m_size * OUT_FILE_PIXEL_PRESCALER, m_size * OUT_FILE_PIXEL_PRESCALER);
+    int dimension = ((format == IF_BMP) || (format == IF_PNG)) ? getRasterDimension(m_size, scale, border)
+                                                                : (m_size + border * 2) * scale;
 
-    for(int y = 0; y < m_size; y++)
+    switch(format)
     {
-      for(int x = 0; x < m_size ; x++)
+      case IF_BMP:  size = Bitmap(dimension, dimension).getFileSize();       break;
+      case IF_PNG:  size = PNG::Png(dimension, dimension).getFileSize();     break;
+      case IF_JPEG: size = 0;                                                break;   // Compressed, not known in advance
+
+      case IF_SVG:
+      case IF_EPS:
+      case IF_PDF:
       {
-        if (getModule(x, y) == 1)
+        std::vector<int> outlines;
+        traceOutlines(outlines);
+        size = writeVector(format, outlines, NULL, scale, border);
+        break;
+      }
+
+      default:      throw "Invalid image format";
+    }
+  }
+
+  return(size);
+}
+
+size_t QRCode::encodeToBuffer(const IMAGE_FORMAT &format, ui8vector &buffer, int scale, int border) const
+{
+  if ((scale < 1) || (border < 0))
+    throw "Value out of range";
+
+  size_t offset = buffer.size();
+
+  if(m_size > 0)
+  {
+    int dimension = ((format == IF_BMP) || (format == IF_PNG)) ? getRasterDimension(m_size, scale, border)
+                                                                : (m_size + border * 2) * scale;
+
+    switch(format)
+    {
+      case IF_BMP:
+      {
+        Bitmap bmp(dimension, dimension);
+        rasterize(bmp, scale, border);
+        bmp.writeToBuffer(buffer);
+        break;
+      }
+
+      case IF_PNG:
+      {
+        PNG::Png png(dimension, dimension);
+        rasterize(png, scale, border);
+        png.writeToBuffer(buffer);
+        break;
+      }
+
+      case IF_JPEG:
+      {
+        /// symbol is two colour, so most of the data units are identical
+        JPEG::Jpeg jpg(dimension, dimension);
+        jpg.setEncodeMode(JPEG::EM_BILEVEL);
+        rasterize(jpg, scale, border);
+        jpg.writeToBuffer(buffer);
+        break;
+      }
+
+      case IF_SVG:
+      case IF_EPS:
+      case IF_PDF:
+      {
+        std::vector<int> outlines;
+        traceOutlines(outlines);
+
+        buffer.resize(offset + writeVector(format, outlines, NULL, scale, border));
+        writeVector(format, outlines, &buffer[offset], scale, border);
+        break;
+      }
+
+      default:
+        throw "Invalid image format";
+    }
+  }
+
+  return(buffer.size() - offset);
+}
+
+size_t QRCode::encodeToBuffer(const IMAGE_FORMAT &format, uint8_t *buffer, size_t capacity, int scale, int border) const
+{
+  if ((buffer == NULL) || (scale < 1) || (border < 0))
+    throw "Value out of range";
+
+  if(m_size <= 0)
+    return(0);
+
+  /// JPEG size is only known after encoding.
+  if(format == IF_JPEG)
+  {
+    ui8vector jpg;
+    encodeToBuffer(format, jpg, scale, border);
+
+    if(jpg.size() > capacity)
+      throw "Buffer too small";
+
+    memcpy(buffer, &jpg[0], jpg.size());
+    return(jpg.size());
+  }
+
+  /// trace vector outlines once, for both sizing and writing.
+  if((format == IF_SVG) || (format == IF_EPS) || (format == IF_PDF))
+  {
+    std::vector<int> outlines;
+    traceOutlines(outlines);
+
+    size_t size = writeVector(format, outlines, NULL, scale, border);
+    if(size > capacity)
+      throw "Buffer too small";
+
+    return(writeVector(format, outlines, buffer, scale, border));
+  }
+
+  size_t size = getImageSize(format, scale, border);
+  if(size > capacity)
+    throw "Buffer too small";
+
+  /// size fits the DWORD of the raster writers, getRasterDimension() checked it.
+  int dimension = getRasterDimension(m_size, scale, border);
+  switch(format)
+  {
+    case IF_BMP:
+    {
+      Bitmap bmp(dimension, dimension);
+      rasterize(bmp, scale, border);
+      bmp.writeToBuffer(buffer, (DWORD)size);
+      break;
+    }
+
+    case IF_PNG:
+    {
+      PNG::Png png(dimension, dimension);
+      rasterize(png, scale, border);
+      png.writeToBuffer(buffer, (PNG::DWORD)size);
+      break;
+    }
+
+    default:
+      throw "Invalid image format";
+  }
+
+  return(size);
+}
+
+void QRCode::rasterize(Bitmap &bmp, int scale, int border) const
+{
+  int dimension = (m_size + border * 2) * scale;
+
+  for(int y = 0; y < m_size; y++)
+  {
+    for(int x = 0; x < m_size ; x++)
+    {
+      if (getModule(x, y) == 1)
+      {
+        for(int l = 0; l < scale; l++)
         {
-          for(int l = 0; l < OUT_FILE_PIXEL_PRESCALER; l++)
+          for(int n = 0; n < scale; n++)
           {
-            for(int n = 0; n < OUT_FILE_PIXEL_PRESCALER; n++)
-            {
-              /// As height is a positive number, the bitmap is a bottom-up DIB 
-              /// and its origin is the lower-left corner.
-              /// So, we to swap row value, so that it's origin become lower-left corner.
-              /// So, we swap row value with it's max value.
-              /// Like: if current row is 0 and max row height is 24,
-              /// then x_pos_swap = 24(max row height) - 0(current row value ) + 1 (as array start's with 0-index).
-
-              int x_pos = l + (x * OUT_FILE_PIXEL_PRESCALER);
-              int y_pos = n + (y * OUT_FILE_PIXEL_PRESCALER);
-              int x_pos_swap = (m_size * OUT_FILE_PIXEL_PRESCALER) - (x_pos + 1);
-
-              bmp.setPixel(x_pos_swap, 
-                            y_pos, 
-                            0xff, 0, 0);
-            }
+            /// As height is a positive number, the bitmap is a bottom-up DIB 
+            /// and its origin is the lower-left corner.
+            /// So, the first row of pixel array is the last row of the image.
+            int x_pos = n + ((x + border) * scale);
+            int y_pos = l + ((y + border) * scale);
+
+            bmp.setPixel(dimension - (y_pos + 1), x_pos, 0xff, 0, 0);
           }
         }
       }
     }
+  }
+}
 
-    // write to file
-    bmp.writeToFile(filename.c_str());
+void QRCode::rasterize(JPEG::Jpeg &jpg, int scale, int border) const
+{
+  for(int y = 0; y < m_size; y++)
+  {
+    for(int x = 0; x < m_size ; x++)
+    {
+      if (getModule(x, y) == 1)
+      {
+        for(int l = 0; l < scale; l++)
+        {
+          for(int n = 0; n < scale; n++)
+            jpg.setJPEGPixel(l + ((y + border) * scale), n + ((x + border) * scale), 0, 0, 0xff);
+        }
+      }
+    }
   }
 }
 
-void QRCode::writeToPNG(const std::string &filename)
+void QRCode::rasterize(PNG::Png &png, int scale, int border) const
 {
-  
+  for(int y = 0; y < m_size; y++)
+  {
+    for(int x = 0; x < m_size ; x++)
+    {
+      if (getModule(x, y) == 1)
+      {
+        for(int l = 0; l < scale; l++)
+        {
+          for(int n = 0; n < scale; n++)
+            png.setPNGPixel(l + ((y + border) * scale), n + ((x + border) * scale), true);
+        }
+      }
+    }
+  }
 }
 
-void QRCode::writeToJPEG(const std::string &filename)
+/// copy text at buffer + pos (if buffer isn't NULL) and return the position after it.
+static size_t appendText(uint8_t *buffer, size_t pos, const char *text)
 {
-  if(m_size > 0)
+  size_t len = strlen(text);
+
+  if(buffer != NULL)
+    memcpy(buffer + pos, text, len);
+
+  return(pos + len);
+}
+
+/// write decimal representation of value at buffer + pos (if buffer isn't NULL), zero padded
+/// to width digits, and return the position after it.
+static size_t appendNumber(uint8_t *buffer, size_t pos, int value, int width = 0)
+{
+  char digits[12];
+  int len = 0;
+  bool negative = (value < 0);
+  unsigned int magnitude = negative ? (0u - (unsigned int)value) : (unsigned int)value;
+
+  do
   {
-    int OUT_FILE_PIXEL_PRESCALER = 8;
+    digits[len++] = (char)('0' + (magnitude % 10));
+    magnitude /= 10;
+  } while((magnitude > 0) || (len < width));
+
+  if(negative)
+    digits[len++] = '-';
 
-    // Output the jpeg file
-    JPEG::Jpeg jpg(m_size * OUT_FILE_PIXEL_PRESCALER, m_size * OUT_FILE_PIXEL_PRESCALER);
+  if(buffer != NULL)
+  {
+    for(int i = 0; i < len; i++)
+      buffer[pos + i] = digits[len - 1 - i];
+  }
+
+  return(pos + len);
+}
+
+void QRCode::traceOutlines(std::vector<int> &outlines) const
+{
+  /// directions, y grows downwards: right, down, left, up.
+  const int DX[4] = {1, 0, -1, 0};
+  const int DY[4] = {0, 1, 0, -1};
+  const int side = m_size + 1;
 
-    //jpg.setHeight(m_size * OUT_FILE_PIXEL_PRESCALER);
-    //jpg.setWidth(m_size * OUT_FILE_PIXEL_PRESCALER);
+  /// outgoing boundary edges of every lattice point, one bit per direction.
+  /// Every dark module gets an edge on each side facing a light module,
+  /// oriented so that the dark module is on the right.
+  std::vector<uint8_t> edges(side * side, 0);
 
-    for(int y = 0; y < m_size; y++)
+  for (int y = 0; y < m_size; y++)
+  {
+    for (int x = 0; x < m_size; x++)
     {
-      for(int x = 0; x < m_size ; x++)
+      if (getModule(x, y) == 0)
+        continue;
+
+      if (getModule(x, y - 1) == 0)
+        edges[(y * side) + x] |= 1;                   // top, going right
+      if (getModule(x + 1, y) == 0)
+        edges[(y * side) + x + 1] |= 2;               // right, going down
+      if (getModule(x, y + 1) == 0)
+        edges[((y + 1) * side) + x + 1] |= 4;         // bottom, going left
+      if (getModule(x - 1, y) == 0)
+        edges[((y + 1) * side) + x] |= 8;             // left, going up
+    }
+  }
+
+  std::vector<int> path;
+
+  for (int start = 0; start < side * side; start++)
+  {
+    while (edges[start] != 0)
+    {
+      int point = start;
+      int dir = 0;
+
+      while ((edges[start] & (1 << dir)) == 0)
+        dir++;
+
+      /// walk the boundary until it's back at the start. Where two regions
+      /// touch diagonally, turn right, so each region keeps its own outline.
+      path.clear();
+      do
       {
-        if (getModule(x, y) == 1)
+        edges[point] &= (uint8_t)~(1 << dir);
+        path.push_back(dir);
+        point += (DY[dir] * side) + DX[dir];
+
+        if (point == start)
+          break;
+
+        const int turns[3] = {(dir + 1) % 4, dir, (dir + 3) % 4};
+        for (int t = 0; t < 3; t++)
         {
-          for(int l = 0; l < OUT_FILE_PIXEL_PRESCALER; l++)
+          if (edges[point] & (1 << turns[t]))
           {
-            for(int n = 0; n < OUT_FILE_PIXEL_PRESCALER; n++)
-            {
-              jpg.setJPEGPixel(l + (x * OUT_FILE_PIXEL_PRESCALER), 
-                            n + (y * OUT_FILE_PIXEL_PRESCALER), 
-                            0, 0, 0xff);
-            }
+            dir = turns[t];
+            break;
           }
         }
+      } while (true);
+
+      /// start at a corner, so no straight run is split at the start point.
+      size_t n = path.size();
+      size_t first = 0;
+      while ((first < n) && (path[first] == path[(first + n - 1) % n]))
+        first++;
+
+      int x = start % side;
+      int y = start / side;
+      for (size_t i = 0; i < first; i++)
+      {
+        x += DX[path[i]];
+        y += DY[path[i]];
+      }
+
+      /// merge the unit edges into runs, which alternate horizontal and vertical.
+      std::vector<int> runs;
+      std::vector<int> runDirs;
+      for (size_t i = 0; i < n; i++)
+      {
+        int d = path[(first + i) % n];
+        if (runs.empty() || (runDirs.back() != d))
+        {
+          runs.push_back(0);
+          runDirs.push_back(d);
+        }
+        runs.back() += (d == 0 || d == 1) ? 1 : -1;
+      }
+
+      /// start with a horizontal run.
+      if ((runDirs[0] % 2) == 1)
+      {
+        y += runs[0];
+        runs.push_back(runs[0]);
+        runs.erase(runs.begin());
       }
+
+      outlines.push_back(x);
+      outlines.push_back(y);
+      outlines.push_back((int)runs.size());
+      outlines.insert(outlines.end(), runs.begin(), runs.end());
+    }
+  }
+}
+
+size_t QRCode::writeVector(const IMAGE_FORMAT &format, const std::vector<int> &outlines, uint8_t *buffer, int scale, int border) const
+{
+  switch(format)
+  {
+    case IF_SVG:  return(writeSvg(outlines, buffer, border));
+    case IF_EPS:  return(writeEps(outlines, buffer, scale, border));
+    case IF_PDF:  return(writePdf(outlines, buffer, scale, border));
+    default:      throw "Invalid image format";
+  }
+}
+
+size_t QRCode::writeSvg(const std::vector<int> &outlines, uint8_t *buffer, int border) const
+{
+  size_t pos = 0;
+  int lastX = 0;
+  int lastY = 0;
+
+  pos = appendText(buffer, pos, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+  pos = appendText(buffer, pos, "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n");
+  pos = appendText(buffer, pos, "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 ");
+  pos = appendNumber(buffer, pos, m_size + border * 2);
+  pos = appendText(buffer, pos, " ");
+  pos = appendNumber(buffer, pos, m_size + border * 2);
+  pos = appendText(buffer, pos, "\">\n");
+  pos = appendText(buffer, pos, "\t<rect width=\"100%\" height=\"100%\" fill=\"#FFFFFF\" stroke-width=\"0\"/>\n");
+  pos = appendText(buffer, pos, "\t<path d=\"");
+
+  /// after z the current point is the start of the outline, so the next
+  /// outline starts with a relative move. The last run is drawn by z.
+  for (size_t i = 0; i < outlines.size(); i += 3 + outlines[i + 2])
+  {
+    int x = outlines[i] + border;
+    int y = outlines[i + 1] + border;
+
+    pos = appendText(buffer, pos, (i == 0) ? "M" : "m");
+    pos = appendNumber(buffer, pos, x - lastX);
+    pos = appendText(buffer, pos, ",");
+    pos = appendNumber(buffer, pos, y - lastY);
+
+    for (int r = 0; r < outlines[i + 2] - 1; r++)
+    {
+      pos = appendText(buffer, pos, (r % 2 == 0) ? "h" : "v");
+      pos = appendNumber(buffer, pos, outlines[i + 3 + r]);
+    }
+
+    pos = appendText(buffer, pos, "z");
+    lastX = x;
+    lastY = y;
+  }
+
+  pos = appendText(buffer, pos, "\" fill=\"#000000\" stroke-width=\"0\"/>\n");
+  pos = appendText(buffer, pos, "</svg>\n");
+
+  return(pos);
+}
+
+size_t QRCode::writeEps(const std::vector<int> &outlines, uint8_t *buffer, int scale, int border) const
+{
+  size_t pos = 0;
+  int dimension = m_size + border * 2;
+  int lastX = 0;
+  int lastY = 0;
+
+  pos = appendText(buffer, pos, "%!PS-Adobe-3.0 EPSF-3.0\n");
+  pos = appendText(buffer, pos, "%%BoundingBox: 0 0 ");
+  pos = appendNumber(buffer, pos, dimension * scale);
+  pos = appendText(buffer, pos, " ");
+  pos = appendNumber(buffer, pos, dimension * scale);
+  pos = appendText(buffer, pos, "\n%%Pages: 0\n%%EndComments\n");
+
+  /// m: relative move, h/v: horizontal/vertical line, z: close outline.
+  /// Coordinates are in modules, y grows downwards like in the symbol.
+  pos = appendText(buffer, pos, "/m {rmoveto} bind def /h {0 rlineto} bind def\n");
+  pos = appendText(buffer, pos, "/v {0 exch rlineto} bind def /z {closepath} bind def\n");
+  pos = appendText(buffer, pos, "gsave\n");
+  pos = appendNumber(buffer, pos, scale);
+  pos = appendText(buffer, pos, " ");
+  pos = appendNumber(buffer, pos, scale);
+  pos = appendText(buffer, pos, " scale 0 ");
+  pos = appendNumber(buffer, pos, dimension);
+  pos = appendText(buffer, pos, " translate 1 -1 scale\n");
+  pos = appendText(buffer, pos, "1 setgray 0 0 ");
+  pos = appendNumber(buffer, pos, dimension);
+  pos = appendText(buffer, pos, " ");
+  pos = appendNumber(buffer, pos, dimension);
+  pos = appendText(buffer, pos, " rectfill 0 setgray\n");
+  pos = appendText(buffer, pos, "newpath 0 0 moveto\n");
+
+  for (size_t i = 0; i < outlines.size(); i += 3 + outlines[i + 2])
+  {
+    int x = outlines[i] + border;
+    int y = outlines[i + 1] + border;
+
+    pos = appendNumber(buffer, pos, x - lastX);
+    pos = appendText(buffer, pos, " ");
+    pos = appendNumber(buffer, pos, y - lastY);
+    pos = appendText(buffer, pos, " m");
+
+    for (int r = 0; r < outlines[i + 2] - 1; r++)
+    {
+      pos = appendText(buffer, pos, " ");
+      pos = appendNumber(buffer, pos, outlines[i + 3 + r]);
+      pos = appendText(buffer, pos, (r % 2 == 0) ? " h" : " v");
+    }
+
+    pos = appendText(buffer, pos, " z\n");
+    lastX = x;
+    lastY = y;
+  }
+
+  pos = appendText(buffer, pos, "fill\ngrestore\n%%EOF\n");
+
+  return(pos);
+}
+
+/// write the content stream of the PDF page, see writePdf().
+static size_t appendPdfContent(const std::vector<int> &outlines, uint8_t *buffer, size_t pos, int scale, int border, int dimension)
+{
+  /// module coordinates, y grows downwards like in the symbol.
+  pos = appendNumber(buffer, pos, scale);
+  pos = appendText(buffer, pos, " 0 0 -");
+  pos = appendNumber(buffer, pos, scale);
+  pos = appendText(buffer, pos, " 0 ");
+  pos = appendNumber(buffer, pos, dimension * scale);
+  pos = appendText(buffer, pos, " cm\n1 g 0 0 ");
+  pos = appendNumber(buffer, pos, dimension);
+  pos = appendText(buffer, pos, " ");
+  pos = appendNumber(buffer, pos, dimension);
+  pos = appendText(buffer, pos, " re f 0 g\n");
+
+  for (size_t i = 0; i < outlines.size(); i += 3 + outlines[i + 2])
+  {
+    int x = outlines[i] + border;
+    int y = outlines[i + 1] + border;
+
+    pos = appendNumber(buffer, pos, x);
+    pos = appendText(buffer, pos, " ");
+    pos = appendNumber(buffer, pos, y);
+    pos = appendText(buffer, pos, " m");
+
+    for (int r = 0; r < outlines[i + 2] - 1; r++)
+    {
+      if (r % 2 == 0)
+        x += outlines[i + 3 + r];
+      else
+        y += outlines[i + 3 + r];
+
+      pos = appendText(buffer, pos, " ");
+      pos = appendNumber(buffer, pos, x);
+      pos = appendText(buffer, pos, " ");
+      pos = appendNumber(buffer, pos, y);
+      pos = appendText(buffer, pos, " l");
     }
 
-    jpg.writeToFile(filename.c_str());
+    pos = appendText(buffer, pos, " h\n");
+  }
+
+  pos = appendText(buffer, pos, "f\n");
+
+  return(pos);
+}
+
+size_t QRCode::writePdf(const std::vector<int> &outlines, uint8_t *buffer, int scale, int border) const
+{
+  size_t pos = 0;
+  size_t offsets[5];
+  int dimension = m_size + border * 2;
+
+  /// length of the content stream goes before the stream itself.
+  size_t length = appendPdfContent(outlines, NULL, 0, scale, border, dimension);
+
+  pos = appendText(buffer, pos, "%PDF-1.4\n");
+
+  offsets[1] = pos;
+  pos = appendText(buffer, pos, "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+
+  offsets[2] = pos;
+  pos = appendText(buffer, pos, "2 0 obj\n<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n");
+
+  offsets[3] = pos;
+  pos = appendText(buffer, pos, "3 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 ");
+  pos = appendNumber(buffer, pos, dimension * scale);
+  pos = appendText(buffer, pos, " ");
+  pos = appendNumber(buffer, pos, dimension * scale);
+  pos = appendText(buffer, pos, "] /Resources << >> /Contents 4 0 R >>\nendobj\n");
+
+  offsets[4] = pos;
+  pos = appendText(buffer, pos, "4 0 obj\n<< /Length ");
+  pos = appendNumber(buffer, pos, (int)length);
+  pos = appendText(buffer, pos, " >>\nstream\n");
+  pos = appendPdfContent(outlines, buffer, pos, scale, border, dimension);
+  pos = appendText(buffer, pos, "endstream\nendobj\n");
+
+  /// cross reference entries are exactly 20 bytes.
+  size_t xref = pos;
+  pos = appendText(buffer, pos, "xref\n0 5\n0000000000 65535 f \n");
+  for (int i = 1; i < 5; i++)
+  {
+    pos = appendNumber(buffer, pos, (int)offsets[i], 10);
+    pos = appendText(buffer, pos, " 00000 n \n");
   }
+
+  pos = appendText(buffer, pos, "trailer\n<< /Size 5 /Root 1 0 R >>\nstartxref\n");
+  pos = appendNumber(buffer, pos, (int)xref);
+  pos = appendText(buffer, pos, "\n%%EOF\n");
+
+  return(pos);
 }
 
 std::vector<int> QRCode::getAlignmentPatternPositions(int version) 
@@ -372,7 +932,74 @@ int QRCode::getDataCodewordsCount(int version, const ECL &ecl)
   return (getRawDataModulesCount(version) / 8 - ERROR_CORRECTION_CODEWORDS[ecl][version]);
 }
 
+ui8vector QRCode::makeDataCodewords(const std::vector<QRSegment> &segs, const ECL &ecl, int &version, ECL &newEcl)
+{
+  // Find the minimal version number to use
+  int dataUsedBits;
+  for (version = MIN_VERSION; ; version++) 
+  {
+    int dataCapacityBits = getDataCodewordsCount(version, ecl) * 8;  // Number of data bits available
+
+    dataUsedBits = getTotalBits(segs, version);
+    if (dataUsedBits != -1 && dataUsedBits <= dataCapacityBits)
+      break;  // This version number is found to be suitable
+
+    if (version >= MAX_VERSION)  // All versions in the range could not fit the given data
+      throw "Data too long";
+  }
+
+  if (dataUsedBits == -1)
+    throw "Assertion error";
+
+  // Increase the error correction level while the data still fits in the current version number
+  newEcl = ecl;
+  //if (boostEcl) 
+  //{
+    if (dataUsedBits <= getDataCodewordsCount(version, ECL_M ) * 8)  newEcl = ECL_M;
+    if (dataUsedBits <= getDataCodewordsCount(version, ECL_Q ) * 8)  newEcl = ECL_Q;
+    if (dataUsedBits <= getDataCodewordsCount(version, ECL_H ) * 8)  newEcl = ECL_H;
+  //}
+
+  // Create the data bit string by concatenating all segments
+  int dataCapacityBits = getDataCodewordsCount(version, newEcl) * 8;
+  QRBitBuffer bits;
+  for (size_t i = 0; i < segs.size(); i++) 
+  {
+    const QRSegment &seg(segs.at(i));
+    bits.appendBits(seg.getMode(), 4);
+    bits.appendBits(seg.getInputSize(), seg.getCharCountIndicatorSize(version));
+    bits.appendData(seg);
+  }
+
+  // Add terminator and pad up to a byte if applicable
+  bits.appendBits(0, std::min(4, dataCapacityBits - bits.getBitLength()));
+  bits.appendBits(0, (8 - bits.getBitLength() % 8) % 8);
+
+  // Pad with alternate bytes until data capacity is reached
+  for (uint8_t padByte = 0xEC; bits.getBitLength() < dataCapacityBits; padByte ^= 0xEC ^ 0x11)
+    bits.appendBits(padByte, 8);
+
+  if (bits.getBitLength() % 8 != 0)
+    throw "Assertion error";  
+
+  return bits.getBytes();
+}
+
 void QRCode::makeQRCode(int version, const ECL &ecl, const ui8vector &dataCodewords, int mask) 
+{
+  // Check arguments
+  if ((mask < -1) || (mask > 7))
+    throw "Value out of range";
+
+  // Draw function patterns, draw all codewords, do masking
+  makeFunctionPatterns(version, ecl);
+
+  const ui8vector allCodewords(appendErrorCorrection(dataCodewords));
+  drawCodewords(allCodewords);
+  this->m_mask = handleConstructorMasking(mask);
+}
+
+void QRCode::makeFunctionPatterns(int version, const ECL &ecl)
 {
   // Initialize scalar fields
   this->m_version = version;
@@ -382,10 +1009,7 @@ void QRCode::makeQRCode(int version, const ECL &ecl, const ui8vector &dataCodewo
   this->m_isFunction.clear();
 
   // Check arguments
-  if (
-      (version < 1) || (version > 40) || 
-      (mask < -1) || (mask > 7)
-     )
+  if ((version < 1) || (version > 40))
     throw "Value out of range";
 
   std::vector<bool> row(m_size);
@@ -395,12 +1019,7 @@ void QRCode::makeQRCode(int version, const ECL &ecl, const ui8vector &dataCodewo
     m_isFunction.push_back(row);
   }
 
-  // Draw function patterns, draw all codewords, do masking
   drawFunctionPatterns();
-
-  const ui8vector allCodewords(appendErrorCorrection(dataCodewords));
-  drawCodewords(allCodewords);
-  this->m_mask = handleConstructorMasking(mask);
 }
 
 void QRCode::makeQRCode(const QRCode &qr, int mask)
@@ -545,6 +1164,34 @@ void QRCode::drawCodewords(const ui8vector &data)
     throw "Assertion error";
 }
 
+std::vector<int> QRCode::getCodewordModules() const
+{
+  const size_t count = (getRawDataModulesCount(m_version) / 8) * 8;
+  std::vector<int> modules;
+  modules.reserve(count);
+
+  // The zigzag scan of drawCodewords(), remainder bits left out
+  for (int right = m_size - 1; right >= 1; right -= 2) 
+  { 
+    if (right == 6)
+      right = 5;
+
+    for (int vert = 0; vert < m_size; vert++) 
+    {
+      for (int j = 0; j < 2; j++)
+      {
+        int x = right - j;
+        bool upwards = ((right & 2) == 0) ^ (x < 6);
+        int y = upwards ? m_size - 1 - vert : vert;
+        if (!m_isFunction[y][x] && modules.size() < count) 
+          modules.push_back(y * m_size + x);
+      }
+    }
+  }
+
+  return modules;
+}
+
 int QRCode::handleConstructorMasking(int mask)
 {
   if (mask == -1) 
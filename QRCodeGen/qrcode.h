@@ -11,11 +11,29 @@
 #include "qrbitbuffer.h"
 #include "qrsegment.h"
 #include "qrreedsolomongenerator.h"
+#include "qrbitmatrix.h"
+
+class Bitmap;
+namespace JPEG { class Jpeg; }
+namespace PNG { class Png; }
 
 namespace QR
 {
+  class QRDecoder;
+  class QRIncrementalEncoder;
+  class QRStages;
+
   class QRCode
   {
+    /// the decoder reads symbols with the same per-version tables and function pattern layout.
+    friend class QRDecoder;
+
+    /// the micro-benchmarks time every encoding stage on its own.
+    friend class QRStages;
+
+    /// the incremental encoder redraws the codewords of the blocks which changed only.
+    friend class QRIncrementalEncoder;
+
     public:
       QRCode();
       QRCode(const QRCode  &other);
@@ -25,9 +43,11 @@ namespace QR
 
       /// Member variable get method
       int getECLFormatBits();
-      int getTotalBits(const std::vector<QRSegment> &segs, int version);
+      static int getTotalBits(const std::vector<QRSegment> &segs, int version);
       int getMask() const;
       int getSize() const;
+      int getVersion() const;
+      ECL getECL() const;
 
       /* 
       * Returns the color of the module (pixel) at the given coordinates, which is either 0 for white or 1 for black. The top
@@ -42,6 +62,44 @@ namespace QR
       */
       std::string toSvgString(int border) const;
 
+      /** @brief get the modules of this QR Code symbol as packed bits.
+      *
+      *  @return QRBitMatrix the modules, one bit per module (1 = black).
+      */
+      QRBitMatrix toBitMatrix() const;
+
+      /** @brief set the modules of this QR Code symbol from packed bits.
+      *
+      *  The inverse of toBitMatrix(), so that a symbol kept packed (QRSymbolCache,
+      *  QRSymbolStore) can go through the image writers without encoding it again.
+      *
+      *  @param[in]   size the width and height of the symbol in modules, 21 to 177.
+      *  @param[in]   data size rows of (size + 7) / 8 bytes, in the layout of QRBitMatrix.
+      *  @param[in]   ecl the error correction level of the symbol.
+      *  @param[in]   mask the mask of the symbol, 0 to 7.
+      *
+      *  @return nothing.
+      */
+      void fromBitMatrix(int size, const uint8_t *data, const ECL &ecl, int mask);
+      void fromBitMatrix(const QRBitMatrix &matrix, const ECL &ecl, int mask);
+
+      /** @brief get the block structure of a version and error correction level.
+      *
+      *  The codewords are split into numBlocks blocks, the first numShortBlocks of them
+      *  hold shortDataLen data codewords, the others one more. Every block has blockEccLen
+      *  error correction codewords.
+      *
+      *  @param[in]   version the version, 1 to 40.
+      *  @param[in]   ecl the error correction level.
+      *  @param[out]  numBlocks the number of blocks.
+      *  @param[out]  numShortBlocks the number of blocks with shortDataLen data codewords.
+      *  @param[out]  shortDataLen the number of data codewords of a short block.
+      *  @param[out]  blockEccLen the number of error correction codewords of a block.
+      *
+      *  @return nothing.
+      */
+      static void getBlockStructure(int version, const ECL &ecl, int &numBlocks, int &numShortBlocks, int &shortDataLen, int &blockEccLen);
+
       /* 
       * Returns a QR Code symbol representing the given Unicode text string at the given error correction level.
       * As a conservative upper bound, this function is guaranteed to succeed for strings that have 738 or fewer Unicode
@@ -70,6 +128,51 @@ namespace QR
       void writeToBMP(const std::string &filename);
       void writeToPNG(const std::string &filename);
       void writeToJPEG(const std::string &filename);
+      void writeToSVG(const std::string &filename, int border = 4);
+      void writeToEPS(const std::string &filename, int scale = 8, int border = 4);
+      void writeToPDF(const std::string &filename, int scale = 8, int border = 4);
+
+      /** @brief get the exact size of the image in the given format.
+      *
+      *  BMP, PNG, SVG, EPS and PDF are written without compression, so their size is known
+      *  before encoding. Use it to size the buffer passed to encodeToBuffer().
+      *
+      *  @param[in]   format the image format.
+      *  @param[in]   scale the number of pixels (points for EPS and PDF) per module on each dimension (ignored for SVG).
+      *  @param[in]   border the number of white modules around the symbol.
+      *
+      *  @return size_t size of the image in bytes, 0 for JPEG (not known before encoding).
+      */
+      size_t getImageSize(const IMAGE_FORMAT &format, int scale = 8, int border = 0) const;
+
+      /** @brief encode this QR Code symbol as an image and append it to buffer.
+      *
+      *  Produce the same bytes as the writeTo*() methods, without touching the file system.
+      *
+      *  @param[in]   format the image format.
+      *  @param[out]  buffer the vector to append the image to.
+      *  @param[in]   scale the number of pixels (points for EPS and PDF) per module on each dimension (ignored for SVG).
+      *  @param[in]   border the number of white modules around the symbol.
+      *
+      *  @return size_t number of bytes appended.
+      */
+      size_t encodeToBuffer(const IMAGE_FORMAT &format, ui8vector &buffer, int scale = 8, int border = 0) const;
+
+      /** @brief encode this QR Code symbol as an image into the caller provided buffer.
+      *
+      *  BMP, PNG, SVG, EPS and PDF are encoded directly into buffer. JPEG is encoded
+      *  into a temporary vector first, as its size isn't known in advance.
+      *  Throws if capacity is too small for the image.
+      *
+      *  @param[in]   format the image format.
+      *  @param[out]  buffer the memory to write the image into.
+      *  @param[in]   capacity the size of buffer in bytes.
+      *  @param[in]   scale the number of pixels (points for EPS and PDF) per module on each dimension (ignored for SVG).
+      *  @param[in]   border the number of white modules around the symbol.
+      *
+      *  @return size_t number of bytes written.
+      */
+      size_t encodeToBuffer(const IMAGE_FORMAT &format, uint8_t *buffer, size_t capacity, int scale = 8, int border = 0) const;
 
     private:
       /* 
@@ -85,17 +188,22 @@ namespace QR
       // Returns a set of positions of the alignment patterns in ascending order. These positions are
       // used on both the x and y axes. Each value in the resulting array is in the range [0, 177).
       // This stateless pure function could be implemented as table of 40 variable-length lists of unsigned bytes.
-      std::vector<int> getAlignmentPatternPositions(int version);
+      static std::vector<int> getAlignmentPatternPositions(int version);
 
       // Returns the number of raw data modules (bits) available at the given version number.
       // These data modules are used for both user data codewords and error correction codewords.
       // This stateless pure function could be implemented as a 40-entry lookup table.
-      int getRawDataModulesCount(int version);
+      static int getRawDataModulesCount(int version);
 
       // Returns the number of 8-bit data (i.e. not error correction) codewords contained in any
       // QR Code of the given version number and error correction level, with remainder bits discarded.
       // This stateless pure function could be implemented as a (40*4)-cell lookup table.
-      int getDataCodewordsCount(int version, const ECL &ecl);
+      static int getDataCodewordsCount(int version, const ECL &ecl);
+
+      // Returns the data codewords of the segments (mode, character count, data, terminator and pad bytes)
+      // in the smallest version which fits them, and sets version and newEcl, the error correction level
+      // boosted as far as the data still fits in that version.
+      static ui8vector makeDataCodewords(const std::vector<QRSegment> &segs, const ECL &ecl, int &version, ECL &newEcl);
 
       // Sets the color of a module and marks it as a function module.
       // Only used by the constructor. Coordinates must be in range.
@@ -135,14 +243,39 @@ namespace QR
       // data area of this QR Code symbol. Function modules need to be marked off before this is called.
       void drawCodewords(const ui8vector &data);
 
+      // Returns the module (y * size + x) of every bit of the codewords, in the order drawCodewords() draws them.
+      std::vector<int> getCodewordModules() const;
+
       // A messy helper function for the constructors. This QR Code must be in an unmasked state when this
       // method is called. The given argument is the requested mask, which is -1 for auto or 0 to 7 for fixed.
       // This method applies and returns the actual mask chosen, from 0 to 7.
       int handleConstructorMasking(int mask);
 
+      // Initializes the scalar fields and blank grids of a version and error correction level,
+      // and draws the function patterns.
+      void makeFunctionPatterns(int version, const ECL &ecl);
+
       void makeQRCode(int version, const ECL &ecl, const ui8vector &dataCodewords, int mask);
       void makeQRCode(const QRCode &qr, int mask);
 
+      // Draw the modules (plus border) of this QR Code into the raster images,
+      // with scale * scale pixels per module. Images must already have the right size.
+      void rasterize(Bitmap &bmp, int scale, int border) const;
+      void rasterize(JPEG::Jpeg &jpg, int scale, int border) const;
+      void rasterize(PNG::Png &png, int scale, int border) const;
+
+      // Traces the outlines of the dark regions, with the dark side on the right (clockwise, y down).
+      // Each outline is stored as x, y of its first corner, the number of runs, then the signed
+      // run lengths, alternating horizontal and vertical and starting with a horizontal one.
+      void traceOutlines(std::vector<int> &outlines) const;
+
+      // Writes the outlines as a vector image into buffer (which must be big enough) and returns
+      // its size. With a NULL buffer only the size is computed.
+      size_t writeVector(const IMAGE_FORMAT &format, const std::vector<int> &outlines, uint8_t *buffer, int scale, int border) const;
+      size_t writeSvg(const std::vector<int> &outlines, uint8_t *buffer, int border) const;
+      size_t writeEps(const std::vector<int> &outlines, uint8_t *buffer, int scale, int border) const;
+      size_t writePdf(const std::vector<int> &outlines, uint8_t *buffer, int scale, int border) const;
+
     private:
       int m_version;    ///< Define version number for This QR Code symbol, which is always between 1 and 40 (inclusive).
       int m_size;       ///< Define the width and height of this QR Code symbol, measured in modules.
@@ -0,0 +1,476 @@
+#include "qrdecoder.h"
+#include "qrcode.h"
+#include "qrsegment.h"
+#include "qrreedsolomondecoder.h"
+
+using namespace QR;
+
+/// maximum number of wrong bits corrected in the format and version information.
+static const int MAX_INFO_ERRORS = 3;
+
+/// the 15 bit format information (BCH code, masked) of the 5 bit data, like QRCode::drawFormatBits().
+static int getFormatCode(int data)
+{
+  int rem = data;
+  for (int i = 0; i < 10; i++)
+    rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+
+  return(((data << 10) | rem) ^ 0x5412);
+}
+
+/// the 18 bit version information (BCH code) of the version, like QRCode::drawVersion().
+static int getVersionCode(int version)
+{
+  int rem = version;
+  for (int i = 0; i < 12; i++)
+    rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+
+  return((version << 12) | rem);
+}
+
+static int countBits(int value)
+{
+  int count = 0;
+
+  for (; value != 0; value &= value - 1)
+    count++;
+
+  return(count);
+}
+
+/// read length bits (MSB first) at bitPos of data and move bitPos after them.
+static int readBits(const ui8vector &data, size_t &bitPos, int length)
+{
+  if (bitPos + length > data.size() * 8)
+    throw "Segment data truncated";
+
+  int value = 0;
+  for (int i = 0; i < length; i++, bitPos++)
+    value = (value << 1) | ((data[bitPos >> 3] >> (7 - (bitPos & 7))) & 1);
+
+  return(value);
+}
+
+/// Default Constructor
+QRDecoder::QRDecoder()
+  :m_version(0),
+  m_ecl(ECL_L),
+  m_mask(-1),
+  m_corrections(0),
+  m_layouts(41)
+{
+}
+
+/// Copy Constructor
+QRDecoder::QRDecoder(const QRDecoder &other)
+  :m_version(other.m_version),
+  m_ecl(other.m_ecl),
+  m_mask(other.m_mask),
+  m_corrections(other.m_corrections),
+  m_layouts(other.m_layouts)
+{
+}
+
+/// Destructor
+QRDecoder::~QRDecoder()
+{
+}
+
+/// Assignment Operator
+QRDecoder& QRDecoder::operator=(const QRDecoder &other)
+{
+  if(this != &other)
+  {
+    m_version = other.m_version;
+    m_ecl = other.m_ecl;
+    m_mask = other.m_mask;
+    m_corrections = other.m_corrections;
+    m_layouts = other.m_layouts;
+  }
+
+  return(*this);
+}
+
+std::string QRDecoder::decode(const QRBitMatrix &matrix)
+{
+  int size = matrix.getSize();
+
+  if ((size < 21) || (size > 177) || ((size - 17) % 4 != 0))
+    throw "Invalid symbol size";
+
+  m_version = (size - 17) / 4;
+  readFormat(matrix);
+  readVersion(matrix);
+
+  ui8vector codewords;
+  ui8vector data;
+
+  m_corrections = 0;
+  readCodewords(matrix, getLayout(m_version), codewords);
+  deinterleave(codewords, data, m_corrections);
+
+  return(parseSegments(data));
+}
+
+int QRDecoder::getVersion() const
+{
+  return(m_version);
+}
+
+ECL QRDecoder::getECL() const
+{
+  return(m_ecl);
+}
+
+int QRDecoder::getMask() const
+{
+  return(m_mask);
+}
+
+int QRDecoder::getCorrectedCount() const
+{
+  return(m_corrections);
+}
+
+const QRDecoder::Layout& QRDecoder::getLayout(int version)
+{
+  Layout &layout = m_layouts[version];
+
+  if (!layout.m_positions.empty())
+    return(layout);
+
+  /// let the encoder draw the function patterns of this version.
+  QRCode qr;
+  qr.m_version = version;
+  qr.m_size = version * 4 + 17;
+  qr.m_modules.assign(qr.m_size, std::vector<bool>(qr.m_size));
+  qr.m_isFunction.assign(qr.m_size, std::vector<bool>(qr.m_size));
+  qr.drawFunctionPatterns();
+
+  /// same zigzag scan as QRCode::drawCodewords()
+  size_t count = (QRCode::getRawDataModulesCount(version) / 8) * 8;
+  layout.m_positions.reserve(count);
+
+  for (int right = qr.m_size - 1; right >= 1; right -= 2)
+  {
+    if (right == 6)
+      right = 5;
+
+    for (int vert = 0; vert < qr.m_size; vert++)
+    {
+      for (int j = 0; j < 2; j++)
+      {
+        int x = right - j;
+        bool upwards = ((right & 2) == 0) ^ (x < 6);
+        int y = upwards ? qr.m_size - 1 - vert : vert;
+
+        if (!qr.m_isFunction[y][x] && (layout.m_positions.size() < count))
+          layout.m_positions.push_back((uint16_t)((y << 8) | x));
+      }
+    }
+  }
+
+  if (layout.m_positions.size() != count)
+    throw "Assertion error";
+
+  /// on a light data area, applying a mask darkens exactly the modules it inverts.
+  layout.m_maskBits.assign(count, 0);
+
+  for (int mask = 0; mask < 8; mask++)
+  {
+    for (int y = 0; y < qr.m_size; y++)
+    {
+      for (int x = 0; x < qr.m_size; x++)
+      {
+        if (!qr.m_isFunction[y][x])
+          qr.m_modules[y][x] = false;
+      }
+    }
+
+    qr.applyMask(mask);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      if (qr.m_modules[layout.m_positions[i] >> 8][layout.m_positions[i] & 0xFF])
+        layout.m_maskBits[i] |= (uint8_t)(1 << mask);
+    }
+  }
+
+  return(layout);
+}
+
+void QRDecoder::readFormat(const QRBitMatrix &matrix)
+{
+  int size = matrix.getSize();
+  int first = 0;
+  int second = 0;
+
+  /// bit positions as drawn by QRCode::drawFormatBits()
+  for (int i = 0; i <= 5; i++)
+    first |= matrix.get(8, i) << i;
+
+  first |= matrix.get(8, 7) << 6;
+  first |= matrix.get(8, 8) << 7;
+  first |= matrix.get(7, 8) << 8;
+
+  for (int i = 9; i < 15; i++)
+    first |= matrix.get(14 - i, 8) << i;
+
+  for (int i = 0; i <= 7; i++)
+    second |= matrix.get(size - 1 - i, 8) << i;
+
+  for (int i = 8; i < 15; i++)
+    second |= matrix.get(8, size - 15 + i) << i;
+
+  /// the nearest of the 32 valid codes, to either copy.
+  int best = -1;
+  int bestDistance = MAX_INFO_ERRORS + 1;
+
+  for (int data = 0; data < 32; data++)
+  {
+    int code = getFormatCode(data);
+    int distance = std::min(countBits(code ^ first), countBits(code ^ second));
+
+    if (distance < bestDistance)
+    {
+      best = data;
+      bestDistance = distance;
+    }
+  }
+
+  if (best < 0)
+    throw "Format information unreadable";
+
+  /// inverse of QRCode::getECLFormatBits()
+  const ECL formatBitsECL[] = {ECL_M, ECL_L, ECL_H, ECL_Q};
+
+  m_ecl = formatBitsECL[best >> 3];
+  m_mask = best & 7;
+}
+
+void QRDecoder::readVersion(const QRBitMatrix &matrix)
+{
+  if (m_version < 7)
+    return;
+
+  int size = matrix.getSize();
+  int first = 0;
+  int second = 0;
+
+  /// bit positions as drawn by QRCode::drawVersion()
+  for (int i = 0; i < 18; i++)
+  {
+    int a = size - 11 + i % 3;
+    int b = i / 3;
+
+    first |= matrix.get(a, b) << i;
+    second |= matrix.get(b, a) << i;
+  }
+
+  int best = -1;
+  int bestDistance = MAX_INFO_ERRORS + 1;
+
+  for (int version = 7; version <= 40; version++)
+  {
+    int code = getVersionCode(version);
+    int distance = std::min(countBits(code ^ first), countBits(code ^ second));
+
+    if (distance < bestDistance)
+    {
+      best = version;
+      bestDistance = distance;
+    }
+  }
+
+  /// the size of a module matrix is exact, so it wins over unreadable version information,
+  /// but readable information has to agree with it.
+  if ((best > 0) && (best != m_version))
+    throw "Version information doesn't match the symbol size";
+}
+
+void QRDecoder::readCodewords(const QRBitMatrix &matrix, const Layout &layout, ui8vector &codewords) const
+{
+  const uint8_t *rows = matrix.getData();
+  const int stride = matrix.getStride();
+  const size_t count = layout.m_positions.size();
+
+  codewords.assign(count / 8, 0);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    int x = layout.m_positions[i] & 0xFF;
+    int y = layout.m_positions[i] >> 8;
+    int bit = ((rows[(y * stride) + (x >> 3)] >> (7 - (x & 7))) ^ (layout.m_maskBits[i] >> m_mask)) & 1;
+
+    codewords[i >> 3] |= (uint8_t)(bit << (7 - (i & 7)));
+  }
+}
+
+void QRDecoder::deinterleave(const ui8vector &codewords, ui8vector &data, int &corrections) const
+{
+  int numBlocks, numShortBlocks, shortDataLen, blockEccLen;
+  QRCode::getBlockStructure(m_version, m_ecl, numBlocks, numShortBlocks, shortDataLen, blockEccLen);
+
+  int shortBlockLen = shortDataLen + blockEccLen;
+
+  /// every block gets shortBlockLen + 1 bytes, short blocks keep a dummy byte
+  /// at shortDataLen, which isn't in the interleaved sequence.
+  std::vector<ui8vector> blocks(numBlocks, ui8vector(shortBlockLen + 1));
+  size_t k = 0;
+
+  for (int i = 0; i <= shortBlockLen; i++)
+  {
+    for (int j = 0; j < numBlocks; j++)
+    {
+      if ((i != shortDataLen) || (j >= numShortBlocks))
+        blocks[j][i] = codewords.at(k++);
+    }
+  }
+
+  if (k != codewords.size())
+    throw "Assertion error";
+
+  const QRReedSolomonDecoder rs(blockEccLen);
+
+  data.clear();
+  data.reserve(QRCode::getDataCodewordsCount(m_version, m_ecl));
+
+  for (int j = 0; j < numBlocks; j++)
+  {
+    ui8vector &block = blocks[j];
+
+    if (j < numShortBlocks)
+      block.erase(block.begin() + shortDataLen);
+
+    corrections += rs.decode(block);
+    data.insert(data.end(), block.begin(), block.end() - blockEccLen);
+  }
+}
+
+std::string QRDecoder::parseSegments(const ui8vector &data) const
+{
+  const char ALPHANUMERIC_CHARSET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+  std::string result;
+  size_t bitPos = 0;
+
+  /// a terminator shorter than 4 bits is allowed at the end of the data.
+  while (bitPos + 4 <= data.size() * 8)
+  {
+    int mode = readBits(data, bitPos, 4);
+
+    if (mode == 0)
+      break;
+
+    int count = 0;
+    int ccbits = QRSegment::getCharCountIndicatorSize((DATA_MODE)mode, m_version);
+
+    if (ccbits > 0)
+      count = readBits(data, bitPos, ccbits);
+
+    switch (mode)
+    {
+      case DM_NUM:
+      {
+        for (; count >= 3; count -= 3)
+        {
+          int value = readBits(data, bitPos, 10);
+          if (value > 999)
+            throw "Invalid numeric data";
+
+          result += (char)('0' + value / 100);
+          result += (char)('0' + value / 10 % 10);
+          result += (char)('0' + value % 10);
+        }
+
+        if (count == 2)
+        {
+          int value = readBits(data, bitPos, 7);
+          if (value > 99)
+            throw "Invalid numeric data";
+
+          result += (char)('0' + value / 10);
+          result += (char)('0' + value % 10);
+        }
+        else if (count == 1)
+        {
+          int value = readBits(data, bitPos, 4);
+          if (value > 9)
+            throw "Invalid numeric data";
+
+          result += (char)('0' + value);
+        }
+        break;
+      }
+
+      case DM_AN:
+      {
+        for (; count >= 2; count -= 2)
+        {
+          int value = readBits(data, bitPos, 11);
+          if (value >= 45 * 45)
+            throw "Invalid alphanumeric data";
+
+          result += ALPHANUMERIC_CHARSET[value / 45];
+          result += ALPHANUMERIC_CHARSET[value % 45];
+        }
+
+        if (count == 1)
+        {
+          int value = readBits(data, bitPos, 6);
+          if (value >= 45)
+            throw "Invalid alphanumeric data";
+
+          result += ALPHANUMERIC_CHARSET[value];
+        }
+        break;
+      }
+
+      case DM_8:
+      {
+        for (; count > 0; count--)
+          result += (char)readBits(data, bitPos, 8);
+        break;
+      }
+
+      case DM_KANJI:
+      {
+        /// 13 bits per character, back to Shift JIS
+        for (; count > 0; count--)
+        {
+          int value = readBits(data, bitPos, 13);
+          int code = ((value / 0xC0) << 8) | (value % 0xC0);
+
+          code += (code < 0x1F00) ? 0x8140 : 0xC140;
+          result += (char)(code >> 8);
+          result += (char)(code & 0xFF);
+        }
+        break;
+      }
+
+      case 7:   // ECI, designator of 1, 2 or 3 bytes
+      {
+        int first = readBits(data, bitPos, 8);
+
+        if ((first & 0x80) == 0x80)
+          readBits(data, bitPos, ((first & 0xC0) == 0x80) ? 8 : 16);
+        break;
+      }
+
+      case 3:   // structured append, symbol position and parity
+        readBits(data, bitPos, 16);
+        break;
+
+      case 5:   // FNC1 first position
+        break;
+
+      case 9:   // FNC1 second position, application indicator
+        readBits(data, bitPos, 8);
+        break;
+
+      default:
+        throw "Invalid segment mode";
+    }
+  }
+
+  return(result);
+}
@@ -0,0 +1,115 @@
+/**
+*  @file    qrdecoder.h
+*  @brief   class to read the payload back from a QR Code symbol.
+*
+*  QRDecoder takes the modules of a symbol (QRBitMatrix) and undoes every
+*  step of QRCode::encode(): it reads the format and version information
+*  (correcting up to 3 wrong bits), removes the mask, collects the
+*  codewords in the zigzag order, de-interleaves the blocks, corrects them
+*  with their error correction codewords and parses the segments.
+*  The positions of the codeword bits and the mask patterns only depend
+*  on the version, so they are computed once per version (from the
+*  encoder's own function pattern and mask code) and reused.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRDECODER_H
+#define QRDECODER_H
+
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrbitmatrix.h"
+
+namespace QR
+{
+  //!  @class  QRDecoder
+  /*!
+    Decodes QR Code symbols given as module matrices. Throws a string literal when
+    the matrix isn't a readable symbol. The per-version tables are cached in the object,
+    so keep one decoder around (one per thread) when decoding many symbols.
+  */
+  class QRDecoder
+  {
+    public:
+      /// Default Constructor
+      QRDecoder();
+
+      /// Copy Constructor
+      QRDecoder(const QRDecoder &other);
+
+      /// Destructor
+      ~QRDecoder();
+
+      /// Assignment Operator
+      QRDecoder& operator=(const QRDecoder &other);
+
+      /** @brief decode a QR Code symbol.
+      *
+      *  The matrix must hold exactly the symbol, without quiet zone.
+      *  Numeric and alphanumeric segments are returned as text, byte segments as they are,
+      *  kanji segments as Shift JIS. ECI, FNC1 and structured append headers are skipped.
+      *
+      *  @param[in]   matrix the modules of the symbol.
+      *
+      *  @return std::string the payload.
+      */
+      std::string decode(const QRBitMatrix &matrix);
+
+      /// version of the last decoded symbol.
+      int getVersion() const;
+
+      /// error correction level of the last decoded symbol.
+      ECL getECL() const;
+
+      /// mask of the last decoded symbol.
+      int getMask() const;
+
+      /// number of codewords the error correction fixed in the last decoded symbol.
+      int getCorrectedCount() const;
+
+    private:
+      //!  @struct  Layout
+      /*!
+        Data area of a version, in the order the codeword bits are drawn.
+      */
+      struct Layout
+      {
+        std::vector<uint16_t> m_positions;  ///< Define y << 8 | x of every codeword bit (remainder bits excluded).
+        ui8vector             m_maskBits;   ///< Define for every codeword bit, bit m is set if mask m inverts its module.
+      };
+
+      // Returns the layout of the given version, building it on first use.
+      const Layout& getLayout(int version);
+
+      // Reads both copies of the format information, sets m_ecl and m_mask.
+      void readFormat(const QRBitMatrix &matrix);
+
+      // Reads both copies of the version information (version 7 and up) and checks them against the size.
+      void readVersion(const QRBitMatrix &matrix);
+
+      // Reads and unmasks all the codewords, in the order they are drawn (interleaved).
+      void readCodewords(const QRBitMatrix &matrix, const Layout &layout, ui8vector &codewords) const;
+
+      // Splits the codewords into blocks, corrects them with their error correction codewords and
+      // returns the data codewords of all the blocks, in order, and the number of corrected codewords.
+      void deinterleave(const ui8vector &codewords, ui8vector &data, int &corrections) const;
+
+      // Parses the segments of the data codewords.
+      std::string parseSegments(const ui8vector &data) const;
+
+    private:
+      int                 m_version;      ///< Define version of the last decoded symbol.
+      ECL                 m_ecl;          ///< Define error correction level of the last decoded symbol.
+      int                 m_mask;         ///< Define mask of the last decoded symbol.
+      int                 m_corrections;  ///< Define number of corrected codewords of the last decoded symbol.
+      std::vector<Layout> m_layouts;      ///< Define layout of every version, index 0 is unused, empty ones aren't built yet.
+  };
+}
+
+#endif    // QRDECODER_H
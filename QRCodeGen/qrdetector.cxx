@@ -0,0 +1,751 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "qrdetector.h"
+#include "qrperspectivetransform.h"
+#include "bitmap.h"
+
+using namespace QR;
+
+/// side of the binarization blocks, in pixels.
+static const int BLOCK_SIZE = 8;
+
+/// blocks with less contrast than this are taken as uniform.
+static const int MIN_DYNAMIC_RANGE = 24;
+
+/// number of modules of the largest symbol, the rows scanned for finder patterns are picked
+/// so that a finder pattern of that symbol filling 3/4 of the image height is crossed 3 times.
+static const int MAX_MODULES = 177;
+
+/// most candidates considered when choosing the three finder patterns.
+static const size_t MAX_CANDIDATES = 12;
+
+/// worst score (see scoreTriplet()) of three finder patterns taken as a symbol.
+static const double MAX_TRIPLET_SCORE = 0.5;
+
+/// Default Constructor
+QRDetector::QRDetector()
+  :m_width(0),
+  m_height(0),
+  m_binary(),
+  m_blockLevels(),
+  m_runs(),
+  m_candidates()
+{
+  std::fill(m_points, m_points + 8, 0.0);
+}
+
+/// Copy Constructor
+QRDetector::QRDetector(const QRDetector &other)
+  :m_width(other.m_width),
+  m_height(other.m_height),
+  m_binary(other.m_binary),
+  m_blockLevels(other.m_blockLevels),
+  m_runs(other.m_runs),
+  m_candidates(other.m_candidates)
+{
+  std::copy(other.m_points, other.m_points + 8, m_points);
+}
+
+/// Destructor
+QRDetector::~QRDetector()
+{
+}
+
+/// Assignment Operator
+QRDetector& QRDetector::operator=(const QRDetector &other)
+{
+  if(this != &other)
+  {
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_binary = other.m_binary;
+    m_blockLevels = other.m_blockLevels;
+    m_runs = other.m_runs;
+    m_candidates = other.m_candidates;
+    std::copy(other.m_points, other.m_points + 8, m_points);
+  }
+
+  return(*this);
+}
+
+bool QRDetector::detect(const unsigned char *gray, int width, int height, int stride, QRBitMatrix &matrix)
+{
+  if (!binarize(gray, width, height, stride))
+    return(false);
+
+  findFinderPatterns();
+
+  QRFinderPattern patterns[3];
+  if (!selectFinderPatterns(m_candidates, patterns))
+    return(false);
+
+  return(sampleSymbol(patterns, matrix, m_points));
+}
+
+bool QRDetector::detect(const Bitmap &bmp, QRBitMatrix &matrix)
+{
+  std::vector<unsigned char> gray;
+  bmp.getGrayscale(gray);
+
+  if (gray.empty())
+    return(false);
+
+  return(detect(&gray[0], bmp.getWidth(), bmp.getHeight(), bmp.getWidth(), matrix));
+}
+
+const std::vector<uint8_t>& QRDetector::getBinaryImage() const
+{
+  return(m_binary);
+}
+
+const std::vector<QRFinderPattern>& QRDetector::getFinderCandidates() const
+{
+  return(m_candidates);
+}
+
+void QRDetector::getPoints(double points[8]) const
+{
+  std::copy(m_points, m_points + 8, points);
+}
+
+bool QRDetector::binarize(const unsigned char *gray, int width, int height, int stride)
+{
+  if (!startBinarize(gray, width, height, stride))
+    return(false);
+
+  const int blockRows = getBlockRowCount();
+
+  measureBlocks(gray, stride, 0, blockRows);
+  resolveUniformBlocks();
+  thresholdBlocks(gray, stride, 0, blockRows);
+
+  return(true);
+}
+
+bool QRDetector::startBinarize(const unsigned char *gray, int width, int height, int stride)
+{
+  if ((gray == NULL) || (width < BLOCK_SIZE) || (height < BLOCK_SIZE) || (stride < width))
+    return(false);
+
+  m_width = width;
+  m_height = height;
+  m_binary.resize(width * height);
+  m_blockLevels.resize(((width + BLOCK_SIZE - 1) / BLOCK_SIZE) * getBlockRowCount());
+
+  return(true);
+}
+
+int QRDetector::getBlockRowCount() const
+{
+  return((m_height + BLOCK_SIZE - 1) / BLOCK_SIZE);
+}
+
+void QRDetector::measureBlocks(const unsigned char *gray, int stride, int first, int last)
+{
+  const int subWidth = (m_width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+  /// black point of every block. The last row and column of blocks overlap
+  /// the previous ones, so every block is a full 8x8 one.
+  for (int by = first; by < last; by++)
+  {
+    const int yoffset = std::min(by * BLOCK_SIZE, m_height - BLOCK_SIZE);
+
+    for (int bx = 0; bx < subWidth; bx++)
+    {
+      const int xoffset = std::min(bx * BLOCK_SIZE, m_width - BLOCK_SIZE);
+      int sum = 0;
+      int minimum = 0xff;
+      int maximum = 0;
+
+      for (int yy = 0; yy < BLOCK_SIZE; yy++)
+      {
+        const unsigned char *row = gray + ((yoffset + yy) * stride) + xoffset;
+
+        for (int xx = 0; xx < BLOCK_SIZE; xx++)
+        {
+          sum += row[xx];
+          minimum = std::min(minimum, (int)row[xx]);
+          maximum = std::max(maximum, (int)row[xx]);
+        }
+      }
+
+      /// a uniform block depends on its neighbours, it is marked with its minimum.
+      m_blockLevels[(by * subWidth) + bx] = (maximum - minimum <= MIN_DYNAMIC_RANGE) ? -(minimum + 1) : (sum / (BLOCK_SIZE * BLOCK_SIZE));
+    }
+  }
+}
+
+void QRDetector::resolveUniformBlocks()
+{
+  const int subWidth = (m_width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  const int subHeight = getBlockRowCount();
+
+  for (int by = 0; by < subHeight; by++)
+  {
+    for (int bx = 0; bx < subWidth; bx++)
+    {
+      int &level = m_blockLevels[(by * subWidth) + bx];
+      if (level >= 0)
+        continue;
+
+      /// a uniform block is taken as light, unless it is darker than
+      /// its neighbours (inside a large dark module).
+      const int minimum = -level - 1;
+      level = minimum / 2;
+
+      if ((by > 0) && (bx > 0))
+      {
+        int neighbours = (m_blockLevels[((by - 1) * subWidth) + bx] + (2 * m_blockLevels[(by * subWidth) + bx - 1]) +
+                          m_blockLevels[((by - 1) * subWidth) + bx - 1]) / 4;
+
+        if (minimum < neighbours)
+          level = neighbours;
+      }
+    }
+  }
+}
+
+void QRDetector::thresholdBlocks(const unsigned char *gray, int stride, int first, int last)
+{
+  const int subWidth = (m_width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  const int subHeight = getBlockRowCount();
+
+  /// threshold every block at the mean black point of the 5x5 blocks around it.
+  for (int by = first; by < last; by++)
+  {
+    const int yoffset = std::min(by * BLOCK_SIZE, m_height - BLOCK_SIZE);
+    const int top = std::max(0, by - 2);
+    const int bottom = std::min(subHeight - 1, by + 2);
+
+    for (int bx = 0; bx < subWidth; bx++)
+    {
+      const int xoffset = std::min(bx * BLOCK_SIZE, m_width - BLOCK_SIZE);
+      const int left = std::max(0, bx - 2);
+      const int right = std::min(subWidth - 1, bx + 2);
+      int sum = 0;
+
+      for (int y = top; y <= bottom; y++)
+      {
+        for (int x = left; x <= right; x++)
+          sum += m_blockLevels[(y * subWidth) + x];
+      }
+
+      const unsigned char threshold = (unsigned char)(sum / ((bottom - top + 1) * (right - left + 1)));
+
+      for (int yy = 0; yy < BLOCK_SIZE; yy++)
+      {
+        const unsigned char *s = gray + ((yoffset + yy) * stride) + xoffset;
+        uint8_t *d = &m_binary[((yoffset + yy) * m_width) + xoffset];
+
+        for (int xx = 0; xx < BLOCK_SIZE; xx++)
+          d[xx] = (uint8_t)(s[xx] <= threshold);
+      }
+    }
+  }
+}
+
+int QRDetector::getRuns(const uint8_t *row, int length, std::vector<int> &runs)
+{
+  runs.clear();
+
+  int start = 0;
+  int x = 1;
+
+  while (x < length)
+  {
+    /// no color change in the next 8 pixels: compare them with the same pixels shifted by one.
+    if (x + 8 <= length)
+    {
+      unsigned long long current, previous;
+      memcpy(&current, row + x, 8);
+      memcpy(&previous, row + x - 1, 8);
+
+      if (current == previous)
+      {
+        x += 8;
+        continue;
+      }
+    }
+
+    if (row[x] != row[x - 1])
+    {
+      runs.push_back(x - start);
+      start = x;
+    }
+
+    x++;
+  }
+
+  runs.push_back(length - start);
+
+  return(row[0]);
+}
+
+bool QRDetector::isFinderRatio(const int counts[5])
+{
+  int total = counts[0] + counts[1] + counts[2] + counts[3] + counts[4];
+
+  if (total < 7)
+    return(false);
+
+  /// every module within half a module of the expected size (3/2 of it for the center).
+  double moduleSize = total / 7.0;
+  double maxVariance = moduleSize / 2.0;
+
+  return((std::fabs(moduleSize - counts[0]) < maxVariance) &&
+         (std::fabs(moduleSize - counts[1]) < maxVariance) &&
+         (std::fabs((3.0 * moduleSize) - counts[2]) < (3.0 * maxVariance)) &&
+         (std::fabs(moduleSize - counts[3]) < maxVariance) &&
+         (std::fabs(moduleSize - counts[4]) < maxVariance));
+}
+
+bool QRDetector::isDark(int x, int y) const
+{
+  if ((x < 0) || (y < 0) || (x >= m_width) || (y >= m_height))
+    return(false);
+
+  return(m_binary[(y * m_width) + x] != 0);
+}
+
+double QRDetector::crossCheck(int x, int y, bool vertical, int maxCount, int originalTotal) const
+{
+  const int dx = vertical ? 0 : 1;
+  const int dy = vertical ? 1 : 0;
+  const int limit = vertical ? m_height : m_width;
+  int counts[5] = {0, 0, 0, 0, 0};
+  int i = vertical ? y : x;
+
+  /// walk back from the center: dark, light, dark.
+  while ((i >= 0) && isDark(x + dx * (i - x), y + dy * (i - y)))
+  {
+    counts[2]++;
+    i--;
+  }
+
+  if (i < 0)
+    return(-1.0);
+
+  while ((i >= 0) && !isDark(x + dx * (i - x), y + dy * (i - y)) && (counts[1] <= maxCount))
+  {
+    counts[1]++;
+    i--;
+  }
+
+  if ((i < 0) || (counts[1] > maxCount))
+    return(-1.0);
+
+  while ((i >= 0) && isDark(x + dx * (i - x), y + dy * (i - y)) && (counts[0] <= maxCount))
+  {
+    counts[0]++;
+    i--;
+  }
+
+  if (counts[0] > maxCount)
+    return(-1.0);
+
+  /// and forward: dark, light, dark.
+  i = (vertical ? y : x) + 1;
+
+  while ((i < limit) && isDark(x + dx * (i - x), y + dy * (i - y)))
+  {
+    counts[2]++;
+    i++;
+  }
+
+  if (i == limit)
+    return(-1.0);
+
+  while ((i < limit) && !isDark(x + dx * (i - x), y + dy * (i - y)) && (counts[3] < maxCount))
+  {
+    counts[3]++;
+    i++;
+  }
+
+  if ((i == limit) || (counts[3] >= maxCount))
+    return(-1.0);
+
+  while ((i < limit) && isDark(x + dx * (i - x), y + dy * (i - y)) && (counts[4] < maxCount))
+  {
+    counts[4]++;
+    i++;
+  }
+
+  if (counts[4] >= maxCount)
+    return(-1.0);
+
+  /// the size along this line must be about the same as along the scanned row.
+  int total = counts[0] + counts[1] + counts[2] + counts[3] + counts[4];
+
+  if ((5 * std::abs(total - originalTotal) >= 2 * originalTotal) || !isFinderRatio(counts))
+    return(-1.0);
+
+  return((i - counts[4] - counts[3]) - (counts[2] / 2.0));
+}
+
+void QRDetector::handlePossibleCenter(const int counts[5], double centerX, int y, std::vector<QRFinderPattern> &candidates) const
+{
+  int total = counts[0] + counts[1] + counts[2] + counts[3] + counts[4];
+
+  double centerY = crossCheck((int)centerX, y, true, counts[2], total);
+  if (centerY < 0.0)
+    return;
+
+  centerX = crossCheck((int)centerX, (int)centerY, false, counts[2], total);
+  if (centerX < 0.0)
+    return;
+
+  QRFinderPattern pattern = {centerX, centerY, total / 7.0, 1};
+  mergeCandidate(pattern, candidates);
+}
+
+void QRDetector::mergeCandidate(const QRFinderPattern &pattern, std::vector<QRFinderPattern> &candidates)
+{
+  /// the same pattern is crossed by several scanned rows, merge them.
+  for (size_t i = 0; i < candidates.size(); i++)
+  {
+    QRFinderPattern &c = candidates[i];
+
+    if ((std::fabs(c.m_x - pattern.m_x) <= pattern.m_moduleSize) && (std::fabs(c.m_y - pattern.m_y) <= pattern.m_moduleSize) &&
+        (std::fabs(c.m_moduleSize - pattern.m_moduleSize) <= std::max(1.0, c.m_moduleSize / 2.0)))
+    {
+      const int count = c.m_count + pattern.m_count;
+
+      c.m_x = ((c.m_count * c.m_x) + (pattern.m_count * pattern.m_x)) / count;
+      c.m_y = ((c.m_count * c.m_y) + (pattern.m_count * pattern.m_y)) / count;
+      c.m_moduleSize = ((c.m_count * c.m_moduleSize) + (pattern.m_count * pattern.m_moduleSize)) / count;
+      c.m_count = count;
+      return;
+    }
+  }
+
+  candidates.push_back(pattern);
+}
+
+static bool byCount(const QRFinderPattern &a, const QRFinderPattern &b)
+{
+  return(a.m_count > b.m_count);
+}
+
+void QRDetector::findFinderPatterns(int step)
+{
+  if (step <= 0)
+    step = std::max(1, (3 * m_height) / (4 * MAX_MODULES));
+
+  m_candidates.clear();
+  scanRows(step - 1, m_height, step, m_runs, m_candidates);
+  sortCandidates();
+}
+
+void QRDetector::scanRows(int first, int last, int step, std::vector<int> &runs, std::vector<QRFinderPattern> &candidates) const
+{
+  for (int y = first; y < last; y += step)
+  {
+    int color = getRuns(&m_binary[y * m_width], m_width, runs);
+    const int numRuns = (int)runs.size();
+    int start = 0;
+
+    /// the first dark run, then every other run.
+    int firstRun = (color == 1) ? 0 : 1;
+    for (int i = 0; i < firstRun && i < numRuns; i++)
+      start += runs[i];
+
+    for (int i = firstRun; i + 4 < numRuns; i += 2)
+    {
+      const int *counts = &runs[i];
+
+      if (isFinderRatio(counts))
+      {
+        double centerX = start + counts[0] + counts[1] + (counts[2] / 2.0);
+        handlePossibleCenter(counts, centerX, y, candidates);
+      }
+
+      start += runs[i] + runs[i + 1];
+    }
+  }
+}
+
+void QRDetector::sortCandidates()
+{
+  std::stable_sort(m_candidates.begin(), m_candidates.end(), byCount);
+}
+
+static double squaredDistance(const QRFinderPattern &a, const QRFinderPattern &b)
+{
+  return(((a.m_x - b.m_x) * (a.m_x - b.m_x)) + ((a.m_y - b.m_y) * (a.m_y - b.m_y)));
+}
+
+double QRDetector::scoreTriplet(const QRFinderPattern &first, const QRFinderPattern &second, const QRFinderPattern &third,
+                                QRFinderPattern ordered[3])
+{
+  const QRFinderPattern *p[3] = {&first, &second, &third};
+  double minSize = std::min(p[0]->m_moduleSize, std::min(p[1]->m_moduleSize, p[2]->m_moduleSize));
+  double maxSize = std::max(p[0]->m_moduleSize, std::max(p[1]->m_moduleSize, p[2]->m_moduleSize));
+
+  if (maxSize > 1.4 * minSize)
+    return(-1.0);
+
+  /// the top-left pattern is opposite the longest side.
+  double d[3] = {squaredDistance(*p[1], *p[2]), squaredDistance(*p[0], *p[2]), squaredDistance(*p[0], *p[1])};
+  int corner = (d[0] >= d[1]) ? ((d[0] >= d[2]) ? 0 : 2) : ((d[1] >= d[2]) ? 1 : 2);
+  double hypotenuse = d[corner];
+  double a = d[(corner + 1) % 3];
+  double b = d[(corner + 2) % 3];
+  double moduleSize = (p[0]->m_moduleSize + p[1]->m_moduleSize + p[2]->m_moduleSize) / 3.0;
+
+  /// the smallest symbol has its finder centers 14 modules apart (the module size
+  /// of a rotated symbol is overestimated up to sqrt(2) times, hence 10).
+  if (std::min(a, b) < (10.0 * moduleSize) * (10.0 * moduleSize))
+    return(-1.0);
+
+  ordered[1] = *p[corner];
+  ordered[0] = *p[(corner + 1) % 3];
+  ordered[2] = *p[(corner + 2) % 3];
+
+  /// order the other two so that the top-right one is clockwise from the top-left one (y grows downwards).
+  double cross = ((ordered[2].m_x - ordered[1].m_x) * (ordered[0].m_y - ordered[1].m_y)) -
+                 ((ordered[2].m_y - ordered[1].m_y) * (ordered[0].m_x - ordered[1].m_x));
+
+  if (cross < 0.0)
+    std::swap(ordered[0], ordered[2]);
+
+  return((std::fabs(hypotenuse - (a + b)) / hypotenuse) + (std::fabs(a - b) / std::max(a, b)) +
+         ((maxSize - minSize) / maxSize));
+}
+
+bool QRDetector::selectFinderPatterns(const std::vector<QRFinderPattern> &candidates, QRFinderPattern patterns[3]) const
+{
+  const size_t n = std::min(candidates.size(), MAX_CANDIDATES);
+  double bestScore = 1e9;
+  QRFinderPattern ordered[3];
+
+  for (size_t i = 0; i < n; i++)
+  {
+    for (size_t j = i + 1; j < n; j++)
+    {
+      for (size_t k = j + 1; k < n; k++)
+      {
+        double score = scoreTriplet(candidates[i], candidates[j], candidates[k], ordered);
+
+        if ((score >= 0.0) && (score < bestScore))
+        {
+          bestScore = score;
+          std::copy(ordered, ordered + 3, patterns);
+        }
+      }
+    }
+  }
+
+  /// far from a right isosceles triangle, even after perspective.
+  return(bestScore <= MAX_TRIPLET_SCORE);
+}
+
+bool QRDetector::findAlignmentPattern(double moduleSize, double &x, double &y) const
+{
+  const double estimateX = x;
+  const double estimateY = y;
+  const int maxCount = (int)(moduleSize * 2.0 + 1.0);
+  std::vector<int> runs;
+
+  /// search wider and wider areas around the estimate.
+  for (int allowance = 4; allowance <= 16; allowance <<= 1)
+  {
+    int radius = (int)(allowance * moduleSize);
+    int left = std::max(0, (int)estimateX - radius);
+    int right = std::min(m_width - 1, (int)estimateX + radius);
+    int top = std::max(0, (int)estimateY - radius);
+    int bottom = std::min(m_height - 1, (int)estimateY + radius);
+    double bestDistance = -1.0;
+
+    if ((right - left < 3 * moduleSize) || (bottom - top < 3 * moduleSize))
+      return(false);
+
+    for (int row = top; row <= bottom; row++)
+    {
+      int color = getRuns(&m_binary[(row * m_width) + left], right - left + 1, runs);
+      int start = left;
+
+      /// light, dark, light runs of one module each. The runs at the ends of the area are cut.
+      for (int i = 0; i + 2 < (int)runs.size(); i++)
+      {
+        bool centerDark = (((i + 1) % 2 == 0) == (color == 1));
+
+        if (centerDark && (i > 0) &&
+            (std::fabs(runs[i] - moduleSize) < moduleSize / 2.0) &&
+            (std::fabs(runs[i + 1] - moduleSize) < moduleSize / 2.0) &&
+            (std::fabs(runs[i + 2] - moduleSize) < moduleSize / 2.0))
+        {
+          int centerX = start + runs[i] + runs[i + 1] / 2;
+
+          /// same along the column: dark center between two light modules, then dark.
+          int up = row, down = row;
+          while ((up > top) && isDark(centerX, up - 1) && (row - up < maxCount))
+            up--;
+          while ((down < bottom) && isDark(centerX, down + 1) && (down - row < maxCount))
+            down++;
+
+          int lightUp = 0, lightDown = 0;
+          while ((up - lightUp - 1 >= top) && !isDark(centerX, up - lightUp - 1) && (lightUp < maxCount))
+            lightUp++;
+          while ((down + lightDown + 1 <= bottom) && !isDark(centerX, down + lightDown + 1) && (lightDown < maxCount))
+            lightDown++;
+
+          int darkHeight = down - up + 1;
+
+          if ((std::fabs(darkHeight - moduleSize) < moduleSize / 2.0 + 1.0) &&
+              (std::fabs(lightUp - moduleSize) < moduleSize / 2.0 + 1.0) &&
+              (std::fabs(lightDown - moduleSize) < moduleSize / 2.0 + 1.0) &&
+              isDark(centerX, up - lightUp - 1) && isDark(centerX, down + lightDown + 1))
+          {
+            double cx = start + runs[i] + (runs[i + 1] / 2.0);
+            double cy = (up + down + 1) / 2.0;
+            double distance = ((cx - estimateX) * (cx - estimateX)) + ((cy - estimateY) * (cy - estimateY));
+
+            if ((bestDistance < 0.0) || (distance < bestDistance))
+            {
+              bestDistance = distance;
+              x = cx;
+              y = cy;
+            }
+          }
+        }
+
+        start += runs[i];
+      }
+    }
+
+    if (bestDistance >= 0.0)
+      return(true);
+  }
+
+  return(false);
+}
+
+static double distance(double x0, double y0, double x1, double y1)
+{
+  return(std::sqrt(((x0 - x1) * (x0 - x1)) + ((y0 - y1) * (y0 - y1))));
+}
+
+double QRDetector::measureToEdge(double x, double y, double dx, double dy) const
+{
+  /// dark center, light ring, dark ring: the edge is the third color change.
+  bool dark = true;
+  int changes = 0;
+
+  for (double t = 0.0; ; t += 1.0)
+  {
+    int px = (int)(x + t * dx);
+    int py = (int)(y + t * dy);
+
+    if ((px < 0) || (py < 0) || (px >= m_width) || (py >= m_height))
+      return((changes == 2) ? t : -1.0);
+
+    if (isDark(px, py) != dark)
+    {
+      dark = !dark;
+      if (++changes == 3)
+        return(t);
+    }
+  }
+}
+
+double QRDetector::measureModuleSize(const QRFinderPattern &from, const QRFinderPattern &to) const
+{
+  double length = distance(from.m_x, from.m_y, to.m_x, to.m_y);
+
+  if (length <= 0.0)
+    return(-1.0);
+
+  double dx = (to.m_x - from.m_x) / length;
+  double dy = (to.m_y - from.m_y) / length;
+  double forward = measureToEdge(from.m_x, from.m_y, dx, dy);
+  double backward = measureToEdge(from.m_x, from.m_y, -dx, -dy);
+
+  /// 3.5 modules on each side of the center.
+  if ((forward < 0.0) && (backward < 0.0))
+    return(-1.0);
+  if (forward < 0.0)
+    return(backward / 3.5);
+  if (backward < 0.0)
+    return(forward / 3.5);
+
+  return((forward + backward) / 7.0);
+}
+
+bool QRDetector::sampleSymbol(const QRFinderPattern patterns[3], QRBitMatrix &matrix, double points[8]) const
+{
+  const QRFinderPattern &bottomLeft = patterns[0];
+  const QRFinderPattern &topLeft = patterns[1];
+  const QRFinderPattern &topRight = patterns[2];
+  double sizeTop = (measureModuleSize(topLeft, topRight) + measureModuleSize(topRight, topLeft)) / 2.0;
+  double sizeLeft = (measureModuleSize(topLeft, bottomLeft) + measureModuleSize(bottomLeft, topLeft)) / 2.0;
+
+  if ((sizeTop <= 0.0) || (sizeLeft <= 0.0))
+    return(false);
+
+  const double moduleSize = (sizeTop + sizeLeft) / 2.0;
+
+  /// finder centers are size - 7 modules apart, snap to the nearest valid size.
+  double modules = ((distance(topLeft.m_x, topLeft.m_y, topRight.m_x, topRight.m_y) / sizeTop) +
+                    (distance(topLeft.m_x, topLeft.m_y, bottomLeft.m_x, bottomLeft.m_y) / sizeLeft)) / 2.0;
+  int version = (int)std::floor(((modules + 7.0) - 17.0) / 4.0 + 0.5);
+
+  if ((version < 1) || (version > 40))
+    return(false);
+
+  const int size = version * 4 + 17;
+
+  /// bottom-right corner of the parallelogram, refined with the alignment pattern.
+  /// Its center is 3 modules in from the finder centers' line.
+  double bottomRightX = topRight.m_x - topLeft.m_x + bottomLeft.m_x;
+  double bottomRightY = topRight.m_y - topLeft.m_y + bottomLeft.m_y;
+  double sourceBottomRight = size - 3.5;
+
+  if (version >= 2)
+  {
+    double correction = 1.0 - 3.0 / (size - 7);
+    double x = topLeft.m_x + correction * (bottomRightX - topLeft.m_x);
+    double y = topLeft.m_y + correction * (bottomRightY - topLeft.m_y);
+
+    if (findAlignmentPattern(moduleSize, x, y))
+    {
+      bottomRightX = x;
+      bottomRightY = y;
+      sourceBottomRight = size - 6.5;
+    }
+  }
+
+  QRPerspectiveTransform transform = QRPerspectiveTransform::quadrilateralToQuadrilateral(
+      3.5, 3.5, size - 3.5, 3.5, sourceBottomRight, sourceBottomRight, 3.5, size - 3.5,
+      topLeft.m_x, topLeft.m_y, topRight.m_x, topRight.m_y, bottomRightX, bottomRightY, bottomLeft.m_x, bottomLeft.m_y);
+
+  points[0] = bottomLeft.m_x;   points[1] = bottomLeft.m_y;
+  points[2] = topLeft.m_x;      points[3] = topLeft.m_y;
+  points[4] = topRight.m_x;     points[5] = topRight.m_y;
+  points[6] = bottomRightX;     points[7] = bottomRightY;
+
+  matrix = QRBitMatrix(size);
+
+  for (int y = 0; y < size; y++)
+  {
+    for (int x = 0; x < size; x++)
+    {
+      double px = x + 0.5;
+      double py = y + 0.5;
+      transform.transform(px, py);
+
+      /// module centers may fall a little outside the image, not more.
+      if ((px < -1.0) || (py < -1.0) || (px > m_width + 1.0) || (py > m_height + 1.0))
+        return(false);
+
+      int ix = std::max(0, std::min(m_width - 1, (int)px));
+      int iy = std::max(0, std::min(m_height - 1, (int)py));
+
+      if (m_binary[(iy * m_width) + ix] != 0)
+        matrix.set(x, y, true);
+    }
+  }
+
+  return(true);
+}
@@ -0,0 +1,195 @@
+/**
+*  @file    qrdetector.h
+*  @brief   class to find a QR Code symbol in a camera image.
+*
+*  QRDetector locates a symbol in a grayscale photo and samples its modules
+*  into a QRBitMatrix for QRDecoder. The pipeline is:
+*  - adaptive binarization: every 8x8 block is thresholded at the mean
+*    level of the 5x5 blocks around it, so uneven lighting doesn't matter,
+*  - finder pattern scanning: rows are split into runs and dark-light-dark-
+*    light-dark runs in 1:1:3:1:1 ratio (the pattern the N3 penalty rule
+*    keeps out of the data area) are cross-checked vertically and horizontally,
+*  - the three finder patterns forming the best right isosceles triangle
+*    give the orientation, the module size and the version,
+*  - the bottom-right alignment pattern is searched around its estimated
+*    position (version 2 and up) to correct the perspective,
+*  - a perspective transformation maps every module center to the image.
+*  The per pixel loops (block statistics, thresholding, run extraction)
+*  work on plain byte arrays without branches in the inner loop, so the
+*  compiler can vectorize them, and uniform areas are skipped 8 pixels at a time.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRDETECTOR_H
+#define QRDETECTOR_H
+
+#include <vector>
+
+#include "qrutility.h"
+#include "qrbitmatrix.h"
+
+class Bitmap;
+
+namespace QR
+{
+  //!  @struct  QRFinderPattern
+  /*!
+    Center of a finder (or alignment) pattern found in the image.
+  */
+  struct QRFinderPattern
+  {
+    double  m_x;            ///< Define x coordinate of the center, in pixels.
+    double  m_y;            ///< Define y coordinate of the center, in pixels.
+    double  m_moduleSize;   ///< Define estimated size of a module, in pixels.
+    int     m_count;        ///< Define number of scans which found it.
+  };
+
+  //!  @class  QRDetector
+  /*!
+    Finds a QR Code symbol in a grayscale image. The buffers are kept between calls,
+    so keep one detector per video stream (or thread).
+  */
+  class QRDetector
+  {
+    public:
+      /// Default Constructor
+      QRDetector();
+
+      /// Copy Constructor
+      QRDetector(const QRDetector &other);
+
+      /// Destructor
+      ~QRDetector();
+
+      /// Assignment Operator
+      QRDetector& operator=(const QRDetector &other);
+
+      /** @brief find a symbol and sample its modules.
+      *
+      *  @param[in]   gray the luminance of the pixels, top row first.
+      *  @param[in]   width the width of the image.
+      *  @param[in]   height the height of the image.
+      *  @param[in]   stride the number of bytes from a row to the next one.
+      *  @param[out]  matrix the modules of the symbol.
+      *
+      *  @return bool true if a symbol is found, false if not.
+      */
+      bool detect(const unsigned char *gray, int width, int height, int stride, QRBitMatrix &matrix);
+
+      /** @brief find a symbol in a bitmap and sample its modules.
+      *
+      *  @param[in]   bmp the image.
+      *  @param[out]  matrix the modules of the symbol.
+      *
+      *  @return bool true if a symbol is found, false if not.
+      */
+      bool detect(const Bitmap &bmp, QRBitMatrix &matrix);
+
+      /** @brief binarize an image.
+      *
+      *  First step of detect(), the result is kept in the detector (see getBinaryImage()).
+      *
+      *  @return bool false if the image is too small (less than 8 pixels on a side).
+      */
+      bool binarize(const unsigned char *gray, int width, int height, int stride);
+
+      /// binary image of the last call, width * height bytes, 1 for dark pixels.
+      const std::vector<uint8_t>& getBinaryImage() const;
+
+      /// finder pattern candidates of the last call, most often found first.
+      const std::vector<QRFinderPattern>& getFinderCandidates() const;
+
+      /** @brief get the pattern centers of the last detected symbol.
+      *
+      *  @param[out]  points x, y of the bottom-left, top-left and top-right finder
+      *               pattern centers and of the bottom-right alignment point.
+      *
+      *  @return nothing.
+      */
+      void getPoints(double points[8]) const;
+
+    protected:
+      // Finds the finder pattern candidates in the binary image, scanning every step-th row
+      // (0 for the default, suited to one symbol filling most of the image).
+      void findFinderPatterns(int step = 0);
+
+      // Scans the rows first, first + step, ... below last for finder patterns, into candidates.
+      // Only reads the binary image, so strips of rows can be scanned on several threads.
+      void scanRows(int first, int last, int step, std::vector<int> &runs, std::vector<QRFinderPattern> &candidates) const;
+
+      // Sorts the candidates, most often found first.
+      void sortCandidates();
+
+      // binarize() in steps, so that strips of blocks can run on several threads:
+      // startBinarize() sizes the buffers (false if the image is too small), measureBlocks()
+      // computes the black points of the block rows first to last - 1, resolveUniformBlocks()
+      // then settles the uniform blocks, which depend on their neighbours, and thresholdBlocks()
+      // writes the binary pixels of block rows. The last block row overlaps the previous one,
+      // so it must be thresholded after it.
+      bool startBinarize(const unsigned char *gray, int width, int height, int stride);
+      void measureBlocks(const unsigned char *gray, int stride, int first, int last);
+      void resolveUniformBlocks();
+      void thresholdBlocks(const unsigned char *gray, int stride, int first, int last);
+
+      // number of rows of 8x8 blocks of the last image.
+      int getBlockRowCount() const;
+
+      // Selects the three candidates (among the given ones) that form the best
+      // right isosceles triangle, ordered bottom-left, top-left, top-right.
+      bool selectFinderPatterns(const std::vector<QRFinderPattern> &candidates, QRFinderPattern patterns[3]) const;
+
+      // Scores three finder patterns as the corners of one symbol, 0 for a perfect right isosceles
+      // triangle, negative if they can't be. Sets ordered to bottom-left, top-left, top-right.
+      static double scoreTriplet(const QRFinderPattern &first, const QRFinderPattern &second, const QRFinderPattern &third,
+                                 QRFinderPattern ordered[3]);
+
+      // Computes the geometry of the symbol from its finder patterns and samples it,
+      // points gets the pattern centers (see getPoints()). Only reads the binary image.
+      bool sampleSymbol(const QRFinderPattern patterns[3], QRBitMatrix &matrix, double points[8]) const;
+
+      // Splits a row (or column) of the binary image into runs. runs[0] is the
+      // length of the first run, whose color is returned. Uniform 8 pixel spans are skipped at once.
+      static int getRuns(const uint8_t *row, int length, std::vector<int> &runs);
+
+      // True if the 5 run lengths are in 1:1:3:1:1 ratio.
+      static bool isFinderRatio(const int counts[5]);
+
+      // Cross-checks a possible finder pattern center along a column (vertical = true) or a row,
+      // returns the corrected center coordinate along it, or a negative value.
+      double crossCheck(int x, int y, bool vertical, int maxCount, int originalTotal) const;
+
+      // Cross-checks a possible finder pattern center and merges it into candidates.
+      void handlePossibleCenter(const int counts[5], double centerX, int y, std::vector<QRFinderPattern> &candidates) const;
+
+      // Adds a pattern to candidates, or merges it into the one it was already found as (weighted by their counts).
+      static void mergeCandidate(const QRFinderPattern &pattern, std::vector<QRFinderPattern> &candidates);
+
+      // Module size measured across the finder pattern 'from', along the line to 'to'
+      // (runs along rows overestimate it for rotated symbols). Negative if it can't be measured.
+      double measureModuleSize(const QRFinderPattern &from, const QRFinderPattern &to) const;
+
+      // Distance from (x, y) to the outer edge of the finder pattern along (dx, dy), a unit vector.
+      double measureToEdge(double x, double y, double dx, double dy) const;
+
+      // Searches the alignment pattern around (x, y), returns false if it isn't found.
+      bool findAlignmentPattern(double moduleSize, double &x, double &y) const;
+
+      // dark pixel test, false outside the image.
+      bool isDark(int x, int y) const;
+
+    protected:
+      int                           m_width;          ///< Define width of the last image.
+      int                           m_height;         ///< Define height of the last image.
+      std::vector<uint8_t>          m_binary;         ///< Define binary image, 1 for dark pixels.
+      std::vector<int>              m_blockLevels;    ///< Define black point of every 8x8 block (-1 - minimum of a uniform one, while binarizing).
+      std::vector<int>              m_runs;           ///< Define run lengths of the scanned row.
+      std::vector<QRFinderPattern>  m_candidates;     ///< Define finder pattern candidates.
+      double                        m_points[8];      ///< Define pattern centers of the last detected symbol.
+  };
+}
+
+#endif    // QRDETECTOR_H
@@ -0,0 +1,175 @@
+#include <algorithm>
+
+#include "qrgridsampler.h"
+#include "bitmap.h"
+
+using namespace QR;
+
+/// Default Constructor
+QRGridSampler::QRGridSampler()
+  :m_scale(0.0),
+  m_border(0),
+  m_threshold(128)
+{
+}
+
+/// Copy Constructor
+QRGridSampler::QRGridSampler(const QRGridSampler &other)
+  :m_scale(other.m_scale),
+  m_border(other.m_border),
+  m_threshold(other.m_threshold)
+{
+}
+
+/// Destructor
+QRGridSampler::~QRGridSampler()
+{
+}
+
+/// Assignment Operator
+QRGridSampler& QRGridSampler::operator=(const QRGridSampler &other)
+{
+  if(this != &other)
+  {
+    m_scale = other.m_scale;
+    m_border = other.m_border;
+    m_threshold = other.m_threshold;
+  }
+
+  return(*this);
+}
+
+QRBitMatrix QRGridSampler::sample(const Bitmap &bmp, int scale, int border)
+{
+  std::vector<unsigned char> gray;
+  bmp.getGrayscale(gray);
+
+  return(sample(gray, bmp.getWidth(), bmp.getHeight(), scale, border));
+}
+
+QRBitMatrix QRGridSampler::sample(const std::vector<unsigned char> &gray, int width, int height, int scale, int border)
+{
+  if ((width <= 0) || (height <= 0) || (gray.size() < (size_t)width * height))
+    throw "Invalid argument";
+
+  /// threshold halfway between the darkest and the lightest pixel.
+  unsigned char darkest = *std::min_element(gray.begin(), gray.begin() + width * height);
+  unsigned char lightest = *std::max_element(gray.begin(), gray.begin() + width * height);
+
+  if (lightest - darkest < 32)
+    throw "No symbol found";
+
+  m_threshold = (darkest + lightest + 1) / 2;
+
+  const unsigned char threshold = (unsigned char)m_threshold;
+  double left, top, module;
+  int size;
+
+  if ((scale > 0) && (border >= 0))
+  {
+    /// known geometry, the image is the symbol plus the same quiet zone on every side.
+    module = scale;
+    left = top = border * scale;
+    size = (width - 2 * border * scale) / scale;
+  }
+  else
+  {
+    /// bounding box of the dark pixels. The finder patterns sit in three corners,
+    /// so it is the symbol itself (the bottom right corner comes from the bottom left finder).
+    int minX = width, maxX = -1, minY = -1, maxY = -1;
+
+    for (int y = 0; y < height; y++)
+    {
+      const unsigned char *row = &gray[y * width];
+      int first = 0;
+
+      while ((first < width) && (row[first] >= threshold))
+        first++;
+
+      if (first == width)
+        continue;
+
+      int last = width - 1;
+      while (row[last] >= threshold)
+        last--;
+
+      if (minY < 0)
+        minY = y;
+
+      maxY = y;
+      minX = std::min(minX, first);
+      maxX = std::max(maxX, last);
+    }
+
+    if (maxX < 0)
+      throw "No symbol found";
+
+    double extent = std::max(maxX - minX + 1, maxY - minY + 1);
+
+    if (scale > 0)
+      module = scale;
+    else
+    {
+      /// the top row of the top-left finder pattern is 7 dark modules.
+      const unsigned char *row = &gray[minY * width];
+      int run = 0;
+
+      while ((minX + run < width) && (row[minX + run] < threshold))
+        run++;
+
+      module = run / 7.0;
+    }
+
+    if (module <= 0.0)
+      throw "No symbol found";
+
+    /// snap to the nearest valid symbol size, then spread the extent evenly over it.
+    int version = (int)(((extent / module) - 17.0) / 4.0 + 0.5);
+    version = std::max(1, std::min(40, version));
+    size = version * 4 + 17;
+    module = extent / size;
+    left = minX;
+    top = minY;
+  }
+
+  if ((size < 21) || (size > 177) || (left + size * module > width + 0.5) || (top + size * module > height + 0.5))
+    throw "No symbol found";
+
+  m_scale = module;
+  m_border = (int)(left / module + 0.5);
+
+  /// each module is read at its center.
+  QRBitMatrix matrix(size);
+  std::vector<int> columns(size);
+
+  for (int x = 0; x < size; x++)
+    columns[x] = std::min(width - 1, (int)(left + (x + 0.5) * module));
+
+  for (int y = 0; y < size; y++)
+  {
+    const unsigned char *row = &gray[std::min(height - 1, (int)(top + (y + 0.5) * module)) * width];
+
+    for (int x = 0; x < size; x++)
+    {
+      if (row[columns[x]] < threshold)
+        matrix.set(x, y, true);
+    }
+  }
+
+  return(matrix);
+}
+
+double QRGridSampler::getScale() const
+{
+  return(m_scale);
+}
+
+int QRGridSampler::getBorder() const
+{
+  return(m_border);
+}
+
+int QRGridSampler::getThreshold() const
+{
+  return(m_threshold);
+}
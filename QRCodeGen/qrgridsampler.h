@@ -0,0 +1,88 @@
+/**
+*  @file    qrgridsampler.h
+*  @brief   class to recover the module grid from a rendered QR Code image.
+*
+*  QRGridSampler reads back the modules of an axis-aligned render, like the
+*  ones QRCode::writeToBMP() writes (possibly printed and scanned at a fixed
+*  resolution). The scale (pixels per module) and the quiet zone can be
+*  given or detected: the symbol is the bounding box of the dark pixels,
+*  and the top row of the top-left finder pattern is 7 modules long.
+*  Every module is sampled at its center against a global threshold.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRGRIDSAMPLER_H
+#define QRGRIDSAMPLER_H
+
+#include <vector>
+
+#include "qrutility.h"
+#include "qrbitmatrix.h"
+
+class Bitmap;
+
+namespace QR
+{
+  //!  @class  QRGridSampler
+  /*!
+    Samples the modules of an axis-aligned QR Code image. Throws a string literal
+    when no symbol is found. The detected geometry of the last image is kept.
+  */
+  class QRGridSampler
+  {
+    public:
+      /// Default Constructor
+      QRGridSampler();
+
+      /// Copy Constructor
+      QRGridSampler(const QRGridSampler &other);
+
+      /// Destructor
+      ~QRGridSampler();
+
+      /// Assignment Operator
+      QRGridSampler& operator=(const QRGridSampler &other);
+
+      /** @brief sample the modules of a bitmap.
+      *
+      *  @param[in]   bmp the image.
+      *  @param[in]   scale the number of pixels per module, 0 to detect it.
+      *  @param[in]   border the number of quiet zone modules left and above the symbol, -1 to detect it.
+      *
+      *  @return QRBitMatrix the modules of the symbol.
+      */
+      QRBitMatrix sample(const Bitmap &bmp, int scale = 0, int border = -1);
+
+      /** @brief sample the modules of a grayscale image.
+      *
+      *  @param[in]   gray the luminance of the pixels, width * height bytes, top row first.
+      *  @param[in]   width the width of the image.
+      *  @param[in]   height the height of the image.
+      *  @param[in]   scale the number of pixels per module, 0 to detect it.
+      *  @param[in]   border the number of quiet zone modules left and above the symbol, -1 to detect it.
+      *
+      *  @return QRBitMatrix the modules of the symbol.
+      */
+      QRBitMatrix sample(const std::vector<unsigned char> &gray, int width, int height, int scale = 0, int border = -1);
+
+      /// pixels per module of the last sampled image.
+      double getScale() const;
+
+      /// quiet zone modules left of the symbol in the last sampled image.
+      int getBorder() const;
+
+      /// luminance threshold of the last sampled image, darker pixels are dark modules.
+      int getThreshold() const;
+
+    private:
+      double  m_scale;      ///< Define pixels per module of the last sampled image.
+      int     m_border;     ///< Define quiet zone of the last sampled image, in modules.
+      int     m_threshold;  ///< Define luminance threshold of the last sampled image.
+  };
+}
+
+#endif    // QRGRIDSAMPLER_H
@@ -0,0 +1,241 @@
+#include <algorithm>
+
+#include "qrincrementalencoder.h"
+
+using namespace QR;
+
+/// Default Constructor
+QRIncrementalEncoder::QRIncrementalEncoder()
+  :m_code(),
+  m_valid(false),
+  m_incremental(false),
+  m_numBlocks(0),
+  m_numShortBlocks(0),
+  m_shortDataLen(0),
+  m_dataCount(0),
+  m_blocks(),
+  m_ecc(),
+  m_rs(),
+  m_modules(),
+  m_updatedBlocks(0),
+  m_updatedCodewords(0)
+{
+}
+
+/// Copy Constructor
+QRIncrementalEncoder::QRIncrementalEncoder(const QRIncrementalEncoder &other)
+  :m_code(other.m_code),
+  m_valid(other.m_valid),
+  m_incremental(other.m_incremental),
+  m_numBlocks(other.m_numBlocks),
+  m_numShortBlocks(other.m_numShortBlocks),
+  m_shortDataLen(other.m_shortDataLen),
+  m_dataCount(other.m_dataCount),
+  m_blocks(other.m_blocks),
+  m_ecc(other.m_ecc),
+  m_rs(other.m_rs),
+  m_modules(other.m_modules),
+  m_updatedBlocks(other.m_updatedBlocks),
+  m_updatedCodewords(other.m_updatedCodewords)
+{
+}
+
+/// Destructor
+QRIncrementalEncoder::~QRIncrementalEncoder()
+{
+}
+
+/// Assignment Operator
+QRIncrementalEncoder& QRIncrementalEncoder::operator=(const QRIncrementalEncoder &other)
+{
+  if(this != &other)
+  {
+    m_code = other.m_code;
+    m_valid = other.m_valid;
+    m_incremental = other.m_incremental;
+    m_numBlocks = other.m_numBlocks;
+    m_numShortBlocks = other.m_numShortBlocks;
+    m_shortDataLen = other.m_shortDataLen;
+    m_dataCount = other.m_dataCount;
+    m_blocks = other.m_blocks;
+    m_ecc = other.m_ecc;
+    m_rs = other.m_rs;
+    m_modules = other.m_modules;
+    m_updatedBlocks = other.m_updatedBlocks;
+    m_updatedCodewords = other.m_updatedCodewords;
+  }
+
+  return(*this);
+}
+
+const QRCode& QRIncrementalEncoder::encode(const std::string &input, const ECL &ecl, int mask)
+{
+  QRSegment seg;
+  seg.create(input);
+
+  std::vector<QRSegment> segs;
+  segs.push_back(seg);
+
+  return(encode(segs, ecl, mask));
+}
+
+const QRCode& QRIncrementalEncoder::encode(const std::vector<QRSegment> &segs, const ECL &ecl, int mask)
+{
+  if ((mask < -1) || (mask > 7))
+    throw "Mask value out of range";
+
+  /// the segments and the bit stream are cheap to rebuild, the previous
+  /// payload is compared with the new one codeword by codeword.
+  int version;
+  ECL newEcl;
+  const ui8vector dataCodewords(QRCode::makeDataCodewords(segs, ecl, version, newEcl));
+
+  m_incremental = m_valid && (version == m_code.m_version) && (newEcl == m_code.m_ecl);
+
+  /// a failure half way leaves the previous symbol unusable.
+  m_valid = false;
+  if (m_incremental)
+    updateSymbol(dataCodewords, mask);
+  else
+    makeSymbol(version, newEcl, dataCodewords, mask);
+  m_valid = true;
+
+  return(m_code);
+}
+
+void QRIncrementalEncoder::reset()
+{
+  m_valid = false;
+  m_incremental = false;
+}
+
+const QRCode& QRIncrementalEncoder::getQRCode() const
+{
+  return(m_code);
+}
+
+bool QRIncrementalEncoder::isIncremental() const
+{
+  return(m_incremental);
+}
+
+int QRIncrementalEncoder::getUpdatedBlockCount() const
+{
+  return(m_updatedBlocks);
+}
+
+int QRIncrementalEncoder::getUpdatedCodewordCount() const
+{
+  return(m_updatedCodewords);
+}
+
+void QRIncrementalEncoder::makeSymbol(int version, const ECL &ecl, const ui8vector &dataCodewords, int mask)
+{
+  int blockEccLen;
+  QRCode::getBlockStructure(version, ecl, m_numBlocks, m_numShortBlocks, m_shortDataLen, blockEccLen);
+  m_dataCount = (int)dataCodewords.size();
+  m_rs = QRReedSolomonGenerator(blockEccLen);
+
+  /// split into blocks and interleave them, as QRCode::appendErrorCorrection() does.
+  ui8vector allCodewords(m_dataCount + (m_numBlocks * blockEccLen));
+  m_blocks.resize(m_numBlocks);
+  m_ecc.resize(m_numBlocks);
+
+  for (int b = 0, k = 0; b < m_numBlocks; b++)
+  {
+    const int len = m_shortDataLen + ((b < m_numShortBlocks) ? 0 : 1);
+
+    m_blocks[b].assign(dataCodewords.begin() + k, dataCodewords.begin() + k + len);
+    m_ecc[b] = m_rs.getErrorCorrection(m_blocks[b]);
+    k += len;
+
+    for (int i = 0; i < len; i++)
+      allCodewords[getDataPosition(b, i)] = m_blocks[b][i];
+    for (int i = 0; i < blockEccLen; i++)
+      allCodewords[getEccPosition(b, i)] = m_ecc[b][i];
+  }
+
+  m_code.makeFunctionPatterns(version, ecl);
+  m_code.drawCodewords(allCodewords);
+  m_code.m_mask = m_code.handleConstructorMasking(mask);
+  m_modules = m_code.getCodewordModules();
+
+  m_updatedBlocks = m_numBlocks;
+  m_updatedCodewords = (int)allCodewords.size();
+}
+
+void QRIncrementalEncoder::updateSymbol(const ui8vector &dataCodewords, int mask)
+{
+  m_updatedBlocks = 0;
+  m_updatedCodewords = 0;
+
+  /// the modules stay masked with the previous mask while codewords are flipped.
+  for (int b = 0, k = 0; b < m_numBlocks; b++)
+  {
+    ui8vector &block = m_blocks[b];
+    const int len = (int)block.size();
+    const ui8vector::const_iterator data = dataCodewords.begin() + k;
+    k += len;
+
+    if (std::equal(block.begin(), block.end(), data))
+      continue;
+
+    for (int i = 0; i < len; i++)
+    {
+      if (block[i] != data[i])
+      {
+        flipCodeword(getDataPosition(b, i), block[i] ^ data[i]);
+        block[i] = data[i];
+      }
+    }
+
+    const ui8vector ecc(m_rs.getErrorCorrection(block));
+    for (int i = 0; i < (int)ecc.size(); i++)
+    {
+      if (ecc[i] != m_ecc[b][i])
+        flipCodeword(getEccPosition(b, i), ecc[i] ^ m_ecc[b][i]);
+    }
+    m_ecc[b] = ecc;
+    m_updatedBlocks++;
+  }
+
+  /// the format bits are the same as long as the mask is, otherwise the mask
+  /// is undone and the new one (or the best one) applied.
+  if (mask != m_code.m_mask)
+  {
+    m_code.applyMask(m_code.m_mask);
+    m_code.m_mask = m_code.handleConstructorMasking(mask);
+  }
+}
+
+void QRIncrementalEncoder::flipCodeword(int pos, uint8_t diff)
+{
+  const int size = m_code.m_size;
+  const int *modules = &m_modules[pos * 8];
+
+  /// bit 7 is drawn first.
+  for (int j = 0; j < 8; j++)
+  {
+    if ((diff >> (7 - j)) & 1)
+    {
+      std::vector<bool>::reference module = m_code.m_modules[modules[j] / size][modules[j] % size];
+      module = !module;
+    }
+  }
+
+  m_updatedCodewords++;
+}
+
+int QRIncrementalEncoder::getDataPosition(int b, int i) const
+{
+  /// the last data codeword exists in the long blocks only.
+  if (i < m_shortDataLen)
+    return((i * m_numBlocks) + b);
+  else
+    return((m_shortDataLen * m_numBlocks) + (b - m_numShortBlocks));
+}
+
+int QRIncrementalEncoder::getEccPosition(int b, int i) const
+{
+  return(m_dataCount + (i * m_numBlocks) + b);
+}
@@ -0,0 +1,125 @@
+/**
+*  @file    qrincrementalencoder.h
+*  @brief   class to re-encode a symbol when only part of its payload changes.
+*
+*  Labels printed in series share most of their payload (a long prefix and
+*  a serial number at the end), so most of the Reed-Solomon blocks of one
+*  symbol are those of the previous one. QRIncrementalEncoder keeps the
+*  last symbol with its data and error correction codewords per block and
+*  the module of every codeword bit. When the next payload has the same
+*  version and error correction level, only the blocks whose data changed
+*  get their error correction recomputed, and only the modules of the
+*  codewords which changed are flipped. With a fixed mask that is already
+*  the final symbol; with automatic masking the mask search runs again.
+*
+*  The symbol is the one QRCode::encode() makes for the same arguments,
+*  module for module. Any other version or error correction level makes a
+*  whole new symbol.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRINCREMENTALENCODER_H
+#define QRINCREMENTALENCODER_H
+
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrsegment.h"
+#include "qrreedsolomongenerator.h"
+#include "qrcode.h"
+
+namespace QR
+{
+  //!  @class  QRIncrementalEncoder
+  /*!
+    Encoder keeping the last symbol, to redo only the blocks a new payload changes.
+  */
+  class QRIncrementalEncoder
+  {
+    public:
+      /// Default Constructor, without a previous symbol.
+      QRIncrementalEncoder();
+
+      /// Copy Constructor
+      QRIncrementalEncoder(const QRIncrementalEncoder &other);
+
+      /// Destructor
+      ~QRIncrementalEncoder();
+
+      /// Assignment Operator
+      QRIncrementalEncoder& operator=(const QRIncrementalEncoder &other);
+
+      /** @brief encode a text, from the previous symbol if it has the same structure.
+      *
+      *  @param[in] input the text, in the most efficient single segment as QRCode::encode() does.
+      *  @param[in] ecl the least error correction level.
+      *  @param[in] mask the mask, -1 for automatic masking.
+      *
+      *  @return const QRCode& the symbol, valid until the next call.
+      */
+      const QRCode& encode(const std::string &input, const ECL &ecl, int mask = -1);
+
+      /** @brief encode segments, from the previous symbol if it has the same structure.
+      *
+      *  @param[in] segs the segments.
+      *  @param[in] ecl the least error correction level.
+      *  @param[in] mask the mask, -1 for automatic masking.
+      *
+      *  @return const QRCode& the symbol, valid until the next call.
+      */
+      const QRCode& encode(const std::vector<QRSegment> &segs, const ECL &ecl, int mask = -1);
+
+      /// forget the previous symbol, the next encode() makes a whole one.
+      void reset();
+
+      /// the last symbol encoded.
+      const QRCode& getQRCode() const;
+
+      /// whether the last encode() started from the previous symbol.
+      bool isIncremental() const;
+
+      /// number of blocks whose error correction the last encode() computed.
+      int getUpdatedBlockCount() const;
+
+      /// number of codewords (data and error correction) the last encode() drew.
+      int getUpdatedCodewordCount() const;
+
+    private:
+      // Makes a whole symbol, and keeps its blocks and the modules of its codewords.
+      void makeSymbol(int version, const ECL &ecl, const ui8vector &dataCodewords, int mask);
+
+      // Updates the blocks of the previous symbol which differ from dataCodewords, then masks with mask.
+      void updateSymbol(const ui8vector &dataCodewords, int mask);
+
+      // Flips the modules of the bits set in diff, of the codeword at position pos of the interleaved sequence.
+      void flipCodeword(int pos, uint8_t diff);
+
+      // Position in the interleaved sequence of data codeword i of block b.
+      int getDataPosition(int b, int i) const;
+
+      // Position in the interleaved sequence of error correction codeword i of block b.
+      int getEccPosition(int b, int i) const;
+
+    private:
+      QRCode                  m_code;             ///< Define last symbol.
+      bool                    m_valid;            ///< Define whether m_code and the blocks are of the last payload.
+      bool                    m_incremental;      ///< Define whether the last encode() updated the previous symbol.
+      int                     m_numBlocks;        ///< Define number of blocks of the symbol.
+      int                     m_numShortBlocks;   ///< Define number of blocks with one data codeword less.
+      int                     m_shortDataLen;     ///< Define number of data codewords of a short block.
+      int                     m_dataCount;        ///< Define number of data codewords of the symbol.
+      std::vector<ui8vector>  m_blocks;           ///< Define data codewords of every block.
+      std::vector<ui8vector>  m_ecc;              ///< Define error correction codewords of every block.
+      QRReedSolomonGenerator  m_rs;               ///< Define generator of the error correction of a block.
+      std::vector<int>        m_modules;          ///< Define module (y * size + x) of every bit of the interleaved codewords.
+      int                     m_updatedBlocks;    ///< Define number of blocks the last encode() computed.
+      int                     m_updatedCodewords; ///< Define number of codewords the last encode() drew.
+  };
+}
+
+#endif    // QRINCREMENTALENCODER_H
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "qrmultidetector.h"
+#include "qrdecoder.h"
+#include "bitmap.h"
+
+using namespace QR;
+
+/// worst score (see QRDetector::scoreTriplet()) of three finder patterns taken as a symbol.
+static const double MAX_CLUSTER_SCORE = 0.3;
+
+/// the finder centers of the largest symbol are 170 modules apart, 240 along the diagonal.
+static const double MAX_CLUSTER_MODULES = 260.0;
+
+static double squaredDistance(double x0, double y0, double x1, double y1)
+{
+  return(((x0 - x1) * (x0 - x1)) + ((y0 - y1) * (y0 - y1)));
+}
+
+static double squaredDistance(const QRFinderPattern &a, const QRFinderPattern &b)
+{
+  return(squaredDistance(a.m_x, a.m_y, b.m_x, b.m_y));
+}
+
+/// strips of rows per thread, so that a thread done early takes another one.
+static const int STRIPS_PER_THREAD = 4;
+
+/// Parametric Constructor
+QRMultiDetector::QRMultiDetector(int threads)
+  :QRDetector(),
+  m_pool(threads),
+  m_decoders(m_pool.getThreadCount()),
+  m_stripRuns(),
+  m_stripCandidates(),
+  m_clusterCount(0)
+{
+}
+
+/// Destructor
+QRMultiDetector::~QRMultiDetector()
+{
+}
+
+int QRMultiDetector::detectAll(const unsigned char *gray, int width, int height, int stride, std::vector<QRSymbolResult> &results)
+{
+  results.clear();
+  m_clusterCount = 0;
+
+  if (!startBinarize(gray, width, height, stride))
+    return(0);
+
+  /// the block statistics and the thresholds in strips; the last block row overlaps
+  /// the one before it, and is thresholded after it.
+  const int blockRows = getBlockRowCount();
+
+  runStrips(blockRows, [this, gray, stride](int, int first, int last) { measureBlocks(gray, stride, first, last); });
+  resolveUniformBlocks();
+  runStrips(blockRows - 1, [this, gray, stride](int, int first, int last) { thresholdBlocks(gray, stride, first, last); });
+  thresholdBlocks(gray, stride, blockRows - 1, blockRows);
+
+  /// the labels are small compared to the frame, every row is scanned, in strips
+  /// whose candidates are then merged as the rows of one strip are.
+  m_stripRuns.resize(STRIPS_PER_THREAD * m_pool.getThreadCount());
+  m_stripCandidates.resize(m_stripRuns.size());
+
+  runStrips(height, [this](int strip, int first, int last)
+  {
+    m_stripCandidates[strip].clear();
+    scanRows(first, last, 1, m_stripRuns[strip], m_stripCandidates[strip]);
+  });
+
+  m_candidates.clear();
+  for (size_t strip = 0; strip < m_stripCandidates.size(); strip++)
+  {
+    for (size_t i = 0; i < m_stripCandidates[strip].size(); i++)
+      mergeCandidate(m_stripCandidates[strip][i], m_candidates);
+
+    m_stripCandidates[strip].clear();
+  }
+  sortCandidates();
+
+  std::vector<Cluster> clusters;
+  clusterFinderPatterns(clusters);
+  m_clusterCount = (int)clusters.size();
+
+  /// a task per thread, each with its own decoder (and its per-version tables),
+  /// taking the clusters one at a time and writing their own slots.
+  std::vector<QRSymbolResult> decoded(clusters.size());
+  std::vector<char> found(clusters.size(), 0);
+  std::atomic<size_t> next(0);
+
+  for (size_t t = 0; (t < m_decoders.size()) && (t < clusters.size()); t++)
+  {
+    QRDecoder *decoder = &m_decoders[t];
+
+    m_pool.submit([this, decoder, &clusters, &decoded, &found, &next]()
+    {
+      for (size_t i = next++; i < clusters.size(); i = next++)
+        found[i] = decodeCluster(clusters[i], *decoder, decoded[i]) ? 1 : 0;
+    });
+  }
+
+  m_pool.wait();
+
+  for (size_t i = 0; i < clusters.size(); i++)
+  {
+    if (!found[i])
+      continue;
+
+    /// the same symbol read twice: same text, center within half its size.
+    const QRSymbolResult &result = decoded[i];
+    double radius = std::sqrt(clusters[i].m_side) / 2.0;
+    bool duplicate = false;
+
+    for (size_t j = 0; (j < results.size()) && !duplicate; j++)
+    {
+      duplicate = (results[j].m_text == result.m_text) &&
+                  (std::fabs(results[j].m_x - result.m_x) < radius) && (std::fabs(results[j].m_y - result.m_y) < radius);
+    }
+
+    if (!duplicate)
+      results.push_back(result);
+  }
+
+  /// reading order: symbols whose centers are within half a symbol vertically are on the same row.
+  for (size_t i = 1; i < results.size(); i++)
+  {
+    QRSymbolResult result = results[i];
+    double half = std::sqrt(squaredDistance(result.m_points[2], result.m_points[3], result.m_points[4], result.m_points[5])) / 2.0;
+    size_t j = i;
+
+    while ((j > 0) && ((result.m_y < results[j - 1].m_y - half) ||
+                       ((std::fabs(result.m_y - results[j - 1].m_y) <= half) && (result.m_x < results[j - 1].m_x))))
+    {
+      results[j] = results[j - 1];
+      j--;
+    }
+
+    results[j] = result;
+  }
+
+  return((int)results.size());
+}
+
+int QRMultiDetector::detectAll(const Bitmap &bmp, std::vector<QRSymbolResult> &results)
+{
+  std::vector<unsigned char> gray;
+  bmp.getGrayscale(gray);
+
+  if (gray.empty())
+  {
+    results.clear();
+    return(0);
+  }
+
+  return(detectAll(&gray[0], bmp.getWidth(), bmp.getHeight(), bmp.getWidth(), results));
+}
+
+int QRMultiDetector::getClusterCount() const
+{
+  return(m_clusterCount);
+}
+
+void QRMultiDetector::clusterFinderPatterns(std::vector<Cluster> &clusters) const
+{
+  const std::vector<QRFinderPattern> &candidates = m_candidates;
+  const int n = (int)candidates.size();
+  std::vector<Cluster> triplets;
+  Cluster cluster;
+
+  /// every triplet close enough to be one symbol.
+  for (int i = 0; i < n; i++)
+  {
+    const double limit = MAX_CLUSTER_MODULES * candidates[i].m_moduleSize;
+
+    for (int j = i + 1; j < n; j++)
+    {
+      if (squaredDistance(candidates[i], candidates[j]) > limit * limit)
+        continue;
+
+      for (int k = j + 1; k < n; k++)
+      {
+        if ((squaredDistance(candidates[i], candidates[k]) > limit * limit) ||
+            (squaredDistance(candidates[j], candidates[k]) > limit * limit))
+          continue;
+
+        cluster.m_score = scoreTriplet(candidates[i], candidates[j], candidates[k], cluster.m_patterns);
+
+        if ((cluster.m_score < 0.0) || (cluster.m_score > MAX_CLUSTER_SCORE))
+          continue;
+
+        cluster.m_side = std::max(squaredDistance(candidates[i], candidates[j]),
+                                  std::max(squaredDistance(candidates[i], candidates[k]), squaredDistance(candidates[j], candidates[k])));
+        cluster.m_members[0] = i;
+        cluster.m_members[1] = j;
+        cluster.m_members[2] = k;
+        triplets.push_back(cluster);
+      }
+    }
+  }
+
+  /// the patterns of neighbouring symbols form triangles too, but never as good as the real ones.
+  std::sort(triplets.begin(), triplets.end(), [](const Cluster &a, const Cluster &b)
+  {
+    return((a.m_score != b.m_score) ? (a.m_score < b.m_score) : (a.m_side < b.m_side));
+  });
+
+  std::vector<char> used(n, 0);
+  clusters.clear();
+
+  for (size_t t = 0; t < triplets.size(); t++)
+  {
+    const Cluster &triplet = triplets[t];
+
+    if (used[triplet.m_members[0]] || used[triplet.m_members[1]] || used[triplet.m_members[2]])
+      continue;
+
+    used[triplet.m_members[0]] = used[triplet.m_members[1]] = used[triplet.m_members[2]] = 1;
+    clusters.push_back(triplet);
+  }
+}
+
+void QRMultiDetector::runStrips(int count, const std::function<void(int, int, int)> &task)
+{
+  const int strips = std::min(count, STRIPS_PER_THREAD * m_pool.getThreadCount());
+
+  /// a single thread runs them itself, without the queue.
+  for (int strip = 0; strip < strips; strip++)
+  {
+    const int first = (int)(((long long)count * strip) / strips);
+    const int last = (int)(((long long)count * (strip + 1)) / strips);
+
+    if (m_pool.getThreadCount() == 1)
+      task(strip, first, last);
+    else
+      m_pool.submit([&task, strip, first, last]() { task(strip, first, last); });
+  }
+
+  m_pool.wait();
+}
+
+bool QRMultiDetector::decodeCluster(const Cluster &cluster, QRDecoder &decoder, QRSymbolResult &result) const
+{
+  QRBitMatrix matrix;
+
+  if (!sampleSymbol(cluster.m_patterns, matrix, result.m_points))
+    return(false);
+
+  try
+  {
+    result.m_text = decoder.decode(matrix);
+    result.m_version = decoder.getVersion();
+    result.m_ecl = decoder.getECL();
+  }
+  catch (const char *)
+  {
+    return(false);
+  }
+
+  /// the center is halfway between the bottom-left and the top-right patterns.
+  result.m_x = (result.m_points[0] + result.m_points[4]) / 2.0;
+  result.m_y = (result.m_points[1] + result.m_points[5]) / 2.0;
+
+  return(true);
+}
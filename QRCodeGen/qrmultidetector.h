@@ -0,0 +1,121 @@
+/**
+*  @file    qrmultidetector.h
+*  @brief   class to find and decode every QR Code symbol of an image.
+*
+*  QRMultiDetector extends QRDetector to images holding many symbols (a
+*  pallet with dozens of labels). All the finder pattern candidates of the
+*  frame are grouped into triplets, best shaped and smallest triangles
+*  first, each candidate used once. The thread pool binarizes the frame and
+*  scans its rows in strips, then samples and decodes the triplets: sampling
+*  only reads the shared binary image, and every thread keeps its own
+*  decoder, whose per-version tables last from frame to frame. Symbols with
+*  the same text found at the same place are reported once.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRMULTIDETECTOR_H
+#define QRMULTIDETECTOR_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "qrdetector.h"
+#include "qrdecoder.h"
+#include "qrthreadpool.h"
+
+namespace QR
+{
+  //!  @struct  QRSymbolResult
+  /*!
+    A symbol decoded from an image, with its position.
+  */
+  struct QRSymbolResult
+  {
+    std::string m_text;       ///< Define decoded text.
+    int         m_version;    ///< Define version of the symbol.
+    ECL         m_ecl;        ///< Define error correction level of the symbol.
+    double      m_x;          ///< Define x coordinate of the center of the symbol, in pixels.
+    double      m_y;          ///< Define y coordinate of the center of the symbol, in pixels.
+    double      m_points[8];  ///< Define pattern centers, see QRDetector::getPoints().
+  };
+
+  //!  @class  QRMultiDetector
+  /*!
+    Finds and decodes all the symbols of a grayscale image. The detector owns a thread pool,
+    so it can't be copied; keep one around for a stream of frames.
+  */
+  class QRMultiDetector : public QRDetector
+  {
+    public:
+      /// Parametric Constructor, 0 threads means one per hardware thread.
+      explicit QRMultiDetector(int threads = 0);
+
+      /// Destructor
+      ~QRMultiDetector();
+
+      /** @brief find and decode every symbol of an image.
+      *
+      *  @param[in]   gray the luminance of the pixels, top row first.
+      *  @param[in]   width the width of the image.
+      *  @param[in]   height the height of the image.
+      *  @param[in]   stride the number of bytes from a row to the next one.
+      *  @param[out]  results the decoded symbols, sorted top to bottom then left to right.
+      *
+      *  @return int number of symbols decoded.
+      */
+      int detectAll(const unsigned char *gray, int width, int height, int stride, std::vector<QRSymbolResult> &results);
+
+      /** @brief find and decode every symbol of a bitmap.
+      *
+      *  @param[in]   bmp the image.
+      *  @param[out]  results the decoded symbols, sorted top to bottom then left to right.
+      *
+      *  @return int number of symbols decoded.
+      */
+      int detectAll(const Bitmap &bmp, std::vector<QRSymbolResult> &results);
+
+      /// number of finder pattern triplets tried by the last call (decoded or not).
+      int getClusterCount() const;
+
+    private:
+      //!  @struct  Cluster
+      /*!
+        Three finder patterns taken as the corners of one symbol.
+      */
+      struct Cluster
+      {
+        QRFinderPattern m_patterns[3];    ///< Define bottom-left, top-left and top-right patterns.
+        double          m_score;          ///< Define shape score, see QRDetector::scoreTriplet().
+        double          m_side;           ///< Define squared length of the longest side.
+        int             m_members[3];     ///< Define indexes of the patterns in the candidates.
+      };
+
+      // Groups the candidates into triplets, every candidate in one triplet at most.
+      void clusterFinderPatterns(std::vector<Cluster> &clusters) const;
+
+      // Splits count rows (of pixels or of blocks) into strips, runs task(strip, first, last)
+      // for every strip on the pool and waits for them.
+      void runStrips(int count, const std::function<void(int, int, int)> &task);
+
+      // Samples and decodes a cluster, false if it isn't a readable symbol.
+      // Safe to run on several threads at once, each with its own decoder.
+      bool decodeCluster(const Cluster &cluster, QRDecoder &decoder, QRSymbolResult &result) const;
+
+      QRMultiDetector(const QRMultiDetector &other);
+      QRMultiDetector& operator=(const QRMultiDetector &other);
+
+    private:
+      QRThreadPool                                m_pool;             ///< Define threads binarizing, scanning and decoding.
+      std::vector<QRDecoder>                      m_decoders;         ///< Define decoder of every thread.
+      std::vector<std::vector<int> >              m_stripRuns;        ///< Define run lengths of the row scanned in every strip.
+      std::vector<std::vector<QRFinderPattern> >  m_stripCandidates;  ///< Define finder pattern candidates of every strip.
+      int                                         m_clusterCount;     ///< Define number of triplets tried by the last call.
+  };
+}
+
+#endif    // QRMULTIDETECTOR_H
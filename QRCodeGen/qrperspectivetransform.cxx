@@ -0,0 +1,134 @@
+#include "qrperspectivetransform.h"
+
+using namespace QR;
+
+/// Default Constructor
+QRPerspectiveTransform::QRPerspectiveTransform()
+{
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+      m_a[i][j] = (i == j) ? 1.0 : 0.0;
+  }
+}
+
+/// Copy Constructor
+QRPerspectiveTransform::QRPerspectiveTransform(const QRPerspectiveTransform &other)
+{
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+      m_a[i][j] = other.m_a[i][j];
+  }
+}
+
+/// Destructor
+QRPerspectiveTransform::~QRPerspectiveTransform()
+{
+}
+
+/// Assignment Operator
+QRPerspectiveTransform& QRPerspectiveTransform::operator=(const QRPerspectiveTransform &other)
+{
+  if(this != &other)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      for (int j = 0; j < 3; j++)
+        m_a[i][j] = other.m_a[i][j];
+    }
+  }
+
+  return(*this);
+}
+
+QRPerspectiveTransform QRPerspectiveTransform::quadrilateralToQuadrilateral(double x0, double y0, double x1, double y1,
+                                                                            double x2, double y2, double x3, double y3,
+                                                                            double x0p, double y0p, double x1p, double y1p,
+                                                                            double x2p, double y2p, double x3p, double y3p)
+{
+  QRPerspectiveTransform toSquare = quadrilateralToSquare(x0, y0, x1, y1, x2, y2, x3, y3);
+  QRPerspectiveTransform fromSquare = squareToQuadrilateral(x0p, y0p, x1p, y1p, x2p, y2p, x3p, y3p);
+
+  return(toSquare.times(fromSquare));
+}
+
+QRPerspectiveTransform QRPerspectiveTransform::squareToQuadrilateral(double x0, double y0, double x1, double y1,
+                                                                     double x2, double y2, double x3, double y3)
+{
+  QRPerspectiveTransform result;
+  double dx3 = x0 - x1 + x2 - x3;
+  double dy3 = y0 - y1 + y2 - y3;
+
+  if ((dx3 == 0.0) && (dy3 == 0.0))
+  {
+    /// parallelogram, the transformation is affine.
+    result.m_a[0][0] = x1 - x0;   result.m_a[0][1] = y1 - y0;   result.m_a[0][2] = 0.0;
+    result.m_a[1][0] = x2 - x1;   result.m_a[1][1] = y2 - y1;   result.m_a[1][2] = 0.0;
+    result.m_a[2][0] = x0;        result.m_a[2][1] = y0;        result.m_a[2][2] = 1.0;
+  }
+  else
+  {
+    double dx1 = x1 - x2;
+    double dx2 = x3 - x2;
+    double dy1 = y1 - y2;
+    double dy2 = y3 - y2;
+    double denominator = (dx1 * dy2) - (dx2 * dy1);
+    double a13 = ((dx3 * dy2) - (dx2 * dy3)) / denominator;
+    double a23 = ((dx1 * dy3) - (dx3 * dy1)) / denominator;
+
+    result.m_a[0][0] = x1 - x0 + (a13 * x1);  result.m_a[0][1] = y1 - y0 + (a13 * y1);  result.m_a[0][2] = a13;
+    result.m_a[1][0] = x3 - x0 + (a23 * x3);  result.m_a[1][1] = y3 - y0 + (a23 * y3);  result.m_a[1][2] = a23;
+    result.m_a[2][0] = x0;                    result.m_a[2][1] = y0;                    result.m_a[2][2] = 1.0;
+  }
+
+  return(result);
+}
+
+QRPerspectiveTransform QRPerspectiveTransform::quadrilateralToSquare(double x0, double y0, double x1, double y1,
+                                                                     double x2, double y2, double x3, double y3)
+{
+  return(squareToQuadrilateral(x0, y0, x1, y1, x2, y2, x3, y3).adjoint());
+}
+
+QRPerspectiveTransform QRPerspectiveTransform::times(const QRPerspectiveTransform &other) const
+{
+  QRPerspectiveTransform result;
+
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+      result.m_a[i][j] = (m_a[i][0] * other.m_a[0][j]) + (m_a[i][1] * other.m_a[1][j]) + (m_a[i][2] * other.m_a[2][j]);
+  }
+
+  return(result);
+}
+
+QRPerspectiveTransform QRPerspectiveTransform::adjoint() const
+{
+  QRPerspectiveTransform result;
+
+  /// transpose of the cofactor matrix
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      int r0 = (j + 1) % 3, r1 = (j + 2) % 3;
+      int c0 = (i + 1) % 3, c1 = (i + 2) % 3;
+
+      result.m_a[i][j] = (m_a[r0][c0] * m_a[r1][c1]) - (m_a[r0][c1] * m_a[r1][c0]);
+    }
+  }
+
+  return(result);
+}
+
+void QRPerspectiveTransform::transform(double &x, double &y) const
+{
+  double w = (x * m_a[0][2]) + (y * m_a[1][2]) + m_a[2][2];
+  double tx = ((x * m_a[0][0]) + (y * m_a[1][0]) + m_a[2][0]) / w;
+  double ty = ((x * m_a[0][1]) + (y * m_a[1][1]) + m_a[2][1]) / w;
+
+  x = tx;
+  y = ty;
+}
@@ -0,0 +1,80 @@
+/**
+*  @file    qrperspectivetransform.h
+*  @brief   class to map points between two quadrilaterals.
+*
+*  QRPerspectiveTransform is the projective transformation (homography)
+*  that maps the corners of one quadrilateral onto the corners of another.
+*  The detector uses it to map module coordinates of a symbol to the
+*  pixels of a camera image.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRPERSPECTIVETRANSFORM_H
+#define QRPERSPECTIVETRANSFORM_H
+
+namespace QR
+{
+  //!  @class  QRPerspectiveTransform
+  /*!
+    3x3 projective transformation, points are row vectors: [x' y' w'] = [x y 1] * M.
+  */
+  class QRPerspectiveTransform
+  {
+    public:
+      /// Default Constructor, identity.
+      QRPerspectiveTransform();
+
+      /// Copy Constructor
+      QRPerspectiveTransform(const QRPerspectiveTransform &other);
+
+      /// Destructor
+      ~QRPerspectiveTransform();
+
+      /// Assignment Operator
+      QRPerspectiveTransform& operator=(const QRPerspectiveTransform &other);
+
+      /** @brief transformation mapping a quadrilateral onto another.
+      *
+      *  Corners are given in order around the quadrilateral (x0, y0 to x3, y3),
+      *  corner i of the source is mapped to corner i of the destination.
+      *
+      *  @return QRPerspectiveTransform the transformation.
+      */
+      static QRPerspectiveTransform quadrilateralToQuadrilateral(double x0, double y0, double x1, double y1,
+                                                                 double x2, double y2, double x3, double y3,
+                                                                 double x0p, double y0p, double x1p, double y1p,
+                                                                 double x2p, double y2p, double x3p, double y3p);
+
+      /// transformation mapping the unit square (0,0) (1,0) (1,1) (0,1) onto a quadrilateral.
+      static QRPerspectiveTransform squareToQuadrilateral(double x0, double y0, double x1, double y1,
+                                                          double x2, double y2, double x3, double y3);
+
+      /// transformation mapping a quadrilateral onto the unit square.
+      static QRPerspectiveTransform quadrilateralToSquare(double x0, double y0, double x1, double y1,
+                                                          double x2, double y2, double x3, double y3);
+
+      /// transformation doing this one first, then other.
+      QRPerspectiveTransform times(const QRPerspectiveTransform &other) const;
+
+      /// inverse transformation (up to a scale factor, which doesn't matter).
+      QRPerspectiveTransform adjoint() const;
+
+      /** @brief map a point.
+      *
+      *  @param[in,out]  x the x coordinate.
+      *  @param[in,out]  y the y coordinate.
+      *
+      *  @return nothing.
+      */
+      void transform(double &x, double &y) const;
+
+    private:
+      double m_a[3][3];   ///< Define the matrix.
+  };
+}
+
+#endif    // QRPERSPECTIVETRANSFORM_H
@@ -0,0 +1,240 @@
+#include "qrreedsolomondecoder.h"
+
+using namespace QR;
+
+/// GF(2^8/0x11D) tables, filled before main() runs. GF_EXP is doubled so that
+/// GF_EXP[GF_LOG[x] + GF_LOG[y]] needs no modulo.
+static uint8_t GF_EXP[512];
+static int GF_LOG[256];
+
+static struct GaloisFieldTables
+{
+  GaloisFieldTables()
+  {
+    int value = 1;
+
+    for (int i = 0; i < 255; i++)
+    {
+      GF_EXP[i] = (uint8_t)value;
+      GF_EXP[i + 255] = (uint8_t)value;
+      GF_LOG[value] = i;
+      value = (value << 1) ^ ((value >> 7) * 0x11D);  // Multiply by 0x02 mod GF(2^8/0x11D)
+    }
+
+    GF_EXP[510] = GF_EXP[0];
+    GF_EXP[511] = GF_EXP[1];
+    GF_LOG[0] = 0;   // never used, 0 has no logarithm
+  }
+} gfTables;
+
+static inline uint8_t gfMultiply(uint8_t x, uint8_t y)
+{
+  return(((x == 0) || (y == 0)) ? 0 : GF_EXP[GF_LOG[x] + GF_LOG[y]]);
+}
+
+static inline uint8_t gfInverse(uint8_t x)
+{
+  return(GF_EXP[255 - GF_LOG[x]]);
+}
+
+/// value of the polynomial (coefficients from the lowest power) at x.
+static uint8_t evaluate(const ui8vector &poly, uint8_t x)
+{
+  uint8_t result = 0;
+
+  for (size_t i = poly.size(); i-- > 0; )
+    result = gfMultiply(result, x) ^ poly[i];
+
+  return(result);
+}
+
+/// Default Constructor
+QRReedSolomonDecoder::QRReedSolomonDecoder()
+  :m_degree(0)
+{
+}
+
+/// Parametric Constructor
+QRReedSolomonDecoder::QRReedSolomonDecoder(int degree)
+  :m_degree(0)
+{
+  setDegree(degree);
+}
+
+/// Copy Constructor
+QRReedSolomonDecoder::QRReedSolomonDecoder(const QRReedSolomonDecoder &other)
+  :m_degree(other.m_degree)
+{
+}
+
+/// Destructor
+QRReedSolomonDecoder::~QRReedSolomonDecoder()
+{
+}
+
+/// Assignment Operator
+QRReedSolomonDecoder& QRReedSolomonDecoder::operator=(const QRReedSolomonDecoder &other)
+{
+  if(this != &other)
+    m_degree = other.m_degree;
+
+  return(*this);
+}
+
+void QRReedSolomonDecoder::setDegree(int deg)
+{
+  if ((deg < 1) || (deg > 255))
+    throw "Degree out of range";
+
+  m_degree = deg;
+}
+
+bool QRReedSolomonDecoder::computeSyndromes(const ui8vector &block, ui8vector &syndromes) const
+{
+  uint8_t any = 0;
+
+  /// S_j = block(r^j), the roots of the generator polynomial are r^0 .. r^(degree-1).
+  syndromes.assign(m_degree, 0);
+
+  for (int j = 0; j < m_degree; j++)
+  {
+    uint8_t s = 0;
+
+    for (size_t i = 0; i < block.size(); i++)
+      s = ((s == 0) ? 0 : GF_EXP[GF_LOG[s] + j]) ^ block[i];
+
+    syndromes[j] = s;
+    any |= s;
+  }
+
+  return(any != 0);
+}
+
+int QRReedSolomonDecoder::decode(ui8vector &block, const std::vector<int> &erasures) const
+{
+  const int n = (int)block.size();
+
+  if ((m_degree < 1) || (n <= m_degree) || (n > 255))
+    throw "Invalid argument";
+
+  ui8vector syndromes;
+  if (!computeSyndromes(block, syndromes))
+    return(0);
+
+  const int numErasures = (int)erasures.size();
+  if (numErasures > m_degree)
+    throw "Too many erasures";
+
+  /// codeword i is the coefficient of x^(n-1-i), its locator is r^(n-1-i).
+  /// Erasure locator polynomial: product of (1 + X x) over the erasures.
+  ui8vector locator(1, 1);
+
+  for (int k = 0; k < numErasures; k++)
+  {
+    if ((erasures[k] < 0) || (erasures[k] >= n) || (std::count(erasures.begin(), erasures.begin() + k, erasures[k]) > 0))
+      throw "Invalid argument";
+
+    uint8_t X = GF_EXP[n - 1 - erasures[k]];
+    locator.push_back(0);
+
+    for (size_t i = locator.size() - 1; i > 0; i--)
+      locator[i] ^= gfMultiply(locator[i - 1], X);
+  }
+
+  /// Berlekamp-Massey, started from the erasure locator.
+  ui8vector previous(locator);
+  int L = numErasures;
+
+  for (int r = numErasures + 1; r <= m_degree; r++)
+  {
+    uint8_t delta = 0;
+
+    for (int j = 0; (j < (int)locator.size()) && (j <= r - 1); j++)
+      delta ^= gfMultiply(locator[j], syndromes[r - 1 - j]);
+
+    previous.insert(previous.begin(), 0);   // x * B(x)
+
+    if (delta == 0)
+      continue;
+
+    ui8vector next(std::max(locator.size(), previous.size()), 0);
+    std::copy(locator.begin(), locator.end(), next.begin());
+
+    for (size_t i = 0; i < previous.size(); i++)
+      next[i] ^= gfMultiply(delta, previous[i]);
+
+    if (2 * L <= r + numErasures - 1)
+    {
+      uint8_t inverse = gfInverse(delta);
+
+      previous.resize(locator.size());
+      for (size_t i = 0; i < locator.size(); i++)
+        previous[i] = gfMultiply(locator[i], inverse);
+
+      L = r + numErasures - L;
+    }
+
+    locator.swap(next);
+  }
+
+  while ((locator.size() > 1) && (locator.back() == 0))
+    locator.pop_back();
+
+  int numLocations = (int)locator.size() - 1;
+  if ((numLocations != L) || ((2 * (L - numErasures)) + numErasures > m_degree))
+    throw "Too many errors";
+
+  /// Chien search: codeword i is wrong if the locator has a root at r^-(n-1-i).
+  std::vector<int> positions;
+
+  for (int i = 0; i < n; i++)
+  {
+    if (evaluate(locator, GF_EXP[(255 - (n - 1 - i)) % 255]) == 0)
+      positions.push_back(i);
+  }
+
+  if ((int)positions.size() != numLocations)
+    throw "Too many errors";
+
+  /// Forney: error evaluator omega = S(x) * locator(x) mod x^degree.
+  ui8vector omega(m_degree, 0);
+
+  for (int i = 0; i < m_degree; i++)
+  {
+    for (int j = 0; (j < (int)locator.size()) && (i + j < m_degree); j++)
+      omega[i + j] ^= gfMultiply(syndromes[i], locator[j]);
+  }
+
+  /// formal derivative, only the odd powers are left in GF(2^8).
+  ui8vector derivative(locator.size() > 1 ? locator.size() - 1 : 1, 0);
+
+  for (size_t j = 1; j < locator.size(); j += 2)
+    derivative[j - 1] = locator[j];
+
+  ui8vector corrected(block);
+  int changed = 0;
+
+  for (size_t k = 0; k < positions.size(); k++)
+  {
+    int power = n - 1 - positions[k];
+    uint8_t X = GF_EXP[power];
+    uint8_t Xinverse = GF_EXP[(255 - power) % 255];
+    uint8_t denominator = evaluate(derivative, Xinverse);
+
+    if (denominator == 0)
+      throw "Too many errors";
+
+    uint8_t magnitude = gfMultiply(gfMultiply(X, evaluate(omega, Xinverse)), gfInverse(denominator));
+
+    corrected[positions[k]] ^= magnitude;
+    changed += (magnitude != 0) ? 1 : 0;
+  }
+
+  /// more errors than the code can correct may still give a "solution", make sure it is a codeword.
+  if (computeSyndromes(corrected, syndromes))
+    throw "Too many errors";
+
+  block.swap(corrected);
+
+  return(changed);
+}
@@ -0,0 +1,81 @@
+/**
+*  @file    qrreedsolomondecoder.h
+*  @brief   class to correct QR Code blocks with their Reed-Solomon codewords.
+*
+*  Corrects the errors (and erasures, errors at known positions) of a block made of
+*  data codewords followed by the error correction codewords that QRReedSolomonGenerator
+*  computed for them. A block with 2 * errors + erasures <= degree is always corrected.
+*  GF(2^8/0x11D) arithmetic uses exponent/logarithm tables, and a clean block (all the
+*  syndromes are zero) is detected without going through the error locator algorithm.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRREEDSOLOMONDECODER_H
+#define QRREEDSOLOMONDECODER_H
+
+#include <algorithm>
+#include <vector>
+
+#include "qrutility.h"
+
+namespace QR
+{
+  //!  @class  QRReedSolomonDecoder
+  /*!
+    Reed-Solomon decoder (syndromes, Berlekamp-Massey with erasures, Chien search, Forney)
+    for the code of QRReedSolomonGenerator at a given degree. Objects are immutable,
+    the state only depends on the degree.
+  */
+  class QRReedSolomonDecoder
+  {
+    public:
+      /// Default Constructor
+      QRReedSolomonDecoder();
+
+      /// Parametric Constructor
+      /// Creates a decoder for blocks with degree error correction codewords.
+      QRReedSolomonDecoder(int degree);
+
+      /// Copy Constructor
+      QRReedSolomonDecoder(const QRReedSolomonDecoder &other);
+
+      /// Destructor
+      ~QRReedSolomonDecoder();
+
+      /// Assignment Operator
+      QRReedSolomonDecoder& operator=(const QRReedSolomonDecoder &other);
+
+      /** @brief set degree for QRReedSolomonDecoder class.
+      *
+      *  @param[in]   deg the number of error correction codewords of a block, 1 to 255.
+      *
+      *  @return nothing.
+      */
+      void setDegree(int deg);
+
+      /** @brief correct a block in place.
+      *
+      *  Throws if the block can't be corrected, in which case it is left unchanged.
+      *
+      *  @param[in,out]  block the data codewords followed by the error correction codewords,
+      *                  at most 255 codewords in all.
+      *  @param[in]      erasures the indices (into block) of codewords known to be wrong.
+      *
+      *  @return int number of codewords changed, 0 for a clean block.
+      */
+      int decode(ui8vector &block, const std::vector<int> &erasures = std::vector<int>()) const;
+
+    private:
+      /// computes the degree syndromes of block, returns false if all of them are zero.
+      bool computeSyndromes(const ui8vector &block, ui8vector &syndromes) const;
+
+    private:
+      int m_degree;   ///< Define degree for the Reed-Solomon error correction.
+  };
+}
+
+#endif    // QRREEDSOLOMONDECODER_H
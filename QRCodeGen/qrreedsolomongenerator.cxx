@@ -4,23 +4,23 @@ using namespace QR;
 
 /// Default Constructor
 QRReedSolomonGenerator::QRReedSolomonGenerator(void)
-  :m_coefficients(),
-  m_degree(0)
+  :m_degree(0),
+  m_coefficients()
 {
 }
 
 /// Parametric Constructor
 QRReedSolomonGenerator::QRReedSolomonGenerator(int degree)
-  :m_coefficients(),
-  m_degree(degree)
+  :m_degree(degree),
+  m_coefficients()
 {
   computePolynomial();
 }
 
 /// Copy COnstructor
 QRReedSolomonGenerator::QRReedSolomonGenerator(const QRReedSolomonGenerator &other)
-  :m_coefficients(other.m_coefficients),
-  m_degree(other.m_degree)
+  :m_degree(other.m_degree),
+  m_coefficients(other.m_coefficients)
 {
 }
 
@@ -0,0 +1,550 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "qrroundtrip.h"
+#include "qrcode.h"
+#include "qrdecoder.h"
+#include "qrgridsampler.h"
+#include "bitmap.h"
+#include "png.h"
+#include "jpegdecoder.h"
+
+using namespace QR;
+
+typedef std::chrono::steady_clock Clock;
+
+static const char *FORMAT_NAMES[] = {"BMP", "PNG", "JPEG", "SVG"};
+static const char *STAGE_NAMES[] = {"encode", "render", "read", "sample", "decode"};
+
+/// most mismatches listed in the JSON summary.
+static const size_t MAX_REPORTED_MISMATCHES = 100;
+
+static double secondsSince(const Clock::time_point &start)
+{
+  return(std::chrono::duration<double>(Clock::now() - start).count());
+}
+
+static std::string escapeJSON(const std::string &text)
+{
+  std::string result;
+  char hex[8];
+
+  for (size_t i = 0; i < text.size(); i++)
+  {
+    unsigned char c = (unsigned char)text[i];
+
+    if ((c == '"') || (c == '\\'))
+    {
+      result += '\\';
+      result += (char)c;
+    }
+    else if ((c < 0x20) || (c >= 0x7F))
+    {
+      sprintf(hex, "\\u%04x", c);
+      result += hex;
+    }
+    else
+      result += (char)c;
+  }
+
+  return(result);
+}
+
+/// Default Constructor
+QRRoundTrip::QRRoundTrip()
+  :m_minVersion(1),
+  m_maxVersion(40),
+  m_minMask(0),
+  m_maxMask(7),
+  m_formats(),
+  m_scale(3),
+  m_border(4),
+  m_corpus(),
+  m_cases(0),
+  m_renders(0),
+  m_mismatches()
+{
+  for (int f = IF_BMP; f <= IF_SVG; f++)
+    m_formats.push_back((IMAGE_FORMAT)f);
+
+  std::fill(m_stageTime, m_stageTime + ST_COUNT, 0.0);
+  std::fill(m_stageCount, m_stageCount + ST_COUNT, 0);
+  std::fill(&m_formatTime[0][0], &m_formatTime[0][0] + FORMAT_COUNT * 2, 0.0);
+  std::fill(m_formatRenders, m_formatRenders + FORMAT_COUNT, 0);
+  std::fill(m_formatMismatches, m_formatMismatches + FORMAT_COUNT, 0);
+  std::fill(m_formatBytes, m_formatBytes + FORMAT_COUNT, 0.0);
+}
+
+/// Copy Constructor
+QRRoundTrip::QRRoundTrip(const QRRoundTrip &other)
+  :m_minVersion(other.m_minVersion),
+  m_maxVersion(other.m_maxVersion),
+  m_minMask(other.m_minMask),
+  m_maxMask(other.m_maxMask),
+  m_formats(other.m_formats),
+  m_scale(other.m_scale),
+  m_border(other.m_border),
+  m_corpus(other.m_corpus),
+  m_cases(other.m_cases),
+  m_renders(other.m_renders),
+  m_mismatches(other.m_mismatches)
+{
+  std::copy(other.m_stageTime, other.m_stageTime + ST_COUNT, m_stageTime);
+  std::copy(other.m_stageCount, other.m_stageCount + ST_COUNT, m_stageCount);
+  std::copy(&other.m_formatTime[0][0], &other.m_formatTime[0][0] + FORMAT_COUNT * 2, &m_formatTime[0][0]);
+  std::copy(other.m_formatRenders, other.m_formatRenders + FORMAT_COUNT, m_formatRenders);
+  std::copy(other.m_formatMismatches, other.m_formatMismatches + FORMAT_COUNT, m_formatMismatches);
+  std::copy(other.m_formatBytes, other.m_formatBytes + FORMAT_COUNT, m_formatBytes);
+}
+
+/// Destructor
+QRRoundTrip::~QRRoundTrip()
+{
+}
+
+/// Assignment Operator
+QRRoundTrip& QRRoundTrip::operator=(const QRRoundTrip &other)
+{
+  if(this != &other)
+  {
+    m_minVersion = other.m_minVersion;
+    m_maxVersion = other.m_maxVersion;
+    m_minMask = other.m_minMask;
+    m_maxMask = other.m_maxMask;
+    m_formats = other.m_formats;
+    m_scale = other.m_scale;
+    m_border = other.m_border;
+    m_corpus = other.m_corpus;
+    m_cases = other.m_cases;
+    m_renders = other.m_renders;
+    m_mismatches = other.m_mismatches;
+    std::copy(other.m_stageTime, other.m_stageTime + ST_COUNT, m_stageTime);
+    std::copy(other.m_stageCount, other.m_stageCount + ST_COUNT, m_stageCount);
+    std::copy(&other.m_formatTime[0][0], &other.m_formatTime[0][0] + FORMAT_COUNT * 2, &m_formatTime[0][0]);
+    std::copy(other.m_formatRenders, other.m_formatRenders + FORMAT_COUNT, m_formatRenders);
+    std::copy(other.m_formatMismatches, other.m_formatMismatches + FORMAT_COUNT, m_formatMismatches);
+    std::copy(other.m_formatBytes, other.m_formatBytes + FORMAT_COUNT, m_formatBytes);
+  }
+
+  return(*this);
+}
+
+void QRRoundTrip::setVersions(int minVersion, int maxVersion)
+{
+  if ((minVersion < 1) || (maxVersion > 40) || (minVersion > maxVersion))
+    throw "Value out of range";
+
+  m_minVersion = minVersion;
+  m_maxVersion = maxVersion;
+}
+
+void QRRoundTrip::setMasks(int minMask, int maxMask)
+{
+  if ((minMask < 0) || (maxMask > 7) || (minMask > maxMask))
+    throw "Value out of range";
+
+  m_minMask = minMask;
+  m_maxMask = maxMask;
+}
+
+void QRRoundTrip::setFormats(const std::vector<IMAGE_FORMAT> &formats)
+{
+  for (size_t i = 0; i < formats.size(); i++)
+  {
+    if (getFormatIndex(formats[i]) < 0)
+      throw "Invalid image format";
+  }
+
+  m_formats = formats;
+}
+
+void QRRoundTrip::setGeometry(int scale, int border)
+{
+  if ((scale < 1) || (border < 1))
+    throw "Value out of range";
+
+  m_scale = scale;
+  m_border = border;
+}
+
+int QRRoundTrip::run()
+{
+  m_corpus.setSeed(1);
+  m_cases = 0;
+  m_renders = 0;
+  m_mismatches.clear();
+  std::fill(m_stageTime, m_stageTime + ST_COUNT, 0.0);
+  std::fill(m_stageCount, m_stageCount + ST_COUNT, 0);
+  std::fill(&m_formatTime[0][0], &m_formatTime[0][0] + FORMAT_COUNT * 2, 0.0);
+  std::fill(m_formatRenders, m_formatRenders + FORMAT_COUNT, 0);
+  std::fill(m_formatMismatches, m_formatMismatches + FORMAT_COUNT, 0);
+  std::fill(m_formatBytes, m_formatBytes + FORMAT_COUNT, 0.0);
+
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+  QRDecoder decoder;
+  char name[64];
+
+  for (int version = m_minVersion; version <= m_maxVersion; version++)
+  {
+    for (int e = 0; e < 4; e++)
+    {
+      for (int content = 0; content < QRTestCorpus::CT_COUNT; content++)
+      {
+        std::vector<QRTestCorpus::Segment> segments;
+        m_corpus.makeSegments(version, ecls[e], (QRTestCorpus::CONTENT)content, segments);
+
+        const std::string expected(QRTestCorpus::getText(segments));
+        const std::vector<QRSegment> segs(QRTestCorpus::toQRSegments(segments));
+
+        for (int mask = m_minMask; mask <= m_maxMask; mask++)
+        {
+          sprintf(name, "v%d-%s-mask%d-%s", version, QRTestCorpus::getECLName(ecls[e]), mask,
+                  QRTestCorpus::getContentName((QRTestCorpus::CONTENT)content));
+          m_cases++;
+
+          QRCode qr;
+          Clock::time_point start = Clock::now();
+          try
+          {
+            qr.encode(segs, ecls[e], mask);
+          }
+          catch (const char *error)
+          {
+            m_mismatches.push_back(std::string(name) + ": encode: " + error);
+            continue;
+          }
+          m_stageTime[ST_ENCODE] += secondsSince(start);
+          m_stageCount[ST_ENCODE]++;
+
+          if ((qr.getVersion() != version) || (qr.getECL() != ecls[e]) || (qr.getMask() != mask))
+          {
+            m_mismatches.push_back(std::string(name) + ": encode: wrong version, level or mask");
+            continue;
+          }
+
+          for (size_t f = 0; f < m_formats.size(); f++)
+          {
+            const int index = getFormatIndex(m_formats[f]);
+            std::string error;
+            ui8vector image;
+            QRBitMatrix matrix;
+
+            start = Clock::now();
+            qr.encodeToBuffer(m_formats[f], image, m_scale, m_border);
+            m_formatTime[index][0] += secondsSince(start);
+            m_stageCount[ST_RENDER]++;
+            m_formatBytes[index] += image.size();
+            m_formatRenders[index]++;
+            m_renders++;
+
+            bool ok = readBack(m_formats[f], image, matrix, error);
+
+            if (ok)
+            {
+              start = Clock::now();
+              try
+              {
+                std::string text = decoder.decode(matrix);
+
+                if (text != expected)
+                  error = "decode: wrong text";
+                else if ((decoder.getVersion() != version) || (decoder.getECL() != ecls[e]) || (decoder.getMask() != mask))
+                  error = "decode: wrong version, level or mask";
+              }
+              catch (const char *message)
+              {
+                error = std::string("decode: ") + message;
+              }
+              m_stageTime[ST_DECODE] += secondsSince(start);
+              m_stageCount[ST_DECODE]++;
+            }
+
+            if (!error.empty())
+            {
+              m_mismatches.push_back(std::string(name) + " " + FORMAT_NAMES[index] + ": " + error);
+              m_formatMismatches[index]++;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < FORMAT_COUNT; i++)
+  {
+    m_stageTime[ST_RENDER] += m_formatTime[i][0];
+    m_stageTime[ST_READ] += m_formatTime[i][1];
+  }
+
+  return((int)m_mismatches.size());
+}
+
+int QRRoundTrip::getCaseCount() const
+{
+  return(m_cases);
+}
+
+int QRRoundTrip::getRenderCount() const
+{
+  return(m_renders);
+}
+
+const std::vector<std::string>& QRRoundTrip::getMismatches() const
+{
+  return(m_mismatches);
+}
+
+std::string QRRoundTrip::toJSON() const
+{
+  std::ostringstream json;
+
+  json << "{\n";
+  json << "  \"corpus\": {\"min_version\": " << m_minVersion << ", \"max_version\": " << m_maxVersion
+       << ", \"ecls\": 4, \"min_mask\": " << m_minMask << ", \"max_mask\": " << m_maxMask << ", \"contents\": [";
+  for (int c = 0; c < QRTestCorpus::CT_COUNT; c++)
+    json << ((c > 0) ? ", " : "") << "\"" << QRTestCorpus::getContentName((QRTestCorpus::CONTENT)c) << "\"";
+  json << "], \"scale\": " << m_scale << ", \"border\": " << m_border << "},\n";
+
+  json << "  \"cases\": " << m_cases << ",\n";
+  json << "  \"renders\": " << m_renders << ",\n";
+  json << "  \"mismatches\": " << m_mismatches.size() << ",\n";
+
+  json << "  \"stages\": {\n";
+  for (int s = 0; s < ST_COUNT; s++)
+  {
+    json << "    \"" << STAGE_NAMES[s] << "\": {\"count\": " << m_stageCount[s]
+         << ", \"total_ms\": " << (m_stageTime[s] * 1e3)
+         << ", \"mean_us\": " << ((m_stageCount[s] > 0) ? (m_stageTime[s] * 1e6 / m_stageCount[s]) : 0.0) << "}"
+         << ((s + 1 < ST_COUNT) ? "," : "") << "\n";
+  }
+  json << "  },\n";
+
+  json << "  \"formats\": {\n";
+  for (int f = 0; f < FORMAT_COUNT; f++)
+  {
+    int n = m_formatRenders[f];
+
+    json << "    \"" << FORMAT_NAMES[f] << "\": {\"renders\": " << n << ", \"mismatches\": " << m_formatMismatches[f]
+         << ", \"mean_bytes\": " << ((n > 0) ? (m_formatBytes[f] / n) : 0.0)
+         << ", \"render_ms\": " << (m_formatTime[f][0] * 1e3) << ", \"read_ms\": " << (m_formatTime[f][1] * 1e3) << "}"
+         << ((f + 1 < FORMAT_COUNT) ? "," : "") << "\n";
+  }
+  json << "  },\n";
+
+  json << "  \"failures\": [";
+  for (size_t i = 0; (i < m_mismatches.size()) && (i < MAX_REPORTED_MISMATCHES); i++)
+    json << ((i > 0) ? "," : "") << "\n    \"" << escapeJSON(m_mismatches[i]) << "\"";
+  json << (m_mismatches.empty() ? "]\n" : "\n  ]\n");
+
+  json << "}\n";
+
+  return(json.str());
+}
+
+bool QRRoundTrip::writeJSON(const std::string &filename) const
+{
+  std::ofstream fs(filename.c_str(), std::ios::out | std::ios::binary);
+
+  if (!fs.is_open())
+    return(false);
+
+  std::string json = toJSON();
+  fs.write(json.c_str(), json.size());
+
+  return(fs.good());
+}
+
+bool QRRoundTrip::readBack(const IMAGE_FORMAT &format, const ui8vector &image, QRBitMatrix &matrix, std::string &error)
+{
+  const int index = getFormatIndex(format);
+  std::vector<unsigned char> gray;
+  int width = 0, height = 0;
+
+  Clock::time_point start = Clock::now();
+  m_stageCount[ST_READ]++;
+
+  switch (format)
+  {
+    case IF_BMP:
+    {
+      Bitmap bmp;
+      if (bmp.readFromBuffer(&image[0], image.size()))
+      {
+        bmp.getGrayscale(gray);
+        width = bmp.getWidth();
+        height = bmp.getHeight();
+      }
+      break;
+    }
+
+    case IF_PNG:
+    {
+      PNG::Png png;
+      if (png.readFromBuffer(&image[0], (PNG::DWORD)image.size()))
+      {
+        width = png.getWidth();
+        height = png.getHeight();
+        gray.resize(width * height);
+
+        for (int y = 0; y < height; y++)
+        {
+          for (int x = 0; x < width; x++)
+            gray[(y * width) + x] = png.getPNGPixel(y, x) ? 0 : 255;
+        }
+      }
+      break;
+    }
+
+    case IF_JPEG:
+    {
+      JPEG::JpegDecoder jpg;
+      if (jpg.decode(&image[0], image.size()))
+      {
+        gray = jpg.getLuminance();
+        width = jpg.getWidth();
+        height = jpg.getHeight();
+      }
+      break;
+    }
+
+    default:
+    {
+      /// vector: the outlines give the modules directly, there's nothing to sample.
+      bool ok = readSvg(image, m_border, matrix);
+      m_formatTime[index][1] += secondsSince(start);
+
+      if (!ok)
+        error = "read: invalid SVG path";
+
+      return(ok);
+    }
+  }
+
+  m_formatTime[index][1] += secondsSince(start);
+
+  if (gray.empty())
+  {
+    error = "read: image can't be decoded";
+    return(false);
+  }
+
+  start = Clock::now();
+  try
+  {
+    QRGridSampler sampler;
+    matrix = sampler.sample(gray, width, height, m_scale, m_border);
+  }
+  catch (const char *message)
+  {
+    error = std::string("sample: ") + message;
+  }
+  m_stageTime[ST_SAMPLE] += secondsSince(start);
+  m_stageCount[ST_SAMPLE]++;
+
+  return(error.empty());
+}
+
+bool QRRoundTrip::readSvg(const ui8vector &image, int border, QRBitMatrix &matrix)
+{
+  const std::string svg(image.begin(), image.end());
+
+  /// the symbol size from the view box, the dark modules from the path.
+  size_t viewBox = svg.find("viewBox=\"0 0 ");
+  size_t path = svg.find("<path d=\"");
+  if ((viewBox == std::string::npos) || (path == std::string::npos))
+    return(false);
+
+  int dimension = atoi(svg.c_str() + viewBox + 13);
+  int size = dimension - 2 * border;
+  if ((size < 21) || (size > 177))
+    return(false);
+
+  /// crossings of the vertical edges with every row of modules, filled even-odd.
+  std::vector<std::vector<int> > crossings(dimension);
+  const char *p = svg.c_str() + path + 9;
+  int x = 0, y = 0, startX = 0, startY = 0;
+
+  while (*p != '"')
+  {
+    char command = *p++;
+    char *end;
+
+    if ((command == 'M') || (command == 'm'))
+    {
+      long dx = strtol(p, &end, 10);
+      if (*end != ',')
+        return(false);
+
+      long dy = strtol(end + 1, &end, 10);
+      p = end;
+
+      x = (command == 'M') ? (int)dx : (x + (int)dx);
+      y = (command == 'M') ? (int)dy : (y + (int)dy);
+      startX = x;
+      startY = y;
+    }
+    else if ((command == 'h') || (command == 'v') || (command == 'z'))
+    {
+      int toX = x, toY = y;
+
+      if (command == 'z')
+      {
+        toX = startX;
+        toY = startY;
+      }
+      else
+      {
+        long d = strtol(p, &end, 10);
+        if (end == p)
+          return(false);
+
+        p = end;
+        (command == 'h') ? (toX += (int)d) : (toY += (int)d);
+      }
+
+      if ((toX == x) && (toY != y))
+      {
+        for (int row = std::min(y, toY); row < std::max(y, toY); row++)
+        {
+          if ((row < 0) || (row >= dimension))
+            return(false);
+
+          crossings[row].push_back(x);
+        }
+      }
+
+      x = toX;
+      y = toY;
+    }
+    else
+      return(false);
+  }
+
+  matrix = QRBitMatrix(size);
+
+  for (int row = 0; row < dimension; row++)
+  {
+    std::vector<int> &edges = crossings[row];
+    std::sort(edges.begin(), edges.end());
+
+    if (edges.size() % 2 != 0)
+      return(false);
+
+    for (size_t i = 0; i < edges.size(); i += 2)
+    {
+      for (int col = edges[i]; col < edges[i + 1]; col++)
+        matrix.set(col - border, row - border, true);
+    }
+  }
+
+  return(true);
+}
+
+int QRRoundTrip::getFormatIndex(const IMAGE_FORMAT &format)
+{
+  return((format <= IF_SVG) ? (int)format : -1);
+}
@@ -0,0 +1,138 @@
+/**
+*  @file    qrroundtrip.h
+*  @brief   class to verify symbols by encoding, rendering and decoding them back.
+*
+*  QRRoundTrip generates a corpus of symbols covering every version, error
+*  correction level and mask, with numeric, alphanumeric, byte, kanji and
+*  mixed content filling each symbol to capacity. Every symbol is rendered
+*  through the image writers (BMP, PNG, JPEG, SVG), read back from memory
+*  (Bitmap, Png, JpegDecoder, or the SVG path), sampled with QRGridSampler
+*  and decoded with QRDecoder. Any difference in text, version, error
+*  correction level or mask is a mismatch. The time spent in every stage is
+*  recorded, and the results can be written as a JSON summary, so the same
+*  run doubles as a performance regression check.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRROUNDTRIP_H
+#define QRROUNDTRIP_H
+
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrsegment.h"
+#include "qrbitmatrix.h"
+#include "qrtestcorpus.h"
+
+namespace QR
+{
+  //!  @class  QRRoundTrip
+  /*!
+    Encode -> render -> read -> sample -> decode verification harness.
+  */
+  class QRRoundTrip
+  {
+    public:
+      /// stages of a round trip, the render and read stages are timed per format.
+      enum STAGE
+      {
+        ST_ENCODE = 0,
+        ST_RENDER,
+        ST_READ,
+        ST_SAMPLE,
+        ST_DECODE,
+        ST_COUNT
+      };
+
+      /// Default Constructor, the whole corpus through BMP, PNG, JPEG and SVG at scale 3.
+      QRRoundTrip();
+
+      /// Copy Constructor
+      QRRoundTrip(const QRRoundTrip &other);
+
+      /// Destructor
+      ~QRRoundTrip();
+
+      /// Assignment Operator
+      QRRoundTrip& operator=(const QRRoundTrip &other);
+
+      /// limit the corpus to versions minVersion to maxVersion.
+      void setVersions(int minVersion, int maxVersion);
+
+      /// limit the corpus to masks minMask to maxMask.
+      void setMasks(int minMask, int maxMask);
+
+      /// set the image formats to go through, EPS and PDF can't be read back.
+      void setFormats(const std::vector<IMAGE_FORMAT> &formats);
+
+      /// set the pixels per module and the quiet zone of the raster images.
+      void setGeometry(int scale, int border);
+
+      /** @brief run the whole corpus.
+      *
+      *  The counters and timings of a previous run are reset first.
+      *
+      *  @return int number of mismatches.
+      */
+      int run();
+
+      /// number of symbols encoded by the last run.
+      int getCaseCount() const;
+
+      /// number of images rendered and read back by the last run.
+      int getRenderCount() const;
+
+      /// description of every mismatch of the last run.
+      const std::vector<std::string>& getMismatches() const;
+
+      /** @brief summary of the last run as JSON.
+      *
+      *  Holds the corpus settings, the counts, the time spent in every stage
+      *  (overall and per format) and the first 100 mismatches.
+      *
+      *  @return std::string the JSON document.
+      */
+      std::string toJSON() const;
+
+      /// write toJSON() to a file, false if it can't be written.
+      bool writeJSON(const std::string &filename) const;
+
+    private:
+      // Reads a rendered image back into a module matrix, false (and the reason) if it can't.
+      bool readBack(const IMAGE_FORMAT &format, const ui8vector &image, QRBitMatrix &matrix, std::string &error);
+
+      // Rasterizes the path of an SVG image written by QRCode, one pixel per module.
+      static bool readSvg(const ui8vector &image, int border, QRBitMatrix &matrix);
+
+      // Index of a format in the per format counters, -1 for the formats which can't be read back.
+      static int getFormatIndex(const IMAGE_FORMAT &format);
+
+    private:
+      static const int FORMAT_COUNT = 4;      ///< Define number of formats which can be read back.
+
+      int                       m_minVersion;                     ///< Define first version of the corpus.
+      int                       m_maxVersion;                     ///< Define last version of the corpus.
+      int                       m_minMask;                        ///< Define first mask of the corpus.
+      int                       m_maxMask;                        ///< Define last mask of the corpus.
+      std::vector<IMAGE_FORMAT> m_formats;                        ///< Define formats every symbol goes through.
+      int                       m_scale;                          ///< Define pixels per module of the raster images.
+      int                       m_border;                         ///< Define quiet zone of the images, in modules.
+      QRTestCorpus              m_corpus;                         ///< Define generator of the content.
+      int                       m_cases;                          ///< Define number of symbols encoded.
+      int                       m_renders;                        ///< Define number of images read back.
+      std::vector<std::string>  m_mismatches;                     ///< Define description of every mismatch.
+      double                    m_stageTime[ST_COUNT];            ///< Define seconds spent in every stage.
+      int                       m_stageCount[ST_COUNT];           ///< Define number of runs of every stage.
+      double                    m_formatTime[FORMAT_COUNT][2];    ///< Define seconds spent rendering and reading every format.
+      int                       m_formatRenders[FORMAT_COUNT];    ///< Define images of every format.
+      int                       m_formatMismatches[FORMAT_COUNT]; ///< Define mismatches of every format.
+      double                    m_formatBytes[FORMAT_COUNT];      ///< Define total size of the images of every format.
+  };
+}
+
+#endif    // QRROUNDTRIP_H
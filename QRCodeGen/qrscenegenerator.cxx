@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "qrscenegenerator.h"
+#include "qrperspectivetransform.h"
+
+using namespace QR;
+
+/// pixel levels of the scene.
+static const int BACKGROUND_LEVEL = 150;
+static const int LIGHT_LEVEL = 215;
+static const int DARK_LEVEL = 35;
+
+/// quiet zone around every symbol, in modules.
+static const int QUIET_ZONE = 4;
+
+/// Parametric Constructor
+QRSceneGenerator::QRSceneGenerator(int width, int height, unsigned int seed)
+  :m_width(width),
+  m_height(height),
+  m_seed(seed),
+  m_image(width * height, (unsigned char)BACKGROUND_LEVEL)
+{
+}
+
+/// Copy Constructor
+QRSceneGenerator::QRSceneGenerator(const QRSceneGenerator &other)
+  :m_width(other.m_width),
+  m_height(other.m_height),
+  m_seed(other.m_seed),
+  m_image(other.m_image)
+{
+}
+
+/// Destructor
+QRSceneGenerator::~QRSceneGenerator()
+{
+}
+
+/// Assignment Operator
+QRSceneGenerator& QRSceneGenerator::operator=(const QRSceneGenerator &other)
+{
+  if(this != &other)
+  {
+    m_width = other.m_width;
+    m_height = other.m_height;
+    m_seed = other.m_seed;
+    m_image = other.m_image;
+  }
+
+  return(*this);
+}
+
+void QRSceneGenerator::clear()
+{
+  std::fill(m_image.begin(), m_image.end(), (unsigned char)BACKGROUND_LEVEL);
+}
+
+void QRSceneGenerator::addSymbol(const QRCode &qr, double x, double y, double moduleSize, double angle)
+{
+  QRBitMatrix symbol = qr.toBitMatrix();
+  const double extent = symbol.getSize() + 2 * QUIET_ZONE;
+  const double half = extent * moduleSize / 2.0;
+  const double c = std::cos(angle);
+  const double s = std::sin(angle);
+  double corners[8];
+
+  /// corners clockwise from the top-left one.
+  for (int i = 0; i < 4; i++)
+  {
+    double dx = ((i == 1) || (i == 2)) ? half : -half;
+    double dy = (i >= 2) ? half : -half;
+
+    corners[2 * i] = x + (dx * c) - (dy * s);
+    corners[2 * i + 1] = y + (dx * s) + (dy * c);
+  }
+
+  QRPerspectiveTransform toSymbol = QRPerspectiveTransform::quadrilateralToQuadrilateral(
+      corners[0], corners[1], corners[2], corners[3], corners[4], corners[5], corners[6], corners[7],
+      0.0, 0.0, extent, 0.0, extent, extent, 0.0, extent);
+
+  /// only the pixels of the bounding box of the rotated square.
+  int left = m_width, right = -1, top = m_height, bottom = -1;
+  for (int i = 0; i < 4; i++)
+  {
+    left = std::min(left, (int)std::floor(corners[2 * i]));
+    right = std::max(right, (int)std::ceil(corners[2 * i]));
+    top = std::min(top, (int)std::floor(corners[2 * i + 1]));
+    bottom = std::max(bottom, (int)std::ceil(corners[2 * i + 1]));
+  }
+
+  left = std::max(0, left);
+  top = std::max(0, top);
+  right = std::min(m_width - 1, right);
+  bottom = std::min(m_height - 1, bottom);
+
+  for (int py = top; py <= bottom; py++)
+  {
+    for (int px = left; px <= right; px++)
+    {
+      double mx = px + 0.5;
+      double my = py + 0.5;
+      toSymbol.transform(mx, my);
+
+      if ((mx < 0.0) || (my < 0.0) || (mx >= extent) || (my >= extent))
+        continue;
+
+      bool dark = symbol.get((int)mx - QUIET_ZONE, (int)my - QUIET_ZONE);
+      m_image[(py * m_width) + px] = (unsigned char)(dark ? DARK_LEVEL : LIGHT_LEVEL);
+    }
+  }
+}
+
+void QRSceneGenerator::addLightingAndNoise(double falloff, int noise)
+{
+  for (int y = 0; y < m_height; y++)
+  {
+    for (int x = 0; x < m_width; x++)
+    {
+      unsigned char &pixel = m_image[(y * m_width) + x];
+      double light = 1.0 - falloff * (((double)x / m_width) + ((double)y / m_height)) / 2.0;
+      int level = (int)(pixel * light);
+
+      if (noise > 0)
+        level += (random() % (2 * noise + 1)) - noise;
+
+      pixel = (unsigned char)std::max(0, std::min(255, level));
+    }
+  }
+}
+
+int QRSceneGenerator::generate(int count, double moduleSize, std::vector<std::string> &texts)
+{
+  clear();
+  texts.clear();
+
+  /// contents of every kind: numeric, alphanumeric and byte mode, of various lengths.
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+  std::vector<QRCode> symbols(count);
+  int largest = 0;
+  char text[128];
+
+  for (int i = 0; i < count; i++)
+  {
+    int n = random();
+
+    switch (i % 3)
+    {
+      case 0:
+        sprintf(text, "%05d%05d%05d%05d", i, n, n % 9973, (n * 7) % 99991);
+        break;
+
+      case 1:
+        sprintf(text, "PALLET-%04d LOT %05d/%d", i, n, n % 97);
+        break;
+
+      default:
+        sprintf(text, "https://example.com/label?id=%d&sku=%x&qty=%d", i, n, n % 50);
+        break;
+    }
+
+    texts.push_back(text);
+    symbols[i].encode(text, ecls[random() % 4]);
+    largest = std::max(largest, symbols[i].toBitMatrix().getSize());
+  }
+
+  /// a grid of cells large enough for the largest symbol at any rotation.
+  const double diagonal = (largest + 2 * QUIET_ZONE) * moduleSize * std::sqrt(2.0);
+  const int cell = (int)(diagonal * 1.05) + 1;
+  const int columns = m_width / cell;
+  const int rows = m_height / cell;
+  const int placed = std::min(count, columns * rows);
+
+  for (int i = 0; i < placed; i++)
+  {
+    double jitter = (cell - diagonal) / 2.0;
+    double x = ((i % columns) + 0.5) * cell + jitter * ((random() % 201) - 100) / 100.0;
+    double y = ((i / columns) + 0.5) * cell + jitter * ((random() % 201) - 100) / 100.0;
+    double angle = (random() % 3600) * (3.14159265358979 / 1800.0);
+
+    addSymbol(symbols[i], x, y, moduleSize, angle);
+  }
+
+  texts.resize(placed);
+  addLightingAndNoise(0.4, 12);
+
+  return(placed);
+}
+
+int QRSceneGenerator::getWidth() const
+{
+  return(m_width);
+}
+
+int QRSceneGenerator::getHeight() const
+{
+  return(m_height);
+}
+
+const std::vector<unsigned char>& QRSceneGenerator::getImage() const
+{
+  return(m_image);
+}
+
+Bitmap QRSceneGenerator::toBitmap() const
+{
+  /// 24 bit, bottom-up rows padded to 4 bytes.
+  const int rowSize = ((m_width * 3) + 3) & ~3;
+  std::vector<unsigned char> pixels(rowSize * m_height, 0);
+
+  for (int y = 0; y < m_height; y++)
+  {
+    const unsigned char *src = &m_image[y * m_width];
+    unsigned char *dst = &pixels[(m_height - 1 - y) * rowSize];
+
+    for (int x = 0; x < m_width; x++)
+      dst[3 * x] = dst[3 * x + 1] = dst[3 * x + 2] = src[x];
+  }
+
+  Bitmap bmp(m_width, m_height);
+  bmp.setPixelArray(&pixels[0]);
+
+  return(bmp);
+}
+
+int QRSceneGenerator::random()
+{
+  m_seed = (m_seed * 1103515245) + 12345;
+
+  return((int)((m_seed >> 16) & 0x7fff));
+}
@@ -0,0 +1,106 @@
+/**
+*  @file    qrscenegenerator.h
+*  @brief   class to render synthetic photos of many QR Code symbols.
+*
+*  QRSceneGenerator composites symbols encoded by QRCode into one large
+*  grayscale image, each rotated and placed on a grid like labels on a
+*  pallet, then adds uneven lighting and noise. The images are
+*  reproducible (seeded), so they serve as a benchmark for the detectors.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRSCENEGENERATOR_H
+#define QRSCENEGENERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "qrcode.h"
+#include "bitmap.h"
+
+namespace QR
+{
+  //!  @class  QRSceneGenerator
+  /*!
+    Renders symbols into a grayscale image, light background and dark modules.
+  */
+  class QRSceneGenerator
+  {
+    public:
+      /// Parametric Constructor, a blank image of the given size.
+      QRSceneGenerator(int width, int height, unsigned int seed = 1);
+
+      /// Copy Constructor
+      QRSceneGenerator(const QRSceneGenerator &other);
+
+      /// Destructor
+      ~QRSceneGenerator();
+
+      /// Assignment Operator
+      QRSceneGenerator& operator=(const QRSceneGenerator &other);
+
+      /// fill the image with the background level.
+      void clear();
+
+      /** @brief render a symbol with its 4 module quiet zone.
+      *
+      *  @param[in]  qr the encoded symbol.
+      *  @param[in]  x the x coordinate of the center of the symbol, in pixels.
+      *  @param[in]  y the y coordinate of the center of the symbol, in pixels.
+      *  @param[in]  moduleSize the size of a module, in pixels.
+      *  @param[in]  angle the rotation, in radians.
+      *
+      *  @return nothing.
+      */
+      void addSymbol(const QRCode &qr, double x, double y, double moduleSize, double angle);
+
+      /** @brief darken the image towards its right and bottom edges, and add noise.
+      *
+      *  @param[in]  falloff the fraction of light lost at the bottom right corner.
+      *  @param[in]  noise the largest change of a pixel (uniform noise).
+      *
+      *  @return nothing.
+      */
+      void addLightingAndNoise(double falloff, int noise);
+
+      /** @brief render a pallet: symbols with random contents and rotations on a grid.
+      *
+      *  The image is cleared first, and lighting and noise are added at the end.
+      *
+      *  @param[in]   count the number of symbols wanted.
+      *  @param[in]   moduleSize the size of a module, in pixels.
+      *  @param[out]  texts the encoded texts, in grid order (rows top to bottom).
+      *
+      *  @return int number of symbols rendered, less than count if they don't fit.
+      */
+      int generate(int count, double moduleSize, std::vector<std::string> &texts);
+
+      /// width of the image.
+      int getWidth() const;
+
+      /// height of the image.
+      int getHeight() const;
+
+      /// the image, width * height bytes, top row first.
+      const std::vector<unsigned char>& getImage() const;
+
+      /// the image as a 24 bit bitmap.
+      Bitmap toBitmap() const;
+
+    private:
+      // Next number of the pseudo-random sequence, 0 to 32767.
+      int random();
+
+    private:
+      int                         m_width;    ///< Define width of the image.
+      int                         m_height;   ///< Define height of the image.
+      unsigned int                m_seed;     ///< Define state of the pseudo-random sequence.
+      std::vector<unsigned char>  m_image;    ///< Define the pixels.
+  };
+}
+
+#endif    // QRSCENEGENERATOR_H
@@ -1,3 +1,5 @@
+#include "charclass.h"
+#include "textpack.h"
 #include "qrbitbuffer.h"
 #include "qrsegment.h"
 
@@ -111,6 +113,21 @@ uint8_t QRSegment::at(int pos) const
 *  @return size of Character Count Indicator.
 */
 int QRSegment::getCharCountIndicatorSize(int version) const
+{
+  return(getCharCountIndicatorSize(m_mode, version));
+}
+
+/** @brief get size of Character Count Indicator.
+*
+*  Get size of Character Count Indicator according to the
+*  passing DATA_MODE and version number.
+*
+*  @param[in]   mode the DATA_MODE of the segment.
+*  @param[in]   version the number of version.
+*
+*  @return size of Character Count Indicator, 0 for modes without one.
+*/
+int QRSegment::getCharCountIndicatorSize(const DATA_MODE &mode, int version)
 {
   int len = 0;
   int datamode = -1;
@@ -123,13 +140,13 @@ int QRSegment::getCharCountIndicatorSize(int version) const
                                       };
 
   /// get array position according to the DATA_MODE
-  if(m_mode == 1)
+  if(mode == 1)
     datamode = 0;
-  else if(m_mode == 2)
+  else if(mode == 2)
     datamode = 1;
-  else if(m_mode == 4)
+  else if(mode == 4)
     datamode = 2;
-  else if(m_mode == 8)
+  else if(mode == 8)
     datamode = 3;
 
   if(((datamode >= 0) && (datamode < 4)) &&
@@ -159,13 +176,22 @@ int QRSegment::getCharCountIndicatorSize(int version) const
 */
 void QRSegment::create(const std::string &input)
 {
+  int size = (int) input.size();
+
   /// check for valid input
-  if (input.size() > 0)
+  if (size > 0)
   {
+    /// classify the input once, 16 or 32 bytes at a time (charclass.h);
+    /// the mode is the first class whose run spans the whole input.
+    int words = CHARCLASS_WORDS(size);
+    std::vector<CharClassWord> masks(words * 3);
+    CharClass_classify((const unsigned char *)input.data(), size,
+                       &masks[0], &masks[words], &masks[words * 2]);
+
     // Select the most efficient segment encoding automatically
-    if (isDigit(input))
+    if (CharClass_span(&masks[0], 0, size) == size)
       createNumeric(input);
-    else if (isAlphaNumeric(input))
+    else if (CharClass_span(&masks[words], 0, size) == size)
       createAlphanumeric(input);
     /*else if (isKanji(input))
       createKanji(input);*/
@@ -277,9 +303,6 @@ void QRSegment::createNumeric(const std::string &input)
   /// check for valid input string
   if(size > 0)
   {
-    QRBitBuffer bits;
-    int split = 0, c_split = 0;
-
     //<!
     /* Encode procedure for numeric mode:
     *  1. Break String up into groups of Three number.
@@ -294,31 +317,13 @@ void QRSegment::createNumeric(const std::string &input)
     */
     //<!
 
-    /// loop over entire input string
-    for (int i = 0; i < size; ++i) 
-    {
-      /// split the character of input string into 3 digit number.
-      split = split * 10 + (input[i] - '0');
-      c_split++;
-
-      /// convert numbers into an 10-bit binary data, 
-      /// padding on the left with 0s if necessary.
-      if (c_split == 3) 
-      {
-        bits.appendBits(split, 10);
-        split = 0;
-        c_split = 0;
-      }
-    }
-
-    /// convert left numbers into:
-    /// for 1-digit = 4-bits and for 2-digit = 7-bits. 
-    /// padding on the left with 0s if necessary.
-    if (c_split > 0)  // 1 or 2 digits remaining
-      bits.appendBits(split, c_split * 3 + 1);
+    /// the groups are packed 4 to 16 at a time (textpack.h),
+    /// bit for bit as appending them one by one does.
+    ui8vector bits(TEXTPACK_BYTES(TEXTPACK_NUMERIC_BITS(size)));
+    int bitSize = TextPack_numeric((const unsigned char *)input.data(), size, &bits[0]);
 
     /// Set all the member variables of this segment.
-    setSegment(DM_NUM, size, bits.getBytes(), bits.getBitLength());
+    setSegment(DM_NUM, size, bits, bitSize);
   }
 }
 
@@ -341,9 +346,6 @@ void QRSegment::createAlphanumeric(const std::string &input)
   /// check for valid input
   if(size > 0)
   {
-    QRBitBuffer bits;
-    int digit = 0, count = 0;
-
     //<!
     /* Encode procedure for alphanumeric mode:
     *  1. each alphanumeric character is represented by a number according to the
@@ -360,37 +362,13 @@ void QRSegment::createAlphanumeric(const std::string &input)
     */
     //<!
 
-    ///loop over entire input string
-    for (int i = 0; i < size; ++i) 
-    {
-      /// get alphanumeric value for each character of input string
-      digit += getAlphanumeric(input[i]);
-      count++;
-
-      // if count == 1, then multiply digit by 45.
-      if((count == 1) && (i < (size - 1)))
-        digit = digit * 45;
-
-      // if count == 2, create a binary number for each pair
-      if(count == 2)
-      {
-        /// convert number(formed using character pair) into an 11-bit binary data, 
-        /// padding on the left with 0s if necessary.
-        bits.appendBits(digit, 11);
-
-        // reset digit and count.
-        digit = count = 0;
-      }
-    }
-
-    /// If encoding an odd number of characters, 
-    /// take the numeric representation of the final character and 
-    /// convert it into a 6-bit binary data.
-    if (count > 0)
-      bits.appendBits(digit, 6);
+    /// the pairs are packed 8 to 16 at a time (textpack.h),
+    /// bit for bit as appending them one by one does.
+    ui8vector bits(TEXTPACK_BYTES(TEXTPACK_ALPHANUMERIC_BITS(size)));
+    int bitSize = TextPack_alphanumeric((const unsigned char *)input.data(), size, &bits[0]);
 
     /// Set all the member variables of this segment.
-    setSegment(DM_AN, size, bits.getBytes(), bits.getBitLength());
+    setSegment(DM_AN, size, bits, bitSize);
   }
 }
 
@@ -459,7 +437,7 @@ void QRSegment::createBytes(const ui8vector &data)
 *
 *  @return nothing.
 */
-void QRSegment::createKanji(const std::string &input)
+void QRSegment::createKanji(const std::string &/*input*/)
 {
   /*const char *p;
   int ret;
@@ -27,6 +27,8 @@
 
 namespace QR
 {
+  class QRStages;
+
   //!  @class  QRSegment
   /*!
     Represents a character string to be encoded in a QR Code symbol. Each segment has
@@ -37,6 +39,9 @@ namespace QR
   */
   class QRSegment
   {
+    /// the micro-benchmarks time the mode encoders on their own.
+    friend class QRStages;
+
     public:
       /// Default Constructor
       QRSegment();
@@ -69,6 +74,19 @@ namespace QR
       */
       int getCharCountIndicatorSize(int version) const;
 
+      /** @brief get size of Character Count Indicator.
+      *
+      *  Get size of Character Count Indicator according to the
+      *  passing DATA_MODE and version number. Used by the decoder,
+      *  which has no segment to ask.
+      *
+      *  @param[in]   mode the DATA_MODE of the segment.
+      *  @param[in]   version the number of version.
+      *
+      *  @return size of Character Count Indicator, 0 for modes without one.
+      */
+      static int getCharCountIndicatorSize(const DATA_MODE &mode, int version);
+
       /** @brief get size of Input string/data.
       *
       *  @param[in] nothing.
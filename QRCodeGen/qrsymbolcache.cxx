@@ -0,0 +1,277 @@
+#include <cstdio>
+#include <cstring>
+
+#include "qrsymbolcache.h"
+#include "qrcode.h"
+
+using namespace QR;
+
+/// bytes counted for an entry besides its key and value: list node, index slot, control blocks.
+static const size_t ENTRY_OVERHEAD = 160;
+
+/// kinds of payload, first byte of a key.
+static const char KEY_TEXT = 'T';
+static const char KEY_BINARY = 'B';
+
+static unsigned long long rotateLeft(unsigned long long x, int n)
+{
+  return((x << n) | (x >> (64 - n)));
+}
+
+/// the key of an entry: kind, level, mask, format (or -1 for a symbol), scale and border, then the payload.
+static std::string makeKey(bool binary, const uint8_t *payload, size_t size, const ECL &ecl, int mask,
+                           int format, int scale, int border)
+{
+  char header[64];
+  int length = sprintf(header, "%c%d%+d%+d:%d:%d:", binary ? KEY_BINARY : KEY_TEXT, (int)ecl, mask, format, scale, border);
+
+  std::string key(header, length);
+  key.append((const char *)payload, size);
+
+  return(key);
+}
+
+/// Parametric Constructor
+QRSymbolCache::QRSymbolCache(size_t capacity, int shards)
+  :m_capacity(capacity),
+  m_shardCapacity(0),
+  m_shards()
+{
+  if (shards < 1)
+    throw "Value out of range";
+
+  m_shardCapacity = capacity / shards;
+  for (int i = 0; i < shards; i++)
+  {
+    m_shards.push_back(std::unique_ptr<Shard>(new Shard()));
+
+    Shard &shard = *m_shards.back();
+    shard.m_bytes = 0;
+    shard.m_hits = 0;
+    shard.m_misses = 0;
+    shard.m_insertions = 0;
+    shard.m_evictions = 0;
+  }
+}
+
+/// Destructor
+QRSymbolCache::~QRSymbolCache()
+{
+}
+
+bool QRSymbolCache::encode(const std::string &payload, const ECL &ecl, int mask, Symbol &symbol)
+{
+  return(lookup(false, (const uint8_t *)payload.data(), payload.size(), ecl, mask, -1, 0, 0, &symbol, NULL));
+}
+
+bool QRSymbolCache::encode(const ui8vector &payload, const ECL &ecl, int mask, Symbol &symbol)
+{
+  return(lookup(true, payload.empty() ? NULL : &payload[0], payload.size(), ecl, mask, -1, 0, 0, &symbol, NULL));
+}
+
+bool QRSymbolCache::encodeToBuffer(const std::string &payload, const ECL &ecl, int mask, const IMAGE_FORMAT &format,
+                                   ui8vector &buffer, int scale, int border)
+{
+  return(lookup(false, (const uint8_t *)payload.data(), payload.size(), ecl, mask, (int)format, scale, border, NULL, &buffer));
+}
+
+bool QRSymbolCache::encodeToBuffer(const ui8vector &payload, const ECL &ecl, int mask, const IMAGE_FORMAT &format,
+                                   ui8vector &buffer, int scale, int border)
+{
+  return(lookup(true, payload.empty() ? NULL : &payload[0], payload.size(), ecl, mask, (int)format, scale, border, NULL, &buffer));
+}
+
+void QRSymbolCache::clear()
+{
+  for (size_t i = 0; i < m_shards.size(); i++)
+  {
+    Shard &shard = *m_shards[i];
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+    shard.m_entries.clear();
+    shard.m_index.clear();
+    shard.m_bytes = 0;
+  }
+}
+
+QRSymbolCache::Statistics QRSymbolCache::getStatistics() const
+{
+  Statistics statistics;
+  memset(&statistics, 0, sizeof(statistics));
+
+  for (size_t i = 0; i < m_shards.size(); i++)
+  {
+    Shard &shard = *m_shards[i];
+    std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+    statistics.m_hits += shard.m_hits;
+    statistics.m_misses += shard.m_misses;
+    statistics.m_insertions += shard.m_insertions;
+    statistics.m_evictions += shard.m_evictions;
+    statistics.m_entries += shard.m_entries.size();
+    statistics.m_bytes += shard.m_bytes;
+  }
+
+  return(statistics);
+}
+
+size_t QRSymbolCache::getCapacity() const
+{
+  return(m_capacity);
+}
+
+unsigned long long QRSymbolCache::hash(const uint8_t *data, size_t size)
+{
+  const unsigned long long PRIME1 = 0x9e3779b185ebca87ULL;
+  const unsigned long long PRIME2 = 0xc2b2ae3d27d4eb4fULL;
+  unsigned long long h = (unsigned long long)size * PRIME1;
+  unsigned long long word;
+  size_t i = 0;
+
+  /// a round of xxHash64 per 8 bytes, the tail zero padded.
+  for (; i + 8 <= size; i += 8)
+  {
+    memcpy(&word, data + i, 8);
+    h ^= rotateLeft(word * PRIME2, 31) * PRIME1;
+    h = (rotateLeft(h, 27) * PRIME1) + PRIME2;
+  }
+
+  if (i < size)
+  {
+    word = 0;
+    memcpy(&word, data + i, size - i);
+    h ^= rotateLeft(word * PRIME2, 31) * PRIME1;
+    h = (rotateLeft(h, 27) * PRIME1) + PRIME2;
+  }
+
+  /// avalanche, so that the low bits (shard and bucket) depend on every byte.
+  h ^= h >> 33;
+  h *= PRIME2;
+  h ^= h >> 29;
+  h *= PRIME1;
+  h ^= h >> 32;
+
+  return(h);
+}
+
+bool QRSymbolCache::lookup(bool binary, const uint8_t *payload, size_t size, const ECL &ecl, int mask,
+                           int format, int scale, int border, Symbol *symbol, ui8vector *buffer)
+{
+  const std::string key(makeKey(binary, payload, size, ecl, mask, format, scale, border));
+  const unsigned long long h = hash((const uint8_t *)key.data(), key.size());
+
+  std::shared_ptr<const Symbol> cachedSymbol;
+  std::shared_ptr<const ui8vector> cachedImage;
+  const bool hit = find(key, h, cachedSymbol, cachedImage);
+
+  /// a miss encodes (and renders) outside of the lock.
+  if (!hit)
+  {
+    QRCode qr;
+    if (binary)
+      qr.encode(ui8vector(payload, payload + size), ecl, mask);
+    else
+      qr.encode(std::string((const char *)payload, size), ecl, mask);
+
+    if (format < 0)
+    {
+      std::shared_ptr<Symbol> encoded(new Symbol());
+      encoded->m_matrix = qr.toBitMatrix();
+      encoded->m_ecl = qr.getECL();
+      encoded->m_mask = qr.getMask();
+      cachedSymbol = encoded;
+    }
+    else
+    {
+      std::shared_ptr<ui8vector> image(new ui8vector());
+      qr.encodeToBuffer((IMAGE_FORMAT)format, *image, scale, border);
+      cachedImage = image;
+    }
+
+    insert(key, h, cachedSymbol, cachedImage);
+  }
+
+  /// the value is shared with the cache, the copy is made unlocked too.
+  if (symbol != NULL)
+    *symbol = *cachedSymbol;
+  else
+    buffer->insert(buffer->end(), cachedImage->begin(), cachedImage->end());
+
+  return(hit);
+}
+
+bool QRSymbolCache::find(const std::string &key, unsigned long long h, std::shared_ptr<const Symbol> &symbol,
+                         std::shared_ptr<const ui8vector> &image)
+{
+  Shard &shard = getShard(h);
+  std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+  std::unordered_map<unsigned long long, EntryList::iterator>::iterator found = shard.m_index.find(h);
+  if ((found == shard.m_index.end()) || (found->second->m_key != key))
+  {
+    shard.m_misses++;
+    return(false);
+  }
+
+  /// most recently used first.
+  shard.m_entries.splice(shard.m_entries.begin(), shard.m_entries, found->second);
+  symbol = found->second->m_symbol;
+  image = found->second->m_image;
+  shard.m_hits++;
+
+  return(true);
+}
+
+void QRSymbolCache::insert(const std::string &key, unsigned long long h, const std::shared_ptr<const Symbol> &symbol,
+                           const std::shared_ptr<const ui8vector> &image)
+{
+  size_t bytes = ENTRY_OVERHEAD + key.size();
+  if (symbol)
+    bytes += symbol->m_matrix.getDataSize();
+  if (image)
+    bytes += image->size();
+
+  /// an entry bigger than a shard would only empty it.
+  if (bytes > m_shardCapacity)
+    return;
+
+  Shard &shard = getShard(h);
+  std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+  /// another thread may have inserted it meanwhile, or another key have the same hash.
+  std::unordered_map<unsigned long long, EntryList::iterator>::iterator found = shard.m_index.find(h);
+  if (found != shard.m_index.end())
+  {
+    shard.m_bytes -= found->second->m_bytes;
+    shard.m_entries.erase(found->second);
+    shard.m_index.erase(found);
+  }
+
+  Entry entry;
+  entry.m_key = key;
+  entry.m_hash = h;
+  entry.m_symbol = symbol;
+  entry.m_image = image;
+  entry.m_bytes = bytes;
+
+  shard.m_entries.push_front(entry);
+  shard.m_index[h] = shard.m_entries.begin();
+  shard.m_bytes += bytes;
+  shard.m_insertions++;
+
+  while (shard.m_bytes > m_shardCapacity)
+  {
+    const Entry &last = shard.m_entries.back();
+
+    shard.m_bytes -= last.m_bytes;
+    shard.m_index.erase(last.m_hash);
+    shard.m_entries.pop_back();
+    shard.m_evictions++;
+  }
+}
+
+QRSymbolCache::Shard& QRSymbolCache::getShard(unsigned long long h) const
+{
+  /// the high bits pick the shard, the low ones the bucket of the index.
+  return(*m_shards[(size_t)((h >> 40) % m_shards.size())]);
+}
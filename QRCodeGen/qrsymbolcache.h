@@ -0,0 +1,195 @@
+/**
+*  @file    qrsymbolcache.h
+*  @brief   class to cache encoded symbols and rendered images by content.
+*
+*  The same payloads come back again and again (product pages, SKUs), and
+*  each time QRCode::encode() and the image writers redo the same work.
+*  QRSymbolCache sits in front of them: an entry is found by a 64-bit hash
+*  of its key (payload, error correction level, mask, and for images the
+*  format, scale and border), and holds either the packed modules of the
+*  symbol or the bytes of the image. A hit copies them out without
+*  encoding or rasterizing anything.
+*
+*  The entries are spread over shards by their hash, each shard with its
+*  own lock, its own share of the byte budget and its own least recently
+*  used list, so threads looking up different payloads rarely wait on
+*  each other. The full key is kept in every entry, so two payloads with
+*  the same hash are never mixed up.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRSYMBOLCACHE_H
+#define QRSYMBOLCACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrbitmatrix.h"
+
+namespace QR
+{
+  //!  @class  QRSymbolCache
+  /*!
+    Byte-budgeted, sharded LRU cache of symbols and images, safe to share between threads.
+    The cache can't be copied.
+  */
+  class QRSymbolCache
+  {
+    public:
+      //!  @struct  Symbol
+      /*!
+        An encoded symbol.
+      */
+      struct Symbol
+      {
+        QRBitMatrix m_matrix;   ///< Define modules of the symbol, packed (see qrbitmatrix.h).
+        ECL         m_ecl;      ///< Define error correction level, which may be higher than the one asked for.
+        int         m_mask;     ///< Define mask of the symbol, 0 to 7.
+      };
+
+      //!  @struct  Statistics
+      /*!
+        Counters of the cache, summed over the shards.
+      */
+      struct Statistics
+      {
+        unsigned long long  m_hits;         ///< Define number of lookups which found their entry.
+        unsigned long long  m_misses;       ///< Define number of lookups which encoded.
+        unsigned long long  m_insertions;   ///< Define number of entries added.
+        unsigned long long  m_evictions;    ///< Define number of entries dropped for room.
+        size_t              m_entries;      ///< Define number of entries held.
+        size_t              m_bytes;        ///< Define bytes held, keys and bookkeeping included.
+      };
+
+      /// Parametric Constructor, capacity is the byte budget of all the shards together.
+      explicit QRSymbolCache(size_t capacity = (64 << 20), int shards = 16);
+
+      /// Destructor
+      ~QRSymbolCache();
+
+      /** @brief encode a text, or get the symbol cached for it.
+      *
+      *  The symbol is the one QRCode::encode() makes for the same arguments.
+      *  Throws as QRCode::encode() does on a miss.
+      *
+      *  @param[in]   payload the text.
+      *  @param[in]   ecl the least error correction level.
+      *  @param[in]   mask the mask, -1 for automatic masking.
+      *  @param[out]  symbol the symbol.
+      *
+      *  @return bool true on a hit.
+      */
+      bool encode(const std::string &payload, const ECL &ecl, int mask, Symbol &symbol);
+
+      /// encode binary data (byte mode) as QRCode::encode() does, or get the symbol cached for it.
+      bool encode(const ui8vector &payload, const ECL &ecl, int mask, Symbol &symbol);
+
+      /** @brief encode a text as an image, or get the image cached for it.
+      *
+      *  The image is the one QRCode::encodeToBuffer() appends for the same arguments.
+      *
+      *  @param[in]   payload the text.
+      *  @param[in]   ecl the least error correction level.
+      *  @param[in]   mask the mask, -1 for automatic masking.
+      *  @param[in]   format the image format.
+      *  @param[out]  buffer the vector to append the image to.
+      *  @param[in]   scale the number of pixels (points for EPS and PDF) per module on each dimension.
+      *  @param[in]   border the number of white modules around the symbol.
+      *
+      *  @return bool true on a hit.
+      */
+      bool encodeToBuffer(const std::string &payload, const ECL &ecl, int mask, const IMAGE_FORMAT &format,
+                          ui8vector &buffer, int scale = 8, int border = 0);
+
+      /// encode binary data as an image, or get the image cached for it.
+      bool encodeToBuffer(const ui8vector &payload, const ECL &ecl, int mask, const IMAGE_FORMAT &format,
+                          ui8vector &buffer, int scale = 8, int border = 0);
+
+      /// drop every entry, the counters are kept.
+      void clear();
+
+      /// counters and size of the cache.
+      Statistics getStatistics() const;
+
+      /// byte budget of the cache.
+      size_t getCapacity() const;
+
+      /** @brief 64-bit hash of a byte string.
+      *
+      *  Reads 8 bytes per step in the host byte order, so the value is only
+      *  stable between machines of the same byte order.
+      *
+      *  @param[in]   data the bytes.
+      *  @param[in]   size the number of bytes.
+      *
+      *  @return unsigned long long the hash.
+      */
+      static unsigned long long hash(const uint8_t *data, size_t size);
+
+    private:
+      //!  @struct  Entry
+      /*!
+        A symbol or an image, with its key.
+      */
+      struct Entry
+      {
+        std::string                       m_key;      ///< Define parameters and payload the entry is of.
+        unsigned long long                m_hash;     ///< Define hash of the key.
+        std::shared_ptr<const Symbol>     m_symbol;   ///< Define symbol, NULL for an image.
+        std::shared_ptr<const ui8vector>  m_image;    ///< Define image, NULL for a symbol.
+        size_t                            m_bytes;    ///< Define bytes counted against the budget.
+      };
+
+      typedef std::list<Entry> EntryList;
+
+      //!  @struct  Shard
+      /*!
+        Entries of a range of hashes, most recently used first.
+      */
+      struct Shard
+      {
+        std::mutex                                                  m_mutex;        ///< Define lock of the shard.
+        EntryList                                                   m_entries;      ///< Define entries, most recently used first.
+        std::unordered_map<unsigned long long, EntryList::iterator> m_index;        ///< Define entry of every hash.
+        size_t                                                      m_bytes;        ///< Define bytes of the entries.
+        unsigned long long                                          m_hits;         ///< Define number of hits.
+        unsigned long long                                          m_misses;       ///< Define number of misses.
+        unsigned long long                                          m_insertions;   ///< Define number of entries added.
+        unsigned long long                                          m_evictions;    ///< Define number of entries dropped for room.
+      };
+
+      // Looks up a symbol (format < 0) or an image, encoding and inserting it on a miss.
+      bool lookup(bool binary, const uint8_t *payload, size_t size, const ECL &ecl, int mask,
+                  int format, int scale, int border, Symbol *symbol, ui8vector *buffer);
+
+      // Finds the entry of a key and makes it the most recently used, false on a miss.
+      bool find(const std::string &key, unsigned long long h, std::shared_ptr<const Symbol> &symbol,
+                std::shared_ptr<const ui8vector> &image);
+
+      // Adds an entry (replacing the one of the same hash), then evicts down to the budget.
+      void insert(const std::string &key, unsigned long long h, const std::shared_ptr<const Symbol> &symbol,
+                  const std::shared_ptr<const ui8vector> &image);
+
+      // Shard of a hash.
+      Shard& getShard(unsigned long long h) const;
+
+      QRSymbolCache(const QRSymbolCache &other);
+      QRSymbolCache& operator=(const QRSymbolCache &other);
+
+    private:
+      size_t                                m_capacity;       ///< Define byte budget of all the shards.
+      size_t                                m_shardCapacity;  ///< Define byte budget of a shard.
+      std::vector<std::unique_ptr<Shard> >  m_shards;         ///< Define shards.
+  };
+}
+
+#endif    // QRSYMBOLCACHE_H
@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <cstring>
+
+#include "qrsymbolstore.h"
+#include "qrsymbolcache.h"
+#include "qrcode.h"
+
+using namespace QR;
+
+static const char STORE_MAGIC[8] = { 'Q', 'R', 'S', 'T', 'O', 'R', 'E', '1' };
+static const char INDEX_MAGIC[8] = { 'Q', 'R', 'I', 'N', 'D', 'E', 'X', '1' };
+
+/// read back as another value on a machine of the other byte order.
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/// a slot is the top bits of the hash above the offset / 8 of the record.
+static const int SLOT_OFFSET_BITS = 40;
+static const unsigned long long SLOT_OFFSET_MASK = (1ULL << SLOT_OFFSET_BITS) - 1;
+
+//  Beginning of the file.
+struct StoreHeader
+{
+  char      m_magic[8];
+  uint32_t  m_byteOrder;
+  uint32_t  m_reserved;
+};
+
+//  Beginning of a record, followed by the payload and the matrix, each padded to 8 bytes.
+struct RecordHeader
+{
+  unsigned long long  m_hash;
+  uint32_t            m_payloadSize;
+  uint16_t            m_size;
+  uint8_t             m_ecl;
+  int8_t              m_mask;
+  uint8_t             m_symbolEcl;
+  int8_t              m_symbolMask;
+  uint16_t            m_reserved;
+  uint32_t            m_dataSize;
+};
+
+//  End of the file, after the index.
+struct StoreFooter
+{
+  char                m_magic[8];
+  unsigned long long  m_indexOffset;
+  unsigned long long  m_slotCount;
+  unsigned long long  m_recordCount;
+};
+
+static unsigned long long padded(unsigned long long size)
+{
+  return((size + 7) & ~7ULL);
+}
+
+/// checks the header and the footer of a mapped store, and finds its index.
+static bool readFooter(const uint8_t *data, size_t size, StoreFooter &footer)
+{
+  StoreHeader header;
+  if ((data == NULL) || (size < sizeof(StoreHeader) + sizeof(StoreFooter)) || (size % 8 != 0))
+    return(false);
+
+  memcpy(&header, data, sizeof(header));
+  memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+
+  if ((memcmp(header.m_magic, STORE_MAGIC, 8) != 0) || (header.m_byteOrder != BYTE_ORDER_MARK) ||
+      (memcmp(footer.m_magic, INDEX_MAGIC, 8) != 0))
+    return(false);
+
+  /// the slots fill the space between the records and the footer, a power of 2 of them.
+  const unsigned long long end = size - sizeof(footer);
+  if ((footer.m_slotCount == 0) || ((footer.m_slotCount & (footer.m_slotCount - 1)) != 0) ||
+      (footer.m_indexOffset < sizeof(header)) || (footer.m_indexOffset > end) ||
+      ((end - footer.m_indexOffset) / 8 != footer.m_slotCount) || (footer.m_indexOffset % 8 != 0) ||
+      (footer.m_recordCount >= footer.m_slotCount))
+    return(false);
+
+  return(true);
+}
+
+/// Default Constructor
+QRSymbolStore::QRSymbolStore()
+  :m_file(),
+  p_index(NULL),
+  m_slotMask(0),
+  m_records(0)
+{
+}
+
+/// Destructor
+QRSymbolStore::~QRSymbolStore()
+{
+  close();
+}
+
+bool QRSymbolStore::open(const std::string &filename)
+{
+  close();
+
+  if (!m_file.open(filename.c_str()))
+    return(false);
+
+  StoreFooter footer;
+  if (!readFooter(m_file.getData(), m_file.getSize(), footer))
+  {
+    m_file.close();
+    return(false);
+  }
+
+  p_index = m_file.getData() + footer.m_indexOffset;
+  m_slotMask = (size_t)(footer.m_slotCount - 1);
+  m_records = (size_t)footer.m_recordCount;
+
+  return(true);
+}
+
+void QRSymbolStore::close()
+{
+  m_file.close();
+  p_index = NULL;
+  m_slotMask = 0;
+  m_records = 0;
+}
+
+bool QRSymbolStore::find(const std::string &payload, const ECL &ecl, int mask, Symbol &symbol) const
+{
+  return(find((const uint8_t *)payload.data(), payload.size(), ecl, mask, symbol));
+}
+
+bool QRSymbolStore::find(const uint8_t *payload, size_t size, const ECL &ecl, int mask, Symbol &symbol) const
+{
+  if (p_index == NULL)
+    return(false);
+
+  const unsigned long long h = hash(payload, size, ecl, mask);
+  const unsigned long long tag = h >> SLOT_OFFSET_BITS;
+  const unsigned long long end = (unsigned long long)(p_index - m_file.getData());
+
+  /// linear probing, the index is never more than 3/4 full; a damaged one
+  /// may have no empty slot left, so the probe stops after a full turn.
+  size_t i = (size_t)h & m_slotMask;
+  for (size_t probes = 0; probes <= m_slotMask; probes++, i = (i + 1) & m_slotMask)
+  {
+    unsigned long long slot;
+    memcpy(&slot, p_index + (i * 8), 8);
+
+    if (slot == 0)
+      return(false);
+    if ((slot >> SLOT_OFFSET_BITS) != tag)
+      continue;
+
+    const unsigned long long offset = (slot & SLOT_OFFSET_MASK) << 3;
+    if (offset + sizeof(RecordHeader) > end)
+      return(false);
+
+    RecordHeader record;
+    memcpy(&record, m_file.getData() + offset, sizeof(record));
+
+    if ((record.m_hash != h) || (record.m_payloadSize != size) ||
+        (record.m_ecl != (uint8_t)ecl) || (record.m_mask != (int8_t)mask))
+      continue;
+
+    const uint8_t *stored = m_file.getData() + offset + sizeof(record);
+    const int stride = (record.m_size + 7) / 8;
+    if ((offset + sizeof(record) + padded(size) + padded(record.m_dataSize) > end) ||
+        (record.m_dataSize != (uint32_t)(record.m_size * stride)) ||
+        ((size > 0) && (memcmp(stored, payload, size) != 0)))
+      continue;
+
+    symbol.m_size = record.m_size;
+    symbol.m_stride = stride;
+    symbol.m_ecl = (ECL)record.m_symbolEcl;
+    symbol.m_mask = record.m_symbolMask;
+    symbol.p_data = stored + padded(size);
+
+    return(true);
+  }
+
+  return(false);
+}
+
+size_t QRSymbolStore::getRecordCount() const
+{
+  return(m_records);
+}
+
+unsigned long long QRSymbolStore::hash(const uint8_t *payload, size_t size, const ECL &ecl, int mask)
+{
+  unsigned long long h = QRSymbolCache::hash(payload, size);
+
+  /// level and mask folded in, then mixed again so they reach the tag and the slot.
+  h ^= (unsigned long long)(((int)ecl * 16) + mask + 1) * 0x9e3779b185ebca87ULL;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+
+  return(h);
+}
+
+/// Default Constructor
+QRSymbolStoreWriter::QRSymbolStoreWriter()
+  :p_file(NULL),
+  m_offset(0),
+  m_hashes(),
+  m_offsets()
+{
+}
+
+/// Destructor
+QRSymbolStoreWriter::~QRSymbolStoreWriter()
+{
+  close();
+}
+
+bool QRSymbolStoreWriter::open(const std::string &filename, bool append)
+{
+  close();
+  m_hashes.clear();
+  m_offsets.clear();
+
+  MappedFile existing;
+  if (append && existing.open(filename.c_str()))
+  {
+    StoreFooter footer;
+    if (!readFooter(existing.getData(), existing.getSize(), footer))
+      return(false);
+
+    /// the hashes of the records are read back from their headers, through the index.
+    std::vector<std::pair<unsigned long long, unsigned long long> > records;
+    const uint8_t *index = existing.getData() + footer.m_indexOffset;
+    for (unsigned long long i = 0; i < footer.m_slotCount; i++)
+    {
+      unsigned long long slot;
+      memcpy(&slot, index + (i * 8), 8);
+      if (slot == 0)
+        continue;
+
+      const unsigned long long offset = (slot & SLOT_OFFSET_MASK) << 3;
+      if (offset + sizeof(RecordHeader) > footer.m_indexOffset)
+        return(false);
+
+      RecordHeader record;
+      memcpy(&record, existing.getData() + offset, sizeof(record));
+      records.push_back(std::make_pair(offset, record.m_hash));
+    }
+
+    /// file order, so that the newest of two records with the same key stays in front.
+    std::sort(records.begin(), records.end());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+      m_offsets.push_back(records[i].first);
+      m_hashes.push_back(records[i].second);
+    }
+
+    m_offset = existing.getSize();
+    existing.close();
+
+    p_file = fopen(filename.c_str(), "ab");
+    return(p_file != NULL);
+  }
+
+  p_file = fopen(filename.c_str(), "wb");
+  if (p_file == NULL)
+    return(false);
+
+  StoreHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.m_magic, STORE_MAGIC, 8);
+  header.m_byteOrder = BYTE_ORDER_MARK;
+
+  m_offset = 0;
+  if (!write(&header, sizeof(header)))
+  {
+    fclose(p_file);
+    p_file = NULL;
+    return(false);
+  }
+
+  return(true);
+}
+
+bool QRSymbolStoreWriter::append(const std::string &payload, const ECL &ecl, int mask)
+{
+  QRCode qr;
+  qr.encode(payload, ecl, mask);
+
+  return(append(payload, ecl, mask, qr.toBitMatrix(), qr.getECL(), qr.getMask()));
+}
+
+bool QRSymbolStoreWriter::append(const std::string &payload, const ECL &ecl, int mask,
+                                 const QRBitMatrix &matrix, const ECL &symbolEcl, int symbolMask)
+{
+  if (p_file == NULL)
+    return(false);
+  if ((mask < -1) || (mask > 7) || (symbolMask < 0) || (symbolMask > 7) || (matrix.getSize() < 21) || (matrix.getSize() > 177))
+    throw "Value out of range";
+
+  RecordHeader record;
+  memset(&record, 0, sizeof(record));
+  record.m_hash = QRSymbolStore::hash((const uint8_t *)payload.data(), payload.size(), ecl, mask);
+  record.m_payloadSize = (uint32_t)payload.size();
+  record.m_size = (uint16_t)matrix.getSize();
+  record.m_ecl = (uint8_t)ecl;
+  record.m_mask = (int8_t)mask;
+  record.m_symbolEcl = (uint8_t)symbolEcl;
+  record.m_symbolMask = (int8_t)symbolMask;
+  record.m_dataSize = (uint32_t)matrix.getDataSize();
+
+  const unsigned long long offset = m_offset;
+  if (!write(&record, sizeof(record)) || !write(payload.data(), payload.size()) ||
+      !write(matrix.getData(), matrix.getDataSize()))
+    return(false);
+
+  m_hashes.push_back(record.m_hash);
+  m_offsets.push_back(offset);
+
+  return(true);
+}
+
+bool QRSymbolStoreWriter::close()
+{
+  if (p_file == NULL)
+    return(true);
+
+  /// at most 3/4 full, so that a miss stops early.
+  unsigned long long slotCount = 16;
+  while (slotCount * 3 < (m_hashes.size() + 1) * 4)
+    slotCount <<= 1;
+
+  /// newest first, so that a lookup meets the newest record of a key first.
+  std::vector<unsigned long long> slots((size_t)slotCount, 0);
+  for (size_t r = m_hashes.size(); r-- > 0; )
+  {
+    size_t i = (size_t)(m_hashes[r] & (slotCount - 1));
+    while (slots[i] != 0)
+      i = (i + 1) & (size_t)(slotCount - 1);
+
+    slots[i] = ((m_hashes[r] >> SLOT_OFFSET_BITS) << SLOT_OFFSET_BITS) | (m_offsets[r] >> 3);
+  }
+
+  StoreFooter footer;
+  memset(&footer, 0, sizeof(footer));
+  memcpy(footer.m_magic, INDEX_MAGIC, 8);
+  footer.m_indexOffset = m_offset;
+  footer.m_slotCount = slotCount;
+  footer.m_recordCount = m_hashes.size();
+
+  bool written = write(&slots[0], slots.size() * 8) && write(&footer, sizeof(footer));
+  written = (fclose(p_file) == 0) && written;
+  p_file = NULL;
+
+  return(written);
+}
+
+size_t QRSymbolStoreWriter::getRecordCount() const
+{
+  return(m_hashes.size());
+}
+
+bool QRSymbolStoreWriter::write(const void *data, size_t size)
+{
+  static const uint8_t zeros[8] = { 0 };
+  const size_t padding = (size_t)(padded(size) - size);
+
+  if ((size > 0) && (fwrite(data, 1, size, p_file) != size))
+    return(false);
+  if ((padding > 0) && (fwrite(zeros, 1, padding, p_file) != padding))
+    return(false);
+
+  m_offset += size + padding;
+  return(true);
+}
@@ -0,0 +1,194 @@
+/**
+*  @file    qrsymbolstore.h
+*  @brief   classes to keep pre-generated symbols in a memory mapped file.
+*
+*  A symbol store is an append-only file of records, each one a payload
+*  with its error correction level and mask and the modules of its symbol
+*  packed as QRBitMatrix packs them, followed by a hash index. Labels can
+*  be encoded ahead of time with QRSymbolStoreWriter, then QRSymbolStore
+*  maps the file and looks them up in place: opening reads a header and a
+*  footer only, and a lookup returns a pointer into the mapping, without
+*  copying or decoding anything.
+*
+*  File layout, every part 8 byte aligned, numbers in host byte order:
+*    header   "QRSTORE1", a byte order mark, 4 reserved bytes
+*    records  hash, payload size, symbol size, levels and masks, data size,
+*             then the payload and the rows of the matrix, each padded to 8
+*    index    open addressing table, a slot is the top 24 bits of the hash
+*             and the offset / 8 of the record in the low 40 bits (0: empty)
+*    footer   "QRINDEX1", offset of the index, number of slots and of records
+*
+*  Appending to a store adds records after the last footer and a new
+*  index and footer on close. The old index and footer stay in the middle
+*  of the file as dead bytes (8 per slot, about 11 to 21 per record, plus
+*  32), nothing reads them again; to reclaim them, write the live records
+*  into a new store. Records appended again with the same payload, level
+*  and mask hide the older ones. Records written after the last index are
+*  only seen once the writer is closed.
+*
+*  A writer which stops before close() (a crash, a full disk) leaves
+*  records without a footer after them: the file can then be opened
+*  neither by QRSymbolStore nor to append to, and has to be written again.
+*  To keep serving the previous store meanwhile, append to a copy and
+*  rename it over the original once close() succeeds.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRSYMBOLSTORE_H
+#define QRSYMBOLSTORE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrbitmatrix.h"
+#include "mappedfile.h"
+
+namespace QR
+{
+  //!  @class  QRSymbolStore
+  /*!
+    Read-only view of a symbol store. Lookups may run on several threads at once.
+    The store can't be copied.
+  */
+  class QRSymbolStore
+  {
+    public:
+      //!  @struct  Symbol
+      /*!
+        A stored symbol, pointing into the mapping.
+      */
+      struct Symbol
+      {
+        int             m_size;     ///< Define width and height in modules.
+        int             m_stride;   ///< Define bytes of a row, (size + 7) / 8.
+        ECL             m_ecl;      ///< Define error correction level of the symbol.
+        int             m_mask;     ///< Define mask of the symbol.
+        const uint8_t  *p_data;     ///< Define rows of the matrix, in the layout of QRBitMatrix.
+      };
+
+      /// Default Constructor
+      QRSymbolStore();
+
+      /// Destructor
+      ~QRSymbolStore();
+
+      /** @brief map a store.
+      *
+      *  Any store opened before is closed first.
+      *
+      *  @param[in]  filename the name of the file.
+      *
+      *  @return bool false if the file can't be mapped or isn't a closed store.
+      */
+      bool open(const std::string &filename);
+
+      /// unmap the store, the symbols found become invalid.
+      void close();
+
+      /** @brief look up the symbol of a payload.
+      *
+      *  @param[in]   payload the payload.
+      *  @param[in]   ecl the error correction level it was stored with.
+      *  @param[in]   mask the mask it was stored with, -1 for automatic masking.
+      *  @param[out]  symbol the symbol, valid until the store is closed.
+      *
+      *  @return bool false if the payload isn't stored with this level and mask.
+      */
+      bool find(const std::string &payload, const ECL &ecl, int mask, Symbol &symbol) const;
+      bool find(const uint8_t *payload, size_t size, const ECL &ecl, int mask, Symbol &symbol) const;
+
+      /// number of records of the store, hidden ones included.
+      size_t getRecordCount() const;
+
+      /// hash of a record key, the one of the index.
+      static unsigned long long hash(const uint8_t *payload, size_t size, const ECL &ecl, int mask);
+
+    private:
+      QRSymbolStore(const QRSymbolStore &other);
+      QRSymbolStore& operator=(const QRSymbolStore &other);
+
+    private:
+      MappedFile      m_file;       ///< Define mapping of the store.
+      const uint8_t  *p_index;      ///< Define slots of the index.
+      size_t          m_slotMask;   ///< Define number of slots - 1, a power of 2 - 1.
+      size_t          m_records;    ///< Define number of records.
+  };
+
+  //!  @class  QRSymbolStoreWriter
+  /*!
+    Appends records to a symbol store, and writes its index on close.
+    The writer can't be copied.
+  */
+  class QRSymbolStoreWriter
+  {
+    public:
+      /// Default Constructor
+      QRSymbolStoreWriter();
+
+      /// Destructor, closes the store.
+      ~QRSymbolStoreWriter();
+
+      /** @brief create a store, or open one to append to.
+      *
+      *  An existing store must have been closed, see the file description.
+      *
+      *  @param[in]  filename the name of the file.
+      *  @param[in]  append true to keep the records of an existing store.
+      *
+      *  @return bool false if the file can't be written or isn't a closed store.
+      */
+      bool open(const std::string &filename, bool append = false);
+
+      /** @brief encode a text as QRCode::encode() does, and append its symbol.
+      *
+      *  Throws as QRCode::encode() does.
+      *
+      *  @return bool false if the record can't be written.
+      */
+      bool append(const std::string &payload, const ECL &ecl, int mask);
+
+      /** @brief append a symbol encoded elsewhere.
+      *
+      *  @param[in]  payload the payload, the key of the record with ecl and mask.
+      *  @param[in]  ecl the error correction level asked for.
+      *  @param[in]  mask the mask asked for, -1 for automatic masking.
+      *  @param[in]  matrix the modules of the symbol.
+      *  @param[in]  symbolEcl the error correction level of the symbol.
+      *  @param[in]  symbolMask the mask of the symbol.
+      *
+      *  @return bool false if the record can't be written.
+      */
+      bool append(const std::string &payload, const ECL &ecl, int mask,
+                  const QRBitMatrix &matrix, const ECL &symbolEcl, int symbolMask);
+
+      /** @brief write the index and the footer, and close the file.
+      *
+      *  @return bool false if they can't be written.
+      */
+      bool close();
+
+      /// number of records of the store, those of before open() included.
+      size_t getRecordCount() const;
+
+    private:
+      // Writes bytes at the end of the file, then zeros up to a multiple of 8.
+      bool write(const void *data, size_t size);
+
+      QRSymbolStoreWriter(const QRSymbolStoreWriter &other);
+      QRSymbolStoreWriter& operator=(const QRSymbolStoreWriter &other);
+
+    private:
+      FILE                            *p_file;      ///< Define file appended to.
+      unsigned long long              m_offset;     ///< Define size of the file.
+      std::vector<unsigned long long> m_hashes;     ///< Define hash of every record, in file order.
+      std::vector<unsigned long long> m_offsets;    ///< Define offset of every record, in file order.
+  };
+}
+
+#endif    // QRSYMBOLSTORE_H
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "qrtestcorpus.h"
+#include "qrcode.h"
+#include "qrbitbuffer.h"
+
+using namespace QR;
+
+static const char *CONTENT_NAMES[] = {"numeric", "alphanumeric", "byte", "kanji", "mixed"};
+static const char *ECL_NAMES[] = {"L", "M", "Q", "H"};
+
+static const char ALPHANUMERIC_CHARSET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+/// Default Constructor
+QRTestCorpus::QRTestCorpus()
+  :m_seed(1)
+{
+}
+
+/// Copy Constructor
+QRTestCorpus::QRTestCorpus(const QRTestCorpus &other)
+  :m_seed(other.m_seed)
+{
+}
+
+/// Destructor
+QRTestCorpus::~QRTestCorpus()
+{
+}
+
+/// Assignment Operator
+QRTestCorpus& QRTestCorpus::operator=(const QRTestCorpus &other)
+{
+  if(this != &other)
+    m_seed = other.m_seed;
+
+  return(*this);
+}
+
+void QRTestCorpus::setSeed(unsigned int seed)
+{
+  m_seed = seed;
+}
+
+int QRTestCorpus::random()
+{
+  m_seed = (m_seed * 1103515245) + 12345;
+
+  return((int)((m_seed >> 16) & 0x7fff));
+}
+
+void QRTestCorpus::makeSegments(int version, const ECL &ecl, CONTENT content, std::vector<Segment> &segments)
+{
+  int numBlocks, numShortBlocks, shortDataLen, blockEccLen;
+  QRCode::getBlockStructure(version, ecl, numBlocks, numShortBlocks, shortDataLen, blockEccLen);
+
+  /// filling the version to capacity makes it the smallest one that fits, and leaves no room for a higher level.
+  const int capacity = ((numShortBlocks * shortDataLen) + ((numBlocks - numShortBlocks) * (shortDataLen + 1))) * 8;
+
+  DATA_MODE modes[3];
+  int count = 1;
+
+  switch (content)
+  {
+    case CT_NUMERIC:      modes[0] = DM_NUM;    break;
+    case CT_ALPHANUMERIC: modes[0] = DM_AN;     break;
+    case CT_BYTE:         modes[0] = DM_8;      break;
+    case CT_KANJI:        modes[0] = DM_KANJI;  break;
+    default:
+      modes[0] = DM_NUM;
+      modes[1] = DM_AN;
+      modes[2] = DM_8;
+      count = 3;
+      break;
+  }
+
+  int used = 0;
+  segments.clear();
+
+  for (int s = 0; s < count; s++)
+  {
+    int header = 4 + QRSegment::getCharCountIndicatorSize(modes[s], version);
+    int budget = (s + 1 == count) ? (capacity - used) : (capacity / 3);
+    int n = std::max(1, getCapacity(modes[s], budget - header));
+    Segment segment;
+    segment.m_mode = modes[s];
+
+    for (int i = 0; i < n; i++)
+    {
+      switch (modes[s])
+      {
+        case DM_NUM:
+          segment.m_data += (char)('0' + (random() % 10));
+          break;
+
+        case DM_AN:
+          /// a letter first, so that QRSegment::create() doesn't take it for numeric.
+          segment.m_data += (i == 0) ? 'A' : ALPHANUMERIC_CHARSET[random() % 45];
+          break;
+
+        case DM_8:
+          segment.m_data += (char)(random() & 0xFF);
+          break;
+
+        default:
+        {
+          int lead = (random() % 2) ? (0x81 + (random() % 0x1F)) : (0xE0 + (random() % 0x0B));
+          int trail = 0x40 + (random() % 0xBC);
+          if (trail >= 0x7F)
+            trail++;
+
+          segment.m_data += (char)lead;
+          segment.m_data += (char)trail;
+          break;
+        }
+      }
+    }
+
+    used += header + getBitCount(modes[s], n);
+    segments.push_back(segment);
+  }
+}
+
+std::vector<QRSegment> QRTestCorpus::toQRSegments(const std::vector<Segment> &segments)
+{
+  std::vector<QRSegment> segs(segments.size());
+
+  for (size_t i = 0; i < segments.size(); i++)
+  {
+    const std::string &data = segments[i].m_data;
+
+    switch (segments[i].m_mode)
+    {
+      case DM_NUM:
+      case DM_AN:
+        segs[i].create(data);
+        break;
+
+      case DM_8:
+        segs[i].create(ui8vector(data.begin(), data.end()));
+        break;
+
+      default:
+      {
+        ui8vector bytes;
+        int bitLength;
+
+        packKanji(data, bytes, bitLength);
+        segs[i] = QRSegment(DM_KANJI, (int)(data.size() / 2), bytes, bitLength);
+        break;
+      }
+    }
+  }
+
+  return(segs);
+}
+
+std::string QRTestCorpus::getText(const std::vector<Segment> &segments)
+{
+  std::string text;
+
+  for (size_t i = 0; i < segments.size(); i++)
+    text += segments[i].m_data;
+
+  return(text);
+}
+
+void QRTestCorpus::packKanji(const std::string &sjis, ui8vector &bytes, int &bitLength)
+{
+  QRBitBuffer bits;
+
+  for (size_t i = 0; i + 1 < sjis.size(); i += 2)
+  {
+    int c = ((unsigned char)sjis[i] << 8) | (unsigned char)sjis[i + 1];
+    c -= (c < 0xE040) ? 0x8140 : 0xC140;
+    bits.appendBits(((c >> 8) * 0xC0) + (c & 0xFF), 13);
+  }
+
+  bytes = bits.getBytes();
+  bitLength = bits.getBitLength();
+}
+
+int QRTestCorpus::getCapacity(const DATA_MODE &mode, int bits)
+{
+  if (bits <= 0)
+    return(0);
+
+  switch (mode)
+  {
+    case DM_NUM:    return(((bits / 10) * 3) + (((bits % 10) >= 7) ? 2 : (((bits % 10) >= 4) ? 1 : 0)));
+    case DM_AN:     return(((bits / 11) * 2) + (((bits % 11) >= 6) ? 1 : 0));
+    case DM_8:      return(bits / 8);
+    case DM_KANJI:  return(bits / 13);
+    default:        return(0);
+  }
+}
+
+int QRTestCorpus::getBitCount(const DATA_MODE &mode, int n)
+{
+  switch (mode)
+  {
+    case DM_NUM:    return(((n / 3) * 10) + (((n % 3) == 2) ? 7 : (((n % 3) == 1) ? 4 : 0)));
+    case DM_AN:     return(((n / 2) * 11) + (((n % 2) == 1) ? 6 : 0));
+    case DM_8:      return(n * 8);
+    case DM_KANJI:  return(n * 13);
+    default:        return(0);
+  }
+}
+
+const char* QRTestCorpus::getContentName(CONTENT content)
+{
+  return(((content >= 0) && (content < CT_COUNT)) ? CONTENT_NAMES[content] : "");
+}
+
+const char* QRTestCorpus::getECLName(const ECL &ecl)
+{
+  return(((ecl >= ECL_L) && (ecl <= ECL_H)) ? ECL_NAMES[ecl] : "");
+}
+
+std::string QRTestCorpus::getScratchFileName(const std::string &prefix, const std::string &extension)
+{
+  static std::atomic<unsigned int> counter(0);
+  char name[64];
+
+#ifdef _WIN32
+  const int pid = _getpid();
+#else
+  const int pid = (int)getpid();
+#endif
+
+  sprintf(name, "-%d-%u", pid, counter++);
+  return(prefix + name + extension);
+}
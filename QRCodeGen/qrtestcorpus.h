@@ -0,0 +1,131 @@
+/**
+*  @file    qrtestcorpus.h
+*  @brief   class to generate the content of the verification harnesses.
+*
+*  QRRoundTrip and QRCompare run over the same kind of corpus: numeric,
+*  alphanumeric, byte, kanji and mixed content filling a version and error
+*  correction level to capacity, drawn from a small linear congruential
+*  sequence so that every run (and every machine) sees the same symbols.
+*  QRTestCorpus holds that sequence, the capacity and bit count rules of
+*  the modes and the conversion of the generated segments to QRSegment, so
+*  the harnesses can't drift apart. It also names the scratch files they
+*  write, one set per process.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRTESTCORPUS_H
+#define QRTESTCORPUS_H
+
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrsegment.h"
+
+namespace QR
+{
+  //!  @class  QRTestCorpus
+  /*!
+    Reproducible content of the verification harnesses.
+  */
+  class QRTestCorpus
+  {
+    public:
+      /// kinds of content of the corpus.
+      enum CONTENT
+      {
+        CT_NUMERIC = 0,
+        CT_ALPHANUMERIC,
+        CT_BYTE,
+        CT_KANJI,
+        CT_MIXED,         ///< numeric, alphanumeric and byte segments in one symbol
+        CT_COUNT
+      };
+
+      //!  @struct  Segment
+      /*!
+        A segment as characters, in a form every engine accepts.
+      */
+      struct Segment
+      {
+        DATA_MODE   m_mode;   ///< Define mode of the segment.
+        std::string m_data;   ///< Define digits, alphanumeric characters, bytes or Shift JIS kanji.
+      };
+
+      /// Default Constructor, the sequence starting from seed 1.
+      QRTestCorpus();
+
+      /// Copy Constructor
+      QRTestCorpus(const QRTestCorpus &other);
+
+      /// Destructor
+      ~QRTestCorpus();
+
+      /// Assignment Operator
+      QRTestCorpus& operator=(const QRTestCorpus &other);
+
+      /// restart the sequence from a seed.
+      void setSeed(unsigned int seed);
+
+      /// next number of the sequence, 0 to 32767.
+      int random();
+
+      /** @brief build the segments filling a version and error correction level.
+      *
+      *  The content fills the data codewords, so every engine picks this
+      *  version and QRCode can't raise the level. Mixed content gives a
+      *  third of the bits to a numeric and an alphanumeric segment and the
+      *  rest to a byte segment.
+      *
+      *  @param[in]   version the version to fill.
+      *  @param[in]   ecl the error correction level.
+      *  @param[in]   content the kind of content.
+      *  @param[out]  segments the segments.
+      *
+      *  @return nothing.
+      */
+      void makeSegments(int version, const ECL &ecl, CONTENT content, std::vector<Segment> &segments);
+
+      /// the segments as QRCode encodes them.
+      static std::vector<QRSegment> toQRSegments(const std::vector<Segment> &segments);
+
+      /// the text of the segments, as a decoder returns it.
+      static std::string getText(const std::vector<Segment> &segments);
+
+      /// Shift JIS characters in 13 bits each (ISO/IEC 18004, 7.4.6).
+      static void packKanji(const std::string &sjis, ui8vector &bytes, int &bitLength);
+
+      /// number of characters of a mode fitting in the given number of bits (after the segment header).
+      static int getCapacity(const DATA_MODE &mode, int bits);
+
+      /// number of bits of n characters of a mode.
+      static int getBitCount(const DATA_MODE &mode, int n);
+
+      /// name of a kind of content.
+      static const char* getContentName(CONTENT content);
+
+      /// name of an error correction level, L, M, Q or H.
+      static const char* getECLName(const ECL &ecl);
+
+      /** @brief name of a scratch file, in the working directory.
+      *
+      *  Holds the process id and a counter, so that harnesses run at the
+      *  same time (ctest -j) never share a file. The caller removes it.
+      *
+      *  @param[in]  prefix the start of the name.
+      *  @param[in]  extension the end of the name, with its dot.
+      *
+      *  @return std::string the name.
+      */
+      static std::string getScratchFileName(const std::string &prefix, const std::string &extension);
+
+    private:
+      unsigned int  m_seed;   ///< Define state of the sequence.
+  };
+}
+
+#endif    // QRTESTCORPUS_H
@@ -0,0 +1,89 @@
+#include <algorithm>
+
+#include "qrthreadpool.h"
+
+using namespace QR;
+
+/// Parametric Constructor
+QRThreadPool::QRThreadPool(int threads)
+  :m_threads(),
+  m_tasks(),
+  m_mutex(),
+  m_wakeup(),
+  m_done(),
+  m_pending(0),
+  m_stop(false)
+{
+  if (threads <= 0)
+    threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+  for (int i = 0; i < threads; i++)
+    m_threads.push_back(std::thread(&QRThreadPool::work, this));
+}
+
+/// Destructor
+QRThreadPool::~QRThreadPool()
+{
+  wait();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_wakeup.notify_all();
+
+  for (size_t i = 0; i < m_threads.size(); i++)
+    m_threads[i].join();
+}
+
+void QRThreadPool::submit(const std::function<void()> &task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(task);
+    m_pending++;
+  }
+
+  m_wakeup.notify_one();
+}
+
+void QRThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while (m_pending > 0)
+    m_done.wait(lock);
+}
+
+int QRThreadPool::getThreadCount() const
+{
+  return((int)m_threads.size());
+}
+
+void QRThreadPool::work()
+{
+  for (;;)
+  {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      while (!m_stop && m_tasks.empty())
+        m_wakeup.wait(lock);
+
+      if (m_tasks.empty())
+        return;
+
+      task = m_tasks.front();
+      m_tasks.pop_front();
+    }
+
+    task();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_pending == 0)
+      m_done.notify_all();
+  }
+}
@@ -0,0 +1,73 @@
+/**
+*  @file    qrthreadpool.h
+*  @brief   fixed size pool of worker threads.
+*
+*  QRThreadPool runs submitted tasks on a set of threads created once, so
+*  decoding many symbols of a frame doesn't pay for thread creation on
+*  every frame.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRTHREADPOOL_H
+#define QRTHREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace QR
+{
+  //!  @class  QRThreadPool
+  /*!
+    Runs tasks on worker threads. Tasks must not throw (catch inside them).
+    The pool can't be copied.
+  */
+  class QRThreadPool
+  {
+    public:
+      /// Parametric Constructor, 0 threads means one per hardware thread.
+      explicit QRThreadPool(int threads = 0);
+
+      /// Destructor, waits for the queued tasks and stops the threads.
+      ~QRThreadPool();
+
+      /** @brief queue a task.
+      *
+      *  @param[in]  task the function to run on one of the threads.
+      *
+      *  @return nothing.
+      */
+      void submit(const std::function<void()> &task);
+
+      /// wait until every submitted task is done.
+      void wait();
+
+      /// number of worker threads.
+      int getThreadCount() const;
+
+    private:
+      // Takes tasks from the queue until the pool stops.
+      void work();
+
+      QRThreadPool(const QRThreadPool &other);
+      QRThreadPool& operator=(const QRThreadPool &other);
+
+    private:
+      std::vector<std::thread>            m_threads;    ///< Define worker threads.
+      std::deque<std::function<void()> >  m_tasks;      ///< Define queued tasks.
+      std::mutex                          m_mutex;      ///< Define lock of the queue and the counters.
+      std::condition_variable             m_wakeup;     ///< Define signal of a new task (or of stopping).
+      std::condition_variable             m_done;       ///< Define signal of the last task finished.
+      int                                 m_pending;    ///< Define number of tasks queued or running.
+      bool                                m_stop;       ///< Define whether the threads must stop.
+  };
+}
+
+#endif    // QRTHREADPOOL_H
@@ -6,7 +6,9 @@
 
 namespace QR
 {
-  #define INT32_MAX        2147483647i32
+  #ifndef INT32_MAX
+  #define INT32_MAX        2147483647
+  #endif
 
   /// define system datatype
   typedef unsigned char     uint8_t;
@@ -51,6 +53,20 @@ namespace QR
     ECL_H      ///< highest
   } ECL;
 
+  //!  @enum  IMAGE_FORMAT
+  /*!
+    Image formats a QR Code symbol can be written to, either to a file or into memory.
+  */
+  typedef enum IMAGE_FORMAT
+  {
+    IF_BMP = 0,   ///< Bitmap, 24-bit uncompressed
+    IF_PNG,       ///< PNG, 1-bit grayscale (stored deflate blocks)
+    IF_JPEG,      ///< JPEG, baseline
+    IF_SVG,       ///< SVG, scalable vector graphics
+    IF_EPS,       ///< EPS, encapsulated PostScript
+    IF_PDF        ///< PDF, single page
+  } IMGF;
+
   /// Functionality
   bool isDigit(unsigned char c);
   bool isDigit(const std::string &input);
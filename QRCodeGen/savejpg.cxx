@@ -17,15 +17,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
+#include "fdct.h"
+#include "bitwriter.h"
 #include "savejpg.h"
 
+#ifndef _MSC_VER
+/// the secure functions of the microsoft C runtime, for the other compilers.
+static int fopen_s(FILE **file, const char *filename, const char *mode)
+{
+  *file = fopen(filename, mode);
+  return((*file != NULL) ? 0 : 1);
+}
+
+template <size_t N>
+static int strcpy_s(char (&dest)[N], const char *src)
+{
+  strncpy(dest, src, N - 1);
+  dest[N - 1] = '\0';
+  return(0);
+}
+#endif
+
 
 /***************************************************************************/
 
-static BYTE bytenew=0; // The byte that will be written in the JPG file
-static SBYTE bytepos=7; //bit position in the byte we write (bytenew)
-			//should be<=7 and >=0
+static BitWriter bit_writer; // Entropy coded data, MSB first with 0xFF stuffing
 
 // The Huffman tables we'll use:
 static bitstring YDC_HT[12];
@@ -43,8 +61,8 @@ static bitstring *bitcode; // their bitcoded representation
 static SDWORD YRtab[256],YGtab[256],YBtab[256];
 static SDWORD CbRtab[256],CbGtab[256],CbBtab[256];
 static SDWORD CrRtab[256],CrGtab[256],CrBtab[256];
-static float fdtbl_Y[64];
-static float fdtbl_Cb[64]; //the same with the fdtbl_Cr[64]
+static JPEG::FDCTDivisors divisors_Y;
+static JPEG::FDCTDivisors divisors_Cb; //the same with the divisors_Cr
 
 static colorRGB *RGB_buffer; //image to be encoded
 static WORD Ximage,Yimage;// image dimensions divisible by 8
@@ -54,7 +72,7 @@ static SBYTE CrDU[64];
 //static SWORD DU_DCT[64]; // Current DU (after DCT and quantization) which we'll zigzag
 //static SWORD DU[64]; //zigzag reordered DU which will be Huffman coded
 
-static FILE *fp_jpeg_stream;
+static std::vector<unsigned char> jpeg_stream; // The encoded JPG file, written to disk at the end
 
 static WORD wImage, hImage;
 
@@ -63,7 +81,22 @@ static WORD wImage, hImage;
 
 void writebyte(const char b)
 {
-  fputc(b, fp_jpeg_stream);
+  jpeg_stream.push_back((unsigned char)b);
+}
+
+void write_stream(const char *filename)
+{
+  FILE *fp_jpeg_stream = NULL;
+
+  fopen_s(&fp_jpeg_stream, filename, "wb");
+  if (fp_jpeg_stream != NULL)
+  {
+    if (!jpeg_stream.empty())
+      fwrite(&jpeg_stream[0], 1, jpeg_stream.size(), fp_jpeg_stream);
+    fclose(fp_jpeg_stream);
+  }
+
+  jpeg_stream.clear();
 }
 
 void writeword(const WORD w)
@@ -193,40 +226,8 @@ void write_comment(BYTE *comment)
 }
 
 void writebits(bitstring bs)
-// A portable version; it should be done in assembler
-{
-   WORD value;
-   SBYTE posval;    //bit position in the bitstring we read, should be<=15 and >=0
-   const WORD mask[16] = {
-                          1,2,4,8,
-                          16,32,64,128,
-                          256,512,1024,2048,
-                          4096,8192,16384,32768
-                        };
-
-   value=bs.value;
-   posval=bs.length-1;
-   while (posval>=0)
-  {
-    if (value & mask[posval]) 
-      bytenew|=mask[bytepos];
-
-    posval--;
-    bytepos--;
-    if (bytepos<0) 
-    {
-      if (bytenew==0xFF)
-      {
-        writebyte(0xFF);
-        writebyte(0);
-      }
-      else
-        writebyte(bytenew);
-
-      bytepos=7;
-      bytenew=0;
-    }
-  }
+{
+  bit_writer.writeBits(bs.value, bs.length);
 }
 
 void compute_Huffman_table(BYTE *nrcodes,BYTE *std_table,bitstring *HT)
@@ -256,7 +257,7 @@ void init_Huffman_tables()
  compute_Huffman_table(std_ac_chrominance_nrcodes,std_ac_chrominance_values,CbAC_HT);
 }
 
-void exitmessage(char *error_message)
+void exitmessage(const char *error_message)
 {
  printf("%s\n",error_message);exit(EXIT_FAILURE);
 }
@@ -327,167 +328,21 @@ void precalculate_YCbCr_tables()
   }
 }
 
-// Using a bit modified form of the FDCT routine from IJG's C source:
-// Forward DCT routine idea taken from Independent JPEG Group's C source for
-// JPEG encoders/decoders
-
-// For float AA&N IDCT method, divisors are equal to quantization
-//   coefficients scaled by scalefactor[row]*scalefactor[col], where
-//   scalefactor[0] = 1
-//   scalefactor[k] = cos(k*PI/16) * sqrt(2)    for k=1..7
-//   We apply a further scale factor of 8.
-//   What's actually stored is 1/divisor so that the inner loop can
-//   use a multiplication rather than a division.
+// The integer AA&N FDCT (see fdct.h) quantizes with reciprocal multiplication,
+// the divisors are the quantization coefficients scaled by
+// scalefactor[row]*scalefactor[col]*8.
 void prepare_quant_tables()
 {
-  BYTE row, col;
-  BYTE i = 0;
-
-  double aanscalefactor[8] = {
-                              1.0, 1.387039845, 1.306562965, 1.175875602,
-                              1.0, 0.785694958, 0.541196100, 0.275899379
-                             };
-
-  for (row = 0; row < 8; row++)
-  {
-    for (col = 0; col < 8; col++)
-    {
-      fdtbl_Y[i] = (float) (1.0 / ((double) DQTinfo.Ytable[zigzag[i]] *
-      aanscalefactor[row] * aanscalefactor[col] * 8.0));
-      fdtbl_Cb[i] = (float) (1.0 / ((double) DQTinfo.Cbtable[zigzag[i]] *
-      aanscalefactor[row] * aanscalefactor[col] * 8.0));
-
-      i++;
-    }
-  }
+  JPEG::prepareFDCTDivisors(DQTinfo.Ytable, divisors_Y);
+  JPEG::prepareFDCTDivisors(DQTinfo.Cbtable, divisors_Cb);
 }
 
-void fdct_and_quantization(SBYTE *data,float *fdtbl,SWORD *outdata)
-{
-  float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
-  float tmp10, tmp11, tmp12, tmp13;
-  float z1, z2, z3, z4, z5, z11, z13;
-  float *dataptr;
-  float datafloat[64];
-  float temp;
-  SBYTE ctr;
-  BYTE i;
-  for (i=0;i<64;i++) datafloat[i]=data[i];
-
-  // Pass 1: process rows.
-  dataptr=datafloat;
-  for (ctr = 7; ctr >= 0; ctr--) {
-	tmp0 = dataptr[0] + dataptr[7];
-    tmp7 = dataptr[0] - dataptr[7];
-    tmp1 = dataptr[1] + dataptr[6];
-    tmp6 = dataptr[1] - dataptr[6];
-    tmp2 = dataptr[2] + dataptr[5];
-    tmp5 = dataptr[2] - dataptr[5];
-    tmp3 = dataptr[3] + dataptr[4];
-    tmp4 = dataptr[3] - dataptr[4];
-
-	// Even part
-
-    tmp10 = tmp0 + tmp3;	// phase 2
-    tmp13 = tmp0 - tmp3;
-    tmp11 = tmp1 + tmp2;
-    tmp12 = tmp1 - tmp2;
-
-    dataptr[0] = tmp10 + tmp11; // phase 3
-    dataptr[4] = tmp10 - tmp11;
-
-    z1 = (tmp12 + tmp13) * ((float) 0.707106781); // c4
-	dataptr[2] = tmp13 + z1;	// phase 5
-    dataptr[6] = tmp13 - z1;
-
-    // Odd part
-
-    tmp10 = tmp4 + tmp5;	// phase 2
-    tmp11 = tmp5 + tmp6;
-    tmp12 = tmp6 + tmp7;
-
-	// The rotator is modified from fig 4-8 to avoid extra negations
-    z5 = (tmp10 - tmp12) * ((float) 0.382683433); // c6
-    z2 = ((float) 0.541196100) * tmp10 + z5; // c2-c6
-    z4 = ((float) 1.306562965) * tmp12 + z5; // c2+c6
-    z3 = tmp11 * ((float) 0.707106781); // c4
-
-    z11 = tmp7 + z3;		// phase 5
-    z13 = tmp7 - z3;
-
-    dataptr[5] = z13 + z2;	// phase 6
-    dataptr[3] = z13 - z2;
-	dataptr[1] = z11 + z4;
-    dataptr[7] = z11 - z4;
-
-    dataptr += 8;		//advance pointer to next row
-  }
-
-  // Pass 2: process columns
-
-  dataptr = datafloat;
-  for (ctr = 7; ctr >= 0; ctr--) {
-    tmp0 = dataptr[0] + dataptr[56];
-    tmp7 = dataptr[0] - dataptr[56];
-    tmp1 = dataptr[8] + dataptr[48];
-    tmp6 = dataptr[8] - dataptr[48];
-    tmp2 = dataptr[16] + dataptr[40];
-    tmp5 = dataptr[16] - dataptr[40];
-    tmp3 = dataptr[24] + dataptr[32];
-    tmp4 = dataptr[24] - dataptr[32];
-
-    //Even part/
-
-    tmp10 = tmp0 + tmp3;	//phase 2
-    tmp13 = tmp0 - tmp3;
-    tmp11 = tmp1 + tmp2;
-    tmp12 = tmp1 - tmp2;
-
-    dataptr[0] = tmp10 + tmp11; // phase 3
-    dataptr[32] = tmp10 - tmp11;
-
-	z1 = (tmp12 + tmp13) * ((float) 0.707106781); // c4
-    dataptr[16] = tmp13 + z1; // phase 5
-    dataptr[48] = tmp13 - z1;
-
-    // Odd part
-
-    tmp10 = tmp4 + tmp5;	// phase 2
-    tmp11 = tmp5 + tmp6;
-    tmp12 = tmp6 + tmp7;
-
-    // The rotator is modified from fig 4-8 to avoid extra negations.
-	z5 = (tmp10 - tmp12) * ((float) 0.382683433); // c6
-    z2 = ((float) 0.541196100) * tmp10 + z5; // c2-c6
-    z4 = ((float) 1.306562965) * tmp12 + z5; // c2+c6
-    z3 = tmp11 * ((float) 0.707106781); // c4
-
-    z11 = tmp7 + z3;		// phase 5
-    z13 = tmp7 - z3;
-    dataptr[40] = z13 + z2; // phase 6
-	dataptr[24] = z13 - z2;
-    dataptr[8] = z11 + z4;
-    dataptr[56] = z11 - z4;
-
-    dataptr++;			// advance pointer to next column
-  }
-
-// Quantize/descale the coefficients, and store into output array
- for (i = 0; i < 64; i++) {
- // Apply the quantization and scaling factor
-			   temp = datafloat[i] * fdtbl[i];
-
-   //Round to nearest integer.
-   //Since C does not specify the direction of rounding for negative
-   //quotients, we have to force the dividend positive for portability.
-   //The maximum coefficient size is +-16K (for 12-bit data), so this
-   //code should work for either 16-bit or 32-bit ints.
-
-	   outdata[i] = (SWORD) ((SWORD)(temp + 16384.5) - 16384);
-			  }
+void fdct_and_quantization(SBYTE *data,const JPEG::FDCTDivisors *divisors,SWORD *outdata)
+{
+  JPEG::integerFDCTAndQuantization(data, *divisors, outdata);
 }
 
-void process_DU(SBYTE *ComponentDU,float *fdtbl,SWORD *DC,
+void process_DU(SBYTE *ComponentDU,const JPEG::FDCTDivisors *divisors,SWORD *DC,
 		bitstring *HTDC,bitstring *HTAC)
 {
  bitstring EOB=HTAC[0x00];
@@ -502,7 +357,7 @@ void process_DU(SBYTE *ComponentDU,float *fdtbl,SWORD *DC,
  SWORD DU_DCT[64]; // Current DU (after DCT and quantization) which we'll zigzag
  SWORD DU[64]; //zigzag reordered DU which will be Huffman coded
 
- fdct_and_quantization(ComponentDU,fdtbl,DU_DCT);
+ fdct_and_quantization(ComponentDU,divisors,DU_DCT);
 
  //zigzag reorder
  for (i=0;i<=63;i++)
@@ -582,9 +437,9 @@ void main_encoder()
   for (xpos=0;xpos<Ximage;xpos+=8)
    {
     load_data_units_from_RGB_buffer(xpos,ypos);
-    process_DU(YDU,fdtbl_Y,&DCY,YDC_HT,YAC_HT);
-    process_DU(CbDU,fdtbl_Cb,&DCCb,CbDC_HT,CbAC_HT);
-    process_DU(CrDU,fdtbl_Cb,&DCCr,CbDC_HT,CbAC_HT);
+    process_DU(YDU,&divisors_Y,&DCY,YDC_HT,YAC_HT);
+    process_DU(CbDU,&divisors_Cb,&DCCb,CbDC_HT,CbAC_HT);
+    process_DU(CrDU,&divisors_Cb,&DCCr,CbDC_HT,CbAC_HT);
    }
 }
 
@@ -670,10 +525,8 @@ void SaveJPEGFile(char *szBmpFileNameIn, char* szJpgFileNameOut)
 	WORD Ximage_original,Yimage_original;	//the original image dimensions,
 											// before we made them divisible by 8
 
-	bitstring fillbits; //filling bitstring for the bit alignment of the EOI marker
-
 	load_bitmap(BMP_filename, &Ximage_original, &Yimage_original);
-	fopen_s(&fp_jpeg_stream, JPG_filename,"wb");
+	jpeg_stream.clear();
 	init_all();
 	SOF0info.width=Ximage_original;
 	SOF0info.height=Yimage_original;
@@ -685,25 +538,18 @@ void SaveJPEGFile(char *szBmpFileNameIn, char* szJpgFileNameOut)
 	write_DHTinfo();
 	write_SOSinfo();
 
-	bytenew=0;bytepos=7;
+	bit_writer.setBuffer(&jpeg_stream, BitWriter::BO_MSB_FIRST, true);
 	main_encoder();
 	//Do the bit alignment of the EOI marker
-	if (bytepos>=0) 
-	{
-		fillbits.length=bytepos+1;
-		fillbits.value=(1<<(bytepos+1))-1;
-		writebits(fillbits);
-	}
+	bit_writer.flush(true);
 	writeword(0xFFD9); //EOI
 	free(RGB_buffer); free(category_alloc);free(bitcode_alloc);
-	fclose(fp_jpeg_stream);
+	write_stream(JPG_filename);
 }
 
 void WriteToFile(const char *filename)
 {
-  bitstring fillbits; //filling bitstring for the bit alignment of the EOI marker
-
-  fopen_s(&fp_jpeg_stream, filename,"wb");
+  jpeg_stream.clear();
 
   init_all();
 
@@ -719,26 +565,19 @@ void WriteToFile(const char *filename)
   write_DHTinfo();
   write_SOSinfo();
 
-  bytenew=0;
-  bytepos=7;
+  bit_writer.setBuffer(&jpeg_stream, BitWriter::BO_MSB_FIRST, true);
 
   main_encoder();
 
   //Do the bit alignment of the EOI marker
-  if (bytepos>=0) 
-  {
-	  fillbits.length=bytepos+1;
-	  fillbits.value=(1<<(bytepos+1))-1;
-	  writebits(fillbits);
-  }
+  bit_writer.flush(true);
   writeword(0xFFD9); //EOI
 
   free(RGB_buffer);
   free(category_alloc);
   free(bitcode_alloc);
 
-
-  fclose(fp_jpeg_stream);
+  write_stream(filename);
 }
 
 void setJPEGPixel(int row, int col, int red, int green, int blue)
@@ -50,15 +50,6 @@ void qrcodegen::BitBuffer::appendBits(uint32_t val, int len) {
     data.push_back(0);
   for (int i = len - 1; i >= 0; i--, bitLength++)  // Append bit by bit
   {
-    unsigned bit_left = bitLength >> 3;     // to manage 8-bit format for each entry
-    unsigned val_left = val >> i;
-    unsigned and_one = val_left & 1;
-    unsigned bit_and = bitLength & 7;
-    unsigned after_bit_and = 7 - bit_and;
-    unsigned char right_shift = and_one << after_bit_and;
-    unsigned char prev_val = data[bit_left];
-    unsigned char final_val = prev_val | right_shift;
-
     data[bitLength >> 3] |= ((val >> i) & 1) << (7 - (bitLength & 7));
   }
 }
@@ -0,0 +1,145 @@
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "qrcompare.h"
+
+using namespace QR;
+
+/// Forward declaration
+int doCompareDemo(int minVersion, int maxVersion);
+int runSection(const QRCompare &compare, const char *name, const std::function<int()> &run);
+void doBenchmarkDemo();
+void doContentionDemo();
+
+static bool parseRange(const char *text, int &first, int &last)
+{
+  char *end;
+  first = (int)strtol(text, &end, 10);
+
+  if (end == text)
+    return(false);
+
+  last = first;
+  if (*end == '-')
+  {
+    const char *second = end + 1;
+    last = (int)strtol(second, &end, 10);
+
+    if (end == second)
+      return(false);
+  }
+
+  return((*end == '\0') && (first >= 1) && (last <= 40) && (first <= last));
+}
+
+/// usage: QRCompare [--skip-benchmark] [-v <min>-<max>], exits with 1 if the engines differ.
+/// -v limits the versions of the engine and incremental encoder corpora (default 1-40),
+/// for a short run per CPU level.
+int main(int argc, char **argv)
+{
+  bool skipBenchmark = false;
+  int minVersion = 1, maxVersion = 40;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--skip-benchmark") == 0)
+      skipBenchmark = true;
+    else if ((strcmp(argv[i], "-v") == 0) && (i + 1 < argc) && parseRange(argv[i + 1], minVersion, maxVersion))
+      i++;
+    else
+    {
+      std::cerr << "usage: " << argv[0] << " [--skip-benchmark] [-v <min>-<max>]" << std::endl;
+      return(2);
+    }
+  }
+
+  int mismatches = doCompareDemo(minVersion, maxVersion);
+
+  if (!skipBenchmark)
+  {
+    doBenchmarkDemo();
+    doContentionDemo();
+  }
+
+  return((mismatches == 0) ? 0 : 1);
+}
+
+int doCompareDemo(int minVersion, int maxVersion)
+{
+  QRCompare compare;
+  compare.setVersions(minVersion, maxVersion);
+  int mismatches = compare.run();
+
+  const std::vector<std::string> &failures = compare.getMismatches();
+  for (size_t i = 0; (i < failures.size()) && (i < 20); i++)
+    std::cout << failures[i] << std::endl;
+
+  for (int e = QRCompare::EN_QRCODEGENERATOR; e < QRCompare::EN_COUNT; e++)
+  {
+    std::cout << QRCompare::getEngineName((QRCompare::ENGINE)e) << ": "
+              << compare.getVersionDisagreementCount((QRCompare::ENGINE)e) << " other versions, "
+              << compare.getMaskDisagreementCount((QRCompare::ENGINE)e) << " other automatic masks" << std::endl;
+  }
+
+  std::cout << compare.getComparisonCount() << " symbols compared, " << mismatches << " mismatches "
+            << (mismatches == 0 ? "PASS" : "FAIL") << std::endl;
+
+  /// the other components, after the engines so their mismatches are listed last.
+  int split = runSection(compare, "LibQREncode optimal split", [&compare]() { return(compare.runSplitters()); });
+  int bitmaps = runSection(compare, "LibQREncode QRbitmap", [&compare]() { return(compare.runBitmaps()); });
+  int incremental = runSection(compare, "QRIncrementalEncoder", [&compare]() { return(compare.runIncremental()); });
+  int cached = runSection(compare, "QRSymbolCache", [&compare]() { return(compare.runCache()); });
+  int stored = runSection(compare, "QRSymbolStore", [&compare]() { return(compare.runStore()); });
+
+  return(mismatches + split + bitmaps + incremental + cached + stored);
+}
+
+/// runs a check of compare, lists the mismatches it adds and its verdict.
+int runSection(const QRCompare &compare, const char *name, const std::function<int()> &run)
+{
+  const std::vector<std::string> &failures = compare.getMismatches();
+  const size_t reported = failures.size();
+  int mismatches = run();
+
+  for (size_t i = reported; (i < failures.size()) && (i < reported + 20); i++)
+    std::cout << failures[i] << std::endl;
+
+  std::cout << name << ": " << mismatches << " mismatches " << (mismatches == 0 ? "PASS" : "FAIL") << std::endl;
+
+  return(mismatches);
+}
+
+void doBenchmarkDemo()
+{
+  QRCompare compare;
+  compare.benchmark(3);
+
+  for (int e = 0; e < QRCompare::EN_COUNT; e++)
+  {
+    const QRCompare::Timing &timing = compare.getTiming((QRCompare::ENGINE)e);
+
+    std::cout << QRCompare::getEngineName((QRCompare::ENGINE)e) << ": " << timing.m_symbols << " symbols, fixed mask "
+              << (timing.m_fixedMask * 1e6 / timing.m_symbols) << " us, automatic mask "
+              << (timing.m_autoMask * 1e6 / timing.m_symbols) << " us, mask search "
+              << ((timing.m_autoMask - timing.m_fixedMask) * 1e6 / timing.m_symbols) << " us per symbol" << std::endl;
+  }
+}
+
+void doContentionDemo()
+{
+  const int threads[] = {1, 2, 4, 8, 16, 32};
+
+  std::cout << "LibQREncode on " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+  for (int i = 0; i < 6; i++)
+  {
+    QRCompare::Contention contention = QRCompare::benchmarkContention(threads[i], 0.5);
+
+    std::cout << "  " << contention.m_threads << " threads: " << (long)contention.m_symbols << " symbols/s, "
+              << (long)contention.m_lookups << " cache lookups/s" << std::endl;
+  }
+}
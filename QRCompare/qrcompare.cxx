@@ -0,0 +1,1047 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "qrcompare.h"
+#include "qrcode.h"
+#include "qrincrementalencoder.h"
+#include "qrsymbolcache.h"
+#include "qrsymbolstore.h"
+#include "qrsegment.h"
+#include "qrdecoder.h"
+#include "QrCode.hpp"
+#include "qrencode.h"
+
+extern "C"
+{
+#include "qrencode_inner.h"
+#include "qrspec.h"
+#include "rscode.h"
+#include "split.h"
+}
+
+using namespace QR;
+
+typedef std::chrono::steady_clock Clock;
+
+static const char *ENGINE_NAMES[] = {"QRCodeGen", "QRCodeGenerator", "LibQREncode"};
+
+/// most mismatches described, the rest are only counted.
+static const size_t MAX_REPORTED_MISMATCHES = 100;
+
+static std::vector<qrcodegen::QrSegment> toQRCodeGenerator(const std::vector<QRCompare::Segment> &segments)
+{
+  std::vector<qrcodegen::QrSegment> segs;
+
+  for (size_t i = 0; i < segments.size(); i++)
+  {
+    const std::string &data = segments[i].m_data;
+
+    switch (segments[i].m_mode)
+    {
+      case DM_NUM:
+        segs.push_back(qrcodegen::QrSegment::makeNumeric(data.c_str()));
+        break;
+
+      case DM_AN:
+        segs.push_back(qrcodegen::QrSegment::makeAlphanumeric(data.c_str()));
+        break;
+
+      case DM_8:
+        segs.push_back(qrcodegen::QrSegment::makeBytes(std::vector<uint8_t>(data.begin(), data.end())));
+        break;
+
+      default:
+      {
+        ui8vector bytes;
+        int bitLength;
+
+        QRTestCorpus::packKanji(data, bytes, bitLength);
+        segs.push_back(qrcodegen::QrSegment(qrcodegen::QrSegment::Mode::KANJI, (int)(data.size() / 2), bytes, bitLength));
+        break;
+      }
+    }
+  }
+
+  return(segs);
+}
+
+static const qrcodegen::QrCode::Ecc& toQRCodeGenerator(const ECL &ecl)
+{
+  switch (ecl)
+  {
+    case ECL_L: return(qrcodegen::QrCode::Ecc::LOW);
+    case ECL_M: return(qrcodegen::QrCode::Ecc::MEDIUM);
+    case ECL_Q: return(qrcodegen::QrCode::Ecc::QUARTILE);
+    default:    return(qrcodegen::QrCode::Ecc::HIGH);
+  }
+}
+
+/// the input is freed by the caller, NULL if LibQREncode rejects the segments.
+static QRinput* toLibQREncode(const QRCompare::Case &input)
+{
+  QRinput *qrinput = QRinput_new2(input.m_version, (QRecLevel)input.m_ecl);
+  if (qrinput == NULL)
+    return(NULL);
+
+  for (size_t i = 0; i < input.m_segments.size(); i++)
+  {
+    const std::string &data = input.m_segments[i].m_data;
+    QRencodeMode mode;
+
+    switch (input.m_segments[i].m_mode)
+    {
+      case DM_NUM:  mode = QR_MODE_NUM;   break;
+      case DM_AN:   mode = QR_MODE_AN;    break;
+      case DM_8:    mode = QR_MODE_8;     break;
+      default:      mode = QR_MODE_KANJI; break;
+    }
+
+    if (QRinput_append(qrinput, mode, (int)data.size(), (const unsigned char*)data.data()) != 0)
+    {
+      QRinput_free(qrinput);
+      return(NULL);
+    }
+  }
+
+  return(qrinput);
+}
+
+/// Default Constructor
+QRCompare::QRCompare()
+  :m_minVersion(1),
+  m_maxVersion(40),
+  m_minMask(0),
+  m_maxMask(7),
+  m_corpus(),
+  m_comparisons(0),
+  m_mismatches()
+{
+  std::fill(m_versionDiffs, m_versionDiffs + EN_COUNT, 0);
+  std::fill(m_maskDiffs, m_maskDiffs + EN_COUNT, 0);
+
+  for (int e = 0; e < EN_COUNT; e++)
+  {
+    m_timings[e].m_fixedMask = 0.0;
+    m_timings[e].m_autoMask = 0.0;
+    m_timings[e].m_symbols = 0;
+  }
+}
+
+/// Copy Constructor
+QRCompare::QRCompare(const QRCompare &other)
+  :m_minVersion(other.m_minVersion),
+  m_maxVersion(other.m_maxVersion),
+  m_minMask(other.m_minMask),
+  m_maxMask(other.m_maxMask),
+  m_corpus(other.m_corpus),
+  m_comparisons(other.m_comparisons),
+  m_mismatches(other.m_mismatches)
+{
+  std::copy(other.m_versionDiffs, other.m_versionDiffs + EN_COUNT, m_versionDiffs);
+  std::copy(other.m_maskDiffs, other.m_maskDiffs + EN_COUNT, m_maskDiffs);
+  std::copy(other.m_timings, other.m_timings + EN_COUNT, m_timings);
+}
+
+/// Destructor
+QRCompare::~QRCompare()
+{
+}
+
+/// Assignment Operator
+QRCompare& QRCompare::operator=(const QRCompare &other)
+{
+  if(this != &other)
+  {
+    m_minVersion = other.m_minVersion;
+    m_maxVersion = other.m_maxVersion;
+    m_minMask = other.m_minMask;
+    m_maxMask = other.m_maxMask;
+    m_corpus = other.m_corpus;
+    m_comparisons = other.m_comparisons;
+    m_mismatches = other.m_mismatches;
+    std::copy(other.m_versionDiffs, other.m_versionDiffs + EN_COUNT, m_versionDiffs);
+    std::copy(other.m_maskDiffs, other.m_maskDiffs + EN_COUNT, m_maskDiffs);
+    std::copy(other.m_timings, other.m_timings + EN_COUNT, m_timings);
+  }
+
+  return(*this);
+}
+
+void QRCompare::setVersions(int minVersion, int maxVersion)
+{
+  if ((minVersion < 1) || (maxVersion > 40) || (minVersion > maxVersion))
+    throw "Value out of range";
+
+  m_minVersion = minVersion;
+  m_maxVersion = maxVersion;
+}
+
+void QRCompare::setMasks(int minMask, int maxMask)
+{
+  if ((minMask < 0) || (maxMask > 7) || (minMask > maxMask))
+    throw "Value out of range";
+
+  m_minMask = minMask;
+  m_maxMask = maxMask;
+}
+
+int QRCompare::run()
+{
+  std::vector<Case> corpus;
+  makeCorpus(corpus);
+
+  m_comparisons = 0;
+  m_mismatches.clear();
+  std::fill(m_versionDiffs, m_versionDiffs + EN_COUNT, 0);
+  std::fill(m_maskDiffs, m_maskDiffs + EN_COUNT, 0);
+
+  int mismatches = 0;
+  char name[64];
+
+  for (size_t c = 0; c < corpus.size(); c++)
+  {
+    const Case &input = corpus[c];
+
+    /// every fixed mask, then automatic masking (-1).
+    for (int mask = m_minMask; mask <= m_maxMask + 1; mask++)
+    {
+      const int requested = (mask > m_maxMask) ? -1 : mask;
+      QRBitMatrix matrices[EN_COUNT];
+      int masks[EN_COUNT];
+      bool encoded[EN_COUNT];
+      std::string error;
+
+      sprintf(name, "v%d %s %s mask %d", input.m_version, QRTestCorpus::getECLName(input.m_ecl),
+              QRTestCorpus::getContentName(input.m_content), requested);
+      m_comparisons++;
+
+      for (int e = 0; e < EN_COUNT; e++)
+      {
+        encoded[e] = encode((ENGINE)e, input, requested, matrices[e], masks[e]);
+
+        if (!encoded[e])
+          error += std::string(error.empty() ? "" : ", ") + ENGINE_NAMES[e] + " failed";
+      }
+
+      for (int e = 1; (e < EN_COUNT) && encoded[EN_QRCODEGEN]; e++)
+      {
+        const QRBitMatrix &a = matrices[EN_QRCODEGEN];
+        const QRBitMatrix &b = matrices[e];
+
+        /// another version or mask can't be compared module by module, it's only counted.
+        if (!encoded[e])
+          continue;
+
+        if (b.getSize() != a.getSize())
+        {
+          m_versionDiffs[e]++;
+          continue;
+        }
+
+        if (masks[e] != masks[EN_QRCODEGEN])
+        {
+          if (requested < 0)
+            m_maskDiffs[e]++;
+          else
+            error += std::string(error.empty() ? "" : ", ") + ENGINE_NAMES[e] + " used another mask";
+
+          continue;
+        }
+
+        if (std::equal(a.getData(), a.getData() + a.getDataSize(), b.getData()))
+          continue;
+
+        /// the first module which differs, row by row.
+        for (int y = 0, found = 0; (y < a.getSize()) && !found; y++)
+        {
+          for (int x = 0; (x < a.getSize()) && !found; x++)
+          {
+            if (a.get(x, y) != b.get(x, y))
+            {
+              char where[96];
+              sprintf(where, "%s differs at (%d, %d)", ENGINE_NAMES[e], x, y);
+              error += std::string(error.empty() ? "" : ", ") + where;
+              found = 1;
+            }
+          }
+        }
+      }
+
+      if (!error.empty())
+      {
+        mismatches++;
+
+        reportMismatch(std::string(name) + ": " + error);
+      }
+    }
+  }
+
+  return(mismatches);
+}
+
+int QRCompare::runSplitters(int strings)
+{
+  const QRecLevel levels[] = {QR_ECLEVEL_L, QR_ECLEVEL_M, QR_ECLEVEL_Q, QR_ECLEVEL_H};
+  const char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:abcdefghijklmnopqrstuvwxyz!#&()<>?@_";
+  QRDecoder decoder;
+  int mismatches = 0;
+  char name[64];
+  m_corpus.setSeed(1);
+
+  for (int i = 0; i < strings; i++)
+  {
+    /// runs of digits, of alphanumeric characters and of any printable
+    /// character, whose boundaries are where the two splitters differ.
+    std::string text;
+    for (int runs = 1 + (m_corpus.random() % 8); runs > 0; runs--)
+    {
+      const int kind = m_corpus.random() % 3;
+      const int charsetSize = (kind == 0) ? 10 : ((kind == 1) ? 45 : (int)(sizeof(charset) - 1));
+
+      for (int n = 1 + (m_corpus.random() % 30); n > 0; n--)
+        text += charset[m_corpus.random() % charsetSize];
+    }
+
+    const QRecLevel level = levels[i % 4];
+    std::string error;
+
+    QRcode *greedy = QRcode_encodeString(text.c_str(), 0, level, QR_MODE_8, 1);
+    QRcode *optimal = QRcode_encodeStringOptimal(text.c_str(), 0, level, QR_MODE_8, 1);
+    if ((greedy == NULL) || (optimal == NULL))
+      error = "not encoded";
+    else if (optimal->version > greedy->version)
+    {
+      sprintf(name, "optimal version %d above greedy version %d", optimal->version, greedy->version);
+      error = name;
+    }
+    else
+    {
+      /// the symbol of the optimal split reads back as the input.
+      QRbitmap *bitmap = QRbitmap_fromQRcode(optimal);
+      if (bitmap == NULL)
+        error = "not packed";
+      else
+      {
+        try
+        {
+          if ((decoder.decode(QRBitMatrix(bitmap->width, bitmap->data)) != text) ||
+              (decoder.getVersion() != optimal->version))
+            error = "decoded text differs";
+        }
+        catch (const char *exception)
+        {
+          error = exception;
+        }
+
+        QRbitmap_free(bitmap);
+      }
+    }
+
+    QRcode_free(greedy);
+    QRcode_free(optimal);
+
+    if (!error.empty())
+    {
+      mismatches++;
+      sprintf(name, "split string %d (%d characters)", i, (int)text.size());
+      reportMismatch(std::string(name) + ": " + error);
+    }
+  }
+
+  /// no version holds 8000 digits, the splitter itself must say so.
+  QRinput *input = QRinput_new2(0, QR_ECLEVEL_L);
+  if (input != NULL)
+  {
+    errno = 0;
+    const std::string digits(8000, '7');
+    if ((Split_splitStringToQRinputOptimal(digits.c_str(), input, QR_MODE_8, 1) == 0) || (errno != ERANGE))
+    {
+      mismatches++;
+      reportMismatch("optimal split of 8000 digits: no ERANGE");
+    }
+
+    QRinput_free(input);
+  }
+
+  return(mismatches);
+}
+
+int QRCompare::runBitmaps()
+{
+  /// every version with the level cycling, then every Micro QR Code version and level.
+  const QRecLevel levels[] = {QR_ECLEVEL_L, QR_ECLEVEL_M, QR_ECLEVEL_Q, QR_ECLEVEL_H};
+  const int microVersions[] = {1, 2, 2, 3, 3, 4, 4, 4};
+  const QRecLevel microLevels[] = {QR_ECLEVEL_L, QR_ECLEVEL_L, QR_ECLEVEL_M, QR_ECLEVEL_L, QR_ECLEVEL_M,
+                                   QR_ECLEVEL_L, QR_ECLEVEL_M, QR_ECLEVEL_Q};
+  int mismatches = 0;
+  char name[64];
+
+  for (int i = 0; i < 40 + 8; i++)
+  {
+    const bool micro = (i >= 40);
+    const int version = micro ? microVersions[i - 40] : (i + 1);
+    QRcode *qr;
+
+    if (micro)
+      qr = QRcode_encodeStringMQR("12345", version, microLevels[i - 40], QR_MODE_8, 1);
+    else
+    {
+      sprintf(name, "HTTPS://EXAMPLE.COM/V%02d/0123456789", version);
+      qr = QRcode_encodeString(name, version, levels[i % 4], QR_MODE_8, 1);
+    }
+
+    std::string error;
+    if (qr == NULL)
+      error = "not encoded";
+    else
+    {
+      /// the flags of the function patterns come back with the modules.
+      QRbitmap *bitmap = QRbitmap_fromQRcode(qr);
+      QRcode *unpacked = (bitmap == NULL) ? NULL : QRbitmap_toQRcode(bitmap);
+
+      if (unpacked == NULL)
+        error = "not unpacked";
+      else if ((unpacked->version != qr->version) || (unpacked->width != qr->width))
+        error = "other version or width";
+      else if (memcmp(unpacked->data, qr->data, qr->width * qr->width) != 0)
+        error = "modules or flags differ";
+
+      QRcode_free(unpacked);
+      QRbitmap_free(bitmap);
+      QRcode_free(qr);
+    }
+
+    if (!error.empty())
+    {
+      mismatches++;
+      sprintf(name, "bitmap %s%d", micro ? "M" : "v", version);
+      reportMismatch(std::string(name) + ": " + error);
+    }
+  }
+
+  return(mismatches);
+}
+
+int QRCompare::runIncremental(int labels)
+{
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+  int mismatches = 0;
+  char name[64];
+
+  m_corpus.setSeed(1);
+
+  for (int version = m_minVersion; version <= m_maxVersion; version++)
+  {
+    for (int e = 0; e < 4; e++)
+    {
+      int numBlocks, numShortBlocks, shortDataLen, blockEccLen;
+      QRCode::getBlockStructure(version, ecls[e], numBlocks, numShortBlocks, shortDataLen, blockEccLen);
+
+      const int capacity = ((numShortBlocks * shortDataLen) + ((numBlocks - numShortBlocks) * (shortDataLen + 1))) * 8;
+      const int bytes = QRTestCorpus::getCapacity(DM_8, capacity - 4 - QRSegment::getCharCountIndicatorSize(DM_8, version));
+
+      /// lower case letters keep the whole label in byte mode.
+      std::string prefix;
+      for (int i = 0; i < bytes - 8; i++)
+        prefix += (char)('a' + (m_corpus.random() % 26));
+
+      QRIncrementalEncoder encoder;
+
+      for (int l = 0; l < labels; l++)
+      {
+        char serial[16];
+        sprintf(serial, "%08d", (m_corpus.random() * 32768) + m_corpus.random());
+
+        std::string label = prefix + (serial + (strlen(serial) - std::min(bytes, 8)));
+        if (((l % 5) == 4) && (version < 40))
+          label += "+";
+
+        const int mask = ((l % 4) == 3) ? -1 : ((l / 2) % 8);
+        std::string error;
+
+        try
+        {
+          QRCode expected;
+          expected.encode(label, ecls[e], mask);
+
+          const QRCode &actual = encoder.encode(label, ecls[e], mask);
+          const QRBitMatrix a = expected.toBitMatrix();
+          const QRBitMatrix b = actual.toBitMatrix();
+
+          if ((actual.getVersion() != expected.getVersion()) || (actual.getMask() != expected.getMask()))
+            error = "other version or mask";
+          else if (!std::equal(a.getData(), a.getData() + a.getDataSize(), b.getData()))
+            error = encoder.isIncremental() ? "incremental symbol differs" : "whole symbol differs";
+        }
+        catch (const char *exception)
+        {
+          error = exception;
+        }
+
+        if (!error.empty())
+        {
+          mismatches++;
+          sprintf(name, "v%d %s label %d mask %d", version, QRTestCorpus::getECLName(ecls[e]), l, mask);
+
+          reportMismatch(std::string(name) + ": " + error);
+        }
+      }
+    }
+  }
+
+  return(mismatches);
+}
+
+/// a worker of runCache(), the errors of its requests in errors.
+static void cacheWorker(QRSymbolCache &cache, const std::vector<std::string> &payloads, int worker, int requests,
+                        std::vector<std::string> &errors)
+{
+  const IMAGE_FORMAT formats[] = {IF_BMP, IF_PNG, IF_SVG};
+  unsigned int seed = (unsigned int)worker + 1;
+  char name[64];
+
+  for (int r = 0; r < requests; r++)
+  {
+    /// small indexes come back most often, as popular pages do.
+    seed = (seed * 1103515245) + 12345;
+    const int spread = (int)((seed >> 16) % payloads.size()) + 1;
+    seed = (seed * 1103515245) + 12345;
+    const int p = (int)((seed >> 16) % spread);
+    const std::string &payload = payloads[p];
+    const ECL ecl = (ECL)(p % 4);
+    const int mask = (p % 3 == 0) ? -1 : (p % 8);
+    const int kind = (p + r) % 4;
+    std::string error;
+
+    try
+    {
+      QRCode expected;
+      expected.encode(payload, ecl, mask);
+
+      if (kind == 3)
+      {
+        QRSymbolCache::Symbol symbol;
+        cache.encode(payload, ecl, mask, symbol);
+
+        const QRBitMatrix matrix = expected.toBitMatrix();
+        if ((symbol.m_mask != expected.getMask()) || (symbol.m_ecl != expected.getECL()) ||
+            (symbol.m_matrix.getSize() != matrix.getSize()) ||
+            !std::equal(matrix.getData(), matrix.getData() + matrix.getDataSize(), symbol.m_matrix.getData()))
+          error = "symbol differs";
+      }
+      else
+      {
+        ui8vector image, expectedImage;
+        cache.encodeToBuffer(payload, ecl, mask, formats[kind], image, 2, 4);
+        expected.encodeToBuffer(formats[kind], expectedImage, 2, 4);
+
+        if (image != expectedImage)
+          error = "image differs";
+      }
+    }
+    catch (const char *exception)
+    {
+      error = exception;
+    }
+
+    if (!error.empty())
+    {
+      sprintf(name, "cache thread %d request %d payload %d kind %d", worker, r, p, kind);
+      errors.push_back(std::string(name) + ": " + error);
+    }
+  }
+}
+
+int QRCompare::runCache(int threads, int requests)
+{
+  std::vector<std::string> payloads;
+  m_corpus.setSeed(1);
+
+  for (int i = 0; i < 64; i++)
+  {
+    char page[32];
+    sprintf(page, "/p/%05d?ref=", m_corpus.random() % 100000);
+
+    std::string payload = std::string("https://shop.example.com") + page;
+    for (int n = m_corpus.random() % 40; n > 0; n--)
+      payload += (char)('a' + (m_corpus.random() % 26));
+
+    payloads.push_back(payload);
+  }
+
+  /// room for a fraction of the images only, 8 shards of 48 KB.
+  QRSymbolCache cache(384 << 10, 8);
+  std::vector<std::vector<std::string> > errors(threads);
+  std::vector<std::thread> workers;
+
+  for (int t = 0; t < threads; t++)
+    workers.push_back(std::thread(cacheWorker, std::ref(cache), std::cref(payloads), t, requests, std::ref(errors[t])));
+  for (int t = 0; t < threads; t++)
+    workers[t].join();
+
+  int mismatches = 0;
+  for (int t = 0; t < threads; t++)
+  {
+    for (size_t i = 0; i < errors[t].size(); i++)
+      reportMismatch(errors[t][i]);
+    mismatches += (int)errors[t].size();
+  }
+
+  const QRSymbolCache::Statistics statistics = cache.getStatistics();
+  if ((statistics.m_hits + statistics.m_misses != (unsigned long long)threads * requests) ||
+      (statistics.m_bytes > cache.getCapacity()) || (statistics.m_hits == 0) || (statistics.m_evictions == 0) ||
+      (statistics.m_insertions - statistics.m_evictions < statistics.m_entries))
+  {
+    char counters[160];
+    sprintf(counters, "cache counters: %llu hits, %llu misses, %llu insertions, %llu evictions, %lu entries, %lu bytes",
+            statistics.m_hits, statistics.m_misses, statistics.m_insertions, statistics.m_evictions,
+            (unsigned long)statistics.m_entries, (unsigned long)statistics.m_bytes);
+
+    reportMismatch(counters);
+    mismatches++;
+  }
+
+  return(mismatches);
+}
+
+int QRCompare::runStore()
+{
+  const std::string filename(QRTestCorpus::getScratchFileName("qrcompare", ".qrstore"));
+  std::vector<std::string> payloads;
+  std::vector<std::string> errors;
+  char name[64];
+
+  for (int p = 0; p < 96; p++)
+  {
+    sprintf(name, "LOT-2026-10-%02d SN:%08d", p % 31, 1000 + (p * 7919));
+    payloads.push_back(name);
+  }
+
+  try
+  {
+    /// a first session stores 0 to 63, with the wrong symbols for 32 to 47; a
+    /// second one appends 32 to 95, whose records must hide the older ones.
+    QRSymbolStoreWriter writer;
+    if (!writer.open(filename))
+      errors.push_back("can't create the store");
+
+    for (int p = 0; p < 64; p++)
+    {
+      const ECL ecl = (ECL)(p % 4);
+      const int mask = (p % 3 == 0) ? -1 : (p % 8);
+
+      if (p < 32 || p >= 48)
+        writer.append(payloads[p], ecl, mask);
+      else
+      {
+        QRCode wrong;
+        wrong.encode(payloads[p + 48], ecl, 7 - (p % 8));
+        writer.append(payloads[p], ecl, mask, wrong.toBitMatrix(), wrong.getECL(), wrong.getMask());
+      }
+    }
+
+    if (!writer.close())
+      errors.push_back("can't write the index of the first session");
+
+    if (!writer.open(filename, true))
+      errors.push_back("can't append to the store");
+
+    for (int p = 32; p < 96; p++)
+      writer.append(payloads[p], (ECL)(p % 4), (p % 3 == 0) ? -1 : (p % 8));
+
+    if (!writer.close() || (writer.getRecordCount() != 128))
+      errors.push_back("can't write the index of the second session");
+
+    QRSymbolStore store;
+    if (!store.open(filename) || (store.getRecordCount() != 128))
+      errors.push_back("can't map the store");
+
+    for (int p = 0; p < 96; p++)
+    {
+      const ECL ecl = (ECL)(p % 4);
+      const int mask = (p % 3 == 0) ? -1 : (p % 8);
+      QRSymbolStore::Symbol symbol;
+
+      QRCode expected;
+      expected.encode(payloads[p], ecl, mask);
+      const QRBitMatrix matrix = expected.toBitMatrix();
+
+      if (!store.find(payloads[p], ecl, mask, symbol))
+        sprintf(name, "store payload %d: not found", p);
+      else if ((symbol.m_size != matrix.getSize()) || (symbol.m_stride != matrix.getStride()) ||
+               (symbol.m_ecl != expected.getECL()) || (symbol.m_mask != expected.getMask()) ||
+               !std::equal(matrix.getData(), matrix.getData() + matrix.getDataSize(), symbol.p_data))
+        sprintf(name, "store payload %d: symbol differs", p);
+      else
+        continue;
+
+      errors.push_back(name);
+    }
+
+    /// another level or mask is another key.
+    QRSymbolStore::Symbol symbol;
+    if (store.find("LOT-2026-10-00 SN:99999999", ECL_L, -1, symbol) || store.find(payloads[0], ECL_L, 0, symbol) ||
+        store.find(payloads[1], ECL_H, 1, symbol))
+      errors.push_back("store finds a payload it doesn't hold");
+
+    /// the stored bits go through the image writers as they are.
+    if (store.find(payloads[5], (ECL)(5 % 4), 5, symbol))
+    {
+      QRCode expected, stored;
+      expected.encode(payloads[5], (ECL)(5 % 4), 5);
+      stored.fromBitMatrix(symbol.m_size, symbol.p_data, symbol.m_ecl, symbol.m_mask);
+
+      ui8vector image, expectedImage;
+      stored.encodeToBuffer(IF_PNG, image, 2, 4);
+      expected.encodeToBuffer(IF_PNG, expectedImage, 2, 4);
+      if (image != expectedImage)
+        errors.push_back("store image differs");
+    }
+
+    store.close();
+
+    /// a damaged index without an empty slot must still end a lookup: every
+    /// slot is set to a record no key of the lookups matches.
+    unsigned long long footer[4];
+    FILE *file = fopen(filename.c_str(), "r+b");
+    if ((file == NULL) || (fseek(file, -32, SEEK_END) != 0) || (fread(footer, 8, 4, file) != 4) ||
+        (fseek(file, (long)footer[1], SEEK_SET) != 0))
+      errors.push_back("can't damage the store index");
+    else
+    {
+      const unsigned long long slot = (0xFFFFFFULL << 40) | 2;
+      for (unsigned long long i = 0; i < footer[2]; i++)
+        fwrite(&slot, 8, 1, file);
+    }
+
+    if (file != NULL)
+      fclose(file);
+
+    if (!store.open(filename) || store.find(payloads[0], ECL_H, 0, symbol))
+      errors.push_back("store finds a payload in a full index");
+    store.close();
+  }
+  catch (const char *exception)
+  {
+    errors.push_back(std::string("store: ") + exception);
+  }
+
+  remove(filename.c_str());
+
+  for (size_t i = 0; i < errors.size(); i++)
+    reportMismatch(errors[i]);
+
+  return((int)errors.size());
+}
+
+void QRCompare::benchmark(int repeat)
+{
+  std::vector<Case> corpus;
+  makeCorpus(corpus);
+
+  for (int e = 0; e < EN_COUNT; e++)
+  {
+    Timing &timing = m_timings[e];
+    timing.m_fixedMask = 0.0;
+    timing.m_autoMask = 0.0;
+    timing.m_symbols = 0;
+
+    /// the fixed mask runs cycle through the masks, so both runs encode as many symbols.
+    for (int r = 0; r < repeat; r++)
+    {
+      Clock::time_point start = Clock::now();
+      for (size_t c = 0; c < corpus.size(); c++)
+        encodeOnly((ENGINE)e, corpus[c], m_minMask + (int)((c + r) % (m_maxMask - m_minMask + 1)));
+      timing.m_fixedMask += std::chrono::duration<double>(Clock::now() - start).count();
+
+      start = Clock::now();
+      for (size_t c = 0; c < corpus.size(); c++)
+        encodeOnly((ENGINE)e, corpus[c], -1);
+      timing.m_autoMask += std::chrono::duration<double>(Clock::now() - start).count();
+
+      timing.m_symbols += (int)corpus.size();
+    }
+  }
+}
+
+/// a worker of benchmarkContention(), counts what it does until stop is set.
+static void contentionWorker(bool lookups, int first, const std::atomic<bool> &start, const std::atomic<bool> &stop, long &count)
+{
+  static const char TEXT[] = "https://github.com/abhinath84/Barcode";
+  long done = 0;
+  int spec[5];
+
+  while (!start.load(std::memory_order_acquire))
+    std::this_thread::yield();
+
+  /// the threads start on different versions, as independent requests would.
+  for (int v = first; !stop.load(std::memory_order_relaxed); v = (v % QRSPEC_VERSION_MAX) + 1)
+  {
+    if (lookups)
+    {
+      QRspec_getEccSpec(v, QR_ECLEVEL_M, spec);
+      free(QRspec_newFrame(v));
+      init_rs(8, 0x11d, 0, 1, QRspec_rsEccCodes1(spec), 255 - QRspec_rsDataCodes1(spec) - QRspec_rsEccCodes1(spec));
+    }
+    else
+      QRcode_free(QRcode_encodeString(TEXT, v, QR_ECLEVEL_M, QR_MODE_8, 1));
+
+    done++;
+  }
+
+  count = done;
+}
+
+QRCompare::Contention QRCompare::benchmarkContention(int threads, double seconds)
+{
+  if (threads < 1)
+    throw "Value out of range";
+
+  Contention result;
+  result.m_threads = threads;
+
+  for (int run = 0; run < 2; run++)
+  {
+    std::atomic<bool> start(false), stop(false);
+    std::vector<long> counts(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++)
+      workers.push_back(std::thread(contentionWorker, run == 1, 1 + ((t * 7) % QRSPEC_VERSION_MAX),
+                                    std::cref(start), std::cref(stop), std::ref(counts[t])));
+
+    Clock::time_point begin = Clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true, std::memory_order_relaxed);
+
+    for (int t = 0; t < threads; t++)
+      workers[t].join();
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    long total = 0;
+    for (int t = 0; t < threads; t++)
+      total += counts[t];
+
+    /// a lookup run does a frame and an RS block per iteration.
+    if (run == 0)
+      result.m_symbols = total / elapsed;
+    else
+      result.m_lookups = (2.0 * total) / elapsed;
+  }
+
+  return(result);
+}
+
+int QRCompare::getComparisonCount() const
+{
+  return(m_comparisons);
+}
+
+int QRCompare::getVersionDisagreementCount(ENGINE engine) const
+{
+  if ((engine < 0) || (engine >= EN_COUNT))
+    throw "Invalid engine";
+
+  return(m_versionDiffs[engine]);
+}
+
+int QRCompare::getMaskDisagreementCount(ENGINE engine) const
+{
+  if ((engine < 0) || (engine >= EN_COUNT))
+    throw "Invalid engine";
+
+  return(m_maskDiffs[engine]);
+}
+
+const std::vector<std::string>& QRCompare::getMismatches() const
+{
+  return(m_mismatches);
+}
+
+const QRCompare::Timing& QRCompare::getTiming(ENGINE engine) const
+{
+  if ((engine < 0) || (engine >= EN_COUNT))
+    throw "Invalid engine";
+
+  return(m_timings[engine]);
+}
+
+const char* QRCompare::getEngineName(ENGINE engine)
+{
+  if ((engine < 0) || (engine >= EN_COUNT))
+    throw "Invalid engine";
+
+  return(ENGINE_NAMES[engine]);
+}
+
+bool QRCompare::encode(ENGINE engine, const Case &input, int mask, QRBitMatrix &matrix, int &chosenMask)
+{
+  switch (engine)
+  {
+    case EN_QRCODEGEN:
+    {
+      QRCode qr;
+      try
+      {
+        qr.encode(QRTestCorpus::toQRSegments(input.m_segments), input.m_ecl, mask);
+      }
+      catch (const char*)
+      {
+        return(false);
+      }
+
+      matrix = qr.toBitMatrix();
+      chosenMask = qr.getMask();
+      return(true);
+    }
+
+    case EN_QRCODEGENERATOR:
+    {
+      try
+      {
+        qrcodegen::QrCode qr = qrcodegen::QrCode::encodeSegments(toQRCodeGenerator(input.m_segments),
+            toQRCodeGenerator(input.m_ecl), input.m_version, input.m_version, mask, false);
+
+        matrix = QRBitMatrix(qr.size);
+        for (int y = 0; y < qr.size; y++)
+        {
+          for (int x = 0; x < qr.size; x++)
+            matrix.set(x, y, qr.getModule(x, y) != 0);
+        }
+
+        chosenMask = qr.getMask();
+      }
+      catch (const char*)
+      {
+        return(false);
+      }
+
+      return(true);
+    }
+
+    default:
+    {
+      QRinput *qrinput = toLibQREncode(input);
+      if (qrinput == NULL)
+        return(false);
+
+      QRcode *qr = QRcode_encodeMask(qrinput, mask);
+      QRinput_free(qrinput);
+      if (qr == NULL)
+        return(false);
+
+      /// QRbitmap has the packed rows of QRBitMatrix.
+      QRbitmap *bitmap = QRbitmap_fromQRcode(qr);
+      QRcode_free(qr);
+      if (bitmap == NULL)
+        return(false);
+
+      matrix = QRBitMatrix(bitmap->width, bitmap->data);
+      QRbitmap_free(bitmap);
+
+      /// QRcode doesn't keep the mask, read it back from the format information.
+      QRDecoder decoder;
+      try
+      {
+        decoder.decode(matrix);
+        chosenMask = decoder.getMask();
+      }
+      catch (const char*)
+      {
+        chosenMask = -1;
+      }
+
+      return(true);
+    }
+  }
+}
+
+void QRCompare::makeCorpus(std::vector<Case> &corpus)
+{
+  const ECL ecls[] = {ECL_L, ECL_M, ECL_Q, ECL_H};
+
+  /// the same content for every run.
+  m_corpus.setSeed(1);
+  corpus.clear();
+
+  for (int version = m_minVersion; version <= m_maxVersion; version++)
+  {
+    for (int e = 0; e < 4; e++)
+    {
+      for (int content = 0; content < QRTestCorpus::CT_COUNT; content++)
+      {
+        Case input;
+        input.m_version = version;
+        input.m_ecl = ecls[e];
+        input.m_content = (CONTENT)content;
+        m_corpus.makeSegments(version, ecls[e], (CONTENT)content, input.m_segments);
+
+        corpus.push_back(input);
+      }
+    }
+  }
+}
+
+void QRCompare::reportMismatch(const std::string &description)
+{
+  if (m_mismatches.size() < MAX_REPORTED_MISMATCHES)
+    m_mismatches.push_back(description);
+}
+
+bool QRCompare::encodeOnly(ENGINE engine, const Case &input, int mask)
+{
+  switch (engine)
+  {
+    case EN_QRCODEGEN:
+    {
+      QRCode qr;
+      try
+      {
+        qr.encode(QRTestCorpus::toQRSegments(input.m_segments), input.m_ecl, mask);
+      }
+      catch (const char*)
+      {
+        return(false);
+      }
+
+      return(true);
+    }
+
+    case EN_QRCODEGENERATOR:
+    {
+      try
+      {
+        qrcodegen::QrCode qr = qrcodegen::QrCode::encodeSegments(toQRCodeGenerator(input.m_segments),
+            toQRCodeGenerator(input.m_ecl), input.m_version, input.m_version, mask, false);
+
+        return(qr.size > 0);
+      }
+      catch (const char*)
+      {
+        return(false);
+      }
+    }
+
+    default:
+    {
+      QRinput *qrinput = toLibQREncode(input);
+      if (qrinput == NULL)
+        return(false);
+
+      QRcode *qr = QRcode_encodeMask(qrinput, mask);
+      QRinput_free(qrinput);
+      if (qr == NULL)
+        return(false);
+
+      QRcode_free(qr);
+      return(true);
+    }
+  }
+}
@@ -0,0 +1,270 @@
+/**
+*  @file    qrcompare.h
+*  @brief   class to compare the three QR Code encoders of the solution.
+*
+*  QRCompare feeds the same segments, version, error correction level and
+*  mask to QRCodeGen (QR::QRCode), QRCodeGenerator (qrcodegen::QrCode) and
+*  LibQREncode (QRcode_encodeMask) and compares the module matrices bit for
+*  bit. The corpus covers every version and error correction level with
+*  numeric, alphanumeric, byte, kanji and mixed content filled to capacity,
+*  so every engine should pick that version. An engine picking another
+*  version (LibQREncode overestimates the segment headers near the ends of
+*  the character count ranges) is counted apart, like a different choice of
+*  mask, since the matrices can't be compared then.
+*
+*  runSplitters() checks the optimal string splitter of LibQREncode
+*  against the greedy one, runBitmaps() its packed symbols against QRcode,
+*  runIncremental() checks QRIncrementalEncoder
+*  against QRCode::encode() on series of labels differing in their last
+*  bytes only, runCache() the symbols and images of QRSymbolCache against
+*  those of QRCode, and runStore() those of a QRSymbolStore written in two
+*  sessions.
+*
+*  benchmark() times every engine on the same corpus, once with a fixed
+*  mask (segments, error correction and placement) and once with automatic
+*  masking, the difference being the cost of the mask search. The masks the
+*  engines choose are compared too: a different choice isn't an error, but
+*  shows a difference in the penalty rules.
+*
+*  benchmarkContention() runs LibQREncode on several threads at once, to
+*  measure how its shared caches (initial frames, Reed-Solomon control
+*  blocks) scale with the number of threads.
+*
+*  @author  Abhishek Nath
+*  @date    19-Oct-2026
+*
+*/
+
+
+#ifndef QRCOMPARE_H
+#define QRCOMPARE_H
+
+#include <string>
+#include <vector>
+
+#include "qrutility.h"
+#include "qrbitmatrix.h"
+#include "qrtestcorpus.h"
+
+namespace QR
+{
+  //!  @class  QRCompare
+  /*!
+    Differential tester and benchmark of QRCodeGen, QRCodeGenerator and LibQREncode.
+  */
+  class QRCompare
+  {
+    public:
+      /// encoders under comparison.
+      enum ENGINE
+      {
+        EN_QRCODEGEN = 0,
+        EN_QRCODEGENERATOR,
+        EN_LIBQRENCODE,
+        EN_COUNT
+      };
+
+      /// kinds of content of the corpus, and a segment in a form every engine accepts.
+      typedef QRTestCorpus::CONTENT CONTENT;
+      typedef QRTestCorpus::Segment Segment;
+
+      //!  @struct  Case
+      /*!
+        An input of the corpus.
+      */
+      struct Case
+      {
+        int                   m_version;    ///< Define version the content fills.
+        ECL                   m_ecl;        ///< Define error correction level.
+        CONTENT               m_content;    ///< Define kind of content.
+        std::vector<Segment>  m_segments;   ///< Define segments of the content.
+      };
+
+      //!  @struct  Timing
+      /*!
+        Benchmark results of an engine.
+      */
+      struct Timing
+      {
+        double  m_fixedMask;    ///< Define seconds encoding the corpus with every mask given.
+        double  m_autoMask;     ///< Define seconds encoding the corpus with automatic masking.
+        int     m_symbols;      ///< Define number of symbols encoded in each of the two runs.
+      };
+
+      //!  @struct  Contention
+      /*!
+        Throughput of LibQREncode with a number of threads, all of them together.
+      */
+      struct Contention
+      {
+        int     m_threads;      ///< Define number of threads.
+        double  m_symbols;      ///< Define symbols encoded per second.
+        double  m_lookups;      ///< Define lookups of the frame and RS block caches per second.
+      };
+
+      /// Default Constructor, versions 1 to 40 and masks 0 to 7.
+      QRCompare();
+
+      /// Copy Constructor
+      QRCompare(const QRCompare &other);
+
+      /// Destructor
+      ~QRCompare();
+
+      /// Assignment Operator
+      QRCompare& operator=(const QRCompare &other);
+
+      /// limit the corpus to versions minVersion to maxVersion.
+      void setVersions(int minVersion, int maxVersion);
+
+      /// limit the fixed mask runs to masks minMask to maxMask.
+      void setMasks(int minMask, int maxMask);
+
+      /** @brief compare the three engines on the whole corpus.
+      *
+      *  Every case is encoded with every mask, and once with automatic masking.
+      *  The matrices of the engines picking the same version and mask as
+      *  QRCodeGen are compared with the one of QRCodeGen.
+      *
+      *  @return int number of symbols whose matrices differ or which an engine fails to encode.
+      */
+      int run();
+
+      /** @brief compare the optimal string splitter of LibQREncode with the greedy one.
+      *
+      *  Random strings of digit, alphanumeric and other printable runs are
+      *  encoded with QRcode_encodeString() and QRcode_encodeStringOptimal().
+      *  The optimal symbol must never have a higher version, and must
+      *  decode back to the string. A string too long for any version must
+      *  fail the split with ERANGE.
+      *
+      *  @param[in] strings the number of strings.
+      *
+      *  @return int number of strings which fail, plus one if the long string doesn't.
+      */
+      int runSplitters(int strings = 400);
+
+      /** @brief check that LibQREncode unpacks the symbols it packs.
+      *
+      *  A symbol of every version, and of every Micro QR Code version and
+      *  level, goes through QRbitmap_fromQRcode() and QRbitmap_toQRcode(),
+      *  and must come back byte for byte, flags included.
+      *
+      *  @return int number of symbols which differ.
+      */
+      int runBitmaps();
+
+      /** @brief compare QRIncrementalEncoder with QRCode::encode() on series of labels.
+      *
+      *  For every version and error correction level, a series of labels shares a
+      *  byte prefix filling the symbol but for a serial number at its end. Every
+      *  fifth label is too long for the version, so that the encoder makes a whole
+      *  new symbol, and every fourth one is masked automatically.
+      *
+      *  @param[in] labels the number of labels of every series.
+      *
+      *  @return int number of labels whose symbols differ.
+      */
+      int runIncremental(int labels = 12);
+
+      /** @brief compare QRSymbolCache with QRCode on requests repeating payloads.
+      *
+      *  Threads share a cache too small for all the symbols and images asked
+      *  for, so that it evicts, and compare every symbol or image it returns
+      *  with the one QRCode makes. The counters of the cache must add up.
+      *  The errors of the workers are listed with reportMismatch() once
+      *  they have joined, the counters last.
+      *
+      *  @param[in] threads the number of threads.
+      *  @param[in] requests the number of requests of every thread.
+      *
+      *  @return int number of requests whose results differ, plus one if the counters don't add up.
+      */
+      int runCache(int threads = 4, int requests = 400);
+
+      /** @brief compare the symbols of a QRSymbolStore with those of QRCode.
+      *
+      *  Writes a store in two sessions, the second one appending records
+      *  which must hide some of the first, then maps it and compares the
+      *  symbol of every payload with the one QRCode makes. The file is
+      *  removed afterwards, then the errors are listed with reportMismatch().
+      *
+      *  @return int number of payloads whose symbols differ or are missing, plus the other errors.
+      */
+      int runStore();
+
+      /** @brief time every engine on the whole corpus.
+      *
+      *  @param[in] repeat number of times the corpus is encoded.
+      *
+      *  @return nothing.
+      */
+      void benchmark(int repeat = 1);
+
+      /** @brief time LibQREncode with threads encoding at once.
+      *
+      *  Every thread encodes symbols of every version, then looks up the
+      *  cached frames and Reed-Solomon control blocks alone, for seconds each.
+      *
+      *  @param[in] threads the number of threads.
+      *  @param[in] seconds the time of each of the two runs.
+      *
+      *  @return Contention the throughput of all the threads.
+      */
+      static Contention benchmarkContention(int threads, double seconds);
+
+      /// number of symbols compared by the last run.
+      int getComparisonCount() const;
+
+      /// number of symbols for which an engine picked another version than QRCodeGen.
+      int getVersionDisagreementCount(ENGINE engine) const;
+
+      /// number of automatic masking choices of an engine which differ from the one of QRCodeGen.
+      int getMaskDisagreementCount(ENGINE engine) const;
+
+      /// description of every mismatch of the last run.
+      const std::vector<std::string>& getMismatches() const;
+
+      /// results of the last benchmark for an engine.
+      const Timing& getTiming(ENGINE engine) const;
+
+      /// name of an engine.
+      static const char* getEngineName(ENGINE engine);
+
+      /** @brief encode a case with one engine.
+      *
+      *  @param[in] engine the engine to use.
+      *  @param[in] input the case.
+      *  @param[in] mask the mask, -1 for automatic masking.
+      *  @param[out] matrix the modules of the symbol.
+      *  @param[out] chosenMask the mask of the symbol.
+      *
+      *  @return bool false if the engine fails to encode the case.
+      */
+      static bool encode(ENGINE engine, const Case &input, int mask, QRBitMatrix &matrix, int &chosenMask);
+
+    private:
+      // Builds the corpus for the current version range.
+      void makeCorpus(std::vector<Case> &corpus);
+
+      // Encodes a case without building a matrix, for the benchmark.
+      static bool encodeOnly(ENGINE engine, const Case &input, int mask);
+
+      // Adds the description of a mismatch, unless MAX_REPORTED_MISMATCHES are listed already.
+      void reportMismatch(const std::string &description);
+
+    private:
+      int                       m_minVersion;             ///< Define first version of the corpus.
+      int                       m_maxVersion;             ///< Define last version of the corpus.
+      int                       m_minMask;                ///< Define first mask of the fixed mask runs.
+      int                       m_maxMask;                ///< Define last mask of the fixed mask runs.
+      QRTestCorpus              m_corpus;                 ///< Define generator of the content.
+      int                       m_comparisons;            ///< Define number of symbols compared.
+      int                       m_versionDiffs[EN_COUNT]; ///< Define number of versions which differ from QRCodeGen.
+      int                       m_maskDiffs[EN_COUNT];    ///< Define number of automatic masks which differ from QRCodeGen.
+      std::vector<std::string>  m_mismatches;             ///< Define description of every mismatch.
+      Timing                    m_timings[EN_COUNT];      ///< Define benchmark results of every engine.
+  };
+}
+
+#endif    // QRCOMPARE_H
@@ -0,0 +1,156 @@
+/*
+ * qrencode - QR Code encoder
+ *
+ * Bump allocator of the input data.
+ * Copyright (C) 2026 Abhishek Nath
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#if HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "arena.h"
+
+/* Blocks are aligned to 8 bytes, enough for the pointers, ints and doubles
+ * the library allocates. */
+#define ARENA_ALIGN 8
+#define ARENA_ROUND(__size__) (((__size__) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+typedef struct _ArenaChunk ArenaChunk;
+
+struct _ArenaChunk {
+	ArenaChunk *next;	///< the chunk allocated before this one
+	int size;			///< bytes of the chunk after the header
+	int used;			///< bytes handed out
+	int last;			///< offset of the last block, it can grow in place
+};
+
+#define ARENA_HEADER ARENA_ROUND((int)sizeof(ArenaChunk))
+#define ARENA_DATA(__chunk__) ((unsigned char *)(__chunk__) + ARENA_HEADER)
+
+struct _Arena {
+	ArenaChunk *chunk;	///< the chunk blocks are taken from, head of the list
+};
+
+static ArenaChunk *Arena_newChunk(int size, ArenaChunk *next)
+{
+	ArenaChunk *chunk;
+
+	chunk = (ArenaChunk *)malloc(ARENA_HEADER + size);
+	if(chunk == NULL) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	chunk->next = next;
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->last = -1;
+
+	return chunk;
+}
+
+Arena *Arena_new(int size)
+{
+	ArenaChunk *chunk;
+	Arena *arena;
+	int header;
+
+	/* The arena itself is the first block of its first chunk. */
+	header = ARENA_ROUND((int)sizeof(Arena));
+	chunk = Arena_newChunk(ARENA_ROUND(size) + header, NULL);
+	if(chunk == NULL) return NULL;
+
+	arena = (Arena *)ARENA_DATA(chunk);
+	arena->chunk = chunk;
+	chunk->used = header;
+
+	return arena;
+}
+
+void *Arena_alloc(Arena *arena, int size)
+{
+	ArenaChunk *chunk;
+	int rounded, chunkSize;
+
+	if(arena == NULL) return malloc(size);
+
+	rounded = ARENA_ROUND(size);
+	chunk = arena->chunk;
+	if(chunk->used + rounded > chunk->size) {
+		chunkSize = chunk->size * 2;
+		if(chunkSize < rounded) chunkSize = rounded;
+		chunk = Arena_newChunk(chunkSize, chunk);
+		if(chunk == NULL) return NULL;
+		arena->chunk = chunk;
+	}
+
+	chunk->last = chunk->used;
+	chunk->used += rounded;
+
+	return ARENA_DATA(chunk) + chunk->last;
+}
+
+void *Arena_grow(Arena *arena, void *block, int oldSize, int newSize)
+{
+	ArenaChunk *chunk;
+	void *data;
+	int end;
+
+	if(arena == NULL) return realloc(block, newSize);
+
+	chunk = arena->chunk;
+	if(block != NULL && chunk->last >= 0 && (unsigned char *)block == ARENA_DATA(chunk) + chunk->last) {
+		end = chunk->last + ARENA_ROUND(newSize);
+		if(end <= chunk->size) {
+			chunk->used = end;
+			return block;
+		}
+	}
+
+	data = Arena_alloc(arena, newSize);
+	if(data == NULL) return NULL;
+	if(block != NULL) {
+		memcpy(data, block, oldSize);
+	}
+
+	return data;
+}
+
+void Arena_release(Arena *arena, void *block)
+{
+	if(arena == NULL) {
+		free(block);
+	}
+}
+
+void Arena_free(Arena *arena)
+{
+	ArenaChunk *chunk, *next;
+
+	if(arena == NULL) return;
+
+	/* The arena lives in the last chunk of the list, freed last. */
+	chunk = arena->chunk;
+	while(chunk != NULL) {
+		next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+}
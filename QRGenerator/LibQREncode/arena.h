@@ -0,0 +1,71 @@
+/*
+ * qrencode - QR Code encoder
+ *
+ * Bump allocator of the input data.
+ * Copyright (C) 2026 Abhishek Nath
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+/**
+ * An arena hands out memory from large chunks by moving a pointer, and
+ * frees all of it at once: a block is never freed by itself. The input data
+ * of one symbol (QRinput, its entries, their bit streams and the byte
+ * stream) is short-lived and freed together, so an arena replaces the tens
+ * of malloc()/free() pairs of an encode with one or two.
+ *
+ * Every function takes a NULL arena too and then uses malloc(), realloc()
+ * and free(), so the same code serves both kinds of memory.
+ */
+typedef struct _Arena Arena;
+
+/**
+ * Create an arena.
+ * @param size size of the first chunk in bytes; the next ones double.
+ * @return the arena, or NULL with errno set to ENOMEM.
+ */
+extern Arena *Arena_new(int size);
+
+/**
+ * Allocate a block, aligned for any type of the library.
+ * @param arena the arena, or NULL for malloc().
+ * @return the block, or NULL with errno set to ENOMEM.
+ */
+extern void *Arena_alloc(Arena *arena, int size);
+
+/**
+ * Enlarge a block, keeping its first oldSize bytes. The last block of the
+ * arena grows in place when its chunk has room, the others are copied.
+ * @param arena the arena, or NULL for realloc().
+ * @param block the block, or NULL for a new one.
+ * @return the block, or NULL with errno set to ENOMEM; block is then kept.
+ */
+extern void *Arena_grow(Arena *arena, void *block, int oldSize, int newSize);
+
+/**
+ * Give a block back: free() it without an arena, nothing with one, its
+ * memory is freed with the arena.
+ */
+extern void Arena_release(Arena *arena, void *block);
+
+/**
+ * Free the arena and every block allocated from it.
+ */
+extern void Arena_free(Arena *arena);
+
+#endif /* __ARENA_H__ */
@@ -0,0 +1,60 @@
+/*
+ * qrencode - QR Code encoder
+ *
+ * Atomic pointer operations of the publish-once caches.
+ * Copyright (C) 2026 Abhishek Nath
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef __ATOMICPTR_H__
+#define __ATOMICPTR_H__
+
+/**
+ * A cache entry is built once, published with a compare-and-swap and never
+ * changed afterwards, so readers need no lock: an acquire load sees the
+ * entry completely built. The loser of a race to build the same entry
+ * frees its copy and takes the published one.
+ *
+ * ATOMICPTR_LOAD(p)             acquire load of *p.
+ * ATOMICPTR_CAS(p, old, new)    release store of new to *p if it is old,
+ *                               nonzero on success.
+ * ATOMICPTR_EXCHANGE(p, new)    store new to *p and return the old value.
+ *
+ * p is the address of a void * (cast the address of a typed pointer).
+ */
+#if defined(__GNUC__) || defined(__clang__)
+
+#define ATOMICPTR_LOAD(p) __atomic_load_n((void **)(p), __ATOMIC_ACQUIRE)
+#define ATOMICPTR_CAS(p, old, new) \
+	__sync_bool_compare_and_swap((void **)(p), (void *)(old), (void *)(new))
+#define ATOMICPTR_EXCHANGE(p, new) __atomic_exchange_n((void **)(p), (void *)(new), __ATOMIC_ACQ_REL)
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchangePointer, _InterlockedExchangePointer, _ReadWriteBarrier)
+
+/* volatile reads have acquire semantics with /volatile:ms, the x86 default */
+#define ATOMICPTR_LOAD(p) (*(void *volatile *)(p))
+#define ATOMICPTR_CAS(p, old, new) \
+	(_InterlockedCompareExchangePointer((void *volatile *)(p), (void *)(new), (void *)(old)) == (void *)(old))
+#define ATOMICPTR_EXCHANGE(p, new) _InterlockedExchangePointer((void *volatile *)(p), (void *)(new))
+
+#else
+#error "atomicptr.h: no atomic pointer operations for this compiler"
+#endif
+
+#endif /* __ATOMICPTR_H__ */
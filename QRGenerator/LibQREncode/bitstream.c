@@ -28,165 +28,138 @@
 
 #include "bitstream.h"
 
+/* Smallest data array, the bits of a short segment header and some data. */
+#define BITSTREAM_MIN_CAPACITY 128
+
 BitStream *BitStream_new(void)
+{
+	return BitStream_newArena(NULL);
+}
+
+BitStream *BitStream_newArena(Arena *arena)
 {
 	BitStream *bstream;
 
-	bstream = (BitStream *)malloc(sizeof(BitStream));
+	bstream = (BitStream *)Arena_alloc(arena, sizeof(BitStream));
 	if(bstream == NULL) return NULL;
 
 	bstream->length = 0;
+	bstream->capacity = 0;
 	bstream->data = NULL;
+	bstream->arena = arena;
 
 	return bstream;
 }
 
-static int BitStream_allocate(BitStream *bstream, int length)
+/**
+ * Make room for bits more bits. The capacity at least doubles, so a stream
+ * built by appending numbers one by one is copied O(1) times per bit.
+ */
+static int BitStream_reserve(BitStream *bstream, int bits)
 {
 	unsigned char *data;
+	int capacity;
 
-	if(bstream == NULL) {
-		return -1;
+	if(bstream->length + bits <= bstream->capacity) {
+		return 0;
 	}
 
-	data = (unsigned char *)malloc(length);
-	if(data == NULL) {
-		return -1;
+	capacity = bstream->capacity * 2;
+	if(capacity < bstream->length + bits) {
+		capacity = bstream->length + bits;
+	}
+	if(capacity < BITSTREAM_MIN_CAPACITY) {
+		capacity = BITSTREAM_MIN_CAPACITY;
 	}
 
-	if(bstream->data) {
-		free(bstream->data);
+	data = (unsigned char *)Arena_grow(bstream->arena, bstream->data, bstream->length, capacity);
+	if(data == NULL) {
+		return -1;
 	}
-	bstream->length = length;
 	bstream->data = data;
+	bstream->capacity = capacity;
 
 	return 0;
 }
 
-static BitStream *BitStream_newFromNum(int bits, unsigned int num)
-{
-	unsigned int mask;
-	int i;
-	unsigned char *p;
-	BitStream *bstream;
-
-	bstream = BitStream_new();
-	if(bstream == NULL) return NULL;
-
-	if(BitStream_allocate(bstream, bits)) {
-		BitStream_free(bstream);
-		return NULL;
-	}
-
-	p = bstream->data;
-	mask = 1 << (bits - 1);
-	for(i=0; i<bits; i++) {
-		if(num & mask) {
-			*p = 1;
-		} else {
-			*p = 0;
-		}
-		p++;
-		mask = mask >> 1;
-	}
-
-	return bstream;
-}
-
-static BitStream *BitStream_newFromBytes(int size, unsigned char *data)
-{
-	unsigned char mask;
-	int i, j;
-	unsigned char *p;
-	BitStream *bstream;
-
-	bstream = BitStream_new();
-	if(bstream == NULL) return NULL;
-
-	if(BitStream_allocate(bstream, size * 8)) {
-		BitStream_free(bstream);
-		return NULL;
-	}
-
-	p = bstream->data;
-	for(i=0; i<size; i++) {
-		mask = 0x80;
-		for(j=0; j<8; j++) {
-			if(data[i] & mask) {
-				*p = 1;
-			} else {
-				*p = 0;
-			}
-			p++;
-			mask = mask >> 1;
-		}
-	}
-
-	return bstream;
-}
-
 int BitStream_append(BitStream *bstream, BitStream *arg)
 {
-	unsigned char *data;
-
 	if(arg == NULL) {
 		return -1;
 	}
 	if(arg->length == 0) {
 		return 0;
 	}
-	if(bstream->length == 0) {
-		if(BitStream_allocate(bstream, arg->length)) {
-			return -1;
-		}
-		memcpy(bstream->data, arg->data, arg->length);
-		return 0;
-	}
-
-	data = (unsigned char *)malloc(bstream->length + arg->length);
-	if(data == NULL) {
+	if(BitStream_reserve(bstream, arg->length)) {
 		return -1;
 	}
-	memcpy(data, bstream->data, bstream->length);
-	memcpy(data + bstream->length, arg->data, arg->length);
 
-	free(bstream->data);
+	memcpy(bstream->data + bstream->length, arg->data, arg->length);
 	bstream->length += arg->length;
-	bstream->data = data;
 
 	return 0;
 }
 
 int BitStream_appendNum(BitStream *bstream, int bits, unsigned int num)
 {
-	BitStream *b;
-	int ret;
+	unsigned int mask;
+	int i;
+	unsigned char *p;
 
 	if(bits == 0) return 0;
 
-	b = BitStream_newFromNum(bits, num);
-	if(b == NULL) return -1;
+	if(BitStream_reserve(bstream, bits)) {
+		return -1;
+	}
 
-	ret = BitStream_append(bstream, b);
-	BitStream_free(b);
+	p = bstream->data + bstream->length;
+	mask = 1U << (bits - 1);
+	for(i=0; i<bits; i++) {
+		*p++ = (num & mask) != 0;
+		mask = mask >> 1;
+	}
+	bstream->length += bits;
 
-	return ret;
+	return 0;
 }
 
-int BitStream_appendBytes(BitStream *bstream, int size, unsigned char *data)
+/* The bits of a nibble, one per byte. */
+static const unsigned char BitStream_nibbleBits[16][4] = {
+	{0, 0, 0, 0}, {0, 0, 0, 1}, {0, 0, 1, 0}, {0, 0, 1, 1},
+	{0, 1, 0, 0}, {0, 1, 0, 1}, {0, 1, 1, 0}, {0, 1, 1, 1},
+	{1, 0, 0, 0}, {1, 0, 0, 1}, {1, 0, 1, 0}, {1, 0, 1, 1},
+	{1, 1, 0, 0}, {1, 1, 0, 1}, {1, 1, 1, 0}, {1, 1, 1, 1}
+};
+
+int BitStream_appendBits(BitStream *bstream, int bits, const unsigned char *data)
 {
-	BitStream *b;
-	int ret;
+	int i, bytes;
+	unsigned char *p;
+
+	if(bits == 0) return 0;
 
-	if(size == 0) return 0;
+	if(BitStream_reserve(bstream, bits)) {
+		return -1;
+	}
 
-	b = BitStream_newFromBytes(size, data);
-	if(b == NULL) return -1;
+	p = bstream->data + bstream->length;
+	bytes = bits / 8;
+	for(i=0; i<bytes; i++) {
+		memcpy(p, BitStream_nibbleBits[data[i] >> 4], 4);
+		memcpy(p + 4, BitStream_nibbleBits[data[i] & 0x0f], 4);
+		p += 8;
+	}
+	for(i=0; i<(bits & 7); i++) {
+		*p++ = (data[bytes] >> (7 - i)) & 1;
+	}
+	bstream->length += bits;
 
-	ret = BitStream_append(bstream, b);
-	BitStream_free(b);
+	return 0;
+}
 
-	return ret;
+int BitStream_appendBytes(BitStream *bstream, int size, unsigned char *data)
+{
+	return BitStream_appendBits(bstream, size * 8, data);
 }
 
 unsigned char *BitStream_toByte(BitStream *bstream)
@@ -199,7 +172,7 @@ unsigned char *BitStream_toByte(BitStream *bstream)
 	if(size == 0) {
 		return NULL;
 	}
-	data = (unsigned char *)malloc((size + 7) / 8);
+	data = (unsigned char *)Arena_alloc(bstream->arena, (size + 7) / 8);
 	if(data == NULL) {
 		return NULL;
 	}
@@ -232,7 +205,7 @@ unsigned char *BitStream_toByte(BitStream *bstream)
 void BitStream_free(BitStream *bstream)
 {
 	if(bstream != NULL) {
-		free(bstream->data);
-		free(bstream);
+		Arena_release(bstream->arena, bstream->data);
+		Arena_release(bstream->arena, bstream);
 	}
 }
@@ -22,15 +22,30 @@
 #ifndef __BITSTREAM_H__
 #define __BITSTREAM_H__
 
+#include "arena.h"
+
 typedef struct {
 	int length;
+	int capacity;
 	unsigned char *data;
+	Arena *arena;
 } BitStream;
 
 extern BitStream *BitStream_new(void);
+/**
+ * Bit stream allocated from arena, with its data and the array of
+ * BitStream_toByte(); BitStream_free() leaves them to Arena_free().
+ * A NULL arena is BitStream_new().
+ */
+extern BitStream *BitStream_newArena(Arena *arena);
 extern int BitStream_append(BitStream *bstream, BitStream *arg);
 extern int BitStream_appendNum(BitStream *bstream, int bits, unsigned int num);
 extern int BitStream_appendBytes(BitStream *bstream, int size, unsigned char *data);
+/**
+ * Append the first bits bits of data, most significant bit first, as
+ * textpack.h packs them.
+ */
+extern int BitStream_appendBits(BitStream *bstream, int bits, const unsigned char *data);
 #define BitStream_size(__bstream__) (__bstream__->length)
 extern unsigned char *BitStream_toByte(BitStream *bstream);
 extern void BitStream_free(BitStream *bstream);
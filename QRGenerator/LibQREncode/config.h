@@ -5,7 +5,15 @@
 
 #define HAVE_STRDUP 1
 
+// the POSIX name is deprecated by the microsoft C runtime
+#ifdef _MSC_VER
+#define strdup _strdup
+#endif
+
+// define __STATIC empty to export the internal functions (qrencode_inner.h)
+#ifndef __STATIC
 #define __STATIC static
+#endif
 
 #define MAJOR_VERSION 1
 #define MINOR_VERSION 0
@@ -30,6 +30,12 @@
 #include "qrencode.h"
 #include "qrspec.h"
 #include "mask.h"
+#include "cpudispatch.h"
+#include "atomicptr.h"
+
+#if defined(CPU_DISPATCH_X86)
+# include <immintrin.h>
+#endif
 
 __STATIC int Mask_writeFormatInformation(int width, unsigned char *frame, int mask, QRecLevel level)
 {
@@ -83,70 +89,191 @@ __STATIC int Mask_writeFormatInformation(int width, unsigned char *frame, int ma
 #define N3 (40)
 #define N4 (10)
 
-#define MASKMAKER(__exp__) \
-	int x, y;\
-	int b = 0;\
+/**
+ * Every mask pattern repeats after 12 modules, across and down.
+ */
+#define MASK_PERIOD (12)
+
+/**
+ * Mask a row of modules: d = s, inverted where the pattern is 1 and the
+ * module is not a function pattern (bit 7).
+ * @return the number of dark modules of the masked row.
+ */
+typedef int MaskRow(const unsigned char *s, const unsigned char *pattern, unsigned char *d, int length);
+
+static int Mask_maskRowScalar(const unsigned char *s, const unsigned char *pattern, unsigned char *d, int length)
+{
+	int i;
+	int b = 0;
+
+	for(i=0; i<length; i++) {
+		if(s[i] & 0x80) {
+			d[i] = s[i];
+		} else {
+			d[i] = s[i] ^ pattern[i];
+		}
+		b += (int)(d[i] & 1);
+	}
+
+	return b;
+}
+
+#if defined(CPU_DISPATCH_X86)
+CPU_TARGET_SSE2 static int Mask_maskRowSSE2(const unsigned char *s, const unsigned char *pattern, unsigned char *d, int length)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i sum = zero;
+	__m128i vs, vd, fixed;
+	int i;
+
+	for(i=0; i+16<=length; i+=16) {
+		vs = _mm_loadu_si128((const __m128i *)(s + i));
+		fixed = _mm_cmplt_epi8(vs, zero);
+		vd = _mm_xor_si128(vs, _mm_andnot_si128(fixed, _mm_loadu_si128((const __m128i *)(pattern + i))));
+		_mm_storeu_si128((__m128i *)(d + i), vd);
+		sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_and_si128(vd, one), zero));
+	}
+	sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+
+	return _mm_cvtsi128_si32(sum) + Mask_maskRowScalar(s + i, pattern + i, d + i, length - i);
+}
+
+CPU_TARGET_AVX2 static int Mask_maskRowAVX2(const unsigned char *s, const unsigned char *pattern, unsigned char *d, int length)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi8(1);
+	__m256i sum = zero;
+	__m256i vs, vd, fixed;
+	__m128i vs128, vd128, sum128;
+	int i;
+
+	for(i=0; i+32<=length; i+=32) {
+		vs = _mm256_loadu_si256((const __m256i *)(s + i));
+		fixed = _mm256_cmpgt_epi8(zero, vs);
+		vd = _mm256_xor_si256(vs, _mm256_andnot_si256(fixed, _mm256_loadu_si256((const __m256i *)(pattern + i))));
+		_mm256_storeu_si256((__m256i *)(d + i), vd);
+		sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_and_si256(vd, one), zero));
+	}
+	sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	/* the tail in VEX encoding too, a call to the SSE2 variant would pay the
+	 * AVX to SSE transition */
+	if(i+16 <= length) {
+		vs128 = _mm_loadu_si128((const __m128i *)(s + i));
+		vd128 = _mm_xor_si128(vs128, _mm_andnot_si128(_mm_cmplt_epi8(vs128, _mm_setzero_si128()),
+		                                              _mm_loadu_si128((const __m128i *)(pattern + i))));
+		_mm_storeu_si128((__m128i *)(d + i), vd128);
+		sum128 = _mm_add_epi64(sum128, _mm_sad_epu8(_mm_and_si128(vd128, _mm_set1_epi8(1)), _mm_setzero_si128()));
+		i += 16;
+	}
+	sum128 = _mm_add_epi64(sum128, _mm_unpackhi_epi64(sum128, sum128));
+
+	return _mm_cvtsi128_si32(sum128) + Mask_maskRowScalar(s + i, pattern + i, d + i, length - i);
+}
+#endif
+
+/* Bound at the first mask and published with the other caches (atomicptr.h);
+ * racing threads bind the same variant. */
+static void *maskRow = NULL;
+
+static MaskRow *Mask_getMaskRow(void)
+{
+	CpuFunction variants[CPU_LEVEL_COUNT] = { NULL, NULL, NULL, NULL, NULL };
+	void *row;
+
+	row = ATOMICPTR_LOAD(&maskRow);
+	if(row == NULL) {
+		variants[CPU_SCALAR] = (CpuFunction)Mask_maskRowScalar;
+#if defined(CPU_DISPATCH_X86)
+		variants[CPU_SSE2] = (CpuFunction)Mask_maskRowSSE2;
+		variants[CPU_AVX2] = (CpuFunction)Mask_maskRowAVX2;
+#endif
+		row = (void *)CpuDispatch_bind(CPU_KERNEL_MASK, variants);
+		ATOMICPTR_CAS(&maskRow, NULL, row);
+	}
+
+	return (MaskRow *)row;
+}
+
+/* The pattern of a row is computed for one period and copied along. */
+#define PATTERNMAKER(__exp__) \
+	int x;\
 \
-	for(y=0; y<width; y++) {\
-		for(x=0; x<width; x++) {\
-			if(*s & 0x80) {\
-				*d = *s;\
-			} else {\
-				*d = *s ^ ((__exp__) == 0);\
-			}\
-			b += (int)(*d & 1);\
-			s++; d++;\
-		}\
+	for(x=0; x<width && x<MASK_PERIOD; x++) {\
+		pattern[x] = ((__exp__) == 0);\
 	}\
-	return b;
+	for(; x<width; x++) {\
+		pattern[x] = pattern[x - MASK_PERIOD];\
+	}
 
-static int Mask_mask0(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern0(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER((x+y)&1)
+	PATTERNMAKER((x+y)&1)
 }
 
-static int Mask_mask1(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern1(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER(y&1)
+	PATTERNMAKER(y&1)
 }
 
-static int Mask_mask2(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern2(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER(x%3)
+	PATTERNMAKER(x%3)
+	(void)y;
 }
 
-static int Mask_mask3(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern3(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER((x+y)%3)
+	PATTERNMAKER((x+y)%3)
 }
 
-static int Mask_mask4(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern4(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER(((y/2)+(x/3))&1)
+	PATTERNMAKER(((y/2)+(x/3))&1)
 }
 
-static int Mask_mask5(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern5(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER(((x*y)&1)+(x*y)%3)
+	PATTERNMAKER(((x*y)&1)+(x*y)%3)
 }
 
-static int Mask_mask6(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern6(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER((((x*y)&1)+(x*y)%3)&1)
+	PATTERNMAKER((((x*y)&1)+(x*y)%3)&1)
 }
 
-static int Mask_mask7(int width, const unsigned char *s, unsigned char *d)
+static void Mask_pattern7(int width, int y, unsigned char *pattern)
 {
-	MASKMAKER((((x*y)%3)+((x+y)&1))&1)
+	PATTERNMAKER((((x*y)%3)+((x+y)&1))&1)
 }
 
 #define maskNum (8)
-typedef int MaskMaker(int, const unsigned char *, unsigned char *);
-static MaskMaker *maskMakers[maskNum] = {
-	Mask_mask0, Mask_mask1, Mask_mask2, Mask_mask3,
-	Mask_mask4, Mask_mask5, Mask_mask6, Mask_mask7
+typedef void PatternMaker(int, int, unsigned char *);
+static PatternMaker *patternMakers[maskNum] = {
+	Mask_pattern0, Mask_pattern1, Mask_pattern2, Mask_pattern3,
+	Mask_pattern4, Mask_pattern5, Mask_pattern6, Mask_pattern7
 };
 
+/**
+ * Mask a frame row by row with the dispatched kernel.
+ * @return the number of dark modules.
+ */
+static int Mask_maskFrame(int width, const unsigned char *s, unsigned char *d, int mask)
+{
+	int y;
+	int b = 0;
+	unsigned char pattern[QRSPEC_WIDTH_MAX];
+	MaskRow *row = Mask_getMaskRow();
+
+	for(y=0; y<width; y++) {
+		patternMakers[mask](width, y, pattern);
+		b += row(s, pattern, d, width);
+		s += width; d += width;
+	}
+
+	return b;
+}
+
 #ifdef WITH_TESTS
 unsigned char *Mask_makeMaskedFrame(int width, unsigned char *frame, int mask)
 {
@@ -155,7 +282,7 @@ unsigned char *Mask_makeMaskedFrame(int width, unsigned char *frame, int mask)
 	masked = (unsigned char *)malloc(width * width);
 	if(masked == NULL) return NULL;
 
-	maskMakers[mask](width, frame, masked);
+	Mask_maskFrame(width, frame, masked, mask);
 
 	return masked;
 }
@@ -173,7 +300,7 @@ unsigned char *Mask_makeMask(int width, unsigned char *frame, int mask, QRecLeve
 	masked = (unsigned char *)malloc(width * width);
 	if(masked == NULL) return NULL;
 
-	maskMakers[mask](width, frame, masked);
+	Mask_maskFrame(width, frame, masked, mask);
 	Mask_writeFormatInformation(width, masked, mask, level);
 
 	return masked;
@@ -218,29 +345,40 @@ __STATIC int Mask_calcN1N3(int length, int *runLength)
 	return demerit;
 }
 
-__STATIC int Mask_calcN2(int width, unsigned char *frame)
+/**
+ * N2 of the 2x2 blocks made of a row (p) and the one above it.
+ */
+static int Mask_calcN2Row(int width, const unsigned char *p)
 {
-	int x, y;
-	unsigned char *p;
+	int x;
 	unsigned char b22, w22;
 	int demerit = 0;
 
-	p = frame + width + 1;
-	for(y=1; y<width; y++) {
-		for(x=1; x<width; x++) {
-			b22 = p[0] & p[-1] & p[-width] & p [-width-1];
-			w22 = p[0] | p[-1] | p[-width] | p [-width-1];
-			if((b22 | (w22 ^ 1))&1) {
-				demerit += N2;
-			}
-			p++;
+	for(x=1; x<width; x++) {
+		b22 = p[x] & p[x-1] & p[x-width] & p[x-width-1];
+		w22 = p[x] | p[x-1] | p[x-width] | p[x-width-1];
+		if((b22 | (w22 ^ 1))&1) {
+			demerit += N2;
 		}
-		p++;
 	}
 
 	return demerit;
 }
 
+#ifdef WITH_TESTS
+__STATIC int Mask_calcN2(int width, unsigned char *frame)
+{
+	int y;
+	int demerit = 0;
+
+	for(y=1; y<width; y++) {
+		demerit += Mask_calcN2Row(width, frame + y * width);
+	}
+
+	return demerit;
+}
+#endif
+
 __STATIC int Mask_calcRunLength(int width, unsigned char *frame, int dir, int *runLength)
 {
 	int head;
@@ -271,6 +409,7 @@ __STATIC int Mask_calcRunLength(int width, unsigned char *frame, int dir, int *r
 	return head + 1;
 }
 
+#ifdef WITH_TESTS
 __STATIC int Mask_evaluateSymbol(int width, unsigned char *frame)
 {
 	int x, y;
@@ -292,39 +431,98 @@ __STATIC int Mask_evaluateSymbol(int width, unsigned char *frame)
 
 	return demerit;
 }
+#endif
 
-unsigned char *Mask_mask(int width, unsigned char *frame, QRecLevel level)
+/**
+ * Mask a frame and evaluate the result in one pass: every row is scored
+ * (N1/N3 across, N2 with the row above, dark modules) right after it is
+ * masked, while it is in the L1 cache, and the columns once the last row is
+ * done. The format information is written to the function modules of the
+ * frame first, so that the rows are final when they are scored.
+ * The evaluation stops as soon as the demerit reaches limit: every
+ * penalty is positive, such a symbol can't be better any more.
+ * @return the demerit, at least limit if the evaluation stopped.
+ */
+static int Mask_maskAndEvaluate(int width, unsigned char *frame, int mask, QRecLevel level, unsigned char *d, int limit)
 {
-	int i;
-	unsigned char *mask, *bestMask;
-	int minDemerit = INT_MAX;
-	int blacks;
+	int x, y;
+	int demerit = 0;
+	int blacks = 0;
 	int bratio;
-	int demerit;
+	int length;
 	int w2 = width * width;
+	int runLength[QRSPEC_WIDTH_MAX + 1];
+	unsigned char pattern[QRSPEC_WIDTH_MAX];
+	const unsigned char *s;
+	unsigned char *p;
+	MaskRow *row = Mask_getMaskRow();
+
+	Mask_writeFormatInformation(width, frame, mask, level);
 
-	mask = (unsigned char *)malloc(w2);
-	if(mask == NULL) return NULL;
-	bestMask = NULL;
+	s = frame;
+	p = d;
+	for(y=0; y<width; y++) {
+		patternMakers[mask](width, y, pattern);
+		blacks += row(s, pattern, p, width);
+		length = Mask_calcRunLength(width, p, 0, runLength);
+		demerit += Mask_calcN1N3(length, runLength);
+		if(y > 0) {
+			demerit += Mask_calcN2Row(width, p);
+		}
+		if(demerit >= limit) return demerit;
+		s += width; p += width;
+	}
+
+	for(x=0; x<width; x++) {
+		length = Mask_calcRunLength(width, d + x, 1, runLength);
+		demerit += Mask_calcN1N3(length, runLength);
+		if(demerit >= limit) return demerit;
+	}
+
+	bratio = (200 * blacks + w2) / w2 / 2; /* (int)(100*blacks/w2+0.5) */
+	demerit += (abs(bratio - 50) / 5) * N4;
+
+	return demerit;
+}
+
+/* The masks are tried in buffer0 and buffer1 in turn: the best one is kept
+ * in one of them while the other takes the next candidate. The format
+ * information area of frame is overwritten. */
+static unsigned char *Mask_maskBuffers(int width, unsigned char *frame, QRecLevel level, unsigned char *buffer0, unsigned char *buffer1)
+{
+	int i;
+	unsigned char *candidate = buffer0;
+	unsigned char *bestMask = NULL;
+	int minDemerit = INT_MAX;
+	int demerit;
 
 	for(i=0; i<maskNum; i++) {
-//		n1 = n2 = n3 = n4 = 0;
-		demerit = 0;
-		blacks = maskMakers[i](width, frame, mask);
-		blacks += Mask_writeFormatInformation(width, mask, i, level);
-		bratio = (200 * blacks + w2) / w2 / 2; /* (int)(100*blacks/w2+0.5) */
-		demerit = (abs(bratio - 50) / 5) * N4;
-//		n4 = demerit;
-		demerit += Mask_evaluateSymbol(width, mask);
-//		printf("(%d,%d,%d,%d)=%d\n", n1, n2, n3 ,n4, demerit);
+		demerit = Mask_maskAndEvaluate(width, frame, i, level, candidate, minDemerit);
 		if(demerit < minDemerit) {
 			minDemerit = demerit;
-			free(bestMask);
-			bestMask = mask;
-			mask = (unsigned char *)malloc(w2);
-			if(mask == NULL) break;
+			bestMask = candidate;
+			candidate = (candidate == buffer0) ? buffer1 : buffer0;
 		}
 	}
-	free(mask);
+
+	return bestMask;
+}
+
+unsigned char *Mask_mask(int width, unsigned char *frame, QRecLevel level)
+{
+	unsigned char *buffer0, *buffer1, *bestMask;
+	int w2 = width * width;
+
+	buffer0 = (unsigned char *)malloc(w2);
+	buffer1 = (unsigned char *)malloc(w2);
+	if(buffer0 == NULL || buffer1 == NULL) {
+		free(buffer0);
+		free(buffer1);
+		return NULL;
+	}
+
+	bestMask = Mask_maskBuffers(width, frame, level, buffer0, buffer1);
+	free((bestMask == buffer0) ? buffer1 : buffer0);
+
 	return bestMask;
 }
@@ -32,11 +32,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
-#ifdef HAVE_LIBPTHREAD
-#include <pthread.h>
-#endif
 
 #include "mqrspec.h"
+#include "atomicptr.h"
 
 /******************************************************************************
  * Version and capacity
@@ -157,14 +155,11 @@ unsigned int MQRspec_getFormatInfo(int mask, int version, QRecLevel level)
  *****************************************************************************/
 
 /**
- * Cache of initial frames.
+ * Cache of initial frames, published once per version (see atomicptr.h).
  */
 /* C99 says that static storage shall be initialized to a null pointer
  * by compiler. */
 static unsigned char *frames[MQRSPEC_VERSION_MAX + 1];
-#ifdef HAVE_LIBPTHREAD
-static pthread_mutex_t frames_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif
 
 /**
  * Put a finder pattern.
@@ -239,42 +234,38 @@ static unsigned char *MQRspec_createFrame(int version)
 
 unsigned char *MQRspec_newFrame(int version)
 {
-	unsigned char *frame;
+	unsigned char *frame, *cached;
 	int width;
 
 	if(version < 1 || version > MQRSPEC_VERSION_MAX) return NULL;
 
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_lock(&frames_mutex);
-#endif
-	if(frames[version] == NULL) {
-		frames[version] = MQRspec_createFrame(version);
+	cached = (unsigned char *)ATOMICPTR_LOAD(&frames[version]);
+	if(cached == NULL) {
+		frame = MQRspec_createFrame(version);
+		if(frame == NULL) return NULL;
+		if(ATOMICPTR_CAS(&frames[version], NULL, frame)) {
+			cached = frame;
+		} else {
+			/* another thread published it first */
+			free(frame);
+			cached = (unsigned char *)ATOMICPTR_LOAD(&frames[version]);
+		}
 	}
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_unlock(&frames_mutex);
-#endif
-	if(frames[version] == NULL) return NULL;
 
 	width = mqrspecCapacity[version].width;
 	frame = (unsigned char *)malloc(width * width);
 	if(frame == NULL) return NULL;
-	memcpy(frame, frames[version], width * width);
+	memcpy(frame, cached, width * width);
 
 	return frame;
 }
 
+/* Not to be called while other threads encode, they may still copy a frame. */
 void MQRspec_clearCache(void)
 {
 	int i;
 
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_lock(&frames_mutex);
-#endif
 	for(i=1; i<=MQRSPEC_VERSION_MAX; i++) {
-		free(frames[i]);
-		frames[i] = NULL;
+		free(ATOMICPTR_EXCHANGE(&frames[i], NULL));
 	}
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_unlock(&frames_mutex);
-#endif
 }
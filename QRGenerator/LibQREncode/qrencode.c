@@ -57,6 +57,7 @@ typedef struct {
 	int blocks;
 	RSblock *rsblock;
 	int count;
+	Arena *arena;
 } QRRawCode;
 
 static void RSblock_initBlock(RSblock *block, int dl, unsigned char *data, int el, unsigned char *ecc, RS *rs)
@@ -114,12 +115,15 @@ __STATIC QRRawCode *QRraw_new(QRinput *input)
 	QRRawCode *raw;
 	int spec[5], ret;
 
-	raw = (QRRawCode *)malloc(sizeof(QRRawCode));
+	/* With an arena, the raw code is freed with the input like the byte
+	 * stream, QRraw_free() only frees it without one. */
+	raw = (QRRawCode *)Arena_alloc(input->arena, sizeof(QRRawCode));
 	if(raw == NULL) return NULL;
 
+	raw->arena = input->arena;
 	raw->datacode = QRinput_getByteStream(input);
 	if(raw->datacode == NULL) {
-		free(raw);
+		Arena_release(raw->arena, raw);
 		return NULL;
 	}
 
@@ -129,15 +133,15 @@ __STATIC QRRawCode *QRraw_new(QRinput *input)
 	raw->b1 = QRspec_rsBlockNum1(spec);
 	raw->dataLength = QRspec_rsDataLength(spec);
 	raw->eccLength = QRspec_rsEccLength(spec);
-	raw->ecccode = (unsigned char *)malloc(raw->eccLength);
+	raw->ecccode = (unsigned char *)Arena_alloc(raw->arena, raw->eccLength);
 	if(raw->ecccode == NULL) {
-		free(raw->datacode);
-		free(raw);
+		Arena_release(raw->arena, raw->datacode);
+		Arena_release(raw->arena, raw);
 		return NULL;
 	}
 
 	raw->blocks = QRspec_rsBlockNum(spec);
-	raw->rsblock = (RSblock *)calloc(raw->blocks, sizeof(RSblock));
+	raw->rsblock = (RSblock *)Arena_alloc(raw->arena, raw->blocks * sizeof(RSblock));
 	if(raw->rsblock == NULL) {
 		QRraw_free(raw);
 		return NULL;
@@ -185,10 +189,10 @@ __STATIC unsigned char QRraw_getCode(QRRawCode *raw)
 __STATIC void QRraw_free(QRRawCode *raw)
 {
 	if(raw != NULL) {
-		free(raw->datacode);
-		free(raw->ecccode);
-		free(raw->rsblock);
-		free(raw);
+		Arena_release(raw->arena, raw->datacode);
+		Arena_release(raw->arena, raw->ecccode);
+		Arena_release(raw->arena, raw->rsblock);
+		Arena_release(raw->arena, raw);
 	}
 }
 
@@ -205,6 +209,7 @@ typedef struct {
 	RSblock *rsblock;
 	int oddbits;
 	int count;
+	Arena *arena;
 } MQRRawCode;
 
 __STATIC void MQRraw_free(MQRRawCode *raw);
@@ -213,26 +218,27 @@ __STATIC MQRRawCode *MQRraw_new(QRinput *input)
 	MQRRawCode *raw;
 	RS *rs;
 
-	raw = (MQRRawCode *)malloc(sizeof(MQRRawCode));
+	raw = (MQRRawCode *)Arena_alloc(input->arena, sizeof(MQRRawCode));
 	if(raw == NULL) return NULL;
 
+	raw->arena = input->arena;
 	raw->version = input->version;
 	raw->dataLength = MQRspec_getDataLength(input->version, input->level);
 	raw->eccLength = MQRspec_getECCLength(input->version, input->level);
 	raw->oddbits = raw->dataLength * 8 - MQRspec_getDataLengthBit(input->version, input->level);
 	raw->datacode = QRinput_getByteStream(input);
 	if(raw->datacode == NULL) {
-		free(raw);
+		Arena_release(raw->arena, raw);
 		return NULL;
 	}
-	raw->ecccode = (unsigned char *)malloc(raw->eccLength);
+	raw->ecccode = (unsigned char *)Arena_alloc(raw->arena, raw->eccLength);
 	if(raw->ecccode == NULL) {
-		free(raw->datacode);
-		free(raw);
+		Arena_release(raw->arena, raw->datacode);
+		Arena_release(raw->arena, raw);
 		return NULL;
 	}
 
-	raw->rsblock = (RSblock *)calloc(1, sizeof(RSblock));
+	raw->rsblock = (RSblock *)Arena_alloc(raw->arena, sizeof(RSblock));
 	if(raw->rsblock == NULL) {
 		MQRraw_free(raw);
 		return NULL;
@@ -275,10 +281,10 @@ __STATIC unsigned char MQRraw_getCode(MQRRawCode *raw)
 __STATIC void MQRraw_free(MQRRawCode *raw)
 {
 	if(raw != NULL) {
-		free(raw->datacode);
-		free(raw->ecccode);
-		free(raw->rsblock);
-		free(raw);
+		Arena_release(raw->arena, raw->datacode);
+		Arena_release(raw->arena, raw->ecccode);
+		Arena_release(raw->arena, raw->rsblock);
+		Arena_release(raw->arena, raw);
 	}
 }
 
@@ -632,7 +638,7 @@ QRcode *QRcode_encodeInput(QRinput *input)
 	}
 }
 
-static QRcode *QRcode_encodeStringReal(const char *string, int version, QRecLevel level, int mqr, QRencodeMode hint, int casesensitive)
+static QRcode *QRcode_encodeStringReal(const char *string, int version, QRecLevel level, int mqr, QRencodeMode hint, int casesensitive, int optimal)
 {
 	QRinput *input;
 	QRcode *code;
@@ -647,14 +653,14 @@ static QRcode *QRcode_encodeStringReal(const char *string, int version, QRecLeve
 		return NULL;
 	}
 
-	if(mqr) {
-		input = QRinput_newMQR(version, level);
-	} else {
-		input = QRinput_new2(version, level);
-	}
+	input = QRinput_newArena(version, level, mqr);
 	if(input == NULL) return NULL;
 
-	ret = Split_splitStringToQRinput(string, input, hint, casesensitive);
+	if(optimal) {
+		ret = Split_splitStringToQRinputOptimal(string, input, hint, casesensitive);
+	} else {
+		ret = Split_splitStringToQRinput(string, input, hint, casesensitive);
+	}
 	if(ret < 0) {
 		QRinput_free(input);
 		return NULL;
@@ -667,12 +673,17 @@ static QRcode *QRcode_encodeStringReal(const char *string, int version, QRecLeve
 
 QRcode *QRcode_encodeString(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive)
 {
-	return QRcode_encodeStringReal(string, version, level, 0, hint, casesensitive);
+	return QRcode_encodeStringReal(string, version, level, 0, hint, casesensitive, 0);
 }
 
 QRcode *QRcode_encodeStringMQR(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive)
 {
-	return QRcode_encodeStringReal(string, version, level, 1, hint, casesensitive);
+	return QRcode_encodeStringReal(string, version, level, 1, hint, casesensitive, 0);
+}
+
+QRcode *QRcode_encodeStringOptimal(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive)
+{
+	return QRcode_encodeStringReal(string, version, level, 0, hint, casesensitive, 1);
 }
 
 static QRcode *QRcode_encodeDataReal(const unsigned char *data, int length, int version, QRecLevel level, int mqr)
@@ -686,11 +697,7 @@ static QRcode *QRcode_encodeDataReal(const unsigned char *data, int length, int
 		return NULL;
 	}
 
-	if(mqr) {
-		input = QRinput_newMQR(version, level);
-	} else {
-		input = QRinput_new2(version, level);
-	}
+	input = QRinput_newArena(version, level, mqr);
 	if(input == NULL) return NULL;
 
 	ret = QRinput_append(input, QR_MODE_8, length, data);
@@ -732,6 +739,150 @@ QRcode *QRcode_encodeString8bitMQR(const char *string, int version, QRecLevel le
 	return QRcode_encodeDataReal((unsigned char *)string, strlen(string), version, level, 1);
 }
 
+/******************************************************************************
+ * Packed output
+ *****************************************************************************/
+
+QRbitmap *QRbitmap_fromQRcode(const QRcode *qrcode)
+{
+	QRbitmap *bitmap;
+	const unsigned char *p;
+	unsigned char *q, v;
+	int x, y, i, width, tail;
+
+	if(qrcode == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	bitmap = (QRbitmap *)malloc(sizeof(QRbitmap));
+	if(bitmap == NULL) return NULL;
+
+	width = qrcode->width;
+	bitmap->version = qrcode->version;
+	bitmap->width = width;
+	bitmap->stride = (width + 7) / 8;
+	bitmap->data = (unsigned char *)malloc(bitmap->stride * width);
+	if(bitmap->data == NULL) {
+		free(bitmap);
+		return NULL;
+	}
+
+	p = qrcode->data;
+	q = bitmap->data;
+	tail = width & 7;
+	for(y=0; y<width; y++) {
+		/* eight modules a byte; the compiler keeps v in a register */
+		for(x=0; x<width - tail; x+=8) {
+			v = 0;
+			for(i=0; i<8; i++) {
+				v = (unsigned char)((v << 1) | (p[i] & 1));
+			}
+			*q++ = v;
+			p += 8;
+		}
+		if(tail) {
+			v = 0;
+			for(i=0; i<tail; i++) {
+				v = (unsigned char)((v << 1) | (p[i] & 1));
+			}
+			*q++ = (unsigned char)(v << (8 - tail));
+			p += tail;
+		}
+	}
+
+	return bitmap;
+}
+
+QRcode *QRbitmap_toQRcode(const QRbitmap *bitmap)
+{
+	QRcode *qrcode;
+	unsigned char *frame, *p;
+	const unsigned char *row;
+	int x, y, width, version, dark;
+
+	if(bitmap == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	/* The function patterns and their flags come from the empty frame of
+	 * the version; the format information area of the frame is reserved
+	 * (0x84) and takes its dark bit from the bitmap like the rest. */
+	width = bitmap->width;
+	version = bitmap->version;
+	if(width <= MQRSPEC_WIDTH_MAX) {
+		if(version < 1 || version > MQRSPEC_VERSION_MAX || MQRspec_getWidth(version) != width) {
+			errno = EINVAL;
+			return NULL;
+		}
+		frame = MQRspec_newFrame(version);
+	} else {
+		if(version < 1 || version > QRSPEC_VERSION_MAX || QRspec_getWidth(version) != width) {
+			errno = EINVAL;
+			return NULL;
+		}
+		frame = QRspec_newFrame(version);
+	}
+	if(frame == NULL) return NULL;
+
+	p = frame;
+	for(y=0; y<width; y++) {
+		row = bitmap->data + y * bitmap->stride;
+		for(x=0; x<width; x++) {
+			dark = (row[x >> 3] >> (7 - (x & 7))) & 1;
+			if(*p & 0x80) {
+				*p = (unsigned char)((*p & 0xfe) | dark);
+			} else {
+				*p = (unsigned char)(0x02 | dark);
+			}
+			p++;
+		}
+	}
+
+	qrcode = QRcode_new(version, width, frame);
+	if(qrcode == NULL) {
+		free(frame);
+		return NULL;
+	}
+
+	return qrcode;
+}
+
+void QRbitmap_free(QRbitmap *bitmap)
+{
+	if(bitmap != NULL) {
+		free(bitmap->data);
+		free(bitmap);
+	}
+}
+
+static QRbitmap *QRbitmap_fromQRcodeAndFree(QRcode *qrcode)
+{
+	QRbitmap *bitmap;
+
+	if(qrcode == NULL) return NULL;
+	bitmap = QRbitmap_fromQRcode(qrcode);
+	QRcode_free(qrcode);
+
+	return bitmap;
+}
+
+QRbitmap *QRcode_encodeInputPacked(QRinput *input)
+{
+	return QRbitmap_fromQRcodeAndFree(QRcode_encodeInput(input));
+}
+
+QRbitmap *QRcode_encodeStringPacked(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive)
+{
+	return QRbitmap_fromQRcodeAndFree(QRcode_encodeString(string, version, level, hint, casesensitive));
+}
+
+QRbitmap *QRcode_encodeDataPacked(int size, const unsigned char *data, int version, QRecLevel level)
+{
+	return QRbitmap_fromQRcodeAndFree(QRcode_encodeData(size, data, version, level));
+}
+
 
 /******************************************************************************
  * Structured QR-code encoding
@@ -183,6 +183,24 @@ extern QRinput *QRinput_new2(int version, QRecLevel level);
  */
 extern QRinput *QRinput_newMQR(int version, QRecLevel level);
 
+/**
+ * Instantiate an input data object that takes its memory, and the memory of
+ * its entries, their bit streams and the byte stream of the symbol, from
+ * one arena, a bump allocator freed at once by QRinput_free(). This saves
+ * the most on short inputs, where an encode spends its time in malloc() and
+ * free(). QRcode_encodeString() and QRcode_encodeData() use it. Nothing is
+ * given back before QRinput_free(), so an input encoded many times keeps
+ * growing: it suits inputs encoded once.
+ * @param version version number, as QRinput_new2() or QRinput_newMQR().
+ * @param level Error correction level.
+ * @param mqr 1 for a Micro QR Code input, 0 otherwise.
+ * @return an input object. On error, NULL is returned and errno is set
+ *         to indicate the error.
+ * @throw ENOMEM unable to allocate memory for input objects.
+ * @throw EINVAL invalid arguments.
+ */
+extern QRinput *QRinput_newArena(int version, QRecLevel level, int mqr);
+
 /**
  * Append data to an input object.
  * The data is copied and appended to the input object.
@@ -391,7 +409,6 @@ struct _QRcode_List {
 
 /**
  * Create a symbol from the input data.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  * @param input input data.
  * @return an instance of QRcode class. The version of the result QRcode may
  *         be larger than the designated version. On error, NULL is returned,
@@ -405,7 +422,6 @@ extern QRcode *QRcode_encodeInput(QRinput *input);
 /**
  * Create a symbol from the string. The library automatically parses the input
  * string and encodes in a QR Code symbol.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  * @param string input string. It must be NUL terminated.
  * @param version version of the symbol. If 0, the library chooses the minimum
  *                version for the given input data.
@@ -426,27 +442,31 @@ extern QRcode *QRcode_encodeInput(QRinput *input);
  */
 extern QRcode *QRcode_encodeString(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive);
 
+/**
+ * Same to QRcode_encodeString(), but the string is split into the modes
+ * that give the shortest bit stream, found by dynamic programming over the
+ * whole string, where QRcode_encodeString() decides run by run. The symbol
+ * is never larger, and often one version smaller for mixed content.
+ */
+extern QRcode *QRcode_encodeStringOptimal(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive);
+
 /**
  * Same to QRcode_encodeString(), but encode whole data in 8-bit mode.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  */
 extern QRcode *QRcode_encodeString8bit(const char *string, int version, QRecLevel level);
 
 /**
  * Micro QR Code version of QRcode_encodeString().
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  */
 extern QRcode *QRcode_encodeStringMQR(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive);
 
 /**
  * Micro QR Code version of QRcode_encodeString8bit().
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  */
 extern QRcode *QRcode_encodeString8bitMQR(const char *string, int version, QRecLevel level);
 
 /**
  * Encode byte stream (may include '\0') in 8-bit mode.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  * @param size size of the input data.
  * @param data input data.
  * @param version version of the symbol. If 0, the library chooses the minimum
@@ -460,7 +480,6 @@ extern QRcode *QRcode_encodeData(int size, const unsigned char *data, int versio
 
 /**
  * Micro QR Code version of QRcode_encodeData().
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  */
 extern QRcode *QRcode_encodeDataMQR(int size, const unsigned char *data, int version, QRecLevel level);
 
@@ -470,9 +489,73 @@ extern QRcode *QRcode_encodeDataMQR(int size, const unsigned char *data, int ver
  */
 extern void QRcode_free(QRcode *qrcode);
 
+/**
+ * Packed symbol, one bit per module.
+ * Each row takes stride = (width + 7) / 8 bytes; the leftmost module of a
+ * row is the most significant bit of its first byte, 1 is black, and the
+ * padding bits at the end of a row are 0. The top row comes first. This is
+ * the layout of QRBitMatrix in QRCodeGen, and 1/8 of the memory of QRcode.
+ * The flag bits of QRcode are not kept: QRbitmap_toQRcode() brings them
+ * back when they are needed.
+ */
+typedef struct {
+	int version;         ///< version of the symbol
+	int width;           ///< width of the symbol
+	int stride;          ///< bytes of a row
+	unsigned char *data; ///< stride*width bytes of packed rows
+} QRbitmap;
+
+/**
+ * Create a packed symbol from the input data. Same to QRcode_encodeInput(),
+ * but the result is a ::QRbitmap.
+ * @param input input data.
+ * @return an instance of QRbitmap class. On error, NULL is returned, and
+ *         errno is set to indicate the error.
+ * @throw EINVAL invalid input object.
+ * @throw ENOMEM unable to allocate memory for input objects.
+ */
+extern QRbitmap *QRcode_encodeInputPacked(QRinput *input);
+
+/**
+ * Packed version of QRcode_encodeString().
+ */
+extern QRbitmap *QRcode_encodeStringPacked(const char *string, int version, QRecLevel level, QRencodeMode hint, int casesensitive);
+
+/**
+ * Packed version of QRcode_encodeData().
+ */
+extern QRbitmap *QRcode_encodeDataPacked(int size, const unsigned char *data, int version, QRecLevel level);
+
+/**
+ * Pack a symbol.
+ * @param qrcode an instance of QRcode class, not changed.
+ * @return an instance of QRbitmap class. On error, NULL is returned, and
+ *         errno is set to indicate the error.
+ * @throw ENOMEM unable to allocate memory.
+ */
+extern QRbitmap *QRbitmap_fromQRcode(const QRcode *qrcode);
+
+/**
+ * Unpack a symbol into the byte per module layout of QRcode, with the flag
+ * bits of the function patterns restored from the symbol of its version.
+ * Micro QR Code symbols are told apart by their width.
+ * @param bitmap an instance of QRbitmap class, not changed.
+ * @return an instance of QRcode class, identical to the one the bitmap
+ *         was packed from. On error, NULL is returned, and errno is set to
+ *         indicate the error.
+ * @throw EINVAL invalid version or width.
+ * @throw ENOMEM unable to allocate memory.
+ */
+extern QRcode *QRbitmap_toQRcode(const QRbitmap *bitmap);
+
+/**
+ * Free the instance of QRbitmap class.
+ * @param bitmap an instance of QRbitmap class.
+ */
+extern void QRbitmap_free(QRbitmap *bitmap);
+
 /**
  * Create structured symbols from the input data.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  * @param s
  * @return a singly-linked list of QRcode.
  */
@@ -481,7 +564,6 @@ extern QRcode_List *QRcode_encodeInputStructured(QRinput_Struct *s);
 /**
  * Create structured symbols from the string. The library automatically parses
  * the input string and encodes in a QR Code symbol.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  * @param string input string. It must be NUL terminated.
  * @param version version of the symbol.
  * @param level error correction level.
@@ -500,14 +582,12 @@ extern QRcode_List *QRcode_encodeStringStructured(const char *string, int versio
 
 /**
  * Same to QRcode_encodeStringStructured(), but encode whole data in 8-bit mode.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  */
 extern QRcode_List *QRcode_encodeString8bitStructured(const char *string, int version, QRecLevel level);
 
 /**
  * Create structured symbols from byte stream (may include '\0'). Wholde data
  * are encoded in 8-bit mode.
- * @warning This function is THREAD UNSAFE when pthread is disabled.
  * @param size size of the input data.
  * @param data input dat.
  * @param version version of the symbol.
@@ -32,6 +32,16 @@
 #include "mqrspec.h"
 #include "bitstream.h"
 #include "qrinput.h"
+#include "textpack.h"
+
+/* First chunk of the arena of an input: a short input is encoded without
+ * another one. */
+#define QRINPUT_ARENA_SIZE 4096
+
+/* Characters packed at a time by textpack.h into a buffer on the stack,
+ * whole groups of the numeric and the alphanumeric modes. */
+#define QRINPUT_PACK_DIGITS 384
+#define QRINPUT_PACK_CHARS 256
 
 /******************************************************************************
  * Utilities
@@ -45,7 +55,7 @@ int QRinput_isSplittableMode(QRencodeMode mode)
  * Entry of input data
  *****************************************************************************/
 
-static QRinput_List *QRinput_List_newEntry(QRencodeMode mode, int size, const unsigned char *data)
+static QRinput_List *QRinput_List_newEntry(Arena *arena, QRencodeMode mode, int size, const unsigned char *data)
 {
 	QRinput_List *entry;
 
@@ -54,20 +64,22 @@ static QRinput_List *QRinput_List_newEntry(QRencodeMode mode, int size, const un
 		return NULL;
 	}
 
-	entry = (QRinput_List *)malloc(sizeof(QRinput_List));
+	entry = (QRinput_List *)Arena_alloc(arena, sizeof(QRinput_List));
 	if(entry == NULL) return NULL;
 
 	entry->mode = mode;
 	entry->size = size;
+	entry->data = NULL;
 	if(size > 0) {
-		entry->data = (unsigned char *)malloc(size);
+		entry->data = (unsigned char *)Arena_alloc(arena, size);
 		if(entry->data == NULL) {
-			free(entry);
+			Arena_release(arena, entry);
 			return NULL;
 		}
 		memcpy(entry->data, data, size);
 	}
 	entry->bstream = NULL;
+	entry->arena = arena;
 	entry->next = NULL;
 
 	return entry;
@@ -76,9 +88,9 @@ static QRinput_List *QRinput_List_newEntry(QRencodeMode mode, int size, const un
 static void QRinput_List_freeEntry(QRinput_List *entry)
 {
 	if(entry != NULL) {
-		free(entry->data);
+		Arena_release(entry->arena, entry->data);
 		BitStream_free(entry->bstream);
-		free(entry);
+		Arena_release(entry->arena, entry);
 	}
 }
 
@@ -98,6 +110,7 @@ static QRinput_List *QRinput_List_dup(QRinput_List *entry)
 	}
 	memcpy(n->data, entry->data, entry->size);
 	n->bstream = NULL;
+	n->arena = NULL;
 	n->next = NULL;
 
 	return n;
@@ -112,7 +125,7 @@ QRinput *QRinput_new(void)
 	return QRinput_new2(0, QR_ECLEVEL_L);
 }
 
-QRinput *QRinput_new2(int version, QRecLevel level)
+static QRinput *QRinput_newInArena(Arena *arena, int version, QRecLevel level)
 {
 	QRinput *input;
 
@@ -121,7 +134,7 @@ QRinput *QRinput_new2(int version, QRecLevel level)
 		return NULL;
 	}
 
-	input = (QRinput *)malloc(sizeof(QRinput));
+	input = (QRinput *)Arena_alloc(arena, sizeof(QRinput));
 	if(input == NULL) return NULL;
 
 	input->head = NULL;
@@ -130,10 +143,16 @@ QRinput *QRinput_new2(int version, QRecLevel level)
 	input->level = level;
 	input->mqr = 0;
 	input->fnc1 = 0;
+	input->arena = arena;
 
 	return input;
 }
 
+QRinput *QRinput_new2(int version, QRecLevel level)
+{
+	return QRinput_newInArena(NULL, version, level);
+}
+
 QRinput *QRinput_newMQR(int version, QRecLevel level)
 {
 	QRinput *input;
@@ -153,6 +172,31 @@ INVALID:
 	return NULL;
 }
 
+QRinput *QRinput_newArena(int version, QRecLevel level, int mqr)
+{
+	Arena *arena;
+	QRinput *input;
+
+	if(mqr) {
+		if(version <= 0 || version > MQRSPEC_VERSION_MAX || MQRspec_getECCLength(version, level) == 0) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	arena = Arena_new(QRINPUT_ARENA_SIZE);
+	if(arena == NULL) return NULL;
+
+	input = QRinput_newInArena(arena, version, level);
+	if(input == NULL) {
+		Arena_free(arena);
+		return NULL;
+	}
+	input->mqr = mqr;
+
+	return input;
+}
+
 int QRinput_getVersion(QRinput *input)
 {
 	return input->version;
@@ -223,7 +267,7 @@ int QRinput_append(QRinput *input, QRencodeMode mode, int size, const unsigned c
 {
 	QRinput_List *entry;
 
-	entry = QRinput_List_newEntry(mode, size, data);
+	entry = QRinput_List_newEntry(input->arena, mode, size, data);
 	if(entry == NULL) {
 		return -1;
 	}
@@ -261,7 +305,7 @@ __STATIC int QRinput_insertStructuredAppendHeader(QRinput *input, int size, int
 	buf[0] = (unsigned char)size;
 	buf[1] = (unsigned char)index;
 	buf[2] = parity;
-	entry = QRinput_List_newEntry(QR_MODE_STRUCTURE, 3, buf);
+	entry = QRinput_List_newEntry(input->arena, QR_MODE_STRUCTURE, 3, buf);
 	if(entry == NULL) {
 		return -1;
 	}
@@ -295,6 +339,11 @@ void QRinput_free(QRinput *input)
 	QRinput_List *list, *next;
 
 	if(input != NULL) {
+		if(input->arena != NULL) {
+			/* the input, its entries and their data are blocks of the arena */
+			Arena_free(input->arena);
+			return;
+		}
 		list = input->head;
 		while(list != NULL) {
 			next = list->next;
@@ -409,10 +458,10 @@ int QRinput_estimateBitsModeNum(int size)
  */
 static int QRinput_encodeModeNum(QRinput_List *entry, int version, int mqr)
 {
-	int words, i, ret;
-	unsigned int val;
+	unsigned char packed[TEXTPACK_BYTES(TEXTPACK_NUMERIC_BITS(QRINPUT_PACK_DIGITS))];
+	int i, run, bits, ret;
 
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	if(mqr) {
@@ -430,24 +479,11 @@ static int QRinput_encodeModeNum(QRinput_List *entry, int version, int mqr)
 		if(ret < 0) goto ABORT;
 	}
 
-	words = entry->size / 3;
-	for(i=0; i<words; i++) {
-		val  = (entry->data[i*3  ] - '0') * 100;
-		val += (entry->data[i*3+1] - '0') * 10;
-		val += (entry->data[i*3+2] - '0');
-
-		ret = BitStream_appendNum(entry->bstream, 10, val);
-		if(ret < 0) goto ABORT;
-	}
-
-	if(entry->size - words * 3 == 1) {
-		val = entry->data[words*3] - '0';
-		ret = BitStream_appendNum(entry->bstream, 4, val);
-		if(ret < 0) goto ABORT;
-	} else if(entry->size - words * 3 == 2) {
-		val  = (entry->data[words*3  ] - '0') * 10;
-		val += (entry->data[words*3+1] - '0');
-		BitStream_appendNum(entry->bstream, 7, val);
+	for(i=0; i<entry->size; i+=run) {
+		run = entry->size - i;
+		if(run > QRINPUT_PACK_DIGITS) run = QRINPUT_PACK_DIGITS;
+		bits = TextPack_numeric(entry->data + i, run, packed);
+		ret = BitStream_appendBits(entry->bstream, bits, packed);
 		if(ret < 0) goto ABORT;
 	}
 
@@ -522,10 +558,10 @@ int QRinput_estimateBitsModeAn(int size)
  */
 static int QRinput_encodeModeAn(QRinput_List *entry, int version, int mqr)
 {
-	int words, i, ret;
-	unsigned int val;
+	unsigned char packed[TEXTPACK_BYTES(TEXTPACK_ALPHANUMERIC_BITS(QRINPUT_PACK_CHARS))];
+	int i, run, bits, ret;
 
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	if(mqr) {
@@ -544,19 +580,11 @@ static int QRinput_encodeModeAn(QRinput_List *entry, int version, int mqr)
 		if(ret < 0) goto ABORT;
 	}
 
-	words = entry->size / 2;
-	for(i=0; i<words; i++) {
-		val  = (unsigned int)QRinput_lookAnTable(entry->data[i*2  ]) * 45;
-		val += (unsigned int)QRinput_lookAnTable(entry->data[i*2+1]);
-
-		ret = BitStream_appendNum(entry->bstream, 11, val);
-		if(ret < 0) goto ABORT;
-	}
-
-	if(entry->size & 1) {
-		val = (unsigned int)QRinput_lookAnTable(entry->data[words * 2]);
-
-		ret = BitStream_appendNum(entry->bstream, 6, val);
+	for(i=0; i<entry->size; i+=run) {
+		run = entry->size - i;
+		if(run > QRINPUT_PACK_CHARS) run = QRINPUT_PACK_CHARS;
+		bits = TextPack_alphanumeric(entry->data + i, run, packed);
+		ret = BitStream_appendBits(entry->bstream, bits, packed);
 		if(ret < 0) goto ABORT;
 	}
 
@@ -594,7 +622,7 @@ static int QRinput_encodeMode8(QRinput_List *entry, int version, int mqr)
 {
 	int ret;
 
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	if(mqr) {
@@ -677,7 +705,7 @@ static int QRinput_encodeModeKanji(QRinput_List *entry, int version, int mqr)
 	int ret, i;
 	unsigned int val, h;
 
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	if(mqr) {
@@ -739,7 +767,7 @@ static int QRinput_encodeModeStructure(QRinput_List *entry, int mqr)
 		errno = EINVAL;
 		return -1;
 	}
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	ret = BitStream_appendNum(entry->bstream, 4, QRSPEC_MODEID_STRUCTURE);
@@ -762,18 +790,18 @@ ABORT:
  * FNC1
  *****************************************************************************/
 
-static int QRinput_checkModeFNC1Second(int size, const unsigned char *data)
+static int QRinput_checkModeFNC1Second(int size)
 {
 	if(size != 1) return -1;
 
 	return 0;
 }
 
-static int QRinput_encodeModeFNC1Second(QRinput_List *entry, int version)
+static int QRinput_encodeModeFNC1Second(QRinput_List *entry)
 {
 	int ret;
 
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	ret = BitStream_appendNum(entry->bstream, 4, QRSPEC_MODEID_FNC1SECOND);
@@ -822,12 +850,12 @@ int QRinput_estimateBitsModeECI(unsigned char *data)
 	}
 }
 
-static int QRinput_encodeModeECI(QRinput_List *entry, int version)
+static int QRinput_encodeModeECI(QRinput_List *entry)
 {
 	int ret, words;
 	unsigned int ecinum, code;
 
-	entry->bstream = BitStream_new();
+	entry->bstream = BitStream_newArena(entry->arena);
 	if(entry->bstream == NULL) return -1;
 
 	ecinum = QRinput_decodeECIfromByteArray(entry->data);;
@@ -881,7 +909,7 @@ int QRinput_check(QRencodeMode mode, int size, const unsigned char *data)
 		case QR_MODE_FNC1FIRST:
 			return 0;
 		case QR_MODE_FNC1SECOND:
-			return QRinput_checkModeFNC1Second(size, data);
+			return QRinput_checkModeFNC1Second(size);
 		case QR_MODE_NUL:
 			break;
 	}
@@ -1063,16 +1091,16 @@ static int QRinput_encodeBitStream(QRinput_List *entry, int version, int mqr)
 
 	words = QRspec_maximumWords(entry->mode, version);
 	if(words != 0 && entry->size > words) {
-		st1 = QRinput_List_newEntry(entry->mode, words, entry->data);
+		st1 = QRinput_List_newEntry(entry->arena, entry->mode, words, entry->data);
 		if(st1 == NULL) goto ABORT;
-		st2 = QRinput_List_newEntry(entry->mode, entry->size - words, &entry->data[words]);
+		st2 = QRinput_List_newEntry(entry->arena, entry->mode, entry->size - words, &entry->data[words]);
 		if(st2 == NULL) goto ABORT;
 
 		ret = QRinput_encodeBitStream(st1, version, mqr);
 		if(ret < 0) goto ABORT;
 		ret = QRinput_encodeBitStream(st2, version, mqr);
 		if(ret < 0) goto ABORT;
-		entry->bstream = BitStream_new();
+		entry->bstream = BitStream_newArena(entry->arena);
 		if(entry->bstream == NULL) goto ABORT;
 		ret = BitStream_append(entry->bstream, st1->bstream);
 		if(ret < 0) goto ABORT;
@@ -1099,10 +1127,10 @@ static int QRinput_encodeBitStream(QRinput_List *entry, int version, int mqr)
 				ret = QRinput_encodeModeStructure(entry, mqr);
 				break;
 			case QR_MODE_ECI:
-				ret = QRinput_encodeModeECI(entry, version);
+				ret = QRinput_encodeModeECI(entry);
 				break;
 			case QR_MODE_FNC1SECOND:
-				ret = QRinput_encodeModeFNC1Second(entry, version);
+				ret = QRinput_encodeModeFNC1Second(entry);
 			default:
 				break;
 		}
@@ -1192,7 +1220,6 @@ static int QRinput_appendPaddingBit(BitStream *bstream, QRinput *input)
 {
 	int bits, maxbits, words, maxwords, i, ret;
 	BitStream *padding = NULL;
-	unsigned char *padbuf;
 	int padlen;
 
 	bits = BitStream_size(bstream);
@@ -1214,25 +1241,16 @@ static int QRinput_appendPaddingBit(BitStream *bstream, QRinput *input)
 
 	words = (bits + 4 + 7) / 8;
 
-	padding = BitStream_new();
+	padding = BitStream_newArena(input->arena);
 	if(padding == NULL) return -1;
 	ret = BitStream_appendNum(padding, words * 8 - bits, 0);
 	if(ret < 0) goto DONE;
 
 	padlen = maxwords - words;
 	if(padlen > 0) {
-		padbuf = (unsigned char *)malloc(padlen);
-		if(padbuf == NULL) {
-			ret = -1;
-			goto DONE;
-		}
 		for(i=0; i<padlen; i++) {
-			padbuf[i] = (i&1)?0x11:0xec;
-		}
-		ret = BitStream_appendBytes(padding, padlen, padbuf);
-		free(padbuf);
-		if(ret < 0) {
-			goto DONE;
+			ret = BitStream_appendNum(padding, 8, (i&1)?0x11:0xec);
+			if(ret < 0) goto DONE;
 		}
 	}
 
@@ -1257,7 +1275,6 @@ static int QRinput_appendPaddingBitMQR(BitStream *bstream, QRinput *input)
 {
 	int bits, maxbits, words, maxwords, i, ret, termbits;
 	BitStream *padding = NULL;
-	unsigned char *padbuf;
 	int padlen;
 
 	bits = BitStream_size(bstream);
@@ -1288,25 +1305,16 @@ static int QRinput_appendPaddingBitMQR(BitStream *bstream, QRinput *input)
 	} else {
 		termbits += words * 8 - bits;
 	}
-	padding = BitStream_new();
+	padding = BitStream_newArena(input->arena);
 	if(padding == NULL) return -1;
 	ret = BitStream_appendNum(padding, termbits, 0);
 	if(ret < 0) goto DONE;
 
 	padlen = maxwords - words;
 	if(padlen > 0) {
-		padbuf = (unsigned char *)malloc(padlen);
-		if(padbuf == NULL) {
-			ret = -1;
-			goto DONE;
-		}
 		for(i=0; i<padlen; i++) {
-			padbuf[i] = (i&1)?0x11:0xec;
-		}
-		ret = BitStream_appendBytes(padding, padlen, padbuf);
-		free(padbuf);
-		if(ret < 0) {
-			goto DONE;
+			ret = BitStream_appendNum(padding, 8, (i&1)?0x11:0xec);
+			if(ret < 0) goto DONE;
 		}
 		termbits = maxbits - maxwords * 8;
 		if(termbits > 0) {
@@ -1327,9 +1335,9 @@ static int QRinput_insertFNC1Header(QRinput *input)
 	QRinput_List *entry = NULL;
 
 	if(input->fnc1 == 1) {
-		entry = QRinput_List_newEntry(QR_MODE_FNC1FIRST, 0, NULL);
+		entry = QRinput_List_newEntry(input->arena, QR_MODE_FNC1FIRST, 0, NULL);
 	} else if(input->fnc1 == 2) {
-		entry = QRinput_List_newEntry(QR_MODE_FNC1SECOND, 1, &(input->appid));
+		entry = QRinput_List_newEntry(input->arena, QR_MODE_FNC1SECOND, 1, &(input->appid));
 	}
 	if(entry == NULL) {
 		return -1;
@@ -1373,7 +1381,7 @@ __STATIC BitStream *QRinput_mergeBitStream(QRinput *input)
 		}
 	}
 
-	bstream = BitStream_new();
+	bstream = BitStream_newArena(input->arena);
 	if(bstream == NULL) return NULL;
 
 	list = input->head;
@@ -1542,11 +1550,11 @@ static int QRinput_List_shrinkEntry(QRinput_List *entry, int bytes)
 {
 	unsigned char *data;
 
-	data = (unsigned char *)malloc(bytes);
+	data = (unsigned char *)Arena_alloc(entry->arena, bytes);
 	if(data == NULL) return -1;
 
 	memcpy(data, entry->data, bytes);
-	free(entry->data);
+	Arena_release(entry->arena, entry->data);
 	entry->data = data;
 	entry->size = bytes;
 
@@ -1558,7 +1566,7 @@ __STATIC int QRinput_splitEntry(QRinput_List *entry, int bytes)
 	QRinput_List *e;
 	int ret;
 
-	e = QRinput_List_newEntry(entry->mode, entry->size - bytes, entry->data + bytes);
+	e = QRinput_List_newEntry(entry->arena, entry->mode, entry->size - bytes, entry->data + bytes);
 	if(e == NULL) {
 		return -1;
 	}
@@ -37,6 +37,7 @@ struct _QRinput_List {
 	int size;				///< Size of data chunk (byte).
 	unsigned char *data;	///< Data chunk.
 	BitStream *bstream;
+	Arena *arena;			///< arena of the entry, its data and bit stream, or NULL.
 	QRinput_List *next;
 };
 
@@ -51,6 +52,7 @@ struct _QRinput {
 	int mqr;
 	int fnc1;
 	unsigned char appid;
+	Arena *arena;			///< arena of the input and its entries, or NULL.
 };
 
 /******************************************************************************
@@ -73,7 +75,8 @@ struct _QRinput_Struct {
 /**
  * Pack all bit streams padding bits into a byte array.
  * @param input input data.
- * @return padded merged byte stream
+ * @return padded merged byte stream, from the arena of the input if it has
+ *         one (freed with the input), from malloc() otherwise.
  */
 extern unsigned char *QRinput_getByteStream(QRinput *input);
 
@@ -83,6 +86,10 @@ extern int QRinput_estimateBitsModeAn(int size);
 extern int QRinput_estimateBitsMode8(int size);
 extern int QRinput_estimateBitsModeKanji(int size);
 
+/**
+ * Copy the input data. The copy never has an arena, its entries can be
+ * moved to other inputs (QRinput_splitQRinputToStruct() does).
+ */
 extern QRinput *QRinput_dup(QRinput *input);
 
 extern const signed char QRinput_anTable[128];
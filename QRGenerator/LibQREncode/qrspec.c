@@ -32,11 +32,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
-#ifdef HAVE_LIBPTHREAD
-#include <pthread.h>
-#endif
 
 #include "qrspec.h"
+#include "atomicptr.h"
 #include "qrinput.h"
 
 /******************************************************************************
@@ -395,14 +393,11 @@ unsigned int QRspec_getFormatInfo(int mask, QRecLevel level)
  *****************************************************************************/
 
 /**
- * Cache of initial frames.
+ * Cache of initial frames, published once per version (see atomicptr.h).
  */
 /* C99 says that static storage shall be initialized to a null pointer
  * by compiler. */
 static unsigned char *frames[QRSPEC_VERSION_MAX + 1];
-#ifdef HAVE_LIBPTHREAD
-static pthread_mutex_t frames_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif
 
 /**
  * Put a finder pattern.
@@ -521,42 +516,38 @@ static unsigned char *QRspec_createFrame(int version)
 
 unsigned char *QRspec_newFrame(int version)
 {
-	unsigned char *frame;
+	unsigned char *frame, *cached;
 	int width;
 
 	if(version < 1 || version > QRSPEC_VERSION_MAX) return NULL;
 
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_lock(&frames_mutex);
-#endif
-	if(frames[version] == NULL) {
-		frames[version] = QRspec_createFrame(version);
+	cached = (unsigned char *)ATOMICPTR_LOAD(&frames[version]);
+	if(cached == NULL) {
+		frame = QRspec_createFrame(version);
+		if(frame == NULL) return NULL;
+		if(ATOMICPTR_CAS(&frames[version], NULL, frame)) {
+			cached = frame;
+		} else {
+			/* another thread published it first */
+			free(frame);
+			cached = (unsigned char *)ATOMICPTR_LOAD(&frames[version]);
+		}
 	}
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_unlock(&frames_mutex);
-#endif
-	if(frames[version] == NULL) return NULL;
 
 	width = qrspecCapacity[version].width;
 	frame = (unsigned char *)malloc(width * width);
 	if(frame == NULL) return NULL;
-	memcpy(frame, frames[version], width * width);
+	memcpy(frame, cached, width * width);
 
 	return frame;
 }
 
+/* Not to be called while other threads encode, they may still copy a frame. */
 void QRspec_clearCache(void)
 {
 	int i;
 
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_lock(&frames_mutex);
-#endif
 	for(i=1; i<=QRSPEC_VERSION_MAX; i++) {
-		free(frames[i]);
-		frames[i] = NULL;
+		free(ATOMICPTR_EXCHANGE(&frames[i], NULL));
 	}
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_unlock(&frames_mutex);
-#endif
 }
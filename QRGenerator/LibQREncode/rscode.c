@@ -29,11 +29,9 @@
 #endif
 #include <stdlib.h>
 #include <string.h>
-#ifdef HAVE_LIBPTHREAD
-#  include <pthread.h>
-#endif
 
 #include "rscode.h"
+#include "atomicptr.h"
 
 /* Stuff specific to the 8-bit symbol version of the general purpose RS codecs
  *
@@ -59,10 +57,15 @@ struct _RS {
 	struct _RS *next;
 };
 
-static RS *rslist = NULL;
-#ifdef HAVE_LIBPTHREAD
-static pthread_mutex_t rslist_mutex = PTHREAD_MUTEX_INITIALIZER;
-#endif
+/**
+ * Cache of control blocks: lists hashed by nroots and pad, which set the
+ * block apart in QR Code (the other parameters never change). A block is
+ * pushed at the head of its list with a CAS and is never changed
+ * afterwards, so lookups need no lock (see atomicptr.h).
+ */
+#define RS_BUCKETS (256)
+#define RS_BUCKET(nroots, pad) ((((nroots) * 31) + (pad)) & (RS_BUCKETS - 1))
+static RS *rslist[RS_BUCKETS];
 
 int modnn(RS *rs, int x){
 	while (x >= rs->nn) {
@@ -209,14 +212,9 @@ static RS *init_rs_char(int symsize, int gfpoly, int fcr, int prim, int nroots,
   return rs;
 }
 
-RS *init_rs(int symsize, int gfpoly, int fcr, int prim, int nroots, int pad)
+static RS *init_rs_find(RS *rs, int symsize, int gfpoly, int fcr, int prim, int nroots, int pad)
 {
-	RS *rs;
-
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_lock(&rslist_mutex);
-#endif
-	for(rs = rslist; rs != NULL; rs = rs->next) {
+	for(; rs != NULL; rs = rs->next) {
 		if(rs->pad != pad) continue;
 		if(rs->nroots != nroots) continue;
 		if(rs->mm != symsize) continue;
@@ -224,21 +222,38 @@ RS *init_rs(int symsize, int gfpoly, int fcr, int prim, int nroots, int pad)
 		if(rs->fcr != fcr) continue;
 		if(rs->prim != prim) continue;
 
-		goto DONE;
+		return rs;
 	}
 
-	rs = init_rs_char(symsize, gfpoly, fcr, prim, nroots, pad);
-	if(rs == NULL) goto DONE;
-	rs->next = rslist;
-	rslist = rs;
-
-DONE:
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_unlock(&rslist_mutex);
-#endif
-	return rs;
+	return NULL;
 }
 
+RS *init_rs(int symsize, int gfpoly, int fcr, int prim, int nroots, int pad)
+{
+	RS *rs, *head, *found;
+	RS **bucket;
+
+	bucket = &rslist[RS_BUCKET(nroots, pad)];
+	head = (RS *)ATOMICPTR_LOAD(bucket);
+	rs = init_rs_find(head, symsize, gfpoly, fcr, prim, nroots, pad);
+	if(rs != NULL) return rs;
+
+	rs = init_rs_char(symsize, gfpoly, fcr, prim, nroots, pad);
+	if(rs == NULL) return NULL;
+
+	for(;;) {
+		rs->next = head;
+		if(ATOMICPTR_CAS(bucket, head, rs)) return rs;
+
+		/* the list changed, maybe with the same block */
+		head = (RS *)ATOMICPTR_LOAD(bucket);
+		found = init_rs_find(head, symsize, gfpoly, fcr, prim, nroots, pad);
+		if(found != NULL) {
+			free_rs_char(rs);
+			return found;
+		}
+	}
+}
 
 void free_rs_char(RS *rs)
 {
@@ -248,23 +263,20 @@ void free_rs_char(RS *rs)
 	free(rs);
 }
 
+/* Not to be called while other threads encode, they may still use a block. */
 void free_rs_cache(void)
 {
 	RS *rs, *next;
-
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_lock(&rslist_mutex);
-#endif
-	rs = rslist;
-	while(rs != NULL) {
-		next = rs->next;
-		free_rs_char(rs);
-		rs = next;
+	int i;
+
+	for(i=0; i<RS_BUCKETS; i++) {
+		rs = (RS *)ATOMICPTR_EXCHANGE(&rslist[i], NULL);
+		while(rs != NULL) {
+			next = rs->next;
+			free_rs_char(rs);
+			rs = next;
+		}
 	}
-	rslist = NULL;
-#ifdef HAVE_LIBPTHREAD
-	pthread_mutex_unlock(&rslist_mutex);
-#endif
 }
 
 /* The guts of the Reed-Solomon encoder, meant to be #included
@@ -31,10 +31,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include "qrencode.h"
 #include "qrinput.h"
 #include "qrspec.h"
+#include "mqrspec.h"
 #include "split.h"
+#include "charclass.h"
 
 #define isdigit(__c__) ((unsigned char)((signed char)(__c__) - '0') < 10)
 #define isalnum(__c__) (QRinput_lookAnTable(__c__) >= 0)
@@ -75,14 +78,57 @@ static QRencodeMode Split_identifyMode(const char *string, QRencodeMode hint)
 	return QR_MODE_8;
 }
 
-static int Split_eatNum(const char *string, QRinput *input, QRencodeMode hint);
-static int Split_eatAn(const char *string, QRinput *input, QRencodeMode hint);
-static int Split_eat8(const char *string, QRinput *input, QRencodeMode hint);
-static int Split_eatKanji(const char *string, QRinput *input, QRencodeMode hint);
+/* The string being split and the class masks of its bytes (charclass.h):
+ * the runs of digits and alphanumeric characters end where their mask
+ * does, found a word of 32 bytes at a time. */
+typedef struct {
+	const char *string;
+	int length;
+	QRencodeMode hint;
+	CharClassMasks *masks;
+} SplitString;
+
+static int Split_initString(SplitString *s, const char *string, QRencodeMode hint)
+{
+	s->string = string;
+	s->length = strlen(string);
+	s->hint = hint;
+	s->masks = CharClass_new((const unsigned char *)string, s->length);
+	if(s->masks == NULL) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Split_identifyMode() of the character at byte i. */
+static QRencodeMode Split_identifyModeAt(const SplitString *s, int i)
+{
+	unsigned int word;
+
+	if(i >= s->length) return QR_MODE_NUL;
+	if(CharClass_test(s->masks->num, i)) {
+		return QR_MODE_NUM;
+	} else if(CharClass_test(s->masks->an, i)) {
+		return QR_MODE_AN;
+	} else if(s->hint == QR_MODE_KANJI && CharClass_test(s->masks->kanji, i) && i + 1 < s->length) {
+		word = ((unsigned int)(unsigned char)s->string[i] << 8) | (unsigned char)s->string[i + 1];
+		if((word >= 0x8140 && word <= 0x9ffc) || (word >= 0xe040 && word <= 0xebbf)) {
+			return QR_MODE_KANJI;
+		}
+	}
 
-static int Split_eatNum(const char *string, QRinput *input,QRencodeMode hint)
+	return QR_MODE_8;
+}
+
+static int Split_eatNum(const SplitString *s, int from, QRinput *input);
+static int Split_eatAn(const SplitString *s, int from, QRinput *input);
+static int Split_eat8(const SplitString *s, int from, QRinput *input);
+static int Split_eatKanji(const SplitString *s, int from, QRinput *input);
+
+static int Split_eatNum(const SplitString *s, int from, QRinput *input)
 {
-	const char *p;
 	int ret;
 	int run;
 	int dif;
@@ -91,18 +137,14 @@ static int Split_eatNum(const char *string, QRinput *input,QRencodeMode hint)
 
 	ln = QRspec_lengthIndicator(QR_MODE_NUM, input->version);
 
-	p = string;
-	while(isdigit(*p)) {
-		p++;
-	}
-	run = p - string;
-	mode = Split_identifyMode(p, hint);
+	run = CharClass_span(s->masks->num, from, s->length) - from;
+	mode = Split_identifyModeAt(s, from + run);
 	if(mode == QR_MODE_8) {
 		dif = QRinput_estimateBitsModeNum(run) + 4 + ln
 			+ QRinput_estimateBitsMode8(1) /* + 4 + l8 */
 			- QRinput_estimateBitsMode8(run + 1) /* - 4 - l8 */;
 		if(dif > 0) {
-			return Split_eat8(string, input, hint);
+			return Split_eat8(s, from, input);
 		}
 	}
 	if(mode == QR_MODE_AN) {
@@ -110,19 +152,19 @@ static int Split_eatNum(const char *string, QRinput *input,QRencodeMode hint)
 			+ QRinput_estimateBitsModeAn(1) /* + 4 + la */
 			- QRinput_estimateBitsModeAn(run + 1) /* - 4 - la */;
 		if(dif > 0) {
-			return Split_eatAn(string, input, hint);
+			return Split_eatAn(s, from, input);
 		}
 	}
 
-	ret = QRinput_append(input, QR_MODE_NUM, run, (unsigned char *)string);
+	ret = QRinput_append(input, QR_MODE_NUM, run, (unsigned char *)s->string + from);
 	if(ret < 0) return -1;
 
 	return run;
 }
 
-static int Split_eatAn(const char *string, QRinput *input, QRencodeMode hint)
+static int Split_eatAn(const SplitString *s, int from, QRinput *input)
 {
-	const char *p, *q;
+	int p, q, end;
 	int ret;
 	int run;
 	int dif;
@@ -131,63 +173,58 @@ static int Split_eatAn(const char *string, QRinput *input, QRencodeMode hint)
 	la = QRspec_lengthIndicator(QR_MODE_AN, input->version);
 	ln = QRspec_lengthIndicator(QR_MODE_NUM, input->version);
 
-	p = string;
-	while(isalnum(*p)) {
-		if(isdigit(*p)) {
-			q = p;
-			while(isdigit(*q)) {
-				q++;
-			}
-			dif = QRinput_estimateBitsModeAn(p - string) /* + 4 + la */
-				+ QRinput_estimateBitsModeNum(q - p) + 4 + ln
-				- QRinput_estimateBitsModeAn(q - string) /* - 4 - la */;
-			if(dif < 0) {
-				break;
-			} else {
-				p = q;
-			}
-		} else {
-			p++;
+	/* the run of digits inside the alphanumeric run that is worth a
+	 * segment of its own ends this one */
+	end = CharClass_span(s->masks->an, from, s->length);
+	p = CharClass_find(s->masks->num, from, end);
+	while(p < end) {
+		q = CharClass_span(s->masks->num, p, s->length);
+		dif = QRinput_estimateBitsModeAn(p - from) /* + 4 + la */
+			+ QRinput_estimateBitsModeNum(q - p) + 4 + ln
+			- QRinput_estimateBitsModeAn(q - from) /* - 4 - la */;
+		if(dif < 0) {
+			break;
 		}
+		p = CharClass_find(s->masks->num, q, end);
 	}
 
-	run = p - string;
+	run = p - from;
 
-	if(*p && !isalnum(*p)) {
+	if(p < s->length && !CharClass_test(s->masks->an, p)) {
 		dif = QRinput_estimateBitsModeAn(run) + 4 + la
 			+ QRinput_estimateBitsMode8(1) /* + 4 + l8 */
 			- QRinput_estimateBitsMode8(run + 1) /* - 4 - l8 */;
 		if(dif > 0) {
-			return Split_eat8(string, input, hint);
+			return Split_eat8(s, from, input);
 		}
 	}
 
-	ret = QRinput_append(input, QR_MODE_AN, run, (unsigned char *)string);
+	ret = QRinput_append(input, QR_MODE_AN, run, (unsigned char *)s->string + from);
 	if(ret < 0) return -1;
 
 	return run;
 }
 
-static int Split_eatKanji(const char *string, QRinput *input, QRencodeMode hint)
+static int Split_eatKanji(const SplitString *s, int from, QRinput *input)
 {
-	const char *p;
+	int p;
 	int ret;
 	int run;
 
-	p = string;
-	while(Split_identifyMode(p, hint) == QR_MODE_KANJI) {
+	p = from;
+	while(Split_identifyModeAt(s, p) == QR_MODE_KANJI) {
 		p += 2;
 	}
-	run = p - string;
-	ret = QRinput_append(input, QR_MODE_KANJI, run, (unsigned char *)string);
+	run = p - from;
+	ret = QRinput_append(input, QR_MODE_KANJI, run, (unsigned char *)s->string + from);
 	if(ret < 0) return -1;
 
 	return run;
 }
 
-static int Split_eat8(const char *string, QRinput *input, QRencodeMode hint)
+static int Split_eat8(const SplitString *s, int from, QRinput *input)
 {
-	const char *p, *q;
+	int p, q, next;
 	QRencodeMode mode;
 	int ret;
 	int run;
@@ -197,71 +234,70 @@ static int Split_eat8(const char *string, QRinput *input, QRencodeMode hint)
 	la = QRspec_lengthIndicator(QR_MODE_AN, input->version);
 	ln = QRspec_lengthIndicator(QR_MODE_NUM, input->version);
 
-	p = string + 1;
-	while(*p != '\0') {
-		mode = Split_identifyMode(p, hint);
+	p = from + 1;
+	while(p < s->length) {
+		mode = Split_identifyModeAt(s, p);
 		if(mode == QR_MODE_KANJI) {
 			break;
 		}
 		if(mode == QR_MODE_NUM) {
-			q = p;
-			while(isdigit(*q)) {
-				q++;
-			}
-			dif = QRinput_estimateBitsMode8(p - string) /* + 4 + l8 */
+			q = CharClass_span(s->masks->num, p, s->length);
+			dif = QRinput_estimateBitsMode8(p - from) /* + 4 + l8 */
 				+ QRinput_estimateBitsModeNum(q - p) + 4 + ln
-				- QRinput_estimateBitsMode8(q - string) /* - 4 - l8 */;
+				- QRinput_estimateBitsMode8(q - from) /* - 4 - l8 */;
 			if(dif < 0) {
 				break;
 			} else {
 				p = q;
 			}
 		} else if(mode == QR_MODE_AN) {
-			q = p;
-			while(isalnum(*q)) {
-				q++;
-			}
-			dif = QRinput_estimateBitsMode8(p - string) /* + 4 + l8 */
+			q = CharClass_span(s->masks->an, p, s->length);
+			dif = QRinput_estimateBitsMode8(p - from) /* + 4 + l8 */
 				+ QRinput_estimateBitsModeAn(q - p) + 4 + la
-				- QRinput_estimateBitsMode8(q - string) /* - 4 - l8 */;
+				- QRinput_estimateBitsMode8(q - from) /* - 4 - l8 */;
 			if(dif < 0) {
 				break;
 			} else {
 				p = q;
 			}
 		} else {
-			p++;
+			/* skip to the next character that can end the run */
+			next = CharClass_find(s->masks->an, p + 1, s->length);
+			if(s->hint == QR_MODE_KANJI) {
+				q = CharClass_find(s->masks->kanji, p + 1, next);
+				if(q < next) next = q;
+			}
+			p = next;
 		}
 	}
 
-	run = p - string;
-	ret = QRinput_append(input, QR_MODE_8, run, (unsigned char *)string);
+	run = p - from;
+	ret = QRinput_append(input, QR_MODE_8, run, (unsigned char *)s->string + from);
 	if(ret < 0) return -1;
 
 	return run;
 }
 
-static int Split_splitString(const char *string, QRinput *input,
-		QRencodeMode hint)
+static int Split_splitString(const SplitString *s, int from, QRinput *input)
 {
 	int length;
 	QRencodeMode mode;
 
-	if(*string == '\0') return 0;
+	if(from >= s->length) return 0;
 
-	mode = Split_identifyMode(string, hint);
+	mode = Split_identifyModeAt(s, from);
 	if(mode == QR_MODE_NUM) {
-		length = Split_eatNum(string, input, hint);
+		length = Split_eatNum(s, from, input);
 	} else if(mode == QR_MODE_AN) {
-		length = Split_eatAn(string, input, hint);
-	} else if(mode == QR_MODE_KANJI && hint == QR_MODE_KANJI) {
-		length = Split_eatKanji(string, input, hint);
+		length = Split_eatAn(s, from, input);
+	} else if(mode == QR_MODE_KANJI && s->hint == QR_MODE_KANJI) {
+		length = Split_eatKanji(s, from, input);
 	} else {
-		length = Split_eat8(string, input, hint);
+		length = Split_eat8(s, from, input);
 	}
 	if(length == 0) return 0;
 	if(length < 0) return -1;
-	return Split_splitString(&string[length], input, hint);
+	return Split_splitString(s, from + length, input);
 }
 
 static char *dupAndToUpper(const char *str, QRencodeMode hint)
@@ -269,7 +305,7 @@ static char *dupAndToUpper(const char *str, QRencodeMode hint)
 	char *newstr, *p;
 	QRencodeMode mode;
 
-	newstr = _strdup(str);
+	newstr = strdup(str);
 	if(newstr == NULL) return NULL;
 
 	p = newstr;
@@ -288,10 +324,257 @@ static char *dupAndToUpper(const char *str, QRencodeMode hint)
 	return newstr;
 }
 
-int Split_splitStringToQRinput(const char *string, QRinput *input,
-		QRencodeMode hint, int casesensitive)
+/******************************************************************************
+ * Optimal split
+ *****************************************************************************/
+
+/* The costs are counted in sixths of a bit: a digit is 10/3 bits, an
+ * alphanumeric character 11/2 bits, so every character costs a whole number
+ * of sixths. A segment costs its header plus its characters rounded up to
+ * whole bits, which is exactly what QRinput_estimateBitsMode*() give. */
+#define SPLIT_SIXTHS(__bits__) ((__bits__) * 6)
+#define SPLIT_CEIL(__cost__) (((__cost__) + 5) / 6 * 6)
+#define SPLIT_INFINITY (INT_MAX / 2)
+
+/* Modes the splitter chooses from, QR_MODE_NUM to QR_MODE_KANJI. */
+#define SPLIT_MODES 4
+
+/* Character classes. */
+#define SPLIT_NUM   1
+#define SPLIT_AN    2
+#define SPLIT_KANJI 4
+
+static const int Split_charCost[SPLIT_MODES] = {
+	20,	/* numeric, 10/3 bits */
+	33,	/* alphanumeric, 11/2 bits */
+	48,	/* 8 bit, per byte */
+	78	/* kanji, 13 bits */
+};
+
+/**
+ * Character classes of the string, one per character: a Shift-JIS kanji
+ * (with the hint) takes two bytes, every other character one.
+ * @return number of characters.
+ */
+static int Split_classify(const SplitString *s, unsigned char *classes)
+{
+	int p = 0, n = 0;
+
+	while(p < s->length) {
+		switch(Split_identifyModeAt(s, p)) {
+			case QR_MODE_NUM:
+				classes[n] = SPLIT_NUM | SPLIT_AN;
+				p++;
+				break;
+			case QR_MODE_AN:
+				classes[n] = SPLIT_AN;
+				p++;
+				break;
+			case QR_MODE_KANJI:
+				classes[n] = SPLIT_KANJI;
+				p += 2;
+				break;
+			default:
+				classes[n] = 0;
+				p++;
+				break;
+		}
+		n++;
+	}
+
+	return n;
+}
+
+static int Split_charCostOf(int mode, int klass)
+{
+	switch(mode) {
+		case QR_MODE_NUM:
+			return (klass & SPLIT_NUM) ? Split_charCost[mode] : -1;
+		case QR_MODE_AN:
+			return (klass & SPLIT_AN) ? Split_charCost[mode] : -1;
+		case QR_MODE_8:
+			return (klass & SPLIT_KANJI) ? Split_charCost[mode] * 2 : Split_charCost[mode];
+		default:
+			return (klass & SPLIT_KANJI) ? Split_charCost[mode] : -1;
+	}
+}
+
+/**
+ * Choose the mode of every character so that the bit stream is the
+ * shortest, in one pass over the characters: cost[m] is the cheapest
+ * encoding of the characters so far whose last segment is in mode m, and
+ * from[] records the mode of the previous character on that path.
+ * @param header bits of the mode indicator and the character count
+ *               indicator of every mode, 0 for a mode the symbol lacks.
+ * @param modes receives the mode of every character.
+ * @return bits of the data, or -1 if a character fits no mode.
+ */
+static int Split_chooseModes(int n, const unsigned char *classes, const int header[SPLIT_MODES],
+		unsigned char *from, unsigned char *modes)
+{
+	int cost[SPLIT_MODES], next[SPLIT_MODES];
+	int i, m, p, c, best, bestMode, charCost;
+
+	for(m=0; m<SPLIT_MODES; m++) {
+		charCost = Split_charCostOf(m, classes[0]);
+		if(header[m] == 0 || charCost < 0) {
+			cost[m] = SPLIT_INFINITY;
+		} else {
+			cost[m] = SPLIT_SIXTHS(header[m]) + charCost;
+		}
+		from[m] = (unsigned char)m;
+	}
+
+	for(i=1; i<n; i++) {
+		for(m=0; m<SPLIT_MODES; m++) {
+			next[m] = SPLIT_INFINITY;
+			charCost = Split_charCostOf(m, classes[i]);
+			if(header[m] == 0 || charCost < 0) continue;
+			for(p=0; p<SPLIT_MODES; p++) {
+				if(cost[p] >= SPLIT_INFINITY) continue;
+				if(p == m) {
+					c = cost[p];
+				} else {
+					/* the segment of p ends on a whole bit */
+					c = SPLIT_CEIL(cost[p]) + SPLIT_SIXTHS(header[m]);
+				}
+				if(c + charCost < next[m]) {
+					next[m] = c + charCost;
+					from[i * SPLIT_MODES + m] = (unsigned char)p;
+				}
+			}
+		}
+		memcpy(cost, next, sizeof(cost));
+	}
+
+	best = SPLIT_INFINITY;
+	bestMode = -1;
+	for(m=0; m<SPLIT_MODES; m++) {
+		if(cost[m] < SPLIT_INFINITY && SPLIT_CEIL(cost[m]) < best) {
+			best = SPLIT_CEIL(cost[m]);
+			bestMode = m;
+		}
+	}
+	if(bestMode < 0) return -1;
+
+	m = bestMode;
+	for(i=n-1; i>=0; i--) {
+		modes[i] = (unsigned char)m;
+		m = from[i * SPLIT_MODES + m];
+	}
+
+	return best / 6;
+}
+
+static void Split_setHeaders(int version, int mqr, int header[SPLIT_MODES])
+{
+	int m, l;
+
+	for(m=0; m<SPLIT_MODES; m++) {
+		if(mqr) {
+			l = MQRspec_lengthIndicator((QRencodeMode)m, version);
+			header[m] = (l == 0) ? 0 : version - 1 + l;
+		} else {
+			header[m] = 4 + QRspec_lengthIndicator((QRencodeMode)m, version);
+		}
+	}
+}
+
+static int Split_appendModes(const char *string, int n, const unsigned char *classes,
+		const unsigned char *modes, QRinput *input)
 {
-	char *newstr;
+	const char *start, *p;
+	int i;
+
+	start = p = string;
+	for(i=0; i<n; i++) {
+		p += (classes[i] & SPLIT_KANJI) ? 2 : 1;
+		if(i == n - 1 || modes[i + 1] != modes[i]) {
+			if(QRinput_append(input, (QRencodeMode)modes[i], p - start, (const unsigned char *)start) < 0) {
+				return -1;
+			}
+			start = p;
+		}
+	}
+
+	return 0;
+}
+
+static int Split_splitStringOptimal(const SplitString *s, QRinput *input)
+{
+	/* the three widths of the character count indicators */
+	static const int classFirst[3] = { 1, 10, 27 };
+	static const int classLast[3] = { 9, 26, 40 };
+	unsigned char *buffer, *classes, *from, *modes, *bestModes, *swap;
+	int header[SPLIT_MODES];
+	int n, length, c, bits, version, bestVersion, ret;
+
+	length = s->length;
+	buffer = (unsigned char *)malloc(length * (3 + SPLIT_MODES));
+	if(buffer == NULL) return -1;
+	classes = buffer;
+	modes = buffer + length;
+	bestModes = buffer + length * 2;
+	from = buffer + length * 3;
+
+	n = Split_classify(s, classes);
+
+	if(input->mqr) {
+		Split_setHeaders(input->version, 1, header);
+		bits = Split_chooseModes(n, classes, header, from, bestModes);
+		bestVersion = input->version;
+	} else {
+		/* The same split is the best for every version of a class; the
+		 * smallest version wins, the last class if nothing fits. */
+		bits = -1;
+		bestVersion = 0;
+		for(c=0; c<3; c++) {
+			if(classLast[c] < input->version) continue;
+			Split_setHeaders(classLast[c], 0, header);
+			bits = Split_chooseModes(n, classes, header, from, modes);
+			if(bits < 0) break;
+			version = QRspec_getMinimumVersion((bits + 7) / 8, input->level);
+			if(version < 0) {
+				/* beyond version 40, and the later classes only have
+				 * longer character count indicators */
+				free(buffer);
+				errno = ERANGE;
+				return -1;
+			}
+			if(version < classFirst[c]) version = classFirst[c];
+			if(version < input->version) version = input->version;
+			swap = bestModes; bestModes = modes; modes = swap;
+			if(version <= classLast[c]) {
+				bestVersion = version;
+				break;
+			}
+		}
+	}
+
+	if(bits < 0) {
+		free(buffer);
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = Split_appendModes(s->string, n, classes, bestModes, input);
+	if(ret == 0 && bestVersion > input->version) {
+		QRinput_setVersion(input, bestVersion);
+	}
+	free(buffer);
+
+	return ret;
+}
+
+/******************************************************************************
+ * Entry points
+ *****************************************************************************/
+
+static int Split_splitStringWith(const char *string, QRinput *input,
+		QRencodeMode hint, int casesensitive, int optimal)
+{
+	SplitString s;
+	char *newstr = NULL;
 	int ret;
 
 	if(string == NULL || *string == '\0') {
@@ -301,11 +584,31 @@ int Split_splitStringToQRinput(const char *string, QRinput *input,
 	if(!casesensitive) {
 		newstr = dupAndToUpper(string, hint);
 		if(newstr == NULL) return -1;
-		ret = Split_splitString(newstr, input, hint);
-		free(newstr);
-	} else {
-		ret = Split_splitString(string, input, hint);
+		string = newstr;
 	}
 
+	ret = Split_initString(&s, string, hint);
+	if(ret == 0) {
+		if(optimal) {
+			ret = Split_splitStringOptimal(&s, input);
+		} else {
+			ret = Split_splitString(&s, 0, input);
+		}
+		CharClass_free(s.masks);
+	}
+	free(newstr);
+
 	return ret;
 }
+
+int Split_splitStringToQRinput(const char *string, QRinput *input,
+		QRencodeMode hint, int casesensitive)
+{
+	return Split_splitStringWith(string, input, hint, casesensitive, 0);
+}
+
+int Split_splitStringToQRinputOptimal(const char *string, QRinput *input,
+		QRencodeMode hint, int casesensitive)
+{
+	return Split_splitStringWith(string, input, hint, casesensitive, 1);
+}
@@ -44,4 +44,28 @@
 extern int Split_splitStringToQRinput(const char *string, QRinput *input,
 		QRencodeMode hint, int casesensitive);
 
+/**
+ * Split the input string (null terminated) into QRinput with the shortest
+ * bit stream, instead of the local decisions of
+ * Split_splitStringToQRinput(). A dynamic programming pass over the
+ * characters finds the best modes for the width of the character count
+ * indicators of versions 1-9, 10-26 and 27-40 in turn, and the first that
+ * fits its range is taken. The version of the input is raised to the
+ * smallest one the split fits (Micro QR Code inputs keep theirs); it is a
+ * lower bound, QRcode_encodeInput() raises it further for runs longer
+ * than a character count indicator holds.
+ * @param string input string
+ * @param hint give QR_MODE_KANJI if the input string contains Kanji character encoded in Shift-JIS. If not, give QR_MODE_8.
+ * @param casesensitive 0 for case-insensitive encoding (all alphabet characters are replaced to UPPER-CASE CHARACTERS.
+ * @retval 0 success.
+ * @retval -1 an error occurred. errno is set to indicate the error. See
+ *               Exceptions for the details.
+ * @throw EINVAL invalid input object, or a character the Micro QR Code
+ *               version can't encode.
+ * @throw ENOMEM unable to allocate memory for input objects.
+ * @throw ERANGE the shortest bit stream doesn't fit in version 40.
+ */
+extern int Split_splitStringToQRinputOptimal(const char *string, QRinput *input,
+		QRencodeMode hint, int casesensitive);
+
 #endif /* __SPLIT_H__ */
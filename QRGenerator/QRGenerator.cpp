@@ -53,8 +53,8 @@ int _tmain(int argc, _TCHAR* argv[])
 {
 char            *szSourceSring = QRCODE_TEXT;
 unsigned int    unWidth, x, y, l, n;
-unsigned char   *pSourceData;
-QRcode*         pQRC;
+const unsigned char *pRow;
+QRbitmap*       pQRB;
 
 /*
  * Create a symbol from the string. The library automatically parses the input
@@ -81,20 +81,20 @@ QRcode*         pQRC;
 
 		// Compute QRCode
 
-  if (pQRC = QRcode_encodeString(szSourceSring, 0, QR_ECLEVEL_H, QR_MODE_8, 1))
+  if (pQRB = QRcode_encodeStringPacked(szSourceSring, 0, QR_ECLEVEL_H, QR_MODE_8, 1))
   {
-    unWidth = pQRC->width;
+    unWidth = pQRB->width;
 
     // Output the bmp file
     Bitmap bmp(unWidth * OUT_FILE_PIXEL_PRESCALER, unWidth * OUT_FILE_PIXEL_PRESCALER);
 
-    // Convert QrCode bits to bmp pixels
-    pSourceData = pQRC->data;
+    // Convert QrCode bits to bmp pixels, one bit per module, MSB first
     for(y = 0; y < unWidth; y++)
     {
+        pRow = pQRB->data + (y * pQRB->stride);
         for(x = 0; x < unWidth; x++)
         {
-          if (*pSourceData & 1)
+          if (pRow[x >> 3] & (0x80 >> (x & 7)))
           {
             for(l = 0; l < OUT_FILE_PIXEL_PRESCALER; l++)
             {
@@ -106,7 +106,6 @@ QRcode*         pQRC;
               }
             }
           }
-          pSourceData++;
         }
     }
 
@@ -114,7 +113,7 @@ QRcode*         pQRC;
     bmp.writeToFile(OUT_FILE);
 
     // Free data
-    QRcode_free(pQRC);
+    QRbitmap_free(pQRB);
   }
   else
   {